@@ -0,0 +1,224 @@
+#include "aot.h"
+#include "module.h"
+#include "opcode.h"
+#include "regvm.h"
+#include "utils.h"
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * 预编译器（wasmc-aot）：将 Wasm 模块中的函数翻译成 C 代码，再由 C 编译器编译成共享库，供 wasmc 通过 -a 选项加载执行
+ *
+ * 用法：wasmc-aot WASM_FILE_PATH OUTPUT_C_FILE
+ * 之后通过 cc -O2 -fsignaling-nans -shared -fPIC -I <wasmc 的 source 目录> OUTPUT_C_FILE -o OUTPUT_SO_FILE 编译即可
+ * 注：-fsignaling-nans 用于防止 C 编译器将 x - 0.0、x * 1.0 等浮点运算优化为 x，否则 signaling NaN 不会被转换为 quiet NaN
+ *
+ * 翻译过程直接复用寄存器执行层：先以寄存器执行层加载模块，将函数翻译成寄存器指令流，
+ * 再将每条寄存器指令翻译成 aot_runtime.h 中对应的宏调用，跳转指令翻译成 goto/switch 语句，
+ * 所以每个 Wasm 函数对应一个签名为 JitFunction 的 C 函数，栈帧布局与寄存器执行层完全一致
+ *
+ * 注：内存、表、全局变量等仍然由 wasmc 在加载 Wasm 模块时创建，预编译的函数通过模块 m 访问它们；
+ * 未被翻译成寄存器指令的函数（例如调用了外部导入函数）不会被预编译，仍然由 wasmc 解释执行
+ * */
+
+// 操作码对应的 aot_runtime.h 中的宏名称（去掉 AOT_ 前缀），为 NULL 表示该操作码无法被直接翻译成宏调用
+#define NAME(op) [op] = #op
+static const char *const op_names[OPCODE_COUNT] = {
+        NAME(Unreachable), NAME(Call), NAME(CallIndirect), NAME(ReturnCall), NAME(ReturnCallIndirect), NAME(Select), NAME(RMove), NAME(GlobalGet), NAME(GlobalSet),
+        NAME(I32Load), NAME(I64Load), NAME(F32Load), NAME(F64Load), NAME(I32Load8S), NAME(I32Load8U), NAME(I32Load16S),
+        NAME(I32Load16U), NAME(I64Load8S), NAME(I64Load8U), NAME(I64Load16S), NAME(I64Load16U), NAME(I64Load32S),
+        NAME(I64Load32U), NAME(I32Store), NAME(I64Store), NAME(F32Store), NAME(F64Store), NAME(I32Store8), NAME(I32Store16),
+        NAME(I64Store8), NAME(I64Store16), NAME(I64Store32), NAME(MemorySize), NAME(MemoryGrow),
+        NAME(I32Const), NAME(I64Const), NAME(F32Const), NAME(F64Const),
+        NAME(I32Eqz), NAME(I32Eq), NAME(I32Ne), NAME(I32LtS), NAME(I32LtU), NAME(I32GtS), NAME(I32GtU), NAME(I32LeS),
+        NAME(I32LeU), NAME(I32GeS), NAME(I32GeU), NAME(I64Eqz), NAME(I64Eq), NAME(I64Ne), NAME(I64LtS), NAME(I64LtU),
+        NAME(I64GtS), NAME(I64GtU), NAME(I64LeS), NAME(I64LeU), NAME(I64GeS), NAME(I64GeU), NAME(F32Eq), NAME(F32Ne),
+        NAME(F32Lt), NAME(F32Gt), NAME(F32Le), NAME(F32Ge), NAME(F64Eq), NAME(F64Ne), NAME(F64Lt), NAME(F64Gt),
+        NAME(F64Le), NAME(F64Ge),
+        NAME(I32Clz), NAME(I32Ctz), NAME(I32PopCnt), NAME(I32Add), NAME(I32Sub), NAME(I32Mul), NAME(I32DivS),
+        NAME(I32DivU), NAME(I32RemS), NAME(I32RemU), NAME(I32And), NAME(I32Or), NAME(I32Xor), NAME(I32Shl),
+        NAME(I32ShrS), NAME(I32ShrU), NAME(I32Rotl), NAME(I32Rotr), NAME(I64Clz), NAME(I64Ctz), NAME(I64PopCnt),
+        NAME(I64Add), NAME(I64Sub), NAME(I64Mul), NAME(I64DivS), NAME(I64DivU), NAME(I64RemS), NAME(I64RemU),
+        NAME(I64And), NAME(I64Or), NAME(I64Xor), NAME(I64Shl), NAME(I64ShrS), NAME(I64ShrU), NAME(I64Rotl),
+        NAME(I64Rotr), NAME(F32Abs), NAME(F32Neg), NAME(F32Ceil), NAME(F32Floor), NAME(F32Trunc), NAME(F32Nearest),
+        NAME(F32Sqrt), NAME(F32Add), NAME(F32Sub), NAME(F32Mul), NAME(F32Div), NAME(F32Min), NAME(F32Max),
+        NAME(F32CopySign), NAME(F64Abs), NAME(F64Neg), NAME(F64Ceil), NAME(F64Floor), NAME(F64Trunc),
+        NAME(F64Nearest), NAME(F64Sqrt), NAME(F64Add), NAME(F64Sub), NAME(F64Mul), NAME(F64Div), NAME(F64Min),
+        NAME(F64Max), NAME(F64CopySign),
+        NAME(I32WrapI64), NAME(I32TruncF32S), NAME(I32TruncF32U), NAME(I32TruncF64S), NAME(I32TruncF64U),
+        NAME(I64ExtendI32S), NAME(I64ExtendI32U), NAME(I64TruncF32S), NAME(I64TruncF32U), NAME(I64TruncF64S),
+        NAME(I64TruncF64U), NAME(F32ConvertI32S), NAME(F32ConvertI32U), NAME(F32ConvertI64S), NAME(F32ConvertI64U),
+        NAME(F32DemoteF64), NAME(F64ConvertI32S), NAME(F64ConvertI32U), NAME(F64ConvertI64S), NAME(F64ConvertI64U),
+        NAME(F64PromoteF32), NAME(I32ReinterpretF32), NAME(I64ReinterpretF64), NAME(F32ReinterpretI32),
+        NAME(F64ReinterpretI64), NAME(I32Extend8S), NAME(I32Extend16S), NAME(I64Extend8S), NAME(I64Extend16S),
+        NAME(I64Extend32S), NAME(TruncSat),
+};
+
+// 判断函数 func 的寄存器指令流能否被完整地翻译成 C 代码
+static bool can_compile(Block *func) {
+    if (!func->rcode) {
+        return false;
+    }
+    for (uint32_t i = 0; i < func->rcode_count; i++) {
+        uint16_t opcode = func->rcode[i].opcode;
+        if (opcode != Br && opcode != BrIf && opcode != RBrUnless && opcode != BrTable && opcode != Return && !op_names[opcode]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 将函数 func 的寄存器指令流翻译成 C 函数 func<fidx>
+static void emit_function(FILE *out, Module *m, Block *func, const bool *compiled) {
+    RInstr *code = func->rcode;
+    uint32_t count = func->rcode_count;
+
+    // 标记所有跳转目标，只为跳转目标生成标签，避免 C 编译器产生未使用标签的警告
+    bool *targets = acalloc(count + 1, sizeof(bool), "targets");
+    for (uint32_t i = 0; i < count; i++) {
+        if (code[i].opcode == Br || code[i].opcode == BrIf || code[i].opcode == RBrUnless) {
+            targets[code[i].imm.uint32] = true;
+        } else if (code[i].opcode == BrTable) {
+            for (uint32_t j = 0; j <= code[i].b; j++) {
+                targets[code[i].imm.table[j]] = true;
+            }
+        }
+    }
+
+    fprintf(out, "\nstatic bool func%u(Module *m, StackValue *fp) {\n", func->fidx);
+    for (uint32_t i = 0; i < count; i++) {
+        RInstr *ins = &code[i];
+
+        if (targets[i]) {
+            fprintf(out, "L%u:\n", i);
+        }
+
+        switch (ins->opcode) {
+            case Br:
+                fprintf(out, "    goto L%u;\n", ins->imm.uint32);
+                break;
+            case BrIf:
+                fprintf(out, "    if (AOT_SLOT(%u).uint32) goto L%u;\n", ins->a, ins->imm.uint32);
+                break;
+            case RBrUnless:
+                fprintf(out, "    if (!AOT_SLOT(%u).uint32) goto L%u;\n", ins->a, ins->imm.uint32);
+                break;
+            case BrTable:
+                // 如果槽位 a 的值小于跳转表大小（保存在 b 中），则跳转到跳转表中对应的地址，否则跳转到默认地址（跳转表的最后一项）
+                fprintf(out, "    switch (AOT_SLOT(%u).uint32) {\n", ins->a);
+                for (uint32_t j = 0; j < ins->b; j++) {
+                    fprintf(out, "        case %u: goto L%u;\n", j, ins->imm.table[j]);
+                }
+                fprintf(out, "        default: goto L%u;\n    }\n", ins->imm.table[ins->b]);
+                break;
+            case Return:
+                fprintf(out, "    AOT_RETURN(%u)\n", ins->a);
+                break;
+            case ReturnCall:
+                // 被尾调用的函数同样被预编译时直接尾调用对应的 C 函数，否则通过 jit_tail_call 尾调用
+                // 注：此时 compiled[ins->a] 为 false，下面 Call 分支中的判断不会成立
+                if (compiled[ins->a]) {
+                    fprintf(out, "    AOT_RETURN_CALL(%u, %u, func%u, %u)\n", ins->a, ins->b, ins->a, m->functions[ins->a].slot_count);
+                    break;
+                }
+                // fall through
+            case Call:
+                // 被调用的函数同样被预编译时直接调用对应的 C 函数，否则通过 invoke 调用
+                if (compiled[ins->a]) {
+                    fprintf(out, "    AOT_CALL(%u, %u, func%u, %u)\n", ins->a, ins->b, ins->a, m->functions[ins->a].slot_count);
+                    break;
+                }
+                // fall through
+            default:
+                fprintf(out, "    AOT_%s(%u, %u, %u, UINT64_C(0x%" PRIx64 "))\n", op_names[ins->opcode], ins->d, ins->a, ins->b,
+                        ins->imm.uint64);
+                break;
+        }
+    }
+
+    // 寄存器指令流总是以 Return 或者尾调用结尾，这里的 unreachable 只是为了让跳转到指令流末尾的标签仍然合法
+    if (targets[count]) {
+        fprintf(out, "L%u:\n", count);
+    }
+    fprintf(out, "    AOT_Unreachable(0, 0, 0, 0)\n}\n");
+
+    free(targets);
+}
+
+// 预编译器主函数
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "The right usage is:\n%s WASM_FILE_PATH OUTPUT_C_FILE\n", argv[0]);
+        return 2;
+    }
+
+    int byte_count;
+    uint8_t *bytes = mmap_file(argv[1], &byte_count);
+    if (bytes == NULL) {
+        fprintf(stderr, "Could not load %s", argv[1]);
+        return 2;
+    }
+
+    // 以寄存器执行层加载模块，即将函数翻译成寄存器指令流
+    options.tier = TierRegister;
+    Module *m = load_module(bytes, byte_count);
+
+    // 生成的内存访问代码依赖线性内存的保护页，而保护页无法覆盖 64 位内存的地址空间
+    if (m->memory.memory64) {
+        fprintf(stderr, "Could not precompile %s: 64-bit memories are not supported\n", argv[1]);
+        return 2;
+    }
+
+    FILE *out = fopen(argv[2], "w");
+    if (!out) {
+        fprintf(stderr, "Could not open %s", argv[2]);
+        return 2;
+    }
+
+    bool *compiled = acalloc(m->function_count, sizeof(bool), "compiled");
+    for (uint32_t fidx = m->import_func_count; fidx < m->function_count; fidx++) {
+        compiled[fidx] = can_compile(&m->functions[fidx]);
+    }
+
+    fprintf(out, "// Generated by wasmc-aot from %s, do not edit.\n", argv[1]);
+    // 生成的代码必须与 wasmc-aot（即 wasmc）使用相同的槽位格式
+    fprintf(out, "#define WASMC_UNTAGGED_SLOTS %d\n", WASMC_UNTAGGED_SLOTS);
+    fprintf(out, "#include \"aot_runtime.h\"\n\n");
+
+    // 函数之间可能相互调用，所以先声明所有函数
+    for (uint32_t fidx = m->import_func_count; fidx < m->function_count; fidx++) {
+        if (compiled[fidx]) {
+            fprintf(out, "static bool func%u(Module *m, StackValue *fp);\n", fidx);
+        }
+    }
+
+    for (uint32_t fidx = m->import_func_count; fidx < m->function_count; fidx++) {
+        if (compiled[fidx]) {
+            emit_function(out, m, &m->functions[fidx], compiled);
+        }
+    }
+
+    // 模块描述符
+    fprintf(out, "\nstatic const uint32_t slot_counts[%u] = {", m->function_count);
+    for (uint32_t fidx = 0; fidx < m->function_count; fidx++) {
+        fprintf(out, "%s%u", fidx ? ", " : "", compiled[fidx] ? m->functions[fidx].slot_count : 0);
+    }
+    fprintf(out, "};\n\nstatic const JitFunction functions[%u] = {", m->function_count);
+    for (uint32_t fidx = 0; fidx < m->function_count; fidx++) {
+        if (compiled[fidx]) {
+            fprintf(out, "%sfunc%u", fidx ? ", " : "", fidx);
+        } else {
+            fprintf(out, "%sNULL", fidx ? ", " : "");
+        }
+    }
+    fprintf(out, "};\n\nconst AotModule " AOT_MODULE_SYMBOL " = {AOT_VERSION, sizeof(StackValue), %u, 0x%" PRIx32 "u, %u, slot_counts, functions};\n",
+            (uint32_t) byte_count, aot_checksum(bytes, byte_count), m->function_count);
+
+    fclose(out);
+    free(compiled);
+    return 0;
+}
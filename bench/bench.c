@@ -0,0 +1,167 @@
+#include "interpreter.h"
+#include "module.h"
+#include "opcode.h"
+#include "utils.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// 获取当前的单调时钟时间（单位为纳秒）
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// 基准测试主函数：加载 Wasm 模块，多次调用指定的导出函数，并统计平均每次调用以及平均每条指令的耗时
+// 用法：wasmc-bench [-n 调用次数] [-c 单次调用执行的指令数] [-t 执行层] [-b 越界检查方式] [-F 禁用超级指令融合] [-P 禁用窥孔优化] [-I 禁用小函数内联] WASM_FILE_PATH FUNC [ARGS...]
+// 注：以 WASMC_PROFILE 构建时会直接统计并打印单次调用执行的指令数，
+// 将该值通过 -c 传给其他构建方式的 wasmc-bench，即可计算出平均每条指令的耗时
+int main(int argc, char **argv) {
+    int iterations = 10;  // 调用次数
+    uint64_t icount = 0;  // 单次调用执行的指令数
+    int opt;
+
+#if WASMC_PROFILE
+    // 统计时禁用超级指令融合、窥孔优化以及小函数内联，使统计结果反映原始的 Wasm 指令序列
+    options.no_fusion = true;
+    options.no_peephole = true;
+    options.no_inline = true;
+#endif
+
+    while ((opt = getopt(argc, argv, "n:c:t:T:H:L:b:FPI")) != -1) {
+        switch (opt) {
+            case 'n':
+                iterations = (int) strtol(optarg, NULL, 0);
+                break;
+            case 'c':
+                icount = strtoull(optarg, NULL, 0);
+                break;
+            case 't':
+                if (strcmp(optarg, "register") == 0) {
+                    options.tier = TierRegister;
+                } else if (strcmp(optarg, "jit") == 0) {
+                    options.tier = TierJit;
+                } else if (strcmp(optarg, "stencil") == 0) {
+                    options.tier = TierStencil;
+                } else if (strcmp(optarg, "auto") == 0) {
+                    options.tier = TierAuto;
+                } else {
+                    options.tier = TierInterp;
+                }
+                break;
+            case 'T':
+                if (strcmp(optarg, "register") == 0) {
+                    options.hot_tier = TierRegister;
+                } else if (strcmp(optarg, "stencil") == 0) {
+                    options.hot_tier = TierStencil;
+                } else {
+                    options.hot_tier = TierJit;
+                }
+                break;
+            case 'H':
+                options.hot_calls = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'L':
+                options.hot_loops = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                if (strcmp(optarg, "explicit") == 0) {
+                    options.bounds = BoundsExplicit;
+                } else if (strcmp(optarg, "mask") == 0) {
+                    options.bounds = BoundsMask;
+                } else {
+                    options.bounds = BoundsGuard;
+                }
+                break;
+            case 'F':
+                options.no_fusion = true;
+                break;
+            case 'P':
+                options.no_peephole = true;
+                break;
+            case 'I':
+                options.no_inline = true;
+                break;
+            default:
+                fprintf(stderr, "The right usage is:\n%s [-n ITERATIONS] [-c INSTRUCTIONS] [-t interp|register|jit|stencil|auto] [-T register|jit|stencil] [-H CALLS] [-L COUNT] [-b guard|explicit|mask] [-F] [-P] [-I] WASM_FILE_PATH FUNC [ARGS...]\n-b mask does not trap on out-of-bounds accesses: they wrap around onto live linear memory\n", argv[0]);
+                return 2;
+        }
+    }
+
+    if (argc - optind < 2) {
+        fprintf(stderr, "The right usage is:\n%s [-n ITERATIONS] [-c INSTRUCTIONS] [-t interp|register|jit|stencil|auto] [-T register|jit|stencil] [-H CALLS] [-L COUNT] [-b guard|explicit|mask] [-F] [-P] [-I] WASM_FILE_PATH FUNC [ARGS...]\n-b mask does not trap on out-of-bounds accesses: they wrap around onto live linear memory\n", argv[0]);
+        return 2;
+    }
+
+    int byte_count;
+    uint8_t *bytes = mmap_file(argv[optind], &byte_count);
+    if (bytes == NULL) {
+        fprintf(stderr, "Could not load %s", argv[optind]);
+        return 2;
+    }
+    Module *m = load_module(bytes, byte_count);
+
+    Block *func = get_export(m, argv[optind + 1]);
+    if (!func) {
+        ERROR("no exported function named '%s'\n", argv[optind + 1])
+        return 2;
+    }
+
+    uint64_t total = 0;
+    for (int n = 0; n < iterations; n++) {
+        // 重置运行时相关状态，并重新压入函数参数
+        m->sp = -1;
+        m->fp = -1;
+        m->csp = -1;
+        parse_args(m, func->type, argc - optind - 2, argv + optind + 2);
+
+        uint64_t start = now_ns();
+        if (!invoke(m, func->fidx)) {
+            ERROR("Exception: %s\n", exception)
+            return 1;
+        }
+        total += now_ns() - start;
+    }
+
+#if WASMC_PROFILE
+    // 统计所有操作码的执行次数之和，即为所有调用执行的指令总数
+    uint64_t executed = 0;
+    for (int op = 0; op < OPCODE_COUNT; op++) {
+        executed += opcode_profile[op];
+    }
+    icount = executed / iterations;
+    printf("instructions/call: %" PRIu64 "\n", icount);
+
+    // 打印被连续执行次数最多的若干对相邻指令，作为挑选超级指令的参考
+    for (int top = 0; top < 10; top++) {
+        int best_first = 0, best_second = 0;
+        for (int first = 0; first < OPCODE_COUNT; first++) {
+            for (int second = 0; second < OPCODE_COUNT; second++) {
+                if (opcode_pair_profile[first][second] > opcode_pair_profile[best_first][best_second]) {
+                    best_first = first;
+                    best_second = second;
+                }
+            }
+        }
+        if (opcode_pair_profile[best_first][best_second] == 0) {
+            break;
+        }
+        printf("pair 0x%02x 0x%02x: %" PRIu64 "/call\n", best_first, best_second,
+               opcode_pair_profile[best_first][best_second] / iterations);
+        opcode_pair_profile[best_first][best_second] = 0;
+    }
+#endif
+
+    printf("%s: %d calls, %.3f ms/call", argv[optind + 1], iterations, (double) total / iterations / 1e6);
+    if (icount) {
+        printf(", %.3f ns/instruction", (double) total / iterations / icount);
+    }
+    printf("\n");
+
+    return 0;
+}
@@ -3,19 +3,21 @@
 
 typedef enum {
     /*控制指令 */
-    Unreachable = 0x00, // unreachable
-    Nop = 0x01,         // nop
-    Block_ = 0x02,      // block bt instr* end
-    Loop = 0x03,        // loop bt instr* end
-    If = 0x04,          // if bt instr* else instr* end
-    Else_ = 0x05,       // else
-    End_ = 0x0B,        // end
-    Br = 0x0C,          // br l
-    BrIf = 0x0D,        // br_if l
-    BrTable = 0x0E,     // br_table label_table* label_index
-    Return = 0x0F,      // return
-    Call = 0x10,        // call funcidx
-    CallIndirect = 0x11,// call_indirect tableidx typeidx
+    Unreachable = 0x00,       // unreachable
+    Nop = 0x01,               // nop
+    Block_ = 0x02,            // block bt instr* end
+    Loop = 0x03,              // loop bt instr* end
+    If = 0x04,                // if bt instr* else instr* end
+    Else_ = 0x05,             // else
+    End_ = 0x0B,              // end
+    Br = 0x0C,                // br l
+    BrIf = 0x0D,              // br_if l
+    BrTable = 0x0E,           // br_table label_table* label_index
+    Return = 0x0F,            // return
+    Call = 0x10,              // call funcidx
+    CallIndirect = 0x11,      // call_indirect tableidx typeidx
+    ReturnCall = 0x12,        // return_call funcidx
+    ReturnCallIndirect = 0x13,// return_call_indirect tableidx typeidx
 
     /*引用指令 */
     RefNull = 0xD0,  // ref.null reftype
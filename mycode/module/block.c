@@ -215,11 +215,13 @@ void skip_immediate(const u8 *bytes, u32 *pos) {
             read_LEB128_unsigned(bytes, pos, 32);
             break;
         case Call:
-            // Call 指令的立即数表示被调用函数的索引（占 4 个字节）
+        case ReturnCall:
+            // Call/ReturnCall 指令的立即数表示被调用函数的索引（占 4 个字节）
             read_LEB128_unsigned(bytes, pos, 32);
             break;
         case CallIndirect:
-            // CallIndirect 指令有两个立即数，第一个立即数表示被调用函数的类型索引（占 4 个字节），
+        case ReturnCallIndirect:
+            // CallIndirect/ReturnCallIndirect 指令有两个立即数，第一个立即数表示被调用函数的类型索引（占 4 个字节），
             // 第二个立即数为函数所在表的下标
             read_LEB128_unsigned(bytes, pos, 32);
             read_LEB128_unsigned(bytes, pos, 32);
@@ -0,0 +1,68 @@
+#include "aot.h"
+#include "jit.h"
+#include "memory.h"
+#include "module.h"
+#include "utils.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * 预编译（AOT，ahead-of-time）执行方式的背景知识：
+ * 对于长期不变的 Wasm 模块，可以预先由 wasmc-aot 将模块中的函数翻译成 C 代码，再由 C 编译器编译成共享库，
+ * 运行时 wasmc 仍然正常解析 Wasm 模块（包括内存、表、全局变量、导出项等），只是通过 dlopen 加载共享库后，
+ * 将其中预编译的函数设置为对应函数的 jit_code，这样函数就直接以本机机器码的形式执行，而进程中不需要任何 JIT 编译
+ *
+ * 预编译的函数与 JIT/copy-and-patch 执行层编译得到的机器码一样遵循 JitFunction 的签名，栈帧布局也与寄存器执行层完全一致，
+ * 所以导出函数的调用方式、REPL 交互方式以及异常信息都与其他执行层相同
+ * */
+
+uint32_t aot_checksum(const uint8_t *bytes, uint32_t byte_count) {
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < byte_count; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool aot_load(Module *m, const uint8_t *bytes, uint32_t byte_count, char *path) {
+    const AotModule *aot = NULL;
+    char *err = NULL;
+
+    // 预编译得到的内存访问代码没有越界检查，依赖线性内存的保护页（64 位内存无法使用保护页）
+    if (!MEMORY_GUARDED(m->memory)) {
+        sprintf(exception, "%s requires guard-page bounds checking", path);
+        return false;
+    }
+
+    // 查找共享库中导出的模块描述符
+    if (!resolve_sym(path, AOT_MODULE_SYMBOL, (void **) &aot, &err)) {
+        sprintf(exception, "could not load %s: %s", path, err);
+        return false;
+    }
+
+    // 共享库必须与当前构建的格式版本以及槽位格式一致
+    if (aot->version != AOT_VERSION || aot->slot_size != sizeof(StackValue)) {
+        sprintf(exception, "%s was compiled for a different wasmc build", path);
+        return false;
+    }
+
+    // 共享库必须由当前加载的 Wasm 模块生成，否则函数索引、槽位编号等都无法对应
+    if (aot->byte_count != byte_count || aot->checksum != aot_checksum(bytes, byte_count) || aot->function_count != m->function_count) {
+        sprintf(exception, "%s was not compiled from this module", path);
+        return false;
+    }
+
+    for (uint32_t fidx = m->import_func_count; fidx < m->function_count; fidx++) {
+        Block *func = &m->functions[fidx];
+        if (aot->functions[fidx] == NULL) {
+            continue;
+        }
+        func->jit_code = (void *) aot->functions[fidx];
+        func->slot_count = aot->slot_counts[fidx];
+        // 预编译的函数不再参与分层执行的热点提升
+        func->hotness = UINT32_MAX;
+    }
+
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef WASMC_AOT_H
+#define WASMC_AOT_H
+
+#include "jit.h"
+#include "module.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// 预编译（AOT）模块的格式版本，wasmc-aot 生成的 C 代码与 wasmc 的版本不一致时拒绝加载
+#define AOT_VERSION 6
+
+// 预编译模块中导出的模块描述符的符号名
+#define AOT_MODULE_SYMBOL "wasmc_aot_module"
+
+// 预编译模块的描述符，由 wasmc-aot 生成的 C 代码定义，wasmc 通过 dlopen 加载共享库后据此为每个函数设置机器码入口
+typedef struct AotModule {
+    uint32_t version;            // 格式版本，即 AOT_VERSION
+    uint32_t slot_size;          // 槽位的字节数，用于确认共享库与当前构建的槽位格式一致
+    uint32_t byte_count;         // 预编译时 Wasm 模块文件的字节数
+    uint32_t checksum;           // 预编译时 Wasm 模块文件的校验和（见 aot_checksum），用于确认共享库与当前加载的 Wasm 模块一致
+    uint32_t function_count;     // 模块中函数的数量（包含导入函数）
+    const uint32_t *slot_counts; // 每个函数栈帧占用的槽位数量，与寄存器执行层中的 slot_count 一致
+    const JitFunction *functions;// 每个函数编译得到的机器码入口，为 NULL 表示该函数未被预编译（例如导入函数），继续由 wasmc 解释执行
+} AotModule;
+
+// 计算 Wasm 模块文件的校验和（32 位 FNV-1a 哈希）
+uint32_t aot_checksum(const uint8_t *bytes, uint32_t byte_count);
+
+// 通过 dlopen 加载由 wasmc-aot 生成并编译得到的共享库 path，将其中预编译的函数设置为模块 m 中对应函数的 jit_code，
+// 之后调用这些函数时 invoke 会直接通过 jit_run 执行预编译得到的机器码，如果加载失败则记录异常信息并返回 false
+// 注：参数 bytes/byte_count 为加载模块 m 时使用的 Wasm 模块文件，用于校验共享库是否由同一个 Wasm 模块生成
+bool aot_load(Module *m, const uint8_t *bytes, uint32_t byte_count, char *path);
+
+#endif
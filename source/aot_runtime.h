@@ -0,0 +1,455 @@
+#ifndef WASMC_AOT_RUNTIME_H
+#define WASMC_AOT_RUNTIME_H
+
+#include "aot.h"
+#include "interpreter.h"
+#include "jit.h"
+#include "memory.h"
+#include "module.h"
+#include "utils.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * 预编译模块的运行时头文件，只被 wasmc-aot 生成的 C 代码包含
+ *
+ * wasmc-aot 将每条寄存器指令 op d, a, b, imm 翻译成一次宏调用 AOT_op(d, a, b, imm)，其中的操作数都是编译期常量，
+ * 所以 C 编译器可以把槽位编号直接编码为内存操作数的偏移量，并在相邻指令之间做常规的优化（寄存器分配、常量传播等）
+ * 控制指令（跳转、函数调用、返回）则由 wasmc-aot 直接生成 goto/switch/return 语句
+ *
+ * 这里的宏与寄存器虚拟机 reg_execute 以及 copy-and-patch 模板库中的指令语义完全一致，
+ * 并直接复用 utils.h 中的 OP_TRUNC 系列宏、wa_fmin/wa_fmax、rotl32 等公共方法（这些方法在运行时由 wasmc 可执行文件提供）
+ * */
+
+// 槽位 n 的值
+#define AOT_SLOT(N) fp[N].value
+
+// 将计算结果（类型为 TYPE，对应 StackValue 中的 FIELD 字段）写入槽位 D
+#define AOT_RESULT(D, TYPE, FIELD, EXPR) \
+    fp[D].value.FIELD = (EXPR);          \
+    SET_VALUE_TYPE(fp[D], TYPE)
+
+// 记录异常信息并返回 false
+#define AOT_TRAP(MESSAGE)               \
+    {                                   \
+        sprintf(exception, MESSAGE);    \
+        return false;                   \
+    }
+
+// 以下宏用于定义数值指令，与寄存器虚拟机中的同名宏一致
+#define AOT_UNARY(D, A, CTYPE, FIELD, TYPE, RFIELD, EXPR) \
+    {                                                     \
+        CTYPE x = AOT_SLOT(A).FIELD;                      \
+        AOT_RESULT(D, TYPE, RFIELD, EXPR)                 \
+    }
+
+#define AOT_BINARY(D, A, B, CTYPE, FIELD, TYPE, RFIELD, EXPR) \
+    {                                                         \
+        CTYPE x = AOT_SLOT(A).FIELD;                          \
+        CTYPE y = AOT_SLOT(B).FIELD;                          \
+        AOT_RESULT(D, TYPE, RFIELD, EXPR)                     \
+    }
+
+#define AOT_I32_UNARY(D, A, EXPR) AOT_UNARY(D, A, uint32_t, uint32, I32, uint32, EXPR)
+#define AOT_I64_UNARY(D, A, EXPR) AOT_UNARY(D, A, uint64_t, uint64, I64, uint64, EXPR)
+#define AOT_F32_UNARY(D, A, EXPR) AOT_UNARY(D, A, float, f32, F32, f32, EXPR)
+#define AOT_F64_UNARY(D, A, EXPR) AOT_UNARY(D, A, double, f64, F64, f64, EXPR)
+
+#define AOT_I32_BINARY(D, A, B, EXPR) AOT_BINARY(D, A, B, uint32_t, uint32, I32, uint32, EXPR)
+#define AOT_I64_BINARY(D, A, B, EXPR) AOT_BINARY(D, A, B, uint64_t, uint64, I64, uint64, EXPR)
+#define AOT_F32_BINARY(D, A, B, EXPR) AOT_BINARY(D, A, B, float, f32, F32, f32, EXPR)
+#define AOT_F64_BINARY(D, A, B, EXPR) AOT_BINARY(D, A, B, double, f64, F64, f64, EXPR)
+
+#define AOT_I32_COMPARE(D, A, B, EXPR) AOT_BINARY(D, A, B, uint32_t, uint32, I32, uint32, EXPR)
+#define AOT_I64_COMPARE(D, A, B, EXPR) AOT_BINARY(D, A, B, uint64_t, uint64, I32, uint32, EXPR)
+#define AOT_F32_COMPARE(D, A, B, EXPR) AOT_BINARY(D, A, B, float, f32, I32, uint32, EXPR)
+#define AOT_F64_COMPARE(D, A, B, EXPR) AOT_BINARY(D, A, B, double, f64, I32, uint32, EXPR)
+
+// 加载指令按字节数 SIZE 读取内存时使用的类型：允许不对齐的地址，且以 volatile 方式读取
+// 注：加载的结果可能被丢弃（例如 i32.load; drop），C 编译器会删除结果未被使用的普通读取，
+// 越界访问就不会访问到保护页，所以这里必须保证每条加载指令都真正读取了内存
+typedef uint8_t aot_load_1;
+typedef uint16_t aot_load_2 __attribute__((aligned(1)));
+typedef uint32_t aot_load_4 __attribute__((aligned(1)));
+typedef uint64_t aot_load_8 __attribute__((aligned(1)));
+
+// 内存加载/存储，内存偏移量保存在立即数 IMM 中
+// 注：与栈式解释器一致，越界访问由线性内存的保护页捕获（见 memory.c）
+#define AOT_LOAD(D, A, IMM, TYPE, SIZE)                                                 \
+    {                                                                                   \
+        uint8_t *maddr = m->memory.bytes + (uint32_t) (IMM) + AOT_SLOT(A).uint32;       \
+        AOT_SLOT(D).uint64 = *(volatile aot_load_##SIZE *) maddr;                       \
+        SET_VALUE_TYPE(fp[D], TYPE)                                                     \
+    }
+
+#define AOT_STORE(A, B, IMM, FIELD, SIZE)                                               \
+    {                                                                                   \
+        uint8_t *maddr = m->memory.bytes + (uint32_t) (IMM) + AOT_SLOT(A).uint32;       \
+        memcpy(maddr, &AOT_SLOT(B).FIELD, SIZE);                                        \
+    }
+
+// 整数除法/取余的除数为 0 时，记录异常信息并返回 false
+#define AOT_DIVISOR_CHECK(B, FIELD)           \
+    if (AOT_SLOT(B).FIELD == 0) {             \
+        AOT_TRAP("integer divide by zero")    \
+    }
+
+// 非饱和截断，结果类型为 TYPE，对应 StackValue 中的 FIELD 字段
+#define AOT_TRUNC(D, A, OP, TYPE, FIELD, SRC_FIELD) \
+    OP(AOT_SLOT(D).FIELD, AOT_SLOT(A).SRC_FIELD)    \
+    SET_VALUE_TYPE(fp[D], TYPE)
+
+// 直接调用同一个共享库中预编译的函数 FN（函数索引为 FIDX，栈帧占用 SLOTS 个槽位），参数已经位于槽位 TOP 之前的槽位中
+// 注：相当于内联展开的 invoke + jit_run，省去了通过 jit_code 的间接调用
+#define AOT_CALL(FIDX, TOP, FN, SLOTS)                    \
+    if (m->csp >= CALLSTACK_SIZE - 1) {                   \
+        AOT_TRAP("call stack exhausted")                  \
+    }                                                     \
+    m->sp = m->fp + (int) (TOP) - 1;                      \
+    setup_call(m, FIDX);                                  \
+    if (m->fp + (SLOTS) >= STACK_SIZE) {                  \
+        AOT_TRAP("call stack exhausted")                  \
+    }                                                     \
+    if (!FN(m, &m->stack[m->fp])) {                       \
+        return false;                                     \
+    }
+
+// 尾调用同一个共享库中预编译的函数 FN（参数同 AOT_CALL）：被调用函数复用当前栈帧，再尾调用 FN，C 编译器会将其编译成一条 jmp 指令
+#define AOT_RETURN_CALL(FIDX, TOP, FN, SLOTS)             \
+    m->sp = m->fp + (int) (TOP) - 1;                      \
+    if (!setup_tail_call(m, FIDX)) {                      \
+        return false;                                     \
+    }                                                     \
+    if (m->fp + (SLOTS) >= STACK_SIZE) {                  \
+        AOT_TRAP("call stack exhausted")                  \
+    }                                                     \
+    return FN(m, fp);
+
+// 返回：将返回值所在的槽位设置为操作数栈顶，由 pop_block 拷贝到调用方的操作数栈顶，并弹出当前函数的栈帧
+#define AOT_RETURN(TOP)               \
+    m->sp = m->fp + (int) (TOP);      \
+    return pop_block(m) != NULL;
+
+/*
+ * 控制指令（跳转和返回由 wasmc-aot 直接生成）
+ * */
+#define AOT_Unreachable(D, A, B, IMM) AOT_TRAP("unreachable")
+
+#define AOT_Call(D, A, B, IMM)                 \
+    if (m->csp >= CALLSTACK_SIZE - 1) {        \
+        AOT_TRAP("call stack exhausted")       \
+    }                                          \
+    m->sp = m->fp + (int) (B) - 1;             \
+    if (!invoke(m, A)) {                       \
+        return false;                          \
+    }
+
+// 间接调用：槽位 IMM 的值是【函数索引值】在表中的索引，类型索引保存在 A 中，该调用点的内联缓存的索引保存在 D 中
+// 内联缓存命中时直接调用缓存的函数，未命中时才需要读取表并校验函数签名
+#define AOT_CallIndirect(D, A, B, IMM)                                                                           \
+    {                                                                                                            \
+        uint32_t val = AOT_SLOT(IMM).uint32;                                                                     \
+        CallCache *cache = &m->call_caches[D];                                                                   \
+        Block *func;                                                                                             \
+        CALL_CACHE_LOOKUP(cache, val, func)                                                                      \
+        if (!func) {                                                                                             \
+            if (val >= m->table.max_size) {                                                                      \
+                sprintf(exception, "undefined element 0x%x (max: 0x%x) in table", val, m->table.max_size);       \
+                return false;                                                                                    \
+            }                                                                                                    \
+            func = &m->functions[m->table.entries[val]];                                                         \
+            /* TODO: 暂时忽略调用外部引入函数情况 */                                                             \
+            if (func->fidx >= m->import_func_count) {                                                            \
+                if (func->type->type_id != m->types[A].type_id) {                                                \
+                    AOT_TRAP("indirect call type mismatch (call type and function type differ)")                 \
+                }                                                                                                \
+                call_cache_insert(cache, val, func);                                                             \
+            }                                                                                                    \
+        }                                                                                                        \
+        if (func->fidx >= m->import_func_count) {                                                                \
+            if (m->csp >= CALLSTACK_SIZE - 1) {                                                                  \
+                AOT_TRAP("call stack exhausted")                                                                 \
+            }                                                                                                    \
+            m->sp = m->fp + (int) (B) - 1;                                                                       \
+            if (!invoke(m, func->fidx)) {                                                                        \
+                return false;                                                                                    \
+            }                                                                                                    \
+        }                                                                                                        \
+    }
+
+// 尾调用未被预编译的函数（或者间接尾调用）：由 jit_tail_call 复用当前栈帧，再尾调用其返回的函数
+// 注：指令保存在静态变量中，这样其地址不会指向当前函数的栈帧，C 编译器仍然可以将最后的调用编译成 jmp 指令
+#define AOT_TAIL_CALL(OP, D, A, B, IMM)                                                        \
+    {                                                                                          \
+        static RInstr tail_ins = {OP, D, A, B, {.uint64 = IMM}};                               \
+        return jit_tail_call(m, &tail_ins)(m, fp);                                             \
+    }
+
+#define AOT_ReturnCall(D, A, B, IMM) AOT_TAIL_CALL(ReturnCall, D, A, B, IMM)
+#define AOT_ReturnCallIndirect(D, A, B, IMM) AOT_TAIL_CALL(ReturnCallIndirect, D, A, B, IMM)
+
+/*
+ * 参数指令
+ * */
+// 判断条件所在的槽位保存在立即数 IMM 中
+#define AOT_Select(D, A, B, IMM) fp[D] = AOT_SLOT(IMM).uint32 ? fp[A] : fp[B];
+
+/*
+ * 变量指令
+ * */
+#define AOT_RMove(D, A, B, IMM) fp[D] = fp[A];
+#define AOT_GlobalGet(D, A, B, IMM) fp[D] = m->globals[A];
+#define AOT_GlobalSet(D, A, B, IMM) m->globals[A] = fp[B];
+
+/*
+ * 内存指令
+ * */
+#define AOT_I32Load(D, A, B, IMM) AOT_LOAD(D, A, IMM, I32, 4)
+#define AOT_I64Load(D, A, B, IMM) AOT_LOAD(D, A, IMM, I64, 8)
+#define AOT_F32Load(D, A, B, IMM) AOT_LOAD(D, A, IMM, F32, 4)
+#define AOT_F64Load(D, A, B, IMM) AOT_LOAD(D, A, IMM, F64, 8)
+#define AOT_I32Load8S(D, A, B, IMM) AOT_LOAD(D, A, IMM, I32, 1) sext_8_32(&AOT_SLOT(D).uint32);
+#define AOT_I32Load8U(D, A, B, IMM) AOT_LOAD(D, A, IMM, I32, 1)
+#define AOT_I32Load16S(D, A, B, IMM) AOT_LOAD(D, A, IMM, I32, 2) sext_16_32(&AOT_SLOT(D).uint32);
+#define AOT_I32Load16U(D, A, B, IMM) AOT_LOAD(D, A, IMM, I32, 2)
+#define AOT_I64Load8S(D, A, B, IMM) AOT_LOAD(D, A, IMM, I64, 1) sext_8_64(&AOT_SLOT(D).uint64);
+#define AOT_I64Load8U(D, A, B, IMM) AOT_LOAD(D, A, IMM, I64, 1)
+#define AOT_I64Load16S(D, A, B, IMM) AOT_LOAD(D, A, IMM, I64, 2) sext_16_64(&AOT_SLOT(D).uint64);
+#define AOT_I64Load16U(D, A, B, IMM) AOT_LOAD(D, A, IMM, I64, 2)
+#define AOT_I64Load32S(D, A, B, IMM) AOT_LOAD(D, A, IMM, I64, 4) sext_32_64(&AOT_SLOT(D).uint64);
+#define AOT_I64Load32U(D, A, B, IMM) AOT_LOAD(D, A, IMM, I64, 4)
+#define AOT_I32Store(D, A, B, IMM) AOT_STORE(A, B, IMM, uint32, 4)
+#define AOT_I64Store(D, A, B, IMM) AOT_STORE(A, B, IMM, uint64, 8)
+#define AOT_F32Store(D, A, B, IMM) AOT_STORE(A, B, IMM, f32, 4)
+#define AOT_F64Store(D, A, B, IMM) AOT_STORE(A, B, IMM, f64, 8)
+#define AOT_I32Store8(D, A, B, IMM) AOT_STORE(A, B, IMM, uint32, 1)
+#define AOT_I32Store16(D, A, B, IMM) AOT_STORE(A, B, IMM, uint32, 2)
+#define AOT_I64Store8(D, A, B, IMM) AOT_STORE(A, B, IMM, uint64, 1)
+#define AOT_I64Store16(D, A, B, IMM) AOT_STORE(A, B, IMM, uint64, 2)
+#define AOT_I64Store32(D, A, B, IMM) AOT_STORE(A, B, IMM, uint64, 4)
+#define AOT_MemorySize(D, A, B, IMM) AOT_RESULT(D, I32, uint32, m->memory.cur_size)
+
+// 超过内存最大页数或者 memory_grow 失败时结果为 -1（即 0xFFFFFFFF），页数上限在 64 位下校验，避免 delta 加上当前页数后回绕
+#define AOT_MemoryGrow(D, A, B, IMM)                                                                                      \
+    {                                                                                                                     \
+        uint32_t prev_pages = m->memory.cur_size;                                                                         \
+        uint64_t delta = AOT_SLOT(A).uint32;                                                                              \
+        uint32_t pages = prev_pages;                                                                                      \
+        if (delta > (uint64_t) m->memory.max_size - prev_pages ||                                                         \
+            (delta != 0 && !memory_grow(&m->memory, (uint32_t) delta))) {                                                 \
+            pages = UINT32_MAX;                                                                                           \
+        }                                                                                                                 \
+        AOT_RESULT(D, I32, uint32, pages)                                                                                 \
+    }
+
+/*
+ * 数值指令--常量指令
+ * */
+#define AOT_I32Const(D, A, B, IMM) AOT_RESULT(D, I32, uint64, IMM)
+#define AOT_I64Const(D, A, B, IMM) AOT_RESULT(D, I64, uint64, IMM)
+#define AOT_F32Const(D, A, B, IMM) AOT_RESULT(D, F32, uint64, IMM)
+#define AOT_F64Const(D, A, B, IMM) AOT_RESULT(D, F64, uint64, IMM)
+
+/*
+ * 数值指令--测试指令和比较指令
+ * */
+#define AOT_I32Eqz(D, A, B, IMM) AOT_RESULT(D, I32, uint32, AOT_SLOT(A).uint32 == 0)
+#define AOT_I64Eqz(D, A, B, IMM) AOT_RESULT(D, I32, uint32, AOT_SLOT(A).uint64 == 0)
+#define AOT_I32Eq(D, A, B, IMM) AOT_I32_COMPARE(D, A, B, x == y)
+#define AOT_I32Ne(D, A, B, IMM) AOT_I32_COMPARE(D, A, B, x != y)
+#define AOT_I32LtS(D, A, B, IMM) AOT_I32_COMPARE(D, A, B, (int32_t) x < (int32_t) y)
+#define AOT_I32LtU(D, A, B, IMM) AOT_I32_COMPARE(D, A, B, x < y)
+#define AOT_I32GtS(D, A, B, IMM) AOT_I32_COMPARE(D, A, B, (int32_t) x > (int32_t) y)
+#define AOT_I32GtU(D, A, B, IMM) AOT_I32_COMPARE(D, A, B, x > y)
+#define AOT_I32LeS(D, A, B, IMM) AOT_I32_COMPARE(D, A, B, (int32_t) x <= (int32_t) y)
+#define AOT_I32LeU(D, A, B, IMM) AOT_I32_COMPARE(D, A, B, x <= y)
+#define AOT_I32GeS(D, A, B, IMM) AOT_I32_COMPARE(D, A, B, (int32_t) x >= (int32_t) y)
+#define AOT_I32GeU(D, A, B, IMM) AOT_I32_COMPARE(D, A, B, x >= y)
+#define AOT_I64Eq(D, A, B, IMM) AOT_I64_COMPARE(D, A, B, x == y)
+#define AOT_I64Ne(D, A, B, IMM) AOT_I64_COMPARE(D, A, B, x != y)
+#define AOT_I64LtS(D, A, B, IMM) AOT_I64_COMPARE(D, A, B, (int64_t) x < (int64_t) y)
+#define AOT_I64LtU(D, A, B, IMM) AOT_I64_COMPARE(D, A, B, x < y)
+#define AOT_I64GtS(D, A, B, IMM) AOT_I64_COMPARE(D, A, B, (int64_t) x > (int64_t) y)
+#define AOT_I64GtU(D, A, B, IMM) AOT_I64_COMPARE(D, A, B, x > y)
+#define AOT_I64LeS(D, A, B, IMM) AOT_I64_COMPARE(D, A, B, (int64_t) x <= (int64_t) y)
+#define AOT_I64LeU(D, A, B, IMM) AOT_I64_COMPARE(D, A, B, x <= y)
+#define AOT_I64GeS(D, A, B, IMM) AOT_I64_COMPARE(D, A, B, (int64_t) x >= (int64_t) y)
+#define AOT_I64GeU(D, A, B, IMM) AOT_I64_COMPARE(D, A, B, x >= y)
+#define AOT_F32Eq(D, A, B, IMM) AOT_F32_COMPARE(D, A, B, x == y)
+#define AOT_F32Ne(D, A, B, IMM) AOT_F32_COMPARE(D, A, B, x != y)
+#define AOT_F32Lt(D, A, B, IMM) AOT_F32_COMPARE(D, A, B, x < y)
+#define AOT_F32Gt(D, A, B, IMM) AOT_F32_COMPARE(D, A, B, x > y)
+#define AOT_F32Le(D, A, B, IMM) AOT_F32_COMPARE(D, A, B, x <= y)
+#define AOT_F32Ge(D, A, B, IMM) AOT_F32_COMPARE(D, A, B, x >= y)
+#define AOT_F64Eq(D, A, B, IMM) AOT_F64_COMPARE(D, A, B, x == y)
+#define AOT_F64Ne(D, A, B, IMM) AOT_F64_COMPARE(D, A, B, x != y)
+#define AOT_F64Lt(D, A, B, IMM) AOT_F64_COMPARE(D, A, B, x < y)
+#define AOT_F64Gt(D, A, B, IMM) AOT_F64_COMPARE(D, A, B, x > y)
+#define AOT_F64Le(D, A, B, IMM) AOT_F64_COMPARE(D, A, B, x <= y)
+#define AOT_F64Ge(D, A, B, IMM) AOT_F64_COMPARE(D, A, B, x >= y)
+
+/*
+ * 数值指令--算术指令
+ * */
+#define AOT_I32Clz(D, A, B, IMM) AOT_I32_UNARY(D, A, x == 0 ? 32 : __builtin_clz(x))
+#define AOT_I32Ctz(D, A, B, IMM) AOT_I32_UNARY(D, A, x == 0 ? 32 : __builtin_ctz(x))
+#define AOT_I32PopCnt(D, A, B, IMM) AOT_I32_UNARY(D, A, __builtin_popcount(x))
+#define AOT_I32Add(D, A, B, IMM) AOT_I32_BINARY(D, A, B, x + y)
+#define AOT_I32Sub(D, A, B, IMM) AOT_I32_BINARY(D, A, B, x - y)
+#define AOT_I32Mul(D, A, B, IMM) AOT_I32_BINARY(D, A, B, x * y)
+#define AOT_I32DivS(D, A, B, IMM)                                              \
+    AOT_DIVISOR_CHECK(B, uint32)                                               \
+    if (AOT_SLOT(A).uint32 == 0x80000000 && AOT_SLOT(B).int32 == -1) {         \
+        AOT_TRAP("integer overflow")                                           \
+    }                                                                          \
+    AOT_I32_BINARY(D, A, B, (int32_t) x / (int32_t) y)
+#define AOT_I32DivU(D, A, B, IMM) AOT_DIVISOR_CHECK(B, uint32) AOT_I32_BINARY(D, A, B, x / y)
+#define AOT_I32RemS(D, A, B, IMM) \
+    AOT_DIVISOR_CHECK(B, uint32)  \
+    AOT_I32_BINARY(D, A, B, (x == 0x80000000 && y == (uint32_t) -1) ? 0 : (int32_t) x % (int32_t) y)
+#define AOT_I32RemU(D, A, B, IMM) AOT_DIVISOR_CHECK(B, uint32) AOT_I32_BINARY(D, A, B, x % y)
+#define AOT_I32And(D, A, B, IMM) AOT_I32_BINARY(D, A, B, x & y)
+#define AOT_I32Or(D, A, B, IMM) AOT_I32_BINARY(D, A, B, x | y)
+#define AOT_I32Xor(D, A, B, IMM) AOT_I32_BINARY(D, A, B, x ^ y)
+#define AOT_I32Shl(D, A, B, IMM) AOT_I32_BINARY(D, A, B, x << (y & 31))
+#define AOT_I32ShrS(D, A, B, IMM) AOT_I32_BINARY(D, A, B, ((int32_t) x) >> (y & 31))
+#define AOT_I32ShrU(D, A, B, IMM) AOT_I32_BINARY(D, A, B, x >> (y & 31))
+#define AOT_I32Rotl(D, A, B, IMM) AOT_I32_BINARY(D, A, B, rotl32(x, y))
+#define AOT_I32Rotr(D, A, B, IMM) AOT_I32_BINARY(D, A, B, rotr32(x, y))
+#define AOT_I64Clz(D, A, B, IMM) AOT_I64_UNARY(D, A, x == 0 ? 64 : __builtin_clzll(x))
+#define AOT_I64Ctz(D, A, B, IMM) AOT_I64_UNARY(D, A, x == 0 ? 64 : __builtin_ctzll(x))
+#define AOT_I64PopCnt(D, A, B, IMM) AOT_I64_UNARY(D, A, __builtin_popcountll(x))
+#define AOT_I64Add(D, A, B, IMM) AOT_I64_BINARY(D, A, B, x + y)
+#define AOT_I64Sub(D, A, B, IMM) AOT_I64_BINARY(D, A, B, x - y)
+#define AOT_I64Mul(D, A, B, IMM) AOT_I64_BINARY(D, A, B, x * y)
+#define AOT_I64DivS(D, A, B, IMM)                                                      \
+    AOT_DIVISOR_CHECK(B, uint64)                                                       \
+    if (AOT_SLOT(A).uint64 == 0x8000000000000000 && AOT_SLOT(B).int64 == -1) {         \
+        AOT_TRAP("integer overflow")                                                   \
+    }                                                                                  \
+    AOT_I64_BINARY(D, A, B, (int64_t) x / (int64_t) y)
+#define AOT_I64DivU(D, A, B, IMM) AOT_DIVISOR_CHECK(B, uint64) AOT_I64_BINARY(D, A, B, x / y)
+#define AOT_I64RemS(D, A, B, IMM) \
+    AOT_DIVISOR_CHECK(B, uint64)  \
+    AOT_I64_BINARY(D, A, B, (x == 0x8000000000000000 && y == (uint64_t) -1) ? 0 : (int64_t) x % (int64_t) y)
+#define AOT_I64RemU(D, A, B, IMM) AOT_DIVISOR_CHECK(B, uint64) AOT_I64_BINARY(D, A, B, x % y)
+#define AOT_I64And(D, A, B, IMM) AOT_I64_BINARY(D, A, B, x & y)
+#define AOT_I64Or(D, A, B, IMM) AOT_I64_BINARY(D, A, B, x | y)
+#define AOT_I64Xor(D, A, B, IMM) AOT_I64_BINARY(D, A, B, x ^ y)
+#define AOT_I64Shl(D, A, B, IMM) AOT_I64_BINARY(D, A, B, x << (y & 63))
+#define AOT_I64ShrS(D, A, B, IMM) AOT_I64_BINARY(D, A, B, ((int64_t) x) >> (y & 63))
+#define AOT_I64ShrU(D, A, B, IMM) AOT_I64_BINARY(D, A, B, x >> (y & 63))
+#define AOT_I64Rotl(D, A, B, IMM) AOT_I64_BINARY(D, A, B, rotl64(x, y))
+#define AOT_I64Rotr(D, A, B, IMM) AOT_I64_BINARY(D, A, B, rotr64(x, y))
+#define AOT_F32Abs(D, A, B, IMM) AOT_F32_UNARY(D, A, fabsf(x))
+#define AOT_F32Neg(D, A, B, IMM) AOT_F32_UNARY(D, A, -x)
+#define AOT_F32Ceil(D, A, B, IMM) AOT_F32_UNARY(D, A, ceilf(x))
+#define AOT_F32Floor(D, A, B, IMM) AOT_F32_UNARY(D, A, floorf(x))
+#define AOT_F32Trunc(D, A, B, IMM) AOT_F32_UNARY(D, A, truncf(x))
+#define AOT_F32Nearest(D, A, B, IMM) AOT_F32_UNARY(D, A, rintf(x))
+#define AOT_F32Sqrt(D, A, B, IMM) AOT_F32_UNARY(D, A, sqrtf(x))
+#define AOT_F32Add(D, A, B, IMM) AOT_F32_BINARY(D, A, B, x + y)
+#define AOT_F32Sub(D, A, B, IMM) AOT_F32_BINARY(D, A, B, x - y)
+#define AOT_F32Mul(D, A, B, IMM) AOT_F32_BINARY(D, A, B, x * y)
+#define AOT_F32Div(D, A, B, IMM) AOT_F32_BINARY(D, A, B, x / y)
+#define AOT_F32Min(D, A, B, IMM) AOT_F32_BINARY(D, A, B, wa_fminf(x, y))
+#define AOT_F32Max(D, A, B, IMM) AOT_F32_BINARY(D, A, B, wa_fmaxf(x, y))
+#define AOT_F32CopySign(D, A, B, IMM) AOT_F32_BINARY(D, A, B, signbit(y) ? -fabsf(x) : fabsf(x))
+#define AOT_F64Abs(D, A, B, IMM) AOT_F64_UNARY(D, A, fabs(x))
+#define AOT_F64Neg(D, A, B, IMM) AOT_F64_UNARY(D, A, -x)
+#define AOT_F64Ceil(D, A, B, IMM) AOT_F64_UNARY(D, A, ceil(x))
+#define AOT_F64Floor(D, A, B, IMM) AOT_F64_UNARY(D, A, floor(x))
+#define AOT_F64Trunc(D, A, B, IMM) AOT_F64_UNARY(D, A, trunc(x))
+#define AOT_F64Nearest(D, A, B, IMM) AOT_F64_UNARY(D, A, rint(x))
+#define AOT_F64Sqrt(D, A, B, IMM) AOT_F64_UNARY(D, A, sqrt(x))
+#define AOT_F64Add(D, A, B, IMM) AOT_F64_BINARY(D, A, B, x + y)
+#define AOT_F64Sub(D, A, B, IMM) AOT_F64_BINARY(D, A, B, x - y)
+#define AOT_F64Mul(D, A, B, IMM) AOT_F64_BINARY(D, A, B, x * y)
+#define AOT_F64Div(D, A, B, IMM) AOT_F64_BINARY(D, A, B, x / y)
+#define AOT_F64Min(D, A, B, IMM) AOT_F64_BINARY(D, A, B, wa_fmin(x, y))
+#define AOT_F64Max(D, A, B, IMM) AOT_F64_BINARY(D, A, B, wa_fmax(x, y))
+#define AOT_F64CopySign(D, A, B, IMM) AOT_F64_BINARY(D, A, B, signbit(y) ? -fabs(x) : fabs(x))
+
+/*
+ * 数值指令--类型转换指令
+ * */
+#define AOT_I32WrapI64(D, A, B, IMM) AOT_RESULT(D, I32, uint64, AOT_SLOT(A).uint64 & 0x00000000ffffffff)
+#define AOT_I32TruncF32S(D, A, B, IMM) AOT_TRUNC(D, A, OP_I32_TRUNC_F32, I32, int32, f32)
+#define AOT_I32TruncF32U(D, A, B, IMM) AOT_TRUNC(D, A, OP_U32_TRUNC_F32, I32, uint32, f32)
+#define AOT_I32TruncF64S(D, A, B, IMM) AOT_TRUNC(D, A, OP_I32_TRUNC_F64, I32, int32, f64)
+#define AOT_I32TruncF64U(D, A, B, IMM) AOT_TRUNC(D, A, OP_U32_TRUNC_F64, I32, uint32, f64)
+#define AOT_I64ExtendI32S(D, A, B, IMM) AOT_RESULT(D, I64, int64, (int64_t) AOT_SLOT(A).int32)
+#define AOT_I64ExtendI32U(D, A, B, IMM) AOT_RESULT(D, I64, uint64, (uint64_t) AOT_SLOT(A).uint32)
+#define AOT_I64TruncF32S(D, A, B, IMM) AOT_TRUNC(D, A, OP_I64_TRUNC_F32, I64, int64, f32)
+#define AOT_I64TruncF32U(D, A, B, IMM) AOT_TRUNC(D, A, OP_U64_TRUNC_F32, I64, uint64, f32)
+#define AOT_I64TruncF64S(D, A, B, IMM) AOT_TRUNC(D, A, OP_I64_TRUNC_F64, I64, int64, f64)
+#define AOT_I64TruncF64U(D, A, B, IMM) AOT_TRUNC(D, A, OP_U64_TRUNC_F64, I64, uint64, f64)
+#define AOT_F32ConvertI32S(D, A, B, IMM) AOT_RESULT(D, F32, f32, (float) AOT_SLOT(A).int32)
+#define AOT_F32ConvertI32U(D, A, B, IMM) AOT_RESULT(D, F32, f32, (float) AOT_SLOT(A).uint32)
+#define AOT_F32ConvertI64S(D, A, B, IMM) AOT_RESULT(D, F32, f32, (float) AOT_SLOT(A).int64)
+#define AOT_F32ConvertI64U(D, A, B, IMM) AOT_RESULT(D, F32, f32, (float) AOT_SLOT(A).uint64)
+#define AOT_F32DemoteF64(D, A, B, IMM) AOT_RESULT(D, F32, f32, (float) AOT_SLOT(A).f64)
+#define AOT_F64ConvertI32S(D, A, B, IMM) AOT_RESULT(D, F64, f64, (double) AOT_SLOT(A).int32)
+#define AOT_F64ConvertI32U(D, A, B, IMM) AOT_RESULT(D, F64, f64, (double) AOT_SLOT(A).uint32)
+#define AOT_F64ConvertI64S(D, A, B, IMM) AOT_RESULT(D, F64, f64, (double) AOT_SLOT(A).int64)
+#define AOT_F64ConvertI64U(D, A, B, IMM) AOT_RESULT(D, F64, f64, (double) AOT_SLOT(A).uint64)
+// 注：通过空的内联汇编阻止 C 编译器将相邻的 demote(promote(x)) 折叠为 x，否则 signaling NaN 不会被转换为 quiet NaN
+#define AOT_F64PromoteF32(D, A, B, IMM)          \
+    {                                            \
+        double v = (double) AOT_SLOT(A).f32;     \
+        __asm__("" : "+m"(v));                   \
+        AOT_RESULT(D, F64, f64, v)               \
+    }
+#define AOT_I32ReinterpretF32(D, A, B, IMM) AOT_RESULT(D, I32, uint64, AOT_SLOT(A).uint64)
+#define AOT_I64ReinterpretF64(D, A, B, IMM) AOT_RESULT(D, I64, uint64, AOT_SLOT(A).uint64)
+#define AOT_F32ReinterpretI32(D, A, B, IMM) AOT_RESULT(D, F32, uint64, AOT_SLOT(A).uint64)
+#define AOT_F64ReinterpretI64(D, A, B, IMM) AOT_RESULT(D, F64, uint64, AOT_SLOT(A).uint64)
+#define AOT_I32Extend8S(D, A, B, IMM) AOT_RESULT(D, I32, int32, (int32_t) (int8_t) AOT_SLOT(A).int32)
+#define AOT_I32Extend16S(D, A, B, IMM) AOT_RESULT(D, I32, int32, (int32_t) (int16_t) AOT_SLOT(A).int32)
+#define AOT_I64Extend8S(D, A, B, IMM) AOT_RESULT(D, I64, int64, (int64_t) (int8_t) AOT_SLOT(A).int64)
+#define AOT_I64Extend16S(D, A, B, IMM) AOT_RESULT(D, I64, int64, (int64_t) (int16_t) AOT_SLOT(A).int64)
+#define AOT_I64Extend32S(D, A, B, IMM) AOT_RESULT(D, I64, int64, (int64_t) (int32_t) AOT_SLOT(A).int64)
+
+// 饱和截断指令，B 用来区分不同类型的浮点数和整数之间的转换（B 为编译期常量，C 编译器只会保留对应的分支）
+#define AOT_TruncSat(D, A, B, IMM)                                          \
+    switch (B) {                                                            \
+        case 0x00:                                                          \
+            OP_I32_TRUNC_SAT_F32(AOT_SLOT(D).int32, AOT_SLOT(A).f32)        \
+            SET_VALUE_TYPE(fp[D], I32)                                      \
+            break;                                                          \
+        case 0x01:                                                          \
+            OP_U32_TRUNC_SAT_F32(AOT_SLOT(D).uint32, AOT_SLOT(A).f32)       \
+            SET_VALUE_TYPE(fp[D], I32)                                      \
+            break;                                                          \
+        case 0x02:                                                          \
+            OP_I32_TRUNC_SAT_F64(AOT_SLOT(D).int32, AOT_SLOT(A).f64)        \
+            SET_VALUE_TYPE(fp[D], I32)                                      \
+            break;                                                          \
+        case 0x03:                                                          \
+            OP_U32_TRUNC_SAT_F64(AOT_SLOT(D).uint32, AOT_SLOT(A).f64)       \
+            SET_VALUE_TYPE(fp[D], I32)                                      \
+            break;                                                          \
+        case 0x04:                                                          \
+            OP_I64_TRUNC_SAT_F32(AOT_SLOT(D).int64, AOT_SLOT(A).f32)        \
+            SET_VALUE_TYPE(fp[D], I64)                                      \
+            break;                                                          \
+        case 0x05:                                                          \
+            OP_U64_TRUNC_SAT_F32(AOT_SLOT(D).uint64, AOT_SLOT(A).f32)       \
+            SET_VALUE_TYPE(fp[D], I64)                                      \
+            break;                                                          \
+        case 0x06:                                                          \
+            OP_I64_TRUNC_SAT_F64(AOT_SLOT(D).int64, AOT_SLOT(A).f64)        \
+            SET_VALUE_TYPE(fp[D], I64)                                      \
+            break;                                                          \
+        case 0x07:                                                          \
+            OP_U64_TRUNC_SAT_F64(AOT_SLOT(D).uint64, AOT_SLOT(A).f64)       \
+            SET_VALUE_TYPE(fp[D], I64)                                      \
+            break;                                                          \
+        default:                                                            \
+            break;                                                          \
+    }
+
+#endif
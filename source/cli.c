@@ -1,3 +1,4 @@
+#include "aot.h"
 #include "interpreter.h"
 #include "module.h"
 #include "utils.h"
@@ -5,6 +6,7 @@
 #include <readline/readline.h>
 #include <stdint.h>
 #include <string.h>
+#include <unistd.h>
 
 #define BEGIN(x, y) "\033[" #x ";" #y "m"// x: 背景，y: 前景
 #define CLOSE "\033[0m"                  // 关闭所有属性
@@ -16,15 +18,71 @@ int main(int argc, char **argv) {
     int byte_count;       // Wasm 模块文件映射的内存大小
     char *line = NULL;    // 指向每行输入的字符串的指针
     int res;              // 调用函数过程中的返回值，true 表示函数调用成功，false 表示函数调用失败
+    int opt;              // 命令行选项
+    char *aot_path = NULL;// 预编译模块（共享库）的路径
+
+    // 解析命令行选项，目前支持以下选项：
+    // -t TIER：选择执行层，interp 表示栈式解释器（默认），register 表示寄存器执行层，jit 表示 JIT 执行层，stencil 表示 copy-and-patch 执行层，
+    //          auto 表示分层执行（函数先由栈式解释器执行，成为热点后再提升到 -T 指定的执行层）
+    // -T TIER：分层执行时热点函数被提升到的执行层，可以为 register、jit（默认）或者 stencil
+    // -H CALLS：分层执行时函数被提升前的调用次数阈值（默认 1000）
+    // -L COUNT：分层执行时函数被提升前其中任一循环的回边执行次数阈值（默认 10000）
+    // -b BOUNDS：内存访问的越界检查方式，guard 表示线性内存之后的保护页（默认），explicit 表示每次访问前显式比较，
+    //            mask 表示将地址与掩码按位与（放弃越界异常的语义：越界访问回绕到线性内存中的其他位置，越界写入会改写有效的数据），
+    //            后两种方式无需预留 8 GiB 的虚拟地址空间
+    // -F：禁用超级指令融合
+    // -P：禁用窥孔优化（常量折叠、强度削减等）
+    // -I：禁用小函数内联
+    // -a SO_FILE：加载由 wasmc-aot 预编译得到的共享库，其中的函数直接以本机机器码执行
+    while ((opt = getopt(argc, argv, "t:T:H:L:b:FPIa:")) != -1) {
+        if (opt == 'a') {
+            aot_path = optarg;
+        } else if (opt == 'F') {
+            options.no_fusion = true;
+        } else if (opt == 'P') {
+            options.no_peephole = true;
+        } else if (opt == 'I') {
+            options.no_inline = true;
+        } else if (opt == 'H') {
+            options.hot_calls = (uint32_t) strtoul(optarg, NULL, 0);
+        } else if (opt == 'L') {
+            options.hot_loops = (uint32_t) strtoul(optarg, NULL, 0);
+        } else if (opt == 'b' && strcmp(optarg, "guard") == 0) {
+            options.bounds = BoundsGuard;
+        } else if (opt == 'b' && strcmp(optarg, "explicit") == 0) {
+            options.bounds = BoundsExplicit;
+        } else if (opt == 'b' && strcmp(optarg, "mask") == 0) {
+            options.bounds = BoundsMask;
+        } else if (opt == 't' && strcmp(optarg, "interp") == 0) {
+            options.tier = TierInterp;
+        } else if (opt == 't' && strcmp(optarg, "register") == 0) {
+            options.tier = TierRegister;
+        } else if (opt == 't' && strcmp(optarg, "jit") == 0) {
+            options.tier = TierJit;
+        } else if (opt == 't' && strcmp(optarg, "stencil") == 0) {
+            options.tier = TierStencil;
+        } else if (opt == 't' && strcmp(optarg, "auto") == 0) {
+            options.tier = TierAuto;
+        } else if (opt == 'T' && strcmp(optarg, "register") == 0) {
+            options.hot_tier = TierRegister;
+        } else if (opt == 'T' && strcmp(optarg, "jit") == 0) {
+            options.hot_tier = TierJit;
+        } else if (opt == 'T' && strcmp(optarg, "stencil") == 0) {
+            options.hot_tier = TierStencil;
+        } else {
+            fprintf(stderr, "The right usage is:\n%s [-t interp|register|jit|stencil|auto] [-T register|jit|stencil] [-H CALLS] [-L COUNT] [-b guard|explicit|mask] [-F] [-P] [-I] [-a SO_FILE] WASM_FILE_PATH\n-b mask does not trap on out-of-bounds accesses: they wrap around onto live linear memory\n", argv[0]);
+            return 2;
+        }
+    }
 
-    // 如果参数数量不为 2，则报错并提示正确调用方式，然后退出
-    if (argc != 2) {
-        fprintf(stderr, "The right usage is:\n%s WASM_FILE_PATH\n", argv[0]);
+    // 如果除选项之外的参数数量不为 1，则报错并提示正确调用方式，然后退出
+    if (argc - optind != 1) {
+        fprintf(stderr, "The right usage is:\n%s [-t interp|register|jit|stencil|auto] [-T register|jit|stencil] [-H CALLS] [-L COUNT] [-b guard|explicit|mask] [-F] [-P] [-I] [-a SO_FILE] WASM_FILE_PATH\n-b mask does not trap on out-of-bounds accesses: they wrap around onto live linear memory\n", argv[0]);
         return 2;
     }
 
-    // 第二个参数即 Wasm 文件路径
-    mod_path = argv[1];
+    // 选项之后的参数即 Wasm 文件路径
+    mod_path = argv[optind];
 
     // 加载 Wasm 模块，并映射到内存中
     bytes = mmap_file(mod_path, &byte_count);
@@ -38,6 +96,12 @@ int main(int argc, char **argv) {
     // 解析 Wasm 模块，即将 Wasm 二进制格式转化成内存格式
     Module *m = load_module(bytes, byte_count);
 
+    // 加载预编译模块，如果共享库无法加载或者与 Wasm 模块不一致，则报错提示
+    if (aot_path && !aot_load(m, bytes, byte_count, aot_path)) {
+        fprintf(stderr, "%s\n", exception);
+        return 2;
+    }
+
     // 无限循环，每次循环处理单行命令
     while (1) {
         line = readline(BEGIN(49, 34) "wasmc$ " CLOSE);
@@ -92,8 +156,12 @@ int main(int argc, char **argv) {
         // 如果 invoke 函数返回 true，则说明函数执行过程中出现异常，将异常信息打印出来即可。
         // 注：在解释执行函数过程中，如果有异常，会将异常信息写入到 exception 中
         if (res) {
-            if (m->sp >= 0) {
-                printf("%s\n", value_repr(&m->stack[m->sp]));
+            uint32_t n = func->type->result_count;
+            if (n > 0 && m->sp + 1 >= (int) n) {
+                // 根据函数签名中的返回值类型依次打印返回值（多个返回值位于操作数栈顶，以空格分隔）
+                for (uint32_t r = 0; r < n; r++) {
+                    printf(r + 1 < n ? "%s " : "%s\n", value_repr(&m->stack[m->sp - (int) n + 1 + (int) r], func->type->results[r]));
+                }
                 // 刷新标准输出缓冲区，把输出缓冲区里的东西打印到标准输出设备上，已实现及时获取执行结果
                 fflush(stdout);
             }
@@ -0,0 +1,558 @@
+#define _GNU_SOURCE
+#include "copypatch.h"
+#include "interpreter.h"
+#include "jit.h"
+#include "memory.h"
+#include "module.h"
+#include "opcode.h"
+#include "regvm.h"
+#include "utils.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * copy-and-patch 编译的背景知识：
+ * JIT 执行层（jit.c）中每条指令的机器码模板都是手工编码的 x86-64 指令，编写和维护的成本都很高，所以只覆盖了最常见的指令
+ * 而 copy-and-patch 编译则是在构建时由 C 编译器将每条指令的 C 语言实现（即 stencils/stencils.c 中的模板）编译成机器码，
+ * 模板中与具体指令相关的值（槽位的偏移量、立即数、下一条指令的地址等）都表示为对外部符号的引用，
+ * 编译器会为这些引用生成重定位项，stencilgen 将机器码和重定位项一起提取到模板库 stencils.h 中
+ *
+ * 运行时编译函数时只需逐条遍历函数的寄存器指令流，将对应模板的机器码拷贝（copy）到可执行内存中，
+ * 再根据重定位项将具体指令的值填补（patch）到模板的空洞中即可，不需要任何指令选择或者编码的逻辑，
+ * 所以编译速度与模板式 JIT 相当，而生成的机器码则由 C 编译器优化，且每条指令的实现与寄存器虚拟机共用同一份 C 语言语义
+ *
+ * 模板之间通过尾调用（jmp）衔接，如果模板以跳转到下一条指令的 jmp 结尾，则拼接时直接省去该 jmp，顺序执行下一个模板
+ *
+ * 编译得到的机器码与 JIT 执行层的签名一致（JitFunction），同样保存在函数的 jit_code 中并通过 jit_run 执行
+ * */
+
+// 由模板调用：记录异常信息 message
+void cp_trap(const char *message) {
+    sprintf(exception, "%s", message);
+}
+
+#if WASMC_JIT && WASMC_STENCILS
+
+#include "stencils.h"
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// 空洞的填补目标的种类
+typedef enum {
+    TargetValue, // 编译时即可确定的值（槽位偏移量、立即数、外部函数的地址等）
+    TargetCode,  // 机器码中的位置
+    TargetVeneer,// 外部函数的跳板（veneer）
+    TargetData,  // 模板引用的只读数据
+    TargetPool,  // 常量池中的一项
+    TargetStub,  // 借助寄存器虚拟机执行的指令的寄存器指令流
+} TargetKind;
+
+// 需要在可执行内存分配好之后填补的空洞
+typedef struct Patch {
+    uint32_t pos;  // 空洞在机器码中的位置
+    uint8_t reloc; // 填补空洞的方式，即 RelocKind
+    uint8_t target;// 填补目标的种类，即 TargetKind
+    uint64_t value;// 填补目标：TargetValue 为值本身，其余为对应区域中的位置或者下标
+    int64_t addend;// 填补空洞时需要加上的附加值
+} Patch;
+
+// 常量池中的一项（64 位立即数、跳转表等）
+typedef struct PoolEntry {
+    uint8_t target;// 值的种类，TargetValue 为值本身，TargetCode/TargetPool/TargetStub 为机器码、常量池或者指令流区域中对应位置的地址
+    uint64_t value;
+} PoolEntry;
+
+// 拼接过程中的状态
+typedef struct Patcher {
+    Module *m;
+
+    uint8_t *code;    // 所有函数的机器码
+    uint32_t size;    // 机器码的字节数
+    uint32_t capacity;// 机器码的容量
+
+    Patch *patches;// 所有需要在可执行内存分配好之后填补的空洞
+    uint32_t patch_count;
+    uint32_t patch_capacity;
+
+    PoolEntry *pool;// 常量池
+    uint32_t pool_count;
+    uint32_t pool_capacity;
+
+    // 借助寄存器虚拟机执行的指令的寄存器指令流，每段 2 项（该指令本身和 RExit 指令），
+    // 与机器码一起拷贝到可执行内存中，从而随可执行内存一同释放
+    RInstr *stubs;
+    uint32_t stub_count;// 指令流的段数
+    uint32_t stub_capacity;
+
+    void *symbols[STENCIL_SYMBOL_COUNT + 1];// 模板调用的外部函数的地址
+    uint32_t *labels;                       // 当前函数中每条寄存器指令对应的机器码在 code 中的位置
+
+    Block **loops;        // 所有 loop 类型的控制块，用于在可执行内存分配好之后设置其 OSR 入口
+    uint32_t *osr_entries;// 每个 loop 对应的 OSR 入口（即循环开头对应的模板）在 code 中的位置
+    uint32_t loop_count;
+    uint32_t loop_capacity;
+} Patcher;
+
+// 64 位整数的 1 的个数
+// 注：模板中的 __builtin_popcountll 在不支持 popcnt 指令的编译选项下会被编译成对 libgcc 中 __popcountdi2 的调用，
+// 而 libgcc 是静态链接的，无法通过 dlsym 查找，所以这里提供一个同名的替代实现
+static int popcount64(long x) {
+    return __builtin_popcountll((uint64_t) x);
+}
+
+// wasmc 内部定义的、会被模板调用的函数（可执行文件默认不导出符号，无法通过 dlsym 查找）
+static const struct {
+    const char *name;
+    void *address;
+} internal_symbols[] = {
+        {"cp_trap", (void *) cp_trap},
+        {"invoke", (void *) invoke},
+        {"jit_tail_call", (void *) jit_tail_call},
+        {"pop_block", (void *) pop_block},
+        {"reg_execute", (void *) reg_execute},
+        {"sext_8_32", (void *) sext_8_32},
+        {"sext_16_32", (void *) sext_16_32},
+        {"sext_8_64", (void *) sext_8_64},
+        {"sext_16_64", (void *) sext_16_64},
+        {"sext_32_64", (void *) sext_32_64},
+        {"rotl32", (void *) rotl32},
+        {"rotr32", (void *) rotr32},
+        {"rotl64", (void *) rotl64},
+        {"rotr64", (void *) rotr64},
+        {"wa_fmin", (void *) wa_fmin},
+        {"wa_fmax", (void *) wa_fmax},
+        {"wa_fminf", (void *) wa_fminf},
+        {"wa_fmaxf", (void *) wa_fmaxf},
+        {"__popcountdi2", (void *) popcount64},
+};
+
+// 查找模板调用的外部函数 name 的地址，先查找 wasmc 内部定义的函数，再查找已加载的共享库（例如 libm）中的函数
+static void *resolve_symbol(const char *name) {
+    for (size_t i = 0; i < sizeof(internal_symbols) / sizeof(internal_symbols[0]); i++) {
+        if (strcmp(internal_symbols[i].name, name) == 0) {
+            return internal_symbols[i].address;
+        }
+    }
+    return dlsym(RTLD_DEFAULT, name);
+}
+
+// 将机器码 bytes 追加到 p->code 中
+static void emit_bytes(Patcher *p, const uint8_t *bytes, uint32_t size) {
+    if (p->size + size > p->capacity) {
+        uint32_t capacity = p->capacity ? p->capacity : 4096;
+        while (p->size + size > capacity) {
+            capacity *= 2;
+        }
+        p->code = arecalloc(p->code, p->capacity, capacity, sizeof(uint8_t), "Patcher->code");
+        p->capacity = capacity;
+    }
+    memcpy(p->code + p->size, bytes, size);
+    p->size += size;
+}
+
+// 记录需要在可执行内存分配好之后填补的空洞
+static void add_patch(Patcher *p, Patch patch) {
+    if (p->patch_count == p->patch_capacity) {
+        uint32_t capacity = p->patch_capacity ? p->patch_capacity * 2 : 256;
+        p->patches = arecalloc(p->patches, p->patch_capacity, capacity, sizeof(Patch), "Patcher->patches");
+        p->patch_capacity = capacity;
+    }
+    p->patches[p->patch_count++] = patch;
+}
+
+// 向常量池中追加 n 项（初始均为 0），返回第一项的下标
+static uint32_t add_pool(Patcher *p, uint32_t n) {
+    while (p->pool_count + n > p->pool_capacity) {
+        uint32_t capacity = p->pool_capacity ? p->pool_capacity * 2 : 64;
+        p->pool = arecalloc(p->pool, p->pool_capacity, capacity, sizeof(PoolEntry), "Patcher->pool");
+        p->pool_capacity = capacity;
+    }
+    p->pool_count += n;
+    return p->pool_count - n;
+}
+
+// 追加一段只包含指令 ins 本身和 RExit 指令的寄存器指令流，返回其下标
+static uint32_t add_stub(Patcher *p, RInstr *ins) {
+    if (p->stub_count == p->stub_capacity) {
+        uint32_t capacity = p->stub_capacity ? p->stub_capacity * 2 : 64;
+        p->stubs = arecalloc(p->stubs, p->stub_capacity * 2, capacity * 2, sizeof(RInstr), "Patcher->stubs");
+        p->stub_capacity = capacity;
+    }
+    p->stubs[p->stub_count * 2] = *ins;
+    p->stubs[p->stub_count * 2 + 1].opcode = RExit;
+    return p->stub_count++;
+}
+
+// 是否为会改变控制流的指令，这些指令无法借助寄存器虚拟机执行，必须有对应的模板
+static bool is_control(uint16_t opcode) {
+    return opcode == Br || opcode == BrIf || opcode == RBrUnless || opcode == BrTable || opcode == Return ||
+           opcode == ReturnCall || opcode == ReturnCallIndirect;
+}
+
+// 指令 ins 中编译时即可确定的空洞的值，返回 false 表示该空洞的值需要在拼接时才能确定
+static bool hole_value(RInstr *ins, const StencilHole *hole, uint64_t *value) {
+    switch (hole->kind) {
+        case HoleSlotD:
+            *value = (uint64_t) ins->d * sizeof(StackValue);
+            return true;
+        case HoleSlotA:
+            *value = (uint64_t) ins->a * sizeof(StackValue);
+            return true;
+        case HoleSlotB:
+            *value = (uint64_t) ins->b * sizeof(StackValue);
+            return true;
+        case HoleSlotC:
+            *value = (uint64_t) ins->imm.uint32 * sizeof(StackValue);
+            return true;
+        case HoleArgA:
+            *value = ins->a;
+            return true;
+        case HoleArgB:
+            *value = ins->b;
+            return true;
+        case HoleImm32:
+            *value = ins->imm.uint32;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 值 value 是否可以通过 reloc 方式填补到空洞中
+static bool fits(uint8_t reloc, int64_t value) {
+    switch (reloc) {
+        case RelocAbs32:
+            return value >= 0 && value <= UINT32_MAX;
+        case RelocAbs32S:
+            return value >= INT32_MIN && value <= INT32_MAX;
+        default:
+            return true;
+    }
+}
+
+// 为指令 ins 选择模板：没有对应模板，或者模板中的空洞无法容纳指令中的值时，使用借助寄存器虚拟机执行的模板 stencil_fallback
+// 返回 NULL 表示该指令无法被编译（只可能是控制流指令），此时整个函数都不编译
+static const Stencil *select_stencil(Module *m, RInstr *ins) {
+    const Stencil *s = &stencils[ins->opcode];
+
+    // 内存访问指令的模板没有越界检查，只能配合线性内存的保护页使用，64 位内存的 memory.size/memory.grow 同样借助寄存器虚拟机执行
+    bool memory_op = ins->opcode >= I32Load && (ins->opcode <= I64Store32 || (m->memory.memory64 && ins->opcode <= MemoryGrow));
+    if (memory_op && !MEMORY_GUARDED(m->memory)) {
+        return &stencil_fallback;
+    }
+
+    if (s->code) {
+        for (uint32_t i = 0; i < s->hole_count; i++) {
+            uint64_t value;
+            if (hole_value(ins, &s->holes[i], &value) && !fits(s->holes[i].reloc, (int64_t) value + s->holes[i].addend)) {
+                s = NULL;
+                break;
+            }
+        }
+    } else {
+        s = NULL;
+    }
+
+    if (!s && !is_control(ins->opcode)) {
+        s = &stencil_fallback;
+    }
+    return s;
+}
+
+// 模板 s 拼接后的字节数（以跳转到下一条指令的 jmp 结尾时省去该 jmp）
+static uint32_t stencil_size(const Stencil *s) {
+    return s->tail ? s->size - 5 : s->size;
+}
+
+// 拼接指令 ins（地址为 idx）对应的模板 s，并记录模板中的空洞
+static void emit_stencil(Patcher *p, const Stencil *s, RInstr *ins, uint32_t idx) {
+    uint32_t start = p->size;
+    uint32_t size = stencil_size(s);
+    uint32_t pool = 0;
+
+    emit_bytes(p, s->code, size);
+
+    for (uint32_t i = 0; i < s->hole_count; i++) {
+        const StencilHole *hole = &s->holes[i];
+        Patch patch = {start + hole->offset, hole->reloc, TargetValue, 0, hole->addend};
+
+        // 被省去的 jmp 指令中的空洞无需填补
+        if (hole->offset >= size) {
+            continue;
+        }
+
+        if (hole_value(ins, hole, &patch.value)) {
+            // 编译时即可确定的值，在 select_stencil 中已确认可以容纳
+            add_patch(p, patch);
+            continue;
+        }
+
+        switch (hole->kind) {
+            case HoleImm64:
+                // 64 位立即数保存在常量池中，同一模板中对其的多次引用共用同一项
+                if (!pool) {
+                    if (s == &stencil_fallback) {
+                        // 借助寄存器虚拟机执行：该指令的寄存器指令流只包含该指令本身和 RExit 指令
+                        pool = add_pool(p, 1) + 1;
+                        p->pool[pool - 1] = (PoolEntry){TargetStub, add_stub(p, ins)};
+                    } else if (ins->opcode == BrTable) {
+                        // 跳转表紧跟在保存跳转表地址的一项之后，其中每一项为目标指令的机器码地址
+                        pool = add_pool(p, ins->b + 2) + 1;
+                        p->pool[pool - 1] = (PoolEntry){TargetPool, pool};
+                        for (uint32_t n = 0; n <= ins->b; n++) {
+                            p->pool[pool + n] = (PoolEntry){TargetCode, p->labels[ins->imm.table[n]]};
+                        }
+                    } else if (ins->opcode == ReturnCall || ins->opcode == ReturnCallIndirect) {
+                        // 尾调用：保存该指令本身的地址，由 jit_tail_call 确定被调用函数
+                        pool = add_pool(p, 1) + 1;
+                        p->pool[pool - 1] = (PoolEntry){TargetValue, (uint64_t) (uintptr_t) ins};
+                    } else {
+                        pool = add_pool(p, 1) + 1;
+                        p->pool[pool - 1] = (PoolEntry){TargetValue, ins->imm.uint64};
+                    }
+                }
+                patch.target = TargetPool;
+                patch.value = pool - 1;
+                break;
+            case HoleContinue:
+                patch.target = TargetCode;
+                patch.value = p->labels[idx + 1];
+                break;
+            case HoleJump:
+                patch.target = TargetCode;
+                patch.value = p->labels[ins->imm.uint32];
+                break;
+            case HoleSymbol:
+                // 外部函数与可执行内存之间的距离可能超过 32 位偏移量的范围，所以相对地址统一通过跳板跳转
+                if (hole->reloc == RelocRel32) {
+                    patch.target = TargetVeneer;
+                    patch.value = hole->index;
+                } else {
+                    patch.value = (uint64_t) (uintptr_t) p->symbols[hole->index];
+                }
+                break;
+            case HoleData:
+                patch.target = TargetData;
+                patch.value = hole->index;
+                break;
+            default:
+                break;
+        }
+        add_patch(p, patch);
+    }
+}
+
+// 将函数 func 的寄存器指令流拼接成机器码，返回该函数的机器码在 p->code 中的起始位置，返回 UINT32_MAX 表示该函数无法被编译
+static uint32_t compile_function(Patcher *p, Block *func) {
+    RInstr *code = func->rcode;
+    uint32_t count = func->rcode_count;
+    uint32_t entry = p->size;
+    const Stencil **selected = acalloc(count, sizeof(Stencil *), "selected stencils");
+
+    // 第一遍：为每条指令选择模板并计算其机器码的位置，最后一个标签为函数末尾的 unreachable 模板（正常情况下不会执行到）
+    p->labels = acalloc(count + 1, sizeof(uint32_t), "Patcher->labels");
+    uint32_t pos = entry;
+    for (uint32_t i = 0; i < count; i++) {
+        selected[i] = select_stencil(p->m, &code[i]);
+        if (!selected[i]) {
+            free(selected);
+            free(p->labels);
+            return UINT32_MAX;
+        }
+        p->labels[i] = pos;
+        pos += stencil_size(selected[i]);
+    }
+    p->labels[count] = pos;
+
+    // 第二遍：拷贝模板的机器码，并记录模板中的空洞
+    for (uint32_t i = 0; i < count; i++) {
+        emit_stencil(p, selected[i], &code[i], i);
+    }
+    emit_stencil(p, &stencils[Unreachable], NULL, count);
+
+    // 每个模板的机器码都遵循 JitFunction 的签名，所以循环开头对应的模板可以直接作为该 loop 的 OSR 入口
+    for (uint32_t pc = func->start_addr; pc <= func->end_addr; pc++) {
+        if (p->m->code[pc].opcode == Loop) {
+            if (p->loop_count == p->loop_capacity) {
+                uint32_t capacity = p->loop_capacity ? p->loop_capacity * 2 : 16;
+                p->loops = arecalloc(p->loops, p->loop_capacity, capacity, sizeof(Block *), "Patcher->loops");
+                p->osr_entries = arecalloc(p->osr_entries, p->loop_capacity, capacity, sizeof(uint32_t), "Patcher->osr_entries");
+                p->loop_capacity = capacity;
+            }
+            p->loops[p->loop_count] = p->m->code[pc].b.block;
+            p->osr_entries[p->loop_count++] = p->labels[p->m->code[pc].b.block->osr_addr];
+        }
+    }
+
+    free(selected);
+    free(p->labels);
+    return entry;
+}
+
+// 以小端序写入 4 字节的值
+static void write_u32(uint8_t *pos, uint32_t v) {
+    memcpy(pos, &v, sizeof(v));
+}
+
+// 将索引位于 [first, last) 之间且已被翻译成寄存器指令的函数通过 copy-and-patch 的方式编译成 x86-64 机器码，保存到函数的 jit_code 中
+static void compile_functions(Module *m, uint32_t first, uint32_t last) {
+    // 模板库的槽位格式与当前构建不一致（例如构建模板库和 wasmc 时 WASMC_UNTAGGED_SLOTS 不同）时放弃编译
+    if (STENCIL_SLOT_SIZE != sizeof(StackValue)) {
+        return;
+    }
+
+    Patcher *p = acalloc(1, sizeof(Patcher), "Patcher");
+    uint32_t *entries = acalloc(m->function_count, sizeof(uint32_t), "stencil entries");
+    p->m = m;
+
+    // 查找模板调用的所有外部函数，有任意一个找不到时放弃编译
+    for (uint32_t i = 0; i < STENCIL_SYMBOL_COUNT; i++) {
+        p->symbols[i] = resolve_symbol(stencil_symbols[i]);
+        if (!p->symbols[i]) {
+            free(entries);
+            free(p);
+            return;
+        }
+    }
+
+    for (uint32_t f = 0; f < m->function_count; f++) {
+        entries[f] = f >= first && f < last && m->functions[f].rcode ? compile_function(p, &m->functions[f]) : UINT32_MAX;
+    }
+
+    // 可执行内存的布局：所有函数的机器码 | 外部函数的跳板 | 只读数据 | 常量池 | 寄存器指令流
+    uint32_t veneers = (p->size + 15) & ~15u;
+    uint32_t data[STENCIL_DATA_COUNT + 1];
+    uint32_t size = veneers + STENCIL_SYMBOL_COUNT * 16;
+    for (uint32_t i = 0; i < STENCIL_DATA_COUNT; i++) {
+        size = (size + stencil_data[i].align - 1) / stencil_data[i].align * stencil_data[i].align;
+        data[i] = size;
+        size += stencil_data[i].size;
+    }
+    uint32_t pool = (size + 7) & ~7u;
+    size = pool + p->pool_count * sizeof(uint64_t);
+    uint32_t stubs = (size + 15) & ~15u;
+    size = stubs + p->stub_count * 2 * sizeof(RInstr);
+
+    // 模板中的只读数据等地址被编码为 32 位立即数，所以需要将可执行内存映射到低 2GB 的地址空间中（MAP_32BIT）
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t mapped = (size + page - 1) / page * page;
+    uint8_t *mem = p->size > 0 ? mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0) : MAP_FAILED;
+
+    // 映射失败时放弃编译，所有函数继续由寄存器虚拟机执行
+    if (mem != MAP_FAILED) {
+        memcpy(mem, p->code, p->size);
+
+        // 外部函数的跳板：mov r11, imm64; jmp r11
+        for (uint32_t i = 0; i < STENCIL_SYMBOL_COUNT; i++) {
+            uint8_t *veneer = mem + veneers + i * 16;
+            uint64_t address = (uint64_t) (uintptr_t) p->symbols[i];
+            veneer[0] = 0x49;
+            veneer[1] = 0xBB;
+            memcpy(veneer + 2, &address, sizeof(address));
+            veneer[10] = 0x41;
+            veneer[11] = 0xFF;
+            veneer[12] = 0xE3;
+        }
+
+        for (uint32_t i = 0; i < STENCIL_DATA_COUNT; i++) {
+            memcpy(mem + data[i], stencil_data[i].bytes, stencil_data[i].size);
+        }
+        if (p->stub_count > 0) {
+            memcpy(mem + stubs, p->stubs, p->stub_count * 2 * sizeof(RInstr));
+        }
+
+        for (uint32_t i = 0; i < p->pool_count; i++) {
+            uint64_t value = p->pool[i].value;
+            if (p->pool[i].target == TargetCode) {
+                value = (uint64_t) (uintptr_t) (mem + value);
+            } else if (p->pool[i].target == TargetPool) {
+                value = (uint64_t) (uintptr_t) (mem + pool + value * sizeof(uint64_t));
+            } else if (p->pool[i].target == TargetStub) {
+                value = (uint64_t) (uintptr_t) (mem + stubs + value * 2 * sizeof(RInstr));
+            }
+            memcpy(mem + pool + i * sizeof(uint64_t), &value, sizeof(value));
+        }
+
+        // 填补所有空洞：绝对地址为 S + A，相对地址为 S + A - P
+        for (uint32_t i = 0; i < p->patch_count; i++) {
+            Patch *patch = &p->patches[i];
+            uint64_t target = patch->value;
+            switch (patch->target) {
+                case TargetCode:
+                    target = (uint64_t) (uintptr_t) (mem + target);
+                    break;
+                case TargetVeneer:
+                    target = (uint64_t) (uintptr_t) (mem + veneers + target * 16);
+                    break;
+                case TargetData:
+                    target = (uint64_t) (uintptr_t) (mem + data[target]);
+                    break;
+                case TargetPool:
+                    target = (uint64_t) (uintptr_t) (mem + pool + target * sizeof(uint64_t));
+                    break;
+                default:
+                    break;
+            }
+            target += (uint64_t) patch->addend;
+
+            uint8_t *at = mem + patch->pos;
+            if (patch->reloc == RelocRel32) {
+                write_u32(at, (uint32_t) (target - (uint64_t) (uintptr_t) at));
+            } else if (patch->reloc == RelocAbs64) {
+                memcpy(at, &target, sizeof(target));
+            } else {
+                write_u32(at, (uint32_t) target);
+            }
+        }
+
+        if (mprotect(mem, mapped, PROT_READ | PROT_EXEC) == 0) {
+            for (uint32_t f = first; f < last; f++) {
+                if (entries[f] != UINT32_MAX) {
+                    m->functions[f].jit_code = mem + entries[f];
+                }
+            }
+            for (uint32_t i = 0; i < p->loop_count; i++) {
+                p->loops[i]->osr_code = mem + p->osr_entries[i];
+            }
+        } else {
+            munmap(mem, mapped);
+        }
+    }
+
+    free(entries);
+    free(p->code);
+    free(p->patches);
+    free(p->pool);
+    free(p->stubs);
+    free(p->loops);
+    free(p->osr_entries);
+    free(p);
+}
+
+// 将所有已被翻译成寄存器指令的函数通过 copy-and-patch 的方式编译成 x86-64 机器码，保存到函数的 jit_code 中
+void cp_compile(Module *m) {
+    compile_functions(m, m->import_func_count, m->function_count);
+}
+
+// 将已被翻译成寄存器指令的函数 func 通过 copy-and-patch 的方式编译成 x86-64 机器码，保存到函数的 jit_code 中
+void cp_compile_function(Module *m, Block *func) {
+    compile_functions(m, func->fidx, func->fidx + 1);
+}
+
+#else
+
+// 未生成模板库或者不支持的平台上为空操作，函数继续由寄存器虚拟机执行
+void cp_compile(Module *m) {
+    (void) m;
+}
+
+void cp_compile_function(Module *m, Block *func) {
+    (void) m;
+    (void) func;
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef WASMC_COPYPATCH_H
+#define WASMC_COPYPATCH_H
+
+#include "module.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// 是否已在构建时生成了模板库 stencils.h（由构建系统定义），未生成时 cp_compile 为空操作，函数继续由寄存器虚拟机执行
+#ifndef WASMC_STENCILS
+#define WASMC_STENCILS 0
+#endif
+
+// 模板中待填补的空洞（hole）的种类，即空洞需要被填补成什么值
+typedef enum {
+    HoleSlotD,   // 目的操作数 d 所在槽位相对于栈帧操作数栈底的字节偏移量
+    HoleSlotA,   // 源操作数 a 所在槽位相对于栈帧操作数栈底的字节偏移量
+    HoleSlotB,   // 源操作数 b 所在槽位相对于栈帧操作数栈底的字节偏移量
+    HoleSlotC,   // 立即数 imm 所表示的槽位相对于栈帧操作数栈底的字节偏移量（仅针对 select 指令的判断条件）
+    HoleArgA,    // 指令的 a 字段本身（函数索引、全局变量索引等）
+    HoleArgB,    // 指令的 b 字段本身（跳转表大小、栈帧顶部的槽位等）
+    HoleImm32,   // 32 位立即数 imm（常量值、内存偏移量等）
+    HoleImm64,   // 64 位立即数所在的常量池地址（常量值、跳转表地址等）
+    HoleContinue,// 下一条指令的机器码地址
+    HoleJump,    // 跳转目标指令的机器码地址
+    HoleSymbol,  // 模板调用的外部函数的地址，index 为 stencil_symbols 中的下标
+    HoleData,    // 模板引用的只读数据的地址，index 为 stencil_data 中的下标
+} HoleKind;
+
+// 填补空洞的方式，对应 x86-64 ELF 目标文件中的重定位类型
+typedef enum {
+    RelocAbs32, // 32 位绝对地址（零扩展），即 R_X86_64_32
+    RelocAbs32S,// 32 位绝对地址（符号扩展），即 R_X86_64_32S
+    RelocRel32, // 32 位相对地址，即 R_X86_64_PC32/R_X86_64_PLT32
+    RelocAbs64, // 64 位绝对地址，即 R_X86_64_64
+} RelocKind;
+
+// 模板中的空洞
+typedef struct StencilHole {
+    uint32_t offset;// 空洞在模板机器码中的位置
+    uint8_t kind;   // 空洞的种类，即 HoleKind
+    uint8_t reloc;  // 填补空洞的方式，即 RelocKind
+    uint16_t index; // 外部函数或者只读数据的下标（仅针对 HoleSymbol/HoleData）
+    int64_t addend; // 填补空洞时需要加上的附加值
+} StencilHole;
+
+// 模板（stencil），即某条指令对应的一段带有空洞的机器码
+typedef struct Stencil {
+    const uint8_t *code;     // 机器码
+    uint32_t size;           // 机器码的字节数
+    const StencilHole *holes;// 机器码中的空洞
+    uint32_t hole_count;     // 空洞的数量
+    bool tail;               // 机器码是否以跳转到下一条指令的 jmp 结尾（如果是，则拼接时可以省去该 jmp，直接顺序执行下一个模板）
+} Stencil;
+
+// 模板引用的只读数据（例如字符串常量、浮点数常量）
+typedef struct StencilData {
+    const uint8_t *bytes;// 数据内容
+    uint32_t size;       // 数据的字节数
+    uint32_t align;      // 数据的对齐字节数
+} StencilData;
+
+// 由模板调用：记录异常信息 message
+void cp_trap(const char *message);
+
+// 将所有已被翻译成寄存器指令的函数通过 copy-and-patch 的方式编译成 x86-64 机器码，保存到函数的 jit_code 中
+// 注：需要在 reg_translate 之后调用，编译得到的机器码与 JIT 执行层的签名一致，同样通过 jit_run 执行
+void cp_compile(Module *m);
+
+// 将已被翻译成寄存器指令的函数 func 通过 copy-and-patch 的方式编译成 x86-64 机器码（用于分层执行时只编译热点函数）
+void cp_compile_function(Module *m, Block *func);
+
+#endif
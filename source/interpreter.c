@@ -1,6 +1,10 @@
 #include "interpreter.h"
+#include "copypatch.h"
+#include "jit.h"
+#include "memory.h"
 #include "module.h"
 #include "opcode.h"
+#include "regvm.h"
 #include "utils.h"
 #include <math.h>
 #include <stdbool.h>
@@ -52,34 +56,32 @@ Block *pop_block(Module *m) {
 
     // 获取控制帧对应控制块（包含函数）的签名（即控制块的返回值的数量和类型）
     Type *t = frame->block->type;
-    // 背景知识：目前多返回值提案还没有进入 Wasm 标准，根据当前版本的 Wasm 标准，控制块不能有参数，且最多只能有一个返回值
-    // 如果控制块的返回值数量为 1，也就是有一个返回值时，需要对返回值类型进行校验
-    if (t->result_count == 1) {
-        // 获取当前栈帧的操作数栈顶值，也就是控制块（包含函数）的返回值，
-        // 判断其类型和【控制块签名中的返回值类型】是否一致，如果不一致则记录异常信息
-        if (m->stack[m->sp].value_type != t->results[0]) {
+    uint32_t n = t->result_count;
+    // 获取当前栈帧的操作数栈顶的 n 个值，也就是控制块（包含函数）的返回值，
+    // 判断其类型和【控制块签名中的返回值类型】是否一致，如果不一致则记录异常信息
+    // 注：使用不带类型标记的槽位时无法在运行期间校验，依赖于加载模块时确定的静态类型
+#if !WASMC_UNTAGGED_SLOTS
+    for (uint32_t r = 0; r < n; r++) {
+        if (m->stack[m->sp - (int) n + 1 + (int) r].value_type != t->results[r]) {
             sprintf(exception, "call type mismatch");
             return NULL;
         }
     }
+#endif
 
     /* 3. 恢复 sp */
 
     // 因为该栈帧弹出，所以需要恢复该栈帧被压入调用栈前的【操作数栈顶指针】
     // 注：frame->sp 保存的是该栈帧被压入调用栈前的【操作数栈顶指针】
-    if (t->result_count == 1) {
-        // 背景知识：目前多返回值提案还没有进入 Wasm 标准，根据当前版本的 Wasm 标准，控制块不能有参数，且最多只能有一个返回值
-        // 如果控制块有一个返回值，则这个返回值需要压入到恢复后的操作数栈顶，即恢复后的操作数栈长度需要加 1
-        // 所以恢复的【操作数栈顶指针值】是 该栈帧被压入调用栈前的【操作数栈顶指针】再加 1
-        if (frame->sp < m->sp) {
+    // 控制块的 n 个返回值需要压入到恢复后的操作数栈顶，所以恢复的【操作数栈顶指针值】是 该栈帧被压入调用栈前的【操作数栈顶指针】再加 n，
+    // 返回值在操作数栈中是连续存放的，所以整体拷贝即可（只有 1 个返回值时直接赋值）
+    if (frame->sp < m->sp) {
+        if (n == 1) {
             m->stack[frame->sp + 1] = m->stack[m->sp];
-            m->sp = frame->sp + 1;
-        }
-    } else {
-        // 如果控制块没有返回值，则直接恢复该栈帧被压入调用栈前的【操作数栈顶指针】即可
-        if (frame->sp < m->sp) {
-            m->sp = frame->sp;
+        } else if (n) {
+            memmove(&m->stack[frame->sp + 1], &m->stack[m->sp - (int) n + 1], n * sizeof(StackValue));
         }
+        m->sp = frame->sp + (int) n;
     }
 
     /* 4. 恢复 fp */
@@ -99,6 +101,17 @@ Block *pop_block(Module *m) {
     return frame->block;
 }
 
+// 将函数的局部变量压入到操作数栈顶（默认初始值为 0）
+// 注：不逐个设置每个局部变量，而是一次性初始化所有局部变量：带类型标记的槽位直接拷贝栈帧描述符中预先准备好的初始值，否则直接清零
+static inline void push_locals(Module *m, FrameDesc *frame) {
+#if WASMC_UNTAGGED_SLOTS
+    memset(&m->stack[m->sp + 1], 0, frame->local_count * sizeof(StackValue));
+#else
+    memcpy(&m->stack[m->sp + 1], frame->locals, frame->local_count * sizeof(StackValue));
+#endif
+    m->sp += (int) frame->local_count;
+}
+
 // 调用函数前的设置，主要设置内容如下：
 // 1. 将当前函数关联的栈帧压入到调用栈顶成为当前栈帧，同时保存该栈帧被压入调用栈顶前的运行时状态，例如 sp fp ra 等
 // 2. 将当前函数的局部变量压入到操作数栈顶（默认初始值为 0）
@@ -107,156 +120,638 @@ void setup_call(Module *m, uint32_t fidx) {
     // 根据索引 fidx 从 m->functions 中获取当前函数
     Block *func = &m->functions[fidx];
 
-    // 获取函数签名
-    Type *type = func->type;
+    // 获取函数的栈帧描述符（已在加载模块时预先计算好）
+    FrameDesc *frame = &func->frame;
     // 将当前函数关联的栈帧压入到调用栈顶，成为当前栈帧，同时保存该栈帧被压入调用栈顶前的运行时状态，例如 sp fp ra 等
     // 注：第三个参数操作数栈顶指针减去函数参数个数的原因如下：
     // 调用该函数的父函数的栈帧的操作数栈，和该函数的栈帧的操作数栈，是相邻的，且有一部分数据是重叠的，
     // 这部分数据就是子函数的参数，这样就起到了父函数将参数传递给子函数的作用，所以目前操作数栈顶会有 type->param_count 个参数
     // 真实的操作数栈顶位置应该去除掉子函数参数个数，因为当子函数执行完成后，操作数栈上的参数应该要被消耗掉，
-    // 所以真实的操作数栈顶指针应该是 m->sp - (int)type->param_count
+    // 所以真实的操作数栈顶指针应该是 m->sp - (int)frame->param_count
     // push_block 函数的第三个参数的 sp 本意就是栈帧压入调用栈时的真实操作数栈顶，待后面函数执行完栈帧弹出时，恢复 push_block 中缓存的真实操作数栈顶
-    push_block(m, func, m->sp - (int) type->param_count);
+    push_block(m, func, m->sp - (int) frame->param_count);
 
     // 设置当前栈帧的操作数栈底指针 fp，减去函数参数个数的原因同上，也是为了从父函数传递参数给子函数
-    m->fp = m->sp - (int) type->param_count + 1;
+    m->fp = m->sp - (int) frame->param_count + 1;
 
     // 将当前函数的局部变量压入到操作数栈顶（默认初始值为 0）
-    for (uint32_t lidx = 0; lidx < func->local_count; lidx++) {
-        m->sp += 1;
-        m->stack[m->sp].value_type = func->locals[lidx];
-        m->stack[m->sp].value.uint64 = 0;
+    push_locals(m, frame);
+
+    // 将函数在内部指令流中的【起始地址】设置为 m->pc（即下一条待执行指令的地址）
+    m->pc = func->start_addr;
+}
+
+// 解释器的运行时状态：下一条待执行指令的地址 PC、操作数栈顶指针 SP 以及当前栈帧的帧指针 FP
+// switch 分派和 computed goto 分派直接读写 Module 中对应的字段；尾调用分派时这些状态作为参数在 handler 之间传递，
+// 始终位于寄存器中，只有在调用会读写这些字段的函数（例如 setup_call、pop_block）前后才通过 SAVE_STATE/LOAD_STATE 与 Module 同步
+#if WASMC_TAIL_CALLS
+#define PC pc
+#define SP sp
+#define FP fp
+#define SAVE_STATE() \
+    m->pc = pc;      \
+    m->sp = sp;      \
+    m->fp = fp;
+#define LOAD_STATE() \
+    pc = m->pc;      \
+    sp = m->sp;      \
+    fp = m->fp;
+#else
+#define PC m->pc
+#define SP m->sp
+#define FP m->fp
+#define SAVE_STATE()
+#define LOAD_STATE()
+#endif
+
+// 判断调用函数 FUNC（参数已位于操作数栈顶）是否会导致调用栈或者操作数栈溢出
+// 注：栈帧描述符中预先计算好了栈帧在整个执行过程中占用的最大槽位数量，所以调用时校验一次即可，执行过程中压栈无需再校验
+#define CALL_OVERFLOW(FUNC) \
+    (m->csp >= CALLSTACK_SIZE - 1 || SP - (int) (FUNC)->frame.param_count + (int) (FUNC)->frame.max_depth >= STACK_SIZE)
+
+#if WASMC_PROFILE
+// 每种操作码被执行的次数（仅在构建时开启 WASMC_PROFILE 时统计）
+uint64_t opcode_profile[OPCODE_COUNT];
+// 每对相邻指令（前一条指令的操作码为 key1，后一条为 key2）被连续执行的次数，可用于挑选值得融合成超级指令的指令序列
+// 注：只统计在内部指令流中地址相邻的两条指令，发生跳转、函数调用或返回时不计入
+uint64_t opcode_pair_profile[OPCODE_COUNT][OPCODE_COUNT];
+static uint32_t profile_next_pc = UINT32_MAX;// 上一条被执行指令的下一条指令的地址
+static uint16_t profile_prev_opcode;         // 上一条被执行指令的操作码
+#define PROFILE(op)                                     \
+    opcode_profile[op]++;                               \
+    if (PC - 1 == profile_next_pc) {                    \
+        opcode_pair_profile[profile_prev_opcode][op]++; \
+    }                                                   \
+    profile_next_pc = PC;                               \
+    profile_prev_opcode = op;
+#else
+#define PROFILE(op)
+#endif
+
+// 取指：读取下一条指令及其操作码，并将程序计数器指向再下一条指令
+#define FETCH()           \
+    ins = &code[PC++];    \
+    opcode = ins->opcode; \
+    PROFILE(opcode)
+
+#if WASMC_TAIL_CALLS
+// handler 的参数：除了 Module 之外，内部指令流、PC、SP、FP 以及操作数栈都通过参数传递（x86-64 上恰好占满 6 个参数寄存器）
+#define HANDLER_PARAMS Module *m, Instr *code, uint32_t pc, int sp, int fp, StackValue *stack
+// 每条指令的 handler 都是以 op_ 加操作码命名的独立函数，进入 handler 时 pc 已经指向下一条指令
+// 注：OPCODE 宏先以 } 结束上一个 handler，再开始定义新的 handler，并声明 handler 中用到的临时变量
+#define OPCODE(op)                                                        \
+    }                                                                     \
+    static bool op_##op(HANDLER_PARAMS) {                                 \
+        __attribute__((unused)) Instr *ins = &code[pc - 1];               \
+        __attribute__((unused)) Block *block;                             \
+        __attribute__((unused)) uint32_t cond, fidx, idx, a, b;           \
+        __attribute__((unused)) uint8_t *maddr;                           \
+        __attribute__((unused)) uint64_t d, e;                            \
+        __attribute__((unused)) float g, h;                               \
+        __attribute__((unused)) double j, k;                              \
+        __attribute__((unused)) int csp_base = m->csp_base;               \
+        __attribute__((unused)) bool result;                              \
+        PROFILE(ins->opcode)
+// 每个 handler 执行结束时直接尾调用下一条指令的 handler，编译后即为一条间接跳转指令，不会增长本机栈
+#define NEXT() MUSTTAIL return handler_table[code[pc].opcode](m, code, pc + 1, sp, fp, stack)
+#elif WASMC_COMPUTED_GOTO
+// 每条指令的 handler 都以 L_ 加操作码命名的标签开头
+#define OPCODE(op) L_##op:
+// 每个 handler 执行结束时都复制一份取指和分派的代码，直接跳转到下一条指令的 handler
+#define NEXT()                           \
+    do {                                 \
+        FETCH()                          \
+        goto *dispatch_table[opcode];    \
+    } while (0)
+#else
+#define OPCODE(op) case op:
+#define NEXT() continue
+#endif
+
+// 跳转到跳转指令 INS 的跳转目标：将操作数栈顶的 arity 个值整体拷贝到进入目标控制块时的操作数栈高度处（只有 1 个值时直接赋值），
+// 恢复操作数栈顶指针，然后从目标控制块的跳转地址继续执行
+// 注：跳转目标已在翻译内部指令流时静态计算好，控制块无需压入/弹出调用栈
+// 另外跳转地址在当前指令之前的跳转即为循环的回边，分层执行时需要统计其执行次数，
+// 如果当前栈帧通过 OSR 转移到了新的执行层并已执行完成，则 pop_block 已将 m->pc 恢复为调用方的返回地址，此时无需再跳转
+#define BRANCH(INS)                                                                                   \
+    if ((INS)->arity == 1) {                                                                          \
+        stack[FP + (INS)->b.br.height] = stack[SP];                                                   \
+    } else if ((INS)->arity) {                                                                        \
+        memmove(&stack[FP + (INS)->b.br.height], &stack[SP - (INS)->arity + 1],                       \
+                (INS)->arity * sizeof(StackValue));                                                   \
+    }                                                                                                 \
+    SP = FP + (int) (INS)->b.br.height + (INS)->arity - 1;                                            \
+    if ((INS)->b.br.addr < PC && options.tier == TierAuto) {                                          \
+        SAVE_STATE()                                                                                  \
+        if (count_back_edge(m, (INS)->b.br.addr, &result)) {                                          \
+            if (!result) {                                                                            \
+                return false;                                                                         \
+            }                                                                                         \
+            if (m->csp < csp_base) {                                                                  \
+                return true;                                                                          \
+            }                                                                                         \
+            LOAD_STATE()                                                                              \
+        } else {                                                                                      \
+            PC = (INS)->b.br.addr;                                                                    \
+        }                                                                                             \
+    } else {                                                                                          \
+        PC = (INS)->b.br.addr;                                                                        \
+    }
+
+// 以下宏用于定义数值指令的 handler，其中 EXPR 为计算表达式
+// I32 一元运算：获取操作数栈顶值 a（32 位整数）进行计算，并用计算结果覆盖当前操作数栈顶值
+#define I32_UNARY(EXPR)          \
+    a = stack[SP].value.uint32;  \
+    stack[SP].value.uint32 = (EXPR);
+
+// I64 一元运算：获取操作数栈顶值 d（64 位整数）进行计算，并用计算结果覆盖当前操作数栈顶值
+#define I64_UNARY(EXPR)          \
+    d = stack[SP].value.uint64;  \
+    stack[SP].value.uint64 = (EXPR);
+
+// 二元运算：获取操作数栈的次栈顶值和栈顶值（分别保存到 X 和 Y 中）进行计算，并用计算结果覆盖当前操作数栈顶值
+#define BINARY(X, Y, FIELD, EXPR)      \
+    X = stack[SP - 1].value.FIELD;     \
+    Y = stack[SP].value.FIELD;         \
+    SP -= 1;                           \
+    stack[SP].value.FIELD = (EXPR);
+
+#define I32_BINARY(EXPR) BINARY(a, b, uint32, EXPR)
+#define I64_BINARY(EXPR) BINARY(d, e, uint64, EXPR)
+#define F32_BINARY(EXPR) BINARY(g, h, f32, EXPR)
+#define F64_BINARY(EXPR) BINARY(j, k, f64, EXPR)
+
+// 比较运算：获取操作数栈的次栈顶值和栈顶值（分别保存到 X 和 Y 中）进行比较，并用比较结果覆盖当前操作数栈顶值
+// 注：比较的结果为布尔值，用 32 位整数表示
+#define COMPARE(X, Y, FIELD, EXPR)     \
+    X = stack[SP - 1].value.FIELD;     \
+    Y = stack[SP].value.FIELD;         \
+    SP -= 1;                           \
+    SET_VALUE_TYPE(stack[SP], I32)     \
+    stack[SP].value.uint32 = (EXPR);
+
+#define I32_COMPARE(EXPR) COMPARE(a, b, uint32, EXPR)
+#define I64_COMPARE(EXPR) COMPARE(d, e, uint64, EXPR)
+#define F32_COMPARE(EXPR) COMPARE(g, h, f32, EXPR)
+#define F64_COMPARE(EXPR) COMPARE(j, k, f64, EXPR)
+
+// 计算内存加载/存储指令 I 访问 SIZE 个字节时的实际内存地址 maddr，其中 ADDR 为保存地址的值（StackValue 中的 value），
+// 越界检查方式保存在指令的 arity 中：使用保护页时无需任何检查，越界访问会落在线性内存的保护页中，由 invoke 转换为异常（见 memory.c）；
+// 显式检查时如果越界则记录异常信息并返回 false 退出虚拟机执行；掩码时实际地址始终落在为内存分配的空间中；
+// 64 位内存的地址为 i64 类型，内存偏移量保存在立即数 b 中，需要考虑加法溢出
+#define MEMORY_ADDRESS(I, ADDR, SIZE)                                                    \
+    if ((I)->arity == ACCESS_UNCHECKED) {                                                \
+        maddr = m->memory.bytes + (I)->a + (ADDR).uint32;                                \
+    } else if ((I)->arity == ACCESS_CHECKED) {                                           \
+        if ((uint64_t) (ADDR).uint32 + (I)->b.uint64 > MEMORY_BYTES(m->memory)) {        \
+            sprintf(exception, MEMORY_OOB_MESSAGE);                                      \
+            return false;                                                                \
+        }                                                                                \
+        maddr = m->memory.bytes + (I)->a + (ADDR).uint32;                                \
+    } else if ((I)->arity == ACCESS_MASKED) {                                            \
+        maddr = m->memory.bytes + (((uint64_t) (I)->a + (ADDR).uint32) & m->memory.mask);\
+    } else {                                                                             \
+        if (memory64_out_of_bounds(&m->memory, (ADDR).uint64, (I)->b.uint64, SIZE)) {    \
+            sprintf(exception, MEMORY_OOB_MESSAGE);                                      \
+            return false;                                                                \
+        }                                                                                \
+        maddr = m->memory.bytes + (ADDR).uint64 + (I)->b.uint64;                         \
+    }
+
+// 内存加载：从操作数栈顶弹出地址，和内存偏移量相加得到实际内存地址，
+// 将该地址里保存的 SIZE 个字节拷贝到操作数栈顶（栈顶类型为 TYPE，高位补 0）
+#define LOAD(TYPE, SIZE)                         \
+    MEMORY_ADDRESS(ins, stack[SP].value, SIZE)   \
+    stack[SP].value.uint64 = 0;                  \
+    memcpy(&stack[SP].value, maddr, SIZE);       \
+    SET_VALUE_TYPE(stack[SP], TYPE)
+
+// 内存存储：先从操作数栈顶弹出待存储的值，再从操作数栈顶弹出地址，和内存偏移量相加得到实际内存地址，
+// 将待存储的值（类型对应 StackValue 中的 FIELD 字段）的前 SIZE 个字节拷贝到实际内存地址
+#define STORE(FIELD, SIZE)                         \
+    MEMORY_ADDRESS(ins, stack[SP - 1].value, SIZE) \
+    memcpy(maddr, &stack[SP].value.FIELD, SIZE);   \
+    SP -= 2;
+
+// 虚拟机执行内部指令流
+// 分层执行：将热点函数 func 提升到 options.hot_tier 指定的执行层，之后对该函数的调用都会由新的执行层执行
+// 注：每个函数只会尝试提升一次，无论成功与否（例如调用了外部导入函数而无法被翻译成寄存器指令）都不再统计其热度
+static void promote_function(Module *m, Block *func) {
+    if (func->hotness == UINT32_MAX || func->fidx < m->import_func_count) {
+        return;
+    }
+    func->hotness = UINT32_MAX;
+
+    // 寄存器执行层的翻译只能识别原始指令，翻译失败时重新融合，继续由栈式解释器执行
+    unfuse_function(m, func);
+    if (!reg_translate_function(m, func)) {
+        if (!options.no_fusion) {
+            fuse_function(m, func);
+        }
+        return;
+    }
+
+    if (options.hot_tier == TierJit) {
+        jit_compile_function(m, func);
+    } else if (options.hot_tier == TierStencil) {
+        cp_compile_function(m, func);
+    }
+}
+
+// 尾调用（return_call/return_call_indirect）前的设置：被调用函数直接复用当前栈帧，而不是在其之上压入新的栈帧，主要设置内容如下：
+// 1. 将位于操作数栈顶的函数参数拷贝到当前栈帧的操作数栈底，覆盖当前函数的参数和局部变量
+// 2. 将当前栈帧关联的函数替换为被调用函数，栈帧中保存的 sp ra 等保持不变，所以被调用函数返回时直接返回到当前函数的调用方
+// 3. 将被调用函数的局部变量压入到操作数栈顶，并将其字节码部分的【起始地址】设置为 pc
+// 这样无论尾调用的层数有多深，调用栈和操作数栈都不会增长；如果出现异常，则记录异常信息并返回 false
+// 注：尾调用之后的指令不可达，所以在分层执行时同样需要统计被调用函数的调用次数，否则只通过尾调用实现循环的函数永远不会被提升
+bool setup_tail_call(Module *m, uint32_t fidx) {
+    Block *func = &m->functions[fidx];
+    FrameDesc *frame = &func->frame;
+
+    // 导入函数没有可以复用的栈帧
+    if (fidx < m->import_func_count) {
+        sprintf(exception, "tail call to imported function is not supported");
+        return false;
+    }
+
+    if (options.tier == TierAuto && func->hotness < options.hot_calls && ++func->hotness == options.hot_calls) {
+        promote_function(m, func);
+    }
+
+    // 如果被调用函数的栈帧超出了操作数栈的容量，则记录异常信息并返回 false
+    if (m->fp - 1 + (int) frame->max_depth >= STACK_SIZE) {
+        sprintf(exception, "call stack exhausted");
+        return false;
     }
 
-    // 将函数的字节码部分的【起始地址】设置为 m->pc（即下一条待执行指令的地址）
+    // 被调用函数的参数与当前栈帧的参数和局部变量可能重叠，所以使用 memmove
+    memmove(&m->stack[m->fp], &m->stack[m->sp - (int) frame->param_count + 1], frame->param_count * sizeof(StackValue));
+    m->sp = m->fp + (int) frame->param_count - 1;
+    m->callstack[m->csp].block = func;
+    push_locals(m, frame);
     m->pc = func->start_addr;
+    return true;
+}
+
+// 尾调用：如果被调用函数 FUNC（栈帧已由 setup_tail_call 建立）已被翻译成寄存器指令，则交给对应的执行层执行直到函数返回，
+// 返回后如果进入虚拟机时的函数已经执行完成则退出虚拟机执行，否则返回到调用方继续执行；未被翻译的函数则直接由栈式解释器继续执行
+#define TAIL_CALL(FUNC)                                                                  \
+    if ((FUNC)->rcode) {                                                                 \
+        if (!((FUNC)->jit_code ? jit_run(m, FUNC) : reg_interpret(m, FUNC))) {           \
+            return false;                                                                \
+        }                                                                                \
+        if (m->csp < csp_base) {                                                         \
+            return true;                                                                 \
+        }                                                                                \
+    }
+
+// 分层执行：统计地址为 addr 的循环回边的执行次数，达到阈值时将当前函数提升到更快的执行层
+// 如果当前函数已被提升（无论是因为该循环还是因为调用次数），则通过栈上替换（OSR，on-stack replacement）
+// 将正在由栈式解释器执行的当前栈帧转移到新的执行层，从循环开头继续执行直到函数返回，并将执行结果保存到 result 中，此时返回 true；
+// 否则返回 false，当前栈帧继续由栈式解释器执行
+// 注：寄存器执行层与栈式解释器的栈帧布局完全一致，且翻译时进入 loop 前会将操作数栈中的值都拷贝到各自的槽位（见 regvm.c 中的 materialize_from），
+// 所以回边处的局部变量和操作数栈无需任何转换，新的执行层直接在当前栈帧上继续执行即可，函数返回时同样由 pop_block 弹出当前栈帧
+static bool count_back_edge(Module *m, uint32_t addr, bool *result) {
+    // 回边的跳转地址为 Loop 指令的下一条指令，Loop 指令中保存了对应的控制块
+    Block *loop = m->code[addr - 1].b.block;
+    Block *func = m->callstack[m->csp].block;
+    if (loop->hotness < options.hot_loops && ++loop->hotness == options.hot_loops) {
+        promote_function(m, func);
+    }
+
+    // 函数未被提升，或者寄存器执行层的栈帧所需的槽位超出了操作数栈的容量，则继续由栈式解释器执行
+    if (!func->rcode || m->fp + func->slot_count >= STACK_SIZE) {
+        return false;
+    }
+
+    if (loop->osr_code) {
+        *result = ((JitFunction) loop->osr_code)(m, &m->stack[m->fp]);
+    } else {
+        *result = reg_resume(m, func, loop->osr_addr);
+    }
+    return true;
 }
 
-// 虚拟机执行字节码中的指令流
+// 栈式解释器中实现了 handler 的所有操作码（包括超级指令），用于生成 computed goto 的跳转表或者尾调用分派的 handler 表
+#define HANDLED_OPCODES(X)            \
+    X(Unreachable)                \
+    X(Nop)                        \
+    X(Block_)                     \
+    X(Loop)                       \
+    X(If)                         \
+    X(Else_)                      \
+    X(End_)                       \
+    X(Br)                         \
+    X(BrIf)                       \
+    X(BrTable)                    \
+    X(Return)                     \
+    X(Call)                       \
+    X(CallIndirect)               \
+    X(ReturnCall)                 \
+    X(ReturnCallIndirect)         \
+    X(Drop)                       \
+    X(Select)                     \
+    X(LocalGet)                   \
+    X(LocalSet)                   \
+    X(LocalTee)                   \
+    X(GlobalGet)                  \
+    X(GlobalSet)                  \
+    X(I32Load)                    \
+    X(I64Load)                    \
+    X(F32Load)                    \
+    X(F64Load)                    \
+    X(I32Load8S)                  \
+    X(I32Load8U)                  \
+    X(I32Load16S)                 \
+    X(I32Load16U)                 \
+    X(I64Load8S)                  \
+    X(I64Load8U)                  \
+    X(I64Load16S)                 \
+    X(I64Load16U)                 \
+    X(I64Load32S)                 \
+    X(I64Load32U)                 \
+    X(I32Store)                   \
+    X(I64Store)                   \
+    X(F32Store)                   \
+    X(F64Store)                   \
+    X(I32Store8)                  \
+    X(I32Store16)                 \
+    X(I64Store8)                  \
+    X(I64Store16)                 \
+    X(I64Store32)                 \
+    X(MemorySize)                 \
+    X(MemoryGrow)                 \
+    X(I32Const)                   \
+    X(I64Const)                   \
+    X(F32Const)                   \
+    X(F64Const)                   \
+    X(I32Eqz)                     \
+    X(I32Eq)                      \
+    X(I32Ne)                      \
+    X(I32LtS)                     \
+    X(I32LtU)                     \
+    X(I32GtS)                     \
+    X(I32GtU)                     \
+    X(I32LeS)                     \
+    X(I32LeU)                     \
+    X(I32GeS)                     \
+    X(I32GeU)                     \
+    X(I64Eqz)                     \
+    X(I64Eq)                      \
+    X(I64Ne)                      \
+    X(I64LtS)                     \
+    X(I64LtU)                     \
+    X(I64GtS)                     \
+    X(I64GtU)                     \
+    X(I64LeS)                     \
+    X(I64LeU)                     \
+    X(I64GeS)                     \
+    X(I64GeU)                     \
+    X(F32Eq)                      \
+    X(F32Ne)                      \
+    X(F32Lt)                      \
+    X(F32Gt)                      \
+    X(F32Le)                      \
+    X(F32Ge)                      \
+    X(F64Eq)                      \
+    X(F64Ne)                      \
+    X(F64Lt)                      \
+    X(F64Gt)                      \
+    X(F64Le)                      \
+    X(F64Ge)                      \
+    X(I32Clz)                     \
+    X(I32Ctz)                     \
+    X(I32PopCnt)                  \
+    X(I32Add)                     \
+    X(I32Sub)                     \
+    X(I32Mul)                     \
+    X(I32DivS)                    \
+    X(I32DivU)                    \
+    X(I32RemS)                    \
+    X(I32RemU)                    \
+    X(I32And)                     \
+    X(I32Or)                      \
+    X(I32Xor)                     \
+    X(I32Shl)                     \
+    X(I32ShrS)                    \
+    X(I32ShrU)                    \
+    X(I32Rotl)                    \
+    X(I32Rotr)                    \
+    X(I64Clz)                     \
+    X(I64Ctz)                     \
+    X(I64PopCnt)                  \
+    X(I64Add)                     \
+    X(I64Sub)                     \
+    X(I64Mul)                     \
+    X(I64DivS)                    \
+    X(I64DivU)                    \
+    X(I64RemS)                    \
+    X(I64RemU)                    \
+    X(I64And)                     \
+    X(I64Or)                      \
+    X(I64Xor)                     \
+    X(I64Shl)                     \
+    X(I64ShrS)                    \
+    X(I64ShrU)                    \
+    X(I64Rotl)                    \
+    X(I64Rotr)                    \
+    X(F32Abs)                     \
+    X(F32Neg)                     \
+    X(F32Ceil)                    \
+    X(F32Floor)                   \
+    X(F32Trunc)                   \
+    X(F32Nearest)                 \
+    X(F32Sqrt)                    \
+    X(F32Add)                     \
+    X(F32Sub)                     \
+    X(F32Mul)                     \
+    X(F32Div)                     \
+    X(F32Min)                     \
+    X(F32Max)                     \
+    X(F32CopySign)                \
+    X(F64Abs)                     \
+    X(F64Neg)                     \
+    X(F64Ceil)                    \
+    X(F64Floor)                   \
+    X(F64Trunc)                   \
+    X(F64Nearest)                 \
+    X(F64Sqrt)                    \
+    X(F64Add)                     \
+    X(F64Sub)                     \
+    X(F64Mul)                     \
+    X(F64Div)                     \
+    X(F64Min)                     \
+    X(F64Max)                     \
+    X(F64CopySign)                \
+    X(I32WrapI64)                 \
+    X(I32TruncF32S)               \
+    X(I32TruncF32U)               \
+    X(I32TruncF64S)               \
+    X(I32TruncF64U)               \
+    X(I64ExtendI32S)              \
+    X(I64ExtendI32U)              \
+    X(I64TruncF32S)               \
+    X(I64TruncF32U)               \
+    X(I64TruncF64S)               \
+    X(I64TruncF64U)               \
+    X(F32ConvertI32S)             \
+    X(F32ConvertI32U)             \
+    X(F32ConvertI64S)             \
+    X(F32ConvertI64U)             \
+    X(F32DemoteF64)               \
+    X(F64ConvertI32S)             \
+    X(F64ConvertI32U)             \
+    X(F64ConvertI64S)             \
+    X(F64ConvertI64U)             \
+    X(F64PromoteF32)              \
+    X(I32ReinterpretF32)          \
+    X(I64ReinterpretF64)          \
+    X(F32ReinterpretI32)          \
+    X(F64ReinterpretI64)          \
+    X(I32Extend8S)                \
+    X(I32Extend16S)               \
+    X(I64Extend8S)                \
+    X(I64Extend16S)               \
+    X(I64Extend32S)               \
+    X(TruncSat)                   \
+    X(LocalGetI32ConstI32Add)     \
+    X(LocalGetI32ConstI32Sub)     \
+    X(LocalGetLocalGetI32Add)     \
+    X(LocalGetLocalGetI32LtSBrIf) \
+    X(LocalGetI32ConstI32LtSBrIf) \
+    X(I32ConstI32GtSBrIf)         \
+    X(LocalTeeBrIf)               \
+    X(I32ConstLocalSet)           \
+    X(I32ConstLocalGetI32Store)
+
+#if WASMC_TAIL_CALLS
+// 尾调用分派：每种操作码的 handler 都是一个独立的函数，handler 执行结束时直接尾调用下一条指令的 handler（见 NEXT 宏）
+typedef bool (*Handler)(HANDLER_PARAMS);
+#define HANDLER_PROTOTYPE(op) static bool op_##op(HANDLER_PARAMS);
+HANDLED_OPCODES(HANDLER_PROTOTYPE)
+static bool op_Illegal(HANDLER_PARAMS);
+
+// handler 表，其中 key 为操作码，value 为该操作码对应的 handler
+// 注：未定义的操作码统一由 op_Illegal 处理
+#define HANDLER_ENTRY(op) [op] = op_##op,
+static const Handler handler_table[OPCODE_COUNT] = {
+        [0 ... OPCODE_COUNT - 1] = op_Illegal,
+        HANDLED_OPCODES(HANDLER_ENTRY)
+};
+
 bool interpret(Module *m) {
-    const uint8_t *bytes = m->bytes;// Wasm 二进制内容
+    // 进入虚拟机时当前函数的栈帧在调用栈中的索引，handler 通过 m->csp_base 读取，
+    // 由于虚拟机可能被嵌套调用（例如寄存器执行层回退到栈式解释器），所以需要在退出时恢复外层的值
+    int csp_base = m->csp_base;
+    m->csp_base = m->csp;
+
+    // 调用第一条指令的 handler 开始执行，之后的 handler 依次尾调用，直到某个 handler 返回才退出虚拟机执行
+    bool result = handler_table[m->code[m->pc].opcode](m, m->code, m->pc + 1, m->sp, m->fp, m->stack);
+
+    m->csp_base = csp_base;
+    return result;
+}
+
+// 以下为所有 handler 的定义，第一个 OPCODE 宏中的 } 对应这里的 {
+__attribute__((unused)) static void handlers_begin(void) {
+#else
+bool interpret(Module *m) {
+    Instr *code = m->code;          // 内部指令流
     StackValue *stack = m->stack;   // 操作数栈
-    uint8_t opcode;                 // 操作码
-    uint32_t cur_pc;                // 当前的程序计数器（即下一条即将执行的指令的地址）
+    Instr *ins;                     // 当前指令
+    uint16_t opcode;                // 操作码
     Block *block;                   // 控制块
-    uint8_t value_type;             // 控制块返回值的类型（根据当前版本的 Wasm 标准，控制块不能有参数，且最多只能有一个返回值）
     uint32_t cond;                  // 保存在操作数栈顶的判断条件的值
-    uint32_t depth;                 // 跳转指令的目标标签索引
     uint32_t fidx;                  // 函数索引
     uint32_t idx;                   // 变量索引
     uint8_t *maddr;                 // 实际内存地址指针
-    uint32_t addr;                  // 用于计算相对内存地址
-    uint32_t offset;                // 内存偏移量
-    uint32_t a, b, c;               // 用于 I32 数值计算
-    uint64_t d, e, f;               // 用于 I64 数值计算
-    float g, h, i;                  // 用于 F32 数值计算
-    double j, k, l;                 // 用于 F64 数值计算
-
-    while (m->pc < m->byte_count) {
-        opcode = bytes[m->pc];// 读取指令中的操作码
-        cur_pc = m->pc;       // 保存程序计数器的值（即下一条即将执行的指令的地址）
-        m->pc += 1;           // 程序计数器加 1，即指向下一条指令
+    uint32_t a, b;                  // 用于 I32 数值计算
+    uint64_t d, e;                  // 用于 I64 数值计算
+    float g, h;                     // 用于 F32 数值计算
+    double j, k;                    // 用于 F64 数值计算
+    int csp_base = m->csp;          // 进入虚拟机时当前函数的栈帧在调用栈中的索引
+    bool result;                    // 栈帧通过 OSR 转移到新的执行层后的执行结果
+
+#if WASMC_COMPUTED_GOTO
+    // 跳转表，其中 key 为操作码，value 为该操作码对应的 handler 的标签地址
+    // 注：未定义的操作码统一跳转到 L_Illegal
+#define DISPATCH_ENTRY(op) [op] = &&L_##op,
+    static const void *const dispatch_table[OPCODE_COUNT] = {
+            [0 ... OPCODE_COUNT - 1] = &&L_Illegal,
+            HANDLED_OPCODES(DISPATCH_ENTRY)
+    };
+
+    // 读取第一条指令，并跳转到对应的 handler 开始执行
+    NEXT();
+#else
+    while (true) {
+        // 读取当前指令及其操作码，同时程序计数器加 1，即指向下一条指令
+        FETCH()
 
         switch (opcode) {
+#endif
+#endif
             /*
              * 控制指令--其他指令（2 条）
              * */
-            case Unreachable:
+            OPCODE(Unreachable)
                 // 指令作用：引发运行时错误
                 // 当执行 Unreachable 操作码时，则记录异常信息并返回 false 退出虚拟机执行
                 sprintf(exception, "%s", "unreachable");
                 return false;
-            case Nop:
+            OPCODE(Nop)
                 // 指令作用：什么都不做
                 // 注：Nop 即 No Operation 缩写
-                continue;
+                NEXT();
 
             /*
              * 控制指令--结构化控制指令（3 条）
              * */
-            case Block_:
-            case Loop:
-                // 指令作用：将当前控制块（block 或 loop 类型）关联的栈帧压入到调用栈顶，成为当前栈帧
-
-                // 该指令的立即数为控制块的返回值类型（占 1 个字节）
-                // TODO: 暂时不需要控制块的返回值类型，故暂时忽略
-                value_type = read_LEB_unsigned(bytes, &m->pc, 32);
-                (void) value_type;
-
-                // 如果调用栈溢出，则记录异常信息并返回 false 退出虚拟机执行
-                if (m->csp >= CALLSTACK_SIZE) {
-                    sprintf(exception, "call stack exhausted");
-                    return false;
-                }
-
-                // 在 block_lookup 中根据 Loop/Block_ 操作码的地址查找对应的控制块
-                // 注：block_lookup 索引就是控制块的起始地址，而控制块就是以 Block_/Loop/If 操作码为开头
-                block = m->block_lookup[cur_pc];
-
-                // 控制块（包含函数）被调用前，将【待调用的控制块（包含函数）关联的栈帧】压入到调用栈顶，成为当前栈帧，
-                // 同时保存该栈帧被压入调用栈顶前的运行时状态，例如 sp fp ra 等
-                push_block(m, block, m->sp);
-                continue;
-            case If:
-                // 指令作用：将当前控制块（if 类型）关联的栈帧压入到调用栈顶，成为当前栈帧
-
-                // 该指令的立即数为控制块的返回值类型（占 1 个字节）
-                // TODO: 暂时不需要控制块的返回值类型，故暂时忽略
-                value_type = read_LEB_unsigned(bytes, &m->pc, 32);
-                (void) value_type;
-
-                // 如果调用栈溢出，则记录异常信息并返回 false 退出虚拟机执行
-                if (m->csp >= CALLSTACK_SIZE) {
-                    sprintf(exception, "call stack exhausted");
-                    return false;
-                }
-
-                // 在 block_lookup 中根据 If 操作码的地址查找对应的控制块
-                // 注：block_lookup 索引就是控制块的起始地址，而控制块就是以 Block_/Loop/If 操作码为开头
-                block = m->block_lookup[cur_pc];
-
-                // 控制块（包含函数）被调用前，将【待调用的控制块（包含函数）关联的栈帧】压入到调用栈顶，成为当前栈帧，
-                // 同时保存该栈帧被压入调用栈顶前的运行时状态，例如 sp fp ra 等
-                push_block(m, block, m->sp);
+            OPCODE(Block_)
+                // 指令作用：进入控制块（block 或 loop 类型）
+                // 注：控制块的跳转目标以及跳转后的操作数栈高度都已在翻译内部指令流时静态计算好，保存在跳转指令中，
+                // 所以进入控制块时无需将控制块关联的栈帧压入调用栈，直接执行控制块中的指令即可
+                NEXT();
+            OPCODE(Loop)
+                // 同 Block_
+                NEXT();
+            OPCODE(If)
+                // 指令作用：根据判断条件决定执行 if 分支还是 else 分支
 
                 // 从操作数栈顶获取判断条件的值
                 // 注：在调用 If 指令时，操作数栈顶保存的就是判断条件的值
-                cond = stack[m->sp--].value.uint32;
-                // 如果判断条件为 false，则将程序计数器 pc 设置为 else 控制块首地址或 if 控制块结尾地址，
-                // 即跳过 if 分支的代码对应的指令，执行后面的指令
+                cond = stack[SP--].value.uint32;
+                // 如果判断条件为 false，则跳过 if 分支的代码对应的指令，跳转到 else 分支的起始地址（如果不存在 else 分支则为控制块的结尾）
+                // 注：跳转地址已在翻译内部指令流时计算好，保存在立即数 a 中
                 if (cond == 0) {
-                    if (block->else_addr == 0) {
-                        // 如果不存在 else 分支，则跳转到 if 控制块结尾的下一条指令继续执行
-                        m->pc = block->br_addr + 1;
-                        // 在上面的 push_block 函数中 if 控制块对应的栈帧已经被压入到调用栈且调用栈顶索引 csp 加 1，
-                        // 此时不需要执行 if 控制块的指令，所以调用栈顶索引需要减 1
-                        m->csp -= 1;
-                    } else {
-                        // 如果存在 else 分支，则执行 else 分支代码对应的字节码的起始指令，也是 Else_ 指令的下一条指令
-                        m->pc = block->else_addr;
-                    }
+                    PC = ins->a;
                 }
-                continue;
+                NEXT();
 
             /*
              * 控制指令--伪指令（2 条）
              * 注：Else_ 和 End 指令只起分隔作用，故称为伪指令
              * */
-            case Else_:
+            OPCODE(Else_)
                 // 指令作用：跳转到控制块的结尾指令继续执行
 
-                // 获取当前栈帧对应的控制块
-                block = m->callstack[m->csp].block;
-                // 跳转到控制块的结尾指令继续执行
+                // 跳转到控制块的结尾指令继续执行（跳转地址已在翻译内部指令流时计算好，保存在立即数 a 中）
                 // 注：当上一个分支对应的指令流执行完成后，会执行到 Else_ 指令，则需要跳过 Else_ 指令后面的 else 分支对应的指令流，
                 // 直接执行控制块的结尾指令，可以看出 Else_ 指令起到了分隔多个分支对应的指令流的作用
-                m->pc = block->br_addr;
-                continue;
-            case End_:
-                // 指令作用：控制块执行结束后，将关联的当前栈帧从调用栈顶中弹出，并根据具体情况决定是否退出虚拟机的执行
+                PC = ins->a;
+                NEXT();
+            OPCODE(End_)
+                // 指令作用：函数执行结束后，将关联的当前栈帧从调用栈顶中弹出，并根据具体情况决定是否退出虚拟机的执行
+
+                // 控制块（block/loop/if）执行到结尾时，操作数栈中恰好是进入控制块前的操作数以及控制块的返回值，所以无需任何操作
+                // 注：立即数 a 为 1 表示该指令为函数结尾
+                if (!ins->a) {
+                    NEXT();
+                }
 
-                // 当前控制块（包含函数）执行结束后，将关联的当前栈帧从调用栈顶中弹出，
+                // 当前函数执行结束后，将关联的当前栈帧从调用栈顶中弹出，
                 // 同时恢复该栈帧被压入调用栈顶前的运行时状态，例如 sp fp ra 等
+                SAVE_STATE()
                 block = pop_block(m);
 
                 // 如果 pop_block 函数返回 NULL，则说明有异常（具体逻辑可查看 pop_block 函数），
@@ -265,54 +760,44 @@ bool interpret(Module *m) {
                     return false;
                 }
 
-                if (block->block_type == 0x00) {
-                    // 1. 当控制块类型为函数时，且调用栈为空（即 csp 为 -1），说明已经执行完顶层的控制块，
-                    // 则直接返回 true 退出虚拟机执行，否则继续执行下一条指令
-                    if (m->csp == -1) {
-                        return true;
-                    }
-                } else if (block->block_type == 0x01) {
-                    // 2. 当控制块类型为初始化表达式时，说明只有一层控制块调用，则直接返回 true 退出虚拟机执行即可
+                // 如果调用栈指针已经小于进入虚拟机时的调用栈指针，说明进入虚拟机时的函数已经执行完成，
+                // 则直接返回 true 退出虚拟机执行，否则返回到调用该函数的地方继续执行下一条指令
+                // 注：从命令行调用函数时，进入虚拟机时的调用栈指针为 0，此时即调用栈为空（即 csp 为 -1）
+                if (m->csp < csp_base) {
                     return true;
                 }
-                // 3. 当控制块的块类型为 block/loop/if，则继续执行下一条指令
-                continue;
+                LOAD_STATE()
+                NEXT();
 
             /*
              * 控制指令--跳转指令（4 条）
              * */
-            case Br:
+            OPCODE(Br)
                 // 指令作用：跳转到目标控制块的跳转地址继续执行后面的指令
 
                 // 该指令的立即数表示跳转的目标标签索引（占 4 个字节）
                 // 另外该目标标签索引是相对的，例如为 0 表示该指令所在的控制块定义的跳转标签，
                 // 为 1 表示往外一层控制块定义的跳转标签，
                 // 为 2 表示再往外一层控制块定义的跳转标签，以此类推
-                depth = read_LEB_unsigned(bytes, &m->pc, 32);
-                // 将目标控制块关联的栈帧设置为当前栈帧
-                m->csp -= (int) depth;
-                // 跳转到目标控制块的跳转地址继续执行后面的指令
-                m->pc = m->callstack[m->csp].block->br_addr;
-                continue;
-            case BrIf:
+                // 注：跳转目标（目标控制块的跳转地址以及跳转后的操作数栈高度）已在翻译内部指令流时计算好，保存在立即数 b 中
+                BRANCH(ins)
+                NEXT();
+            OPCODE(BrIf)
                 // 指令作用：根据判断条件决定是否跳转到目标控制块的跳转地址继续执行后面的指令
 
                 // 该指令的立即数表示跳转的目标标签索引（占 4 个字节）
                 // 另外该目标标签索引是相对的，例如为 0 表示该指令所在的控制块定义的跳转标签，
                 // 为 1 表示往外一层控制块定义的跳转标签，
                 // 为 2 表示再往外一层控制块定义的跳转标签，以此类推
-                depth = read_LEB_unsigned(bytes, &m->pc, 32);
+                // 注：跳转目标（目标控制块的跳转地址以及跳转后的操作数栈高度）已在翻译内部指令流时计算好，保存在立即数 b 中
                 // 将操作数栈顶值弹出，作为判断条件
-                cond = stack[m->sp--].value.uint32;
+                cond = stack[SP--].value.uint32;
                 // 如果为真则跳转，否则不跳转
                 if (cond) {
-                    // 将目标控制块关联的栈帧设置为当前栈帧
-                    m->csp -= (int) depth;
-                    // 跳转到目标控制块的跳转地址继续执行后面的指令
-                    m->pc = m->callstack[m->csp].block->br_addr;
+                    BRANCH(ins)
                 }
-                continue;
-            case BrTable: {
+                NEXT();
+            OPCODE(BrTable) {
                 // 指令作用：根据运行时具体情况决定跳转到哪个目标控制块的跳转地址继续执行后面的指令
 
                 // 该指令的立即数给定了 n+1 个跳转目标标签索引
@@ -323,90 +808,101 @@ bool interpret(Module *m) {
                 // 如果 m 小于 n，则跳转到索引表第 m 个索引指向的目标标签处，
                 // 否则跳转到默认索引指定的标签处
 
-                // 读取目标标签索引的数量，也就是索引表的大小
-                uint32_t count = read_LEB_unsigned(bytes, &m->pc, 32);
-
-                // 如果索引表超出了规定的最大值，则记录异常信息并直接返回 false 退出虚拟机执行
-                if (count > BR_TABLE_SIZE) {
-                    sprintf(exception, "br_table size %d exceeds max %d\n", count, BR_TABLE_SIZE);
-                    return false;
-                }
-
-                // 构造索引表
-                for (uint32_t n = 0; n < count; n++) {
-                    m->br_table[n] = read_LEB_unsigned(bytes, &m->pc, 32);
-                }
-
-                // 读取默认索引
-                depth = read_LEB_unsigned(bytes, &m->pc, 32);
+                // 读取目标标签索引的数量，也就是索引表的大小（保存在立即数 a 中）
+                // 注：每个目标标签索引对应的跳转目标已在翻译内部指令流时计算好，保存在立即数 b 指向的跳转表中，
+                // 跳转表的前 n 项对应索引表，最后一项对应默认索引
+                uint32_t count = ins->a;
 
                 // 从操作数栈顶弹出一个 i32 类型的值 m
-                int32_t didx = stack[m->sp--].value.int32;
+                uint32_t didx = stack[SP--].value.uint32;
                 // 如果 m 小于索引表大小 n，则跳转到索引表第 m 个索引指向的目标标签处，
                 // 否则跳转到默认索引指定的标签处
-                if (didx >= 0 && didx < (int32_t) count) {
-                    depth = m->br_table[didx];
-                }
-
-                // 将目标控制块关联的栈帧设置为当前栈帧
-                m->csp -= (int) depth;
-                // 跳转到目标控制块的跳转地址继续执行后面的指令
-                m->pc = m->callstack[m->csp].block->br_addr;
-                continue;
+                BRANCH(&ins->b.table[didx < count ? didx : count])
+                NEXT();
             }
-            case Return:
+            OPCODE(Return)
                 // 指令作用：直接跳出最外层控制块，最终效果是函数返回
 
-                // 循环向外层控制块跳转，直到跳转到当前函数对应的控制块（也就是循环条件中判断是否是函数类型的代码块）
-                while (m->csp >= 0 && m->callstack[m->csp].block->block_type != 0x00) {
-                    m->csp--;
-                }
-                // 直接跳到当前函数对应的控制块结尾处，即 End_ 指令处并执行该指令
+                // 函数返回等同于跳转到函数本身，即将函数的返回值拷贝到参数和局部变量之上，然后跳到函数结尾处的 End_ 指令处执行该指令
                 // 对应的当前栈帧弹出调用栈和退出虚拟机执行 是在 End_ 指令执行逻辑中
-                m->pc = m->callstack[m->csp].block->end_addr;
-                continue;
+                BRANCH(ins)
+                NEXT();
 
             /*
-             * 控制指令----函数调用指令（2 条）
+             * 控制指令----函数调用指令（4 条）
              * */
-            case Call:
+            OPCODE(Call)
                 // 指令作用：调用指定函数
                 // 注：Call 指令要调用的函数是在编译期确定的，也就是说被调用函数的索引硬编码在 call 指令的立即数中
 
-                // 读取该指令的立即数，也就是被调用函数的索引（占 4 个字节）
-                fidx = read_LEB_unsigned(bytes, &m->pc, 32);
+                // 读取该指令的立即数，也就是被调用函数的索引
+                fidx = ins->a;
 
                 // 如果函数索引值小于 m->import_func_count，则说明该函数为外部函数
                 // 原因：在解析 Wasm 二进制文件内容时，首先解析导入段中的函数到 m->functions，然后再解析函数段中的函数到 m->functions
                 if (fidx < m->import_func_count) {
                     // TODO: 暂时忽略调用外部引入函数情况
                 } else {
-                    // 如果调用栈溢出，则记录异常信息并返回 false 退出虚拟机执行
-                    if (m->csp >= CALLSTACK_SIZE) {
+                    // 如果调用栈或者操作数栈溢出，则记录异常信息并返回 false 退出虚拟机执行
+                    if (CALL_OVERFLOW(&m->functions[fidx])) {
                         sprintf(exception, "call stack exhausted");
                         return false;
                     }
 
+                    // 如果被调用函数已被翻译成寄存器指令，则通过 invoke 交给寄存器虚拟机执行，执行完成后返回值已位于操作数栈顶
+                    if (m->functions[fidx].rcode) {
+                        SAVE_STATE()
+                        if (!invoke(m, fidx)) {
+                            return false;
+                        }
+                        LOAD_STATE()
+                        NEXT();
+                    }
+
                     // 调用函数前的设置，主要设置内容如下：
                     // 1. 将当前函数关联的栈帧压入到调用栈顶成为当前栈帧，同时保存该栈帧被压入调用栈顶前的运行时状态，例如 sp fp ra 等
                     // 2. 将当前函数的局部变量压入到操作数栈顶（默认初始值为 0）
                     // 3. 将函数的字节码部分的【起始地址】设置为 pc（即下一条待执行指令的地址），即开始执行函数字节码中的指令流
+                    SAVE_STATE()
                     setup_call(m, fidx);
+                    LOAD_STATE()
                 }
-                continue;
-            case CallIndirect: {
+                NEXT();
+            OPCODE(CallIndirect) {
                 // 指令作用：根据运行期间操作数栈顶的值调用指定函数
                 // 注：在编译期只能确定被调用函数的类型（call_indirect 指令的立即数里存放的是被调用函数的类型索引），
                 // 具体调用哪个函数只有在运行期间根据操作数栈顶的值才能确定
 
-                // 第一个立即数表示被调用函数的类型索引（占 4 个字节）
-                uint32_t tidx = read_LEB_unsigned(bytes, &m->pc, 32);
-
-                // 第二个立即数为保留立即数（占 1 个比特位）
-                read_LEB_unsigned(bytes, &m->pc, 1);
+                // 立即数 a 表示被调用函数的类型索引
+                // 注：第二个立即数为保留立即数，已在翻译内部指令流时跳过
+                uint32_t tidx = ins->a;
 
                 // 操作数栈顶保存的值是【函数索引值】在表 table 中的索引
-                uint32_t val = stack[m->sp--].value.uint32;
+                uint32_t val = stack[SP--].value.uint32;
+
+                // 查找该调用点的内联缓存（立即数 b 为其索引），如果命中，
+                // 说明该调用点之前已经以相同的表中的索引成功调用过该函数，表中的索引、函数签名以及参数类型都已校验通过，
+                // 无需再读取表和查找函数，直接调用缓存的函数即可
+                CallCache *cache = &m->call_caches[ins->b.uint32];
+                Block *func;
+                CALL_CACHE_LOOKUP(cache, val, func)
+                if (func) {
+                    if (CALL_OVERFLOW(func)) {
+                        sprintf(exception, "call stack exhausted");
+                        return false;
+                    }
+                    SAVE_STATE()
+                    if (func->rcode) {
+                        if (!invoke(m, func->fidx)) {
+                            return false;
+                        }
+                    } else {
+                        setup_call(m, func->fidx);
+                    }
+                    LOAD_STATE()
+                    NEXT();
+                }
+
                 // 如果该值大于或等于表 table 的最大值，则记录异常信息并返回 false 退出虚拟机执行
                 if (val >= m->table.max_size) {
                     sprintf(exception, "undefined element 0x%x (max: 0x%x) in table", val, m->table.max_size);
@@ -422,33 +918,47 @@ bool interpret(Module *m) {
                     // TODO: 暂时忽略调用外部引入函数情况
                 } else {
                     // 通过函数索引获取到函数
-                    Block *func = &m->functions[fidx];
+                    func = &m->functions[fidx];
                     // 获取函数签名
                     Type *ftype = func->type;
 
-                    // 如果调用栈溢出，则记录异常信息并返回 false 退出虚拟机执行
-                    if (m->csp >= CALLSTACK_SIZE) {
+                    // 如果调用栈或者操作数栈溢出，则记录异常信息并返回 false 退出虚拟机执行
+                    if (CALL_OVERFLOW(func)) {
                         sprintf(exception, "call stack exhausted");
                         return false;
                     }
 
                     // 如果【实际函数类型】和【指令立即数中对应的函数类型】不相同，
                     // 则记录异常信息并返回 false 退出虚拟机执行
-                    if (ftype->mask != m->types[tidx].mask) {
+                    if (ftype->type_id != m->types[tidx].type_id) {
                         sprintf(exception, "indirect call type mismatch (call type and function type differ)");
                         return false;
                     }
 
+                    // 如果被调用函数已被翻译成寄存器指令，则通过 invoke 交给寄存器虚拟机执行
+                    // 注：寄存器执行层的参数类型由函数签名保证，所以函数签名校验通过后即可记录到内联缓存中
+                    if (func->rcode) {
+                        call_cache_insert(cache, val, func);
+                        SAVE_STATE()
+                        if (!invoke(m, fidx)) {
+                            return false;
+                        }
+                        LOAD_STATE()
+                        NEXT();
+                    }
+
                     // 调用函数前的设置，主要设置内容如下：
                     // 1. 将当前函数关联的栈帧压入到调用栈顶成为当前栈帧，同时保存该栈帧被压入调用栈顶前的运行时状态，例如 sp fp ra 等
                     // 2. 将当前函数的局部变量压入到操作数栈顶（默认初始值为 0）
                     // 3. 将函数的字节码部分的【起始地址】设置为 pc（即下一条待执行指令的地址），即开始执行函数字节码中的指令流
+                    SAVE_STATE()
                     setup_call(m, fidx);
+                    LOAD_STATE()
 
                     // 由于 setup_call 函数中会将函数参数和局部变量压入操作数栈，
                     // 所以可以校验【函数签名中声明的参数数量 + 函数局部变量数量】和【压入操作数栈的函数参数和局部变量总数】是否相等，
                     // 如果不相等则记录异常信息并返回 false 退出虚拟机执行
-                    if (ftype->param_count + func->local_count != m->sp - m->fp + 1) {
+                    if (ftype->param_count + func->local_count != SP - FP + 1) {
                         sprintf(exception, "indirect call type mismatch (param counts differ)");
                         return false;
                     }
@@ -456,45 +966,112 @@ bool interpret(Module *m) {
                     // 由于 setup_call 函数中会将函数参数和局部变量压入操作数栈，
                     // 所以可以遍历【压入操作数栈的函数参数】的值，校验其类型和【函数签名中声明的参数类型】是否相等，
                     // 如果不相等则记录异常信息并返回 false 退出虚拟机执行
+                    // 注：使用不带类型标记的槽位时跳过该校验，参数类型已经由上面的函数签名比对保证
+#if !WASMC_UNTAGGED_SLOTS
                     for (uint32_t n = 0; n < ftype->param_count; n++) {
-                        if (ftype->params[n] != m->stack[m->fp + n].value_type) {
+                        if (ftype->params[n] != m->stack[FP + n].value_type) {
                             sprintf(exception, "indirect call type mismatch (param types differ)");
                             return false;
                         }
                     }
+#endif
+
+                    // 所有校验都已通过，将该目标记录到内联缓存中
+                    call_cache_insert(cache, val, func);
                 }
-                continue;
+                NEXT();
+            }
+            OPCODE(ReturnCall)
+                // 指令作用：尾调用指定函数，即调用指定函数并直接将其返回值作为当前函数的返回值
+                // 注：被调用函数直接复用当前函数的栈帧，所以尾递归无论多深都不会导致调用栈或者操作数栈溢出
+
+                // 读取该指令的立即数，也就是被调用函数的索引
+                fidx = ins->a;
+                SAVE_STATE()
+                if (!setup_tail_call(m, fidx)) {
+                    return false;
+                }
+                TAIL_CALL(&m->functions[fidx])
+                LOAD_STATE()
+                NEXT();
+            OPCODE(ReturnCallIndirect) {
+                // 指令作用：根据运行期间操作数栈顶的值尾调用指定函数，校验方式与 CallIndirect 指令一致
+
+                // 操作数栈顶保存的值是【函数索引值】在表 table 中的索引
+                uint32_t val = stack[SP--].value.uint32;
+
+                // 查找该调用点的内联缓存（立即数 b 为其索引），命中时直接尾调用缓存的函数，
+                // 未命中时才需要读取表并校验函数签名（立即数 a 为被调用函数的类型索引）
+                CallCache *cache = &m->call_caches[ins->b.uint32];
+                Block *func;
+                CALL_CACHE_LOOKUP(cache, val, func)
+                if (!func) {
+                    if (val >= m->table.max_size) {
+                        sprintf(exception, "undefined element 0x%x (max: 0x%x) in table", val, m->table.max_size);
+                        return false;
+                    }
+
+                    func = &m->functions[m->table.entries[val]];
+                    if (func->fidx >= m->import_func_count) {
+                        if (func->type->type_id != m->types[ins->a].type_id) {
+                            sprintf(exception, "indirect call type mismatch (call type and function type differ)");
+                            return false;
+                        }
+
+                        // 校验位于操作数栈顶的函数参数的类型（使用不带类型标记的槽位时跳过，参数类型已经由函数签名比对保证）
+#if !WASMC_UNTAGGED_SLOTS
+                        for (uint32_t n = 0; n < func->type->param_count; n++) {
+                            if (func->type->params[n] != stack[SP - (int) func->type->param_count + 1 + (int) n].value_type) {
+                                sprintf(exception, "indirect call type mismatch (param types differ)");
+                                return false;
+                            }
+                        }
+#endif
+                        call_cache_insert(cache, val, func);
+                    }
+                }
+
+                fidx = func->fidx;
+                SAVE_STATE()
+                if (!setup_tail_call(m, fidx)) {
+                    return false;
+                }
+                TAIL_CALL(func)
+                LOAD_STATE()
+                NEXT();
             }
 
             /*
              * 参数指令（2 条）
              * */
-            case Drop:
+            OPCODE(Drop)
                 // 指令作用：丢弃操作数栈顶值
-                m->sp--;
-                continue;
-            case Select:
+                SP--;
+                NEXT();
+            OPCODE(Select)
                 // 指令作用：从栈顶弹出 3 个操作数，根据最先弹出的操作数从其他两个操作数中选择一个压栈
                 // 如果为 true，则则将最后弹出的操作数压栈；如果为 false，则将中间弹出的操作数压栈。
                 // 注：最先弹出的操作数必须是 i32 类型，其他 2 个操作数数相同类型就可以
 
                 // 最先弹出的操作数必须是 i32 类型，否则报错
-                ASSERT(stack[m->sp].value_type == I32, "The type of operand stack top value need to be i32 when call select instruction \n")
+#if !WASMC_UNTAGGED_SLOTS
+                ASSERT(stack[SP].value_type == I32, "The type of operand stack top value need to be i32 when call select instruction \n")
+#endif
                 // 先从操作数栈弹出一个值作为判断条件
-                cond = stack[m->sp--].value.uint32;
+                cond = stack[SP--].value.uint32;
 
                 // 先将次栈顶设置为栈顶，
                 // 如果判断条件为 true，则将最后弹出的操作数压栈，
                 // 最后弹出的操作数也就是当前的次栈顶的值，已经将其设置为栈顶值，所以后面无需再做任何操作
-                m->sp--;
+                SP--;
 
                 // 如果判断条件为 false，则将中间弹出的操作数压栈，
                 // 中间弹出的操作数压栈也就是 m->sp-- 之前的栈顶值，
                 // 所以用 m->sp-- 之前的栈顶值覆盖掉  m->sp-- 之后的栈顶值即可
                 if (!cond) {
-                    stack[m->sp] = stack[m->sp + 1];
+                    stack[SP] = stack[SP + 1];
                 }
-                continue;
+                NEXT();
 
             /*
              * 变量指令--局部变量指令（3 条）
@@ -502,330 +1079,242 @@ bool interpret(Module *m) {
              *
              * 注：每个函数关联的栈帧拥有一段操作数栈（多个函数栈帧共享同一个大的操作数栈），
              * 该函数栈帧的操作数栈的开头就存储局部变量，
-             * 所以可以通过【函数栈帧的操作数栈底】加上【局部变量索引】来定位到该局部变量，即 m->fp + idx
+             * 所以可以通过【函数栈帧的操作数栈底】加上【局部变量索引】来定位到该局部变量，即 FP + idx
              * */
-            case LocalGet:
+            OPCODE(LocalGet)
                 // 指令作用：将指定局部变量压入到操作数栈顶
 
                 // 该指令的立即数为局部变量的索引
-                idx = read_LEB_unsigned(bytes, &m->pc, 32);
+                idx = ins->a;
 
                 // 将指定局部变量的值压入到操作数栈顶
-                stack[++m->sp] = stack[m->fp + idx];
-                continue;
-            case LocalSet:
+                stack[++SP] = stack[FP + idx];
+                NEXT();
+            OPCODE(LocalSet)
                 // 指令作用：将操作数栈顶的值弹出并保存到指定局部变量中
 
                 // 该指令的立即数为局部变量的索引
-                idx = read_LEB_unsigned(bytes, &m->pc, 32);
+                idx = ins->a;
 
                 // 弹出操作数栈顶的值，将其保存到指定局部变量中
-                stack[m->fp + idx] = stack[m->sp--];
-                continue;
-            case LocalTee:
+                stack[FP + idx] = stack[SP--];
+                NEXT();
+            OPCODE(LocalTee)
                 // 指令作用：将操作数栈顶值保存到指定局部变量中，但不弹出栈顶值
 
                 // 该指令的立即数为局部变量的索引
-                idx = read_LEB_unsigned(bytes, &m->pc, 32);
+                idx = ins->a;
 
                 // 弹出操作数栈顶的值，将其保存到指定局部变量中（注意：不弹出栈顶值）
-                stack[m->fp + idx] = stack[m->sp];
-                continue;
+                stack[FP + idx] = stack[SP];
+                NEXT();
 
             /*
              * 变量指令--全局变量指令（2 条）
              * 指令作用：读写全局变量
              * */
-            case GlobalGet:
+            OPCODE(GlobalGet)
                 // 指令作用：将指定全局变量压入到操作数栈顶
 
                 // 该指令的立即数为全局变量的索引
-                idx = read_LEB_unsigned(bytes, &m->pc, 32);
+                idx = ins->a;
 
                 // 将指定局部变量的值压入到操作数栈顶
-                stack[++m->sp] = m->globals[idx];
-                continue;
-            case GlobalSet:
+                stack[++SP] = m->globals[idx];
+                NEXT();
+            OPCODE(GlobalSet)
                 // 指令作用：操作数栈顶的值弹出并保存到指定全局变量中
 
                 // 该指令的立即数为全局变量的索引
-                idx = read_LEB_unsigned(bytes, &m->pc, 32);
+                idx = ins->a;
 
                 // 弹出操作数栈顶的值，将其保存到指定全局变量中
-                m->globals[idx] = stack[m->sp--];
-                continue;
+                m->globals[idx] = stack[SP--];
+                NEXT();
 
             /*
              * 内存指令--内存加载指令（14 条）
              * 指令作用：从内存中加载数据，转换为适当类型的值，再压入操作数栈顶
+             *
+             * 注：内存加载和存储指令都带有两个立即数：1.对齐方式 2.内存偏移量
+             * 对齐方式只起提示作用，目的是帮助 JIT/AOT 编译器生成更优化的机器代码，对实际执行结果没有任何影响，已在翻译内部指令流时跳过
+             * 内存偏移量保存在立即数 a 中，从操作数栈顶弹出一个 i32 类型的数，和内存偏移量相加，就可以得到实际内存相对地址
+             * 操作数栈顶弹出的数和内存偏移量都是 32 位无符号整数，所以 Wasm 实际拥有 33 比特的地址空间
              * */
-            case I32Load ... I64Load32U:
-                // 内存加载和存储指令都带有两个立即数：1.对齐方式 2.内存偏移量
-
-                // 第一个立即数表示对齐方式
-                // 保存的是以 2 为底，对齐字节数的对数，占 4 个字节
-                // 例如 0 表示一字节（2^0）对齐，1 表示两字节（2^1）对齐，2 表示四字节（2^2）对齐
-                // 对齐方式只起提示作用，目的是帮助 JIT/AOT 编译器生成更优化的机器代码，对实际执行结果没有任何影响，暂时忽略
-                read_LEB_unsigned(bytes, &m->pc, 32);
-
-                // 第二个立即数表示内存偏移量
-                // 从操作数栈顶弹出一个 i32 类型的数，和内存偏移量 offset 相加，就可以得到实际内存相对地址
-                // 注：操作数栈顶弹出的数和内存偏移量都是 32 位无符号整数，所以 Wasm 实际拥有 33 比特的地址空间
-                offset = read_LEB_unsigned(bytes, &m->pc, 32);
-                // 从操作数栈顶弹出一个 i32 类型的数（用于获取实际内存地址）
-                addr = stack[m->sp--].value.uint32;
-
-                // 获取实际内存地址
-                maddr = m->memory.bytes + offset + addr;
-
-                // TODO: 忽略校验 offset/addr/maddr 值的合法性
-
-                // 将 0 作为初始值压入操作数栈顶
-                stack[++m->sp].value.uint64 = 0;
-
-                // 根据具体指令将实际内存地址里保存的数值拷贝到操作数栈顶
-                switch (opcode) {
-                    case I32Load:
-                        // 从内存拷贝 4 个字节数到操作数栈顶（栈顶类型为 32 位整数）
-                        memcpy(&stack[m->sp].value, maddr, 4);
-                        stack[m->sp].value_type = I32;
-                        break;
-
-                    case I64Load:
-                        // 从内存拷贝 8 个字节数到操作数栈顶（栈顶类型为 64 位整数）
-                        memcpy(&stack[m->sp].value, maddr, 8);
-                        stack[m->sp].value_type = I64;
-                        break;
-                    case F32Load:
-                        // 从内存拷贝 4 个字节数到操作数栈顶（栈顶类型为 32 位浮点数）
-                        memcpy(&stack[m->sp].value, maddr, 4);
-                        stack[m->sp].value_type = F32;
-                        break;
-                    case F64Load:
-                        // 从内存拷贝 8 个字节数到操作数栈顶（栈顶类型为 64 位浮点数）
-                        memcpy(&stack[m->sp].value, maddr, 8);
-                        stack[m->sp].value_type = F64;
-                        break;
-                    case I32Load8S:
-                        // 从内存拷贝 1 个字节有符号数到操作数栈顶（栈顶类型为 32 位整数）
-                        memcpy(&stack[m->sp].value, maddr, 1);
-                        sext_8_32(&stack[m->sp].value.uint32);
-                        stack[m->sp].value_type = I32;
-                        break;
-                    case I32Load8U:
-                        // 从内存拷贝 1 个字节无符号数到操作数栈顶（栈顶类型为 32 位整数）
-                        // 因为是无符号数，在转换为更大的数据类型时，只需简单地在开头添加 0 占位，无需特殊转换
-                        memcpy(&stack[m->sp].value, maddr, 1);
-                        stack[m->sp].value_type = I32;
-                        break;
-                    case I32Load16S:
-                        // 从内存拷贝 2 个字节有符号数到操作数栈顶（栈顶类型为 32 位整数）
-                        memcpy(&stack[m->sp].value, maddr, 2);
-                        sext_16_32(&stack[m->sp].value.uint32);
-                        stack[m->sp].value_type = I32;
-                        break;
-                    case I32Load16U:
-                        // 从内存拷贝 2 个字节无符号数到操作数栈顶（栈顶类型为 32 位整数）
-                        // 因为是无符号数，在转换为更大的数据类型时，只需简单地在开头添加 0 占位，无需特殊转换
-                        memcpy(&stack[m->sp].value, maddr, 2);
-                        stack[m->sp].value_type = I32;
-                        break;
-                    case I64Load8S:
-                        // 从内存拷贝 1 个字节有符号数到操作数栈顶（栈顶类型为 64 位整数）
-                        memcpy(&stack[m->sp].value, maddr, 1);
-                        sext_8_64(&stack[m->sp].value.uint64);
-                        stack[m->sp].value_type = I64;
-                        break;
-                    case I64Load8U:
-                        // 从内存拷贝 1 个字节无符号数到操作数栈顶（栈顶类型为 64 位整数）
-                        // 因为是无符号数，在转换为更大的数据类型时，只需简单地在开头添加 0 占位，无需特殊转换
-                        memcpy(&stack[m->sp].value, maddr, 1);
-                        stack[m->sp].value_type = I64;
-                        break;
-                    case I64Load16S:
-                        // 从内存拷贝 2 个字节有符号数到操作数栈顶（栈顶类型为 64 位整数）
-                        memcpy(&stack[m->sp].value, maddr, 2);
-                        sext_16_64(&stack[m->sp].value.uint64);
-                        stack[m->sp].value_type = I64;
-                        break;
-                    case I64Load16U:
-                        // 从内存拷贝 2 个字节无符号数到操作数栈顶（栈顶类型为 64 位整数）
-                        // 因为是无符号数，在转换为更大的数据类型时，只需简单地在开头添加 0 占位，无需特殊转换
-                        memcpy(&stack[m->sp].value, maddr, 2);
-                        stack[m->sp].value_type = I64;
-                        break;
-                    case I64Load32S:
-                        // 从内存拷贝 4 个字节有符号数到操作数栈顶（栈顶类型为 64 位整数）
-                        memcpy(&stack[m->sp].value, maddr, 4);
-                        sext_32_64(&stack[m->sp].value.uint64);
-                        stack[m->sp].value_type = I64;
-                        break;
-                    case I64Load32U:
-                        // 从内存拷贝 4 个字节无符号数到操作数栈顶（栈顶类型为 64 位整数）
-                        // 因为是无符号数，在转换为更大的数据类型时，只需简单地在开头添加 0 占位，无需特殊转换
-                        memcpy(&stack[m->sp].value, maddr, 4);
-                        stack[m->sp].value_type = I64;
-                        break;
-                    default:
-                        break;
-                }
-                continue;
+            OPCODE(I32Load)
+                // 从内存拷贝 4 个字节数到操作数栈顶（栈顶类型为 32 位整数）
+                LOAD(I32, 4)
+                NEXT();
+            OPCODE(I64Load)
+                // 从内存拷贝 8 个字节数到操作数栈顶（栈顶类型为 64 位整数）
+                LOAD(I64, 8)
+                NEXT();
+            OPCODE(F32Load)
+                // 从内存拷贝 4 个字节数到操作数栈顶（栈顶类型为 32 位浮点数）
+                LOAD(F32, 4)
+                NEXT();
+            OPCODE(F64Load)
+                // 从内存拷贝 8 个字节数到操作数栈顶（栈顶类型为 64 位浮点数）
+                LOAD(F64, 8)
+                NEXT();
+            OPCODE(I32Load8S)
+                // 从内存拷贝 1 个字节有符号数到操作数栈顶（栈顶类型为 32 位整数）
+                LOAD(I32, 1)
+                sext_8_32(&stack[SP].value.uint32);
+                NEXT();
+            OPCODE(I32Load8U)
+                // 从内存拷贝 1 个字节无符号数到操作数栈顶（栈顶类型为 32 位整数）
+                // 因为是无符号数，在转换为更大的数据类型时，只需简单地在开头添加 0 占位，无需特殊转换
+                LOAD(I32, 1)
+                NEXT();
+            OPCODE(I32Load16S)
+                // 从内存拷贝 2 个字节有符号数到操作数栈顶（栈顶类型为 32 位整数）
+                LOAD(I32, 2)
+                sext_16_32(&stack[SP].value.uint32);
+                NEXT();
+            OPCODE(I32Load16U)
+                // 从内存拷贝 2 个字节无符号数到操作数栈顶（栈顶类型为 32 位整数）
+                LOAD(I32, 2)
+                NEXT();
+            OPCODE(I64Load8S)
+                // 从内存拷贝 1 个字节有符号数到操作数栈顶（栈顶类型为 64 位整数）
+                LOAD(I64, 1)
+                sext_8_64(&stack[SP].value.uint64);
+                NEXT();
+            OPCODE(I64Load8U)
+                // 从内存拷贝 1 个字节无符号数到操作数栈顶（栈顶类型为 64 位整数）
+                LOAD(I64, 1)
+                NEXT();
+            OPCODE(I64Load16S)
+                // 从内存拷贝 2 个字节有符号数到操作数栈顶（栈顶类型为 64 位整数）
+                LOAD(I64, 2)
+                sext_16_64(&stack[SP].value.uint64);
+                NEXT();
+            OPCODE(I64Load16U)
+                // 从内存拷贝 2 个字节无符号数到操作数栈顶（栈顶类型为 64 位整数）
+                LOAD(I64, 2)
+                NEXT();
+            OPCODE(I64Load32S)
+                // 从内存拷贝 4 个字节有符号数到操作数栈顶（栈顶类型为 64 位整数）
+                LOAD(I64, 4)
+                sext_32_64(&stack[SP].value.uint64);
+                NEXT();
+            OPCODE(I64Load32U)
+                // 从内存拷贝 4 个字节无符号数到操作数栈顶（栈顶类型为 64 位整数）
+                LOAD(I64, 4)
+                NEXT();
 
             /*
              * 内存指令--内存存储指令（9 条）
              * 指令作用：将操作数栈顶值弹出并存储到内存中
              * */
-            case I32Store ... I64Store32:
-                // 内存加载和存储指令都带有两个立即数：1.对齐方式 2.内存偏移量
-
-                // 第一个立即数表示对齐方式
-                // 保存的是以 2 为底，对齐字节数的对数，占 4 个字节
-                // 例如 0 表示一字节（2^0）对齐，1 表示两字节（2^1）对齐，2 表示四字节（2^2）对齐
-                // 对齐方式只起提示作用，目的是帮助 JIT/AOT 编译器生成更优化的机器代码，对实际执行结果没有任何影响，暂时忽略
-                read_LEB_unsigned(bytes, &m->pc, 32);
-
-                // 第二个立即数表示内存偏移量
-                // 从操作数栈顶弹出一个 i32 类型的数，和内存偏移量 offset 相加，就可以得到实际内存相对地址
-                // 注：操作数栈顶弹出的数和内存偏移量都是 32 位无符号整数，所以 Wasm 实际拥有 33 比特的地址空间
-                offset = read_LEB_unsigned(bytes, &m->pc, 32);
-
-                // 获取操作数栈顶地址，并将栈顶弹出
-                StackValue *sval = &stack[m->sp--];
-
-                // 再从操作数栈顶弹出一个 i32 类型的数（用于获取实际内存地址）
-                addr = stack[m->sp--].value.uint32;
-                // 获取实际内存地址
-                maddr = m->memory.bytes + offset + addr;
-
-                // TODO: 忽略校验 offset/addr/maddr 值的合法性
-
-                // 根据具体指令将数操作数栈顶值拷贝到实际内存地址
-                switch (opcode) {
-                    case I32Store:
-                        // 将操作数栈顶值（栈顶值类型为 32 位整数）的前 4 个字节拷贝到实际内存地址
-                        memcpy(maddr, &sval->value.uint32, 4);
-                        break;
-                    case I64Store:
-                        // 将操作数栈顶值（栈顶值类型为 64 位整数）的前 8 个字节拷贝到实际内存地址
-                        memcpy(maddr, &sval->value.uint64, 8);
-                        break;
-                    case F32Store:
-                        // 将操作数栈顶值（栈顶值类型为 32 位浮点数）的前 4 个字节拷贝到实际内存地址
-                        memcpy(maddr, &sval->value.f32, 4);
-                        break;
-                    case F64Store:
-                        // 将操作数栈顶值（栈顶值类型为 64 位浮点数）的前 8 个字节拷贝到实际内存地址
-                        memcpy(maddr, &sval->value.f64, 8);
-                        break;
-                    case I32Store8:
-                        // 将操作数栈顶值（栈顶值类型为 32 位整数）的前 1 个字节拷贝到实际内存地址
-                        memcpy(maddr, &sval->value.uint32, 1);
-                        break;
-                    case I32Store16:
-                        // 将操作数栈顶值（栈顶值类型为 32 位整数）的前 2 个字节拷贝到实际内存地址
-                        memcpy(maddr, &sval->value.uint32, 2);
-                        break;
-                    case I64Store8:
-                        // 将操作数栈顶值（栈顶值类型为 64 位整数）的前 1 个字节拷贝到实际内存地址
-                        memcpy(maddr, &sval->value.uint64, 1);
-                        break;
-                    case I64Store16:
-                        // 将操作数栈顶值（栈顶值类型为 64 位整数）的前 2 个字节拷贝到实际内存地址
-                        memcpy(maddr, &sval->value.uint64, 2);
-                        break;
-                    case I64Store32:
-                        // 将操作数栈顶值（栈顶值类型为 64 位整数）的前 4 个字节拷贝到实际内存地址
-                        memcpy(maddr, &sval->value.uint64, 4);
-                        break;
-                    default:
-                        break;
-                }
-                continue;
-
+            OPCODE(I32Store)
+                // 将操作数栈顶值（栈顶值类型为 32 位整数）的前 4 个字节拷贝到实际内存地址
+                STORE(uint32, 4)
+                NEXT();
+            OPCODE(I64Store)
+                // 将操作数栈顶值（栈顶值类型为 64 位整数）的前 8 个字节拷贝到实际内存地址
+                STORE(uint64, 8)
+                NEXT();
+            OPCODE(F32Store)
+                // 将操作数栈顶值（栈顶值类型为 32 位浮点数）的前 4 个字节拷贝到实际内存地址
+                STORE(f32, 4)
+                NEXT();
+            OPCODE(F64Store)
+                // 将操作数栈顶值（栈顶值类型为 64 位浮点数）的前 8 个字节拷贝到实际内存地址
+                STORE(f64, 8)
+                NEXT();
+            OPCODE(I32Store8)
+                // 将操作数栈顶值（栈顶值类型为 32 位整数）的前 1 个字节拷贝到实际内存地址
+                STORE(uint32, 1)
+                NEXT();
+            OPCODE(I32Store16)
+                // 将操作数栈顶值（栈顶值类型为 32 位整数）的前 2 个字节拷贝到实际内存地址
+                STORE(uint32, 2)
+                NEXT();
+            OPCODE(I64Store8)
+                // 将操作数栈顶值（栈顶值类型为 64 位整数）的前 1 个字节拷贝到实际内存地址
+                STORE(uint64, 1)
+                NEXT();
+            OPCODE(I64Store16)
+                // 将操作数栈顶值（栈顶值类型为 64 位整数）的前 2 个字节拷贝到实际内存地址
+                STORE(uint64, 2)
+                NEXT();
+            OPCODE(I64Store32)
+                // 将操作数栈顶值（栈顶值类型为 64 位整数）的前 4 个字节拷贝到实际内存地址
+                STORE(uint64, 4)
+                NEXT();
             /*
              * 内存指令--size 指令
              * */
-            case MemorySize:
+            OPCODE(MemorySize)
                 // 指令作用：将当前的内存页数以 i32 类型压入操作数栈顶
 
                 // 该指令的立即数表示当前操作的是第几块内存（占 1 个内存）
-                // 但由于当前 Wasm 规范规定最多只能导入或定义一块内存，所以目前必须为 0
-                read_LEB_unsigned(bytes, &m->pc, 32);
+                // 但由于当前 Wasm 规范规定最多只能导入或定义一块内存，所以目前必须为 0，已在翻译内部指令流时跳过
 
-                // 将当前的内存页数以 i32 类型压入操作数栈顶
-                stack[++m->sp].value_type = I32;
-                stack[m->sp].value.uint32 = m->memory.cur_size;
-                continue;
+                // 将当前的内存页数以 i32 类型（64 位内存为 i64 类型）压入操作数栈顶
+                stack[++SP].value.uint64 = m->memory.cur_size;
+                SET_VALUE_TYPE(stack[SP], m->memory.memory64 ? I64 : I32)
+                NEXT();
 
             /*
              * 内存指令--grow 指令
              * */
-            case MemoryGrow:
+            OPCODE(MemoryGrow) {
                 // 指令作用：将内存增长若干页，并从操作数栈顶获取增长前的内存页数
 
                 // 该指令的立即数表示当前操作的是第几块内存（占 1 个内存）
-                // 但由于当前 Wasm 规范规定最多只能导入或定义一块内存，所以目前必须为 0
-                read_LEB_unsigned(bytes, &m->pc, 32);
+                // 但由于当前 Wasm 规范规定最多只能导入或定义一块内存，所以目前必须为 0，已在翻译内部指令流时跳过
 
                 // 先保存当前内存页数
                 uint32_t prev_pages = m->memory.cur_size;
 
-                // 将操作数栈顶值作为内存要增长的页数
-                uint32_t delta = stack[m->sp].value.uint32;
+                // 将操作数栈顶值作为内存要增长的页数（64 位内存为 i64 类型）
+                uint64_t delta = m->memory.memory64 ? stack[SP].value.uint64 : stack[SP].value.uint32;
 
                 // 用刚刚保存的当前内存页数覆盖当前操作数栈顶值
-                stack[m->sp].value.uint32 = prev_pages;
-
-                // 校验内存增长页数是否合法
-                if (delta == 0 || delta + prev_pages > m->memory.max_size) {
-                    // 如果内存增长页数为 0，
-                    // 或者内存增长页数加上当前内存页数后，超过了内存最大页数，
-                    // 则什么都不做，执行下一条指令
-                    continue;
+                stack[SP].value.uint64 = prev_pages;
+
+                // 校验内存增长页数是否合法，如果合法且不为 0，则增加 delta 页内存（见 memory.c 中的 memory_grow）
+                // 如果内存增长页数加上当前内存页数后，超过了内存最大页数，或者宿主无法提供所需的内存（mremap/mprotect 失败），则增长失败，
+                // 用 -1 覆盖当前操作数栈顶值（32 位内存为 i32 类型的 0xFFFFFFFF，64 位内存为 i64 类型的全 1）
+                if (delta > m->memory.max_size - prev_pages ||
+                    (delta != 0 && !memory_grow(&m->memory, (uint32_t) delta))) {
+                    stack[SP].value.uint64 = m->memory.memory64 ? UINT64_MAX : UINT32_MAX;
                 }
-
-                // 如果内存增长页数合法，则增加 delta 页内存
-                m->memory.cur_size += delta;
-                m->memory.bytes = arecalloc(m->memory.bytes, prev_pages * PAGE_SIZE, m->memory.cur_size * PAGE_SIZE, sizeof(uint8_t), "Module->memory.bytes");
-                continue;
+                NEXT();
+            }
 
             /*
              * 数值指令--常量指令（4 条）
              * 
              * 注：数值指令中除了常量指令之外，其余的数值指令都没有立即数
              * */
-            case I32Const:
+            OPCODE(I32Const)
                 // 指令作用：将指令的立即数以 i32 类型压入操作数栈顶
 
-                stack[++m->sp].value_type = I32;
-                stack[m->sp].value.uint32 = read_LEB_signed(bytes, &m->pc, 32);
-                continue;
-            case I64Const:
+                stack[++SP].value.uint32 = ins->b.uint32;
+                SET_VALUE_TYPE(stack[SP], I32)
+                NEXT();
+            OPCODE(I64Const)
                 // 指令作用：将指令的立即数以 i64 类型压入操作数栈顶
 
-                stack[++m->sp].value_type = I64;
-                stack[m->sp].value.int64 = (int64_t) read_LEB_signed(bytes, &m->pc, 64);
-                continue;
-            case F32Const:
+                stack[++SP].value.int64 = ins->b.int64;
+                SET_VALUE_TYPE(stack[SP], I64)
+                NEXT();
+            OPCODE(F32Const)
                 // 指令作用：将指令的立即数以 f32 类型压入操作数栈顶
 
-                stack[++m->sp].value_type = F32;
-                // LEB128 编码仅针对整数，而该指令的立即数为浮点数，并没有被编码，而是直接写入到 Wasm 二进制文件中的
-                memcpy(&stack[m->sp].value.uint32, bytes + m->pc, 4);
-                // 由于是直接将 4 个字节长度的立即数的值拷贝到栈顶，
-                // 没有调用 read_LEB_signed（该函数会实时更新 pc 保存的值），所以程序计数器需要手动加 4
-                m->pc += 4;
-                continue;
-            case F64Const:
+                stack[++SP].value.f32 = ins->b.f32;
+                SET_VALUE_TYPE(stack[SP], F32)
+                NEXT();
+            OPCODE(F64Const)
                 // 指令作用：将指令的立即数以 f64 类型压入操作数栈顶
 
-                stack[++m->sp].value_type = F64;
-                // LEB128 编码仅针对整数，而该指令的立即数为浮点数，并没有被编码，而是直接写入到 Wasm 二进制文件中的
-                memcpy(&stack[m->sp].value.uint64, bytes + m->pc, 8);
-                // 由于是直接将 8 个字节长度的立即数的值拷贝到栈顶，
-                // 没有调用 read_LEB_signed（该函数会实时更新 pc 保存的值），所以程序计数器需要手动加 8
-                m->pc += 8;
-                continue;
+                stack[++SP].value.f64 = ins->b.f64;
+                SET_VALUE_TYPE(stack[SP], F64)
+                NEXT();
 
             /*
              * 数值指令--测试指令（2 条）
@@ -833,557 +1322,434 @@ bool interpret(Module *m) {
              * 注：测试指令是冗余的，完全可用常量指令和比较指令代替，
              * 但是考虑到判断一个数是否为 0 是一种相当常见的操作，使用测试指令可以节约一条常量指令
              * */
-            case I32Eqz:
+            OPCODE(I32Eqz)
                 // 指令作用：判断操作数栈顶值（32 位整数）是否为 0
 
                 // 获取栈顶操作数栈顶值（32 位整数），判断是否为 0，
                 // 然后用判断结果（i32 类型的布尔值）覆盖当前操作数栈顶值
-                stack[m->sp].value_type = I32;
-                stack[m->sp].value.uint32 = stack[m->sp].value.uint32 == 0;
-                continue;
-            case I64Eqz:
+                SET_VALUE_TYPE(stack[SP], I32)
+                stack[SP].value.uint32 = stack[SP].value.uint32 == 0;
+                NEXT();
+            OPCODE(I64Eqz)
                 // 指令作用：判断操作数栈顶值（64 位整数）是否为 0
 
                 // 获取栈顶操作数值（64 位整数），判断是否为 0，
                 // 然后用判断结果（i32 类型的布尔值）覆盖当前操作数栈顶值
-                stack[m->sp].value_type = I32;
-                stack[m->sp].value.uint32 = stack[m->sp].value.uint64 == 0;
-                continue;
+                SET_VALUE_TYPE(stack[SP], I32)
+                stack[SP].value.uint32 = stack[SP].value.uint64 == 0;
+                NEXT();
 
             /*
              * 数值指令--比较指令（32 条）
+             * 指令作用：获取操作数栈的栈顶和次栈顶的值，根据具体指令对两个值进行比较，并用比较结果覆盖当前操作数栈顶值
+             * 注：比较的结果为布尔值，用 32 位整数表示
              * */
-            case I32Eq ... I32GeU:
-                // 指令作用：获取操作数栈的栈顶和次栈顶的值（32 位整数），根据具体指令对两个值进行比较，并用比较结果覆盖当前操作数栈顶值
-
-                a = stack[m->sp - 1].value.uint32;
-                b = stack[m->sp].value.uint32;
-                m->sp -= 1;
-                switch (opcode) {
-                    case I32Eq:
-                        c = a == b;
-                        break;
-                    case I32Ne:
-                        c = a != b;
-                        break;
-                    case I32LtS:
-                        c = (uint32_t) a < (uint32_t) b;
-                        break;
-                    case I32LtU:
-                        c = a < b;
-                        break;
-                    case I32GtS:
-                        c = (uint32_t) a > (uint32_t) b;
-                        break;
-                    case I32GtU:
-                        c = a > b;
-                        break;
-                    case I32LeS:
-                        c = (uint32_t) a <= (uint32_t) b;
-                        break;
-                    case I32LeU:
-                        c = a <= b;
-                        break;
-                    case I32GeS:
-                        c = (uint32_t) a >= (uint32_t) b;
-                        break;
-                    case I32GeU:
-                        c = a >= b;
-                        break;
-                    default:
-                        break;
+            OPCODE(I32Eq)
+                I32_COMPARE(a == b)
+                NEXT();
+            OPCODE(I32Ne)
+                I32_COMPARE(a != b)
+                NEXT();
+            OPCODE(I32LtS)
+                I32_COMPARE((int32_t) a < (int32_t) b)
+                NEXT();
+            OPCODE(I32LtU)
+                I32_COMPARE(a < b)
+                NEXT();
+            OPCODE(I32GtS)
+                I32_COMPARE((int32_t) a > (int32_t) b)
+                NEXT();
+            OPCODE(I32GtU)
+                I32_COMPARE(a > b)
+                NEXT();
+            OPCODE(I32LeS)
+                I32_COMPARE((int32_t) a <= (int32_t) b)
+                NEXT();
+            OPCODE(I32LeU)
+                I32_COMPARE(a <= b)
+                NEXT();
+            OPCODE(I32GeS)
+                I32_COMPARE((int32_t) a >= (int32_t) b)
+                NEXT();
+            OPCODE(I32GeU)
+                I32_COMPARE(a >= b)
+                NEXT();
+            OPCODE(I64Eq)
+                I64_COMPARE(d == e)
+                NEXT();
+            OPCODE(I64Ne)
+                I64_COMPARE(d != e)
+                NEXT();
+            OPCODE(I64LtS)
+                I64_COMPARE((int64_t) d < (int64_t) e)
+                NEXT();
+            OPCODE(I64LtU)
+                I64_COMPARE(d < e)
+                NEXT();
+            OPCODE(I64GtS)
+                I64_COMPARE((int64_t) d > (int64_t) e)
+                NEXT();
+            OPCODE(I64GtU)
+                I64_COMPARE(d > e)
+                NEXT();
+            OPCODE(I64LeS)
+                I64_COMPARE((int64_t) d <= (int64_t) e)
+                NEXT();
+            OPCODE(I64LeU)
+                I64_COMPARE(d <= e)
+                NEXT();
+            OPCODE(I64GeS)
+                I64_COMPARE((int64_t) d >= (int64_t) e)
+                NEXT();
+            OPCODE(I64GeU)
+                I64_COMPARE(d >= e)
+                NEXT();
+            OPCODE(F32Eq)
+                F32_COMPARE(g == h)
+                NEXT();
+            OPCODE(F32Ne)
+                F32_COMPARE(g != h)
+                NEXT();
+            OPCODE(F32Lt)
+                F32_COMPARE(g < h)
+                NEXT();
+            OPCODE(F32Gt)
+                F32_COMPARE(g > h)
+                NEXT();
+            OPCODE(F32Le)
+                F32_COMPARE(g <= h)
+                NEXT();
+            OPCODE(F32Ge)
+                F32_COMPARE(g >= h)
+                NEXT();
+            OPCODE(F64Eq)
+                F64_COMPARE(j == k)
+                NEXT();
+            OPCODE(F64Ne)
+                F64_COMPARE(j != k)
+                NEXT();
+            OPCODE(F64Lt)
+                F64_COMPARE(j < k)
+                NEXT();
+            OPCODE(F64Gt)
+                F64_COMPARE(j > k)
+                NEXT();
+            OPCODE(F64Le)
+                F64_COMPARE(j <= k)
+                NEXT();
+            OPCODE(F64Ge)
+                F64_COMPARE(j >= k)
+                NEXT();
+            /*
+             * 数值指令--算术指令（64 条）
+             * 指令作用：获取操作数栈顶值（一元运算），或者操作数栈的栈顶和次栈顶的值（二元运算），
+             * 根据具体指令进行计算，并用计算结果覆盖当前操作数栈顶值
+             * */
+            OPCODE(I32Clz)
+                // 数值的二进制表示的位数
+                I32_UNARY(a == 0 ? 32 : __builtin_clz(a))
+                NEXT();
+            OPCODE(I32Ctz)
+                // 数值的二进制表示的末尾后面 0 的个数
+                I32_UNARY(a == 0 ? 32 : __builtin_ctz(a))
+                NEXT();
+            OPCODE(I32PopCnt)
+                // 数值的二进制表示中的 1 的个数
+                I32_UNARY(__builtin_popcount(a))
+                NEXT();
+            OPCODE(I32Add)
+                // 加法
+                I32_BINARY(a + b)
+                NEXT();
+            OPCODE(I32Sub)
+                // 减法
+                I32_BINARY(a - b)
+                NEXT();
+            OPCODE(I32Mul)
+                // 乘法
+                I32_BINARY(a * b)
+                NEXT();
+            OPCODE(I32DivS)
+                // 除法（有符号）
+                // 除数不能为 0，且 INT32_MIN / -1 的结果会溢出，遇到这两种情况则记录异常信息并返回 false 退出虚拟机执行
+                if (stack[SP].value.uint32 == 0) {
+                    sprintf(exception, "integer divide by zero");
+                    return false;
                 }
-                // 注：比较的结果为布尔值，用 32 位整数表示
-                stack[m->sp].value_type = I32;
-                stack[m->sp].value.uint32 = c;
-                continue;
-            case I64Eq ... I64GeU:
-                // 指令作用：获取操作数栈的栈顶和次栈顶的值（64 位整数），根据具体指令对两个值进行比较，并用比较结果覆盖当前操作数栈顶值
-
-                d = stack[m->sp - 1].value.uint64;
-                e = stack[m->sp].value.uint64;
-                m->sp -= 1;
-                switch (opcode) {
-                    case I64Eq:
-                        c = d == e;
-                        break;
-                    case I64Ne:
-                        c = d != e;
-                        break;
-                    case I64LtS:
-                        c = (uint64_t) d < (uint64_t) e;
-                        break;
-                    case I64LtU:
-                        c = d < e;
-                        break;
-                    case I64GtS:
-                        c = (uint64_t) d > (uint64_t) e;
-                        break;
-                    case I64GtU:
-                        c = d > e;
-                        break;
-                    case I64LeS:
-                        c = (uint64_t) d <= (uint64_t) e;
-                        break;
-                    case I64LeU:
-                        c = d <= e;
-                        break;
-                    case I64GeS:
-                        c = (uint64_t) d >= (uint64_t) e;
-                        break;
-                    case I64GeU:
-                        c = d >= e;
-                        break;
-                    default:
-                        break;
+                if (stack[SP - 1].value.uint32 == 0x80000000 && stack[SP].value.int32 == -1) {
+                    sprintf(exception, "integer overflow");
+                    return false;
                 }
-                // 注：比较的结果为布尔值，用 32 位整数表示
-                stack[m->sp].value_type = I32;
-                stack[m->sp].value.uint32 = c;
-                continue;
-            case F32Eq ... F32Ge:
-                // 指令作用：获取操作数栈的栈顶和次栈顶的值（32 位浮点数），根据具体指令对两个值进行比较，并用比较结果覆盖当前操作数栈顶值
-
-                g = stack[m->sp - 1].value.f32;
-                h = stack[m->sp].value.f32;
-                m->sp -= 1;
-                switch (opcode) {
-                    case F32Eq:
-                        c = g == h;
-                        break;
-                    case F32Ne:
-                        c = g != h;
-                        break;
-                    case F32Lt:
-                        c = g < h;
-                        break;
-                    case F32Gt:
-                        c = g > h;
-                        break;
-                    case F32Le:
-                        c = g <= h;
-                        break;
-                    case F32Ge:
-                        c = g >= h;
-                        break;
-                    default:
-                        break;
+                I32_BINARY((int32_t) a / (int32_t) b)
+                NEXT();
+            OPCODE(I32DivU)
+                // 除法（无符号）
+                if (stack[SP].value.uint32 == 0) {
+                    sprintf(exception, "integer divide by zero");
+                    return false;
                 }
-                // 注：比较的结果为布尔值，用 32 位整数表示
-                stack[m->sp].value_type = I32;
-                stack[m->sp].value.uint32 = c;
-                continue;
-            case F64Eq ... F64Ge:
-                // 指令作用：获取操作数栈的栈顶和次栈顶的值（64 位浮点数），根据具体指令对两个值进行比较，并用比较结果覆盖当前操作数栈顶值
-
-                j = stack[m->sp - 1].value.f64;
-                k = stack[m->sp].value.f64;
-                m->sp -= 1;
-                switch (opcode) {
-                    case F64Eq:
-                        c = j == k;
-                        break;
-                    case F64Ne:
-                        c = j != k;
-                        break;
-                    case F64Lt:
-                        c = j < k;
-                        break;
-                    case F64Gt:
-                        c = j > k;
-                        break;
-                    case F64Le:
-                        c = j <= k;
-                        break;
-                    case F64Ge:
-                        c = j >= k;
-                        break;
-                    default:
-                        break;
+                I32_BINARY(a / b)
+                NEXT();
+            OPCODE(I32RemS)
+                // 取余（有符号）
+                // 注：INT32_MIN % -1 在 C 语言中是未定义行为，按照 Wasm 规范其结果为 0
+                if (stack[SP].value.uint32 == 0) {
+                    sprintf(exception, "integer divide by zero");
+                    return false;
                 }
-                // 注：比较的结果为布尔值，用 32 位整数表示
-                stack[m->sp].value_type = I32;
-                stack[m->sp].value.uint32 = c;
-                continue;
-
-            /*
-             * 数值指令--算术指令（64 条）
-             * */
-            case I32Clz ... I32PopCnt:
-                // 指令作用：获取操作数栈顶值（32 位整数），根据指令对其进行相应计算，并用计算结果覆盖当前操作数栈顶值
-
-                a = stack[m->sp].value.uint32;
-                switch (opcode) {
-                    case I32Clz:
-                        // 数值的二进制表示的位数
-                        c = a == 0 ? 32 : __builtin_clz(a);
-                        break;
-                    case I32Ctz:
-                        // 数值的二进制表示的末尾后面 0 的个数
-                        c = a == 0 ? 32 : __builtin_ctz(a);
-                        break;
-                    case I32PopCnt:
-                        // 数值的二进制表示中的 1 的个数
-                        c = __builtin_popcount(a);
-                        break;
-                    default:
-                        break;
+                I32_BINARY((a == 0x80000000 && b == (uint32_t) -1) ? 0 : (int32_t) a % (int32_t) b)
+                NEXT();
+            OPCODE(I32RemU)
+                // 取余（无符号）
+                if (stack[SP].value.uint32 == 0) {
+                    sprintf(exception, "integer divide by zero");
+                    return false;
                 }
-
-                stack[m->sp].value.uint32 = c;
-                continue;
-            case I32Add ... I32Rotr:
-                // 指令作用：获取操作数栈的栈顶和次栈顶的值（32 位整数），根据具体指令对两个值进行计算，并用计算结果覆盖当前操作数栈顶值
-
-                a = stack[m->sp - 1].value.uint32;
-                b = stack[m->sp].value.uint32;
-                m->sp -= 1;
-
-                // 执行 I32DivS 和 I32RemU 之间的指令时，栈顶值 b 不能为 0，
-                // 如果为 0 则记录异常信息并返回 false 退出虚拟机执行
-                if (opcode >= I32DivS && opcode <= I32RemU && b == 0) {
+                I32_BINARY(a % b)
+                NEXT();
+            OPCODE(I32And)
+                // 与
+                I32_BINARY(a & b)
+                NEXT();
+            OPCODE(I32Or)
+                // 或
+                I32_BINARY(a | b)
+                NEXT();
+            OPCODE(I32Xor)
+                // 异或
+                I32_BINARY(a ^ b)
+                NEXT();
+            OPCODE(I32Shl)
+                // 左移
+                I32_BINARY(a << b)
+                NEXT();
+            OPCODE(I32ShrS)
+                // 右移（有符号）
+                I32_BINARY(((int32_t) a) >> b)
+                NEXT();
+            OPCODE(I32ShrU)
+                // 右移（无符号）
+                I32_BINARY(a >> b)
+                NEXT();
+            OPCODE(I32Rotl)
+                // 循环左移
+                I32_BINARY(rotl32(a, b))
+                NEXT();
+            OPCODE(I32Rotr)
+                // 循环右移
+                I32_BINARY(rotr32(a, b))
+                NEXT();
+            OPCODE(I64Clz)
+                // 数值的二进制表示的位数
+                I64_UNARY(d == 0 ? 64 : __builtin_clzll(d))
+                NEXT();
+            OPCODE(I64Ctz)
+                // 数值的二进制表示的末尾后面 0 的个数
+                I64_UNARY(d == 0 ? 64 : __builtin_ctzll(d))
+                NEXT();
+            OPCODE(I64PopCnt)
+                // 数值的二进制表示中的 1 的个数
+                I64_UNARY(__builtin_popcountll(d))
+                NEXT();
+            OPCODE(I64Add)
+                // 加法
+                I64_BINARY(d + e)
+                NEXT();
+            OPCODE(I64Sub)
+                // 减法
+                I64_BINARY(d - e)
+                NEXT();
+            OPCODE(I64Mul)
+                // 乘法
+                I64_BINARY(d * e)
+                NEXT();
+            OPCODE(I64DivS)
+                // 除法（有符号）
+                // 除数不能为 0，且 INT64_MIN / -1 的结果会溢出，遇到这两种情况则记录异常信息并返回 false 退出虚拟机执行
+                if (stack[SP].value.uint64 == 0) {
                     sprintf(exception, "integer divide by zero");
                     return false;
                 }
-
-                switch (opcode) {
-                    case I32Add:
-                        // 加法
-                        c = a + b;
-                        break;
-                    case I32Sub:
-                        // 减法
-                        c = a - b;
-                        break;
-                    case I32Mul:
-                        // 乘法
-                        c = a * b;
-                        break;
-                    case I32DivS:
-                        // 除法（有符号）
-                        if (a == 0x80000000 && b == -1) {
-                            sprintf(exception, "integer overflow");
-                            return false;
-                        }
-                        c = (int32_t) a / (int32_t) b;
-                        break;
-                    case I32DivU:
-                        // 除法（无符号）
-                        c = a / b;
-                        break;
-                    case I32RemS:
-                        // 取余（有符号）
-                        if (a == 0x80000000 && b == -1) {
-                            c = 0;
-                        } else {
-                            c = (int32_t) a % (int32_t) b;
-                        }
-                        break;
-                    case I32RemU:
-                        // 取余（无符号）
-                        c = a % b;
-                        break;
-                    case I32And:
-                        // 与
-                        c = a & b;
-                        break;
-                    case I32Or:
-                        // 或
-                        c = a | b;
-                        break;
-                    case I32Xor:
-                        // 异或
-                        c = a ^ b;
-                        break;
-                    case I32Shl:
-                        // 左移
-                        c = a << b;
-                        break;
-                    case I32ShrS:
-                        // 右移
-                        c = ((int32_t) a) >> b;
-                        break;
-                    case I32ShrU:
-                        // 右移
-                        c = a >> b;
-                        break;
-                    case I32Rotl:
-                        // 循环左移
-                        c = rotl32(a, b);
-                        break;
-                    case I32Rotr:
-                        // 循环右移
-                        c = rotr32(a, b);
-                        break;
-                    default:
-                        break;
+                if (stack[SP - 1].value.uint64 == 0x8000000000000000 && stack[SP].value.int64 == -1) {
+                    sprintf(exception, "integer overflow");
+                    return false;
                 }
-
-                stack[m->sp].value.uint32 = c;
-                continue;
-            case I64Clz ... I64PopCnt:
-                // 指令作用：获取操作数栈顶值（64 位整数），根据指令对其进行相应计算，并用计算结果覆盖当前操作数栈顶值
-
-                d = stack[m->sp].value.uint64;
-
-                switch (opcode) {
-                    case I64Clz:
-                        // 数值的二进制表示的位数
-                        f = d == 0 ? 64 : __builtin_clzll(d);
-                        break;
-                    case I64Ctz:
-                        // 数值的二进制表示的末尾后面 0 的个数
-                        f = d == 0 ? 64 : __builtin_ctzll(d);
-                        break;
-                    case I64PopCnt:
-                        // 数值的二进制表示中的 1 的个数
-                        f = __builtin_popcountll(d);
-                        break;
-                    default:
-                        break;
+                I64_BINARY((int64_t) d / (int64_t) e)
+                NEXT();
+            OPCODE(I64DivU)
+                // 除法（无符号）
+                if (stack[SP].value.uint64 == 0) {
+                    sprintf(exception, "integer divide by zero");
+                    return false;
                 }
-
-                stack[m->sp].value.uint64 = f;
-                continue;
-            case I64Add ... I64Rotr:
-                // 指令作用：获取操作数栈的栈顶和次栈顶的值（64 位整数），根据具体指令对两个值进行计算，并用计算结果覆盖当前操作数栈顶值
-
-                d = stack[m->sp - 1].value.uint64;
-                e = stack[m->sp].value.uint64;
-                m->sp -= 1;
-
-                // 执行 I64DivS 和 I64RemU 之间的指令时，栈顶值 e 不能为 0，
-                // 如果为 0 则记录异常信息并返回 false 退出虚拟机执行
-                if (opcode >= I64DivS && opcode <= I64RemU && e == 0) {
+                I64_BINARY(d / e)
+                NEXT();
+            OPCODE(I64RemS)
+                // 取余（有符号）
+                // 注：INT64_MIN % -1 在 C 语言中是未定义行为，按照 Wasm 规范其结果为 0
+                if (stack[SP].value.uint64 == 0) {
                     sprintf(exception, "integer divide by zero");
                     return false;
                 }
-
-                switch (opcode) {
-                    case I64Add:
-                        // 加法
-                        f = d + e;
-                        break;
-                    case I64Sub:
-                        // 减法
-                        f = d - e;
-                        break;
-                    case I64Mul:
-                        // 乘法
-                        f = d * e;
-                        break;
-                    case I64DivS:
-                        // 除法（有符号）
-                        if (d == 0x80000000 && e == -1) {
-                            sprintf(exception, "integer overflow");
-                            return false;
-                        }
-                        f = (int64_t) d / (int64_t) e;
-                        break;
-                    case I64DivU:
-                        // 除法（无符号）
-                        f = d / e;
-                        break;
-                    case I64RemS:
-                        // 取余（有符号）
-                        if (d == 0x80000000 && e == -1) {
-                            f = 0;
-                        } else {
-                            f = (int64_t) d % (int64_t) e;
-                        }
-                        break;
-                    case I64RemU:
-                        // 取余（无符号）
-                        f = d % e;
-                        break;
-                    case I64And:
-                        // 与
-                        f = d & e;
-                        break;
-                    case I64Or:
-                        // 或
-                        f = d | e;
-                        break;
-                    case I64Xor:
-                        // 异或
-                        f = d ^ e;
-                        break;
-                    case I64Shl:
-                        // 左移
-                        f = d << e;
-                        break;
-                    case I64ShrS:
-                        // 右移
-                        f = ((int64_t) d) >> e;
-                        break;
-                    case I64ShrU:
-                        // 右移
-                        f = d >> e;
-                        break;
-                    case I64Rotl:
-                        // 循环左移
-                        f = rotl64(d, e);
-                        break;
-                    case I64Rotr:
-                        // 循环右移
-                        f = rotr64(d, e);
-                        break;
-                    default:
-                        break;
+                I64_BINARY((d == 0x8000000000000000 && e == (uint64_t) -1) ? 0 : (int64_t) d % (int64_t) e)
+                NEXT();
+            OPCODE(I64RemU)
+                // 取余（无符号）
+                if (stack[SP].value.uint64 == 0) {
+                    sprintf(exception, "integer divide by zero");
+                    return false;
                 }
-
-                stack[m->sp].value.uint64 = f;
-                continue;
-            case F32Abs:
+                I64_BINARY(d % e)
+                NEXT();
+            OPCODE(I64And)
+                // 与
+                I64_BINARY(d & e)
+                NEXT();
+            OPCODE(I64Or)
+                // 或
+                I64_BINARY(d | e)
+                NEXT();
+            OPCODE(I64Xor)
+                // 异或
+                I64_BINARY(d ^ e)
+                NEXT();
+            OPCODE(I64Shl)
+                // 左移
+                I64_BINARY(d << e)
+                NEXT();
+            OPCODE(I64ShrS)
+                // 右移（有符号）
+                I64_BINARY(((int64_t) d) >> e)
+                NEXT();
+            OPCODE(I64ShrU)
+                // 右移（无符号）
+                I64_BINARY(d >> e)
+                NEXT();
+            OPCODE(I64Rotl)
+                // 循环左移
+                I64_BINARY(rotl64(d, e))
+                NEXT();
+            OPCODE(I64Rotr)
+                // 循环右移
+                I64_BINARY(rotr64(d, e))
+                NEXT();
+            OPCODE(F32Abs)
                 // 取绝对值（32 位浮点型）
-                stack[m->sp].value.f32 = fabsf(stack[m->sp].value.f32);
-                continue;
-            case F32Neg:
+                stack[SP].value.f32 = fabsf(stack[SP].value.f32);
+                NEXT();
+            OPCODE(F32Neg)
                 // 取反（32 位浮点型）
-                stack[m->sp].value.f32 = -stack[m->sp].value.f32;
-                continue;
-            case F32Ceil:
+                stack[SP].value.f32 = -stack[SP].value.f32;
+                NEXT();
+            OPCODE(F32Ceil)
                 // 获取大于或等于操作数栈顶值的最小的整数值（32 位浮点型）
-                stack[m->sp].value.f32 = ceilf(stack[m->sp].value.f32);
-                continue;
-            case F32Floor:
+                stack[SP].value.f32 = ceilf(stack[SP].value.f32);
+                NEXT();
+            OPCODE(F32Floor)
                 // 获取小于或等于操作数栈顶值的最小的整数值（32 位浮点型）
-                stack[m->sp].value.f32 = floorf(stack[m->sp].value.f32);
-                continue;
-            case F32Trunc:
+                stack[SP].value.f32 = floorf(stack[SP].value.f32);
+                NEXT();
+            OPCODE(F32Trunc)
                 // 将小数部分截去，保留整数（32 位浮点型）
-                stack[m->sp].value.f32 = truncf(stack[m->sp].value.f32);
-                continue;
-            case F32Nearest:
+                stack[SP].value.f32 = truncf(stack[SP].value.f32);
+                NEXT();
+            OPCODE(F32Nearest)
                 // 获取最接近操作数栈顶值的整数，如果有 2 个数同样接近，则取偶数的整数（32 位浮点型）
-                stack[m->sp].value.f32 = rintf(stack[m->sp].value.f32);
-                continue;
-            case F32Sqrt:
+                stack[SP].value.f32 = rintf(stack[SP].value.f32);
+                NEXT();
+            OPCODE(F32Sqrt)
                 // 取平方根（32 位浮点型）
-                stack[m->sp].value.f32 = sqrtf(stack[m->sp].value.f32);
-                continue;
-            case F32Add ... F32CopySign:
-                // 指令作用：获取操作数栈的栈顶和次栈顶的值（32 位浮点数），根据具体指令对两个值进行计算，并用计算结果覆盖当前操作数栈顶值
-
-                g = stack[m->sp - 1].value.f32;
-                h = stack[m->sp].value.f32;
-                m->sp -= 1;
-
-                switch (opcode) {
-                    case F32Add:
-                        // 加法
-                        i = g + h;
-                        break;
-                    case F32Sub:
-                        // 减法
-                        i = g - h;
-                        break;
-                    case F32Mul:
-                        // 乘法
-                        i = g * h;
-                        break;
-                    case F32Div:
-                        // 除法
-                        if (h == 0) {
-                            sprintf(exception, "integer divide by zero");
-                            return false;
-                        }
-                        i = g / h;
-                        break;
-                    case F32Min:
-                        // 取两者之间的最小值
-                        i = wa_fminf(g, h);
-                        break;
-                    case F32Max:
-                        // 取两者之间的最大值
-                        i = wa_fmaxf(g, h);
-                        break;
-                    case F32CopySign:
-                        // 获取带有第二个浮点数符号的第一个浮点数
-                        // 注：signbit 函数用于判断参数的符号位的正负，为负的时候返回 true，否则返回 false
-                        i = signbit(h) ? -fabsf(g) : fabsf(g);
-                        break;
-                    default:
-                        break;
-                }
-
-                stack[m->sp].value.f32 = i;
-                continue;
-            case F64Abs:
+                stack[SP].value.f32 = sqrtf(stack[SP].value.f32);
+                NEXT();
+            OPCODE(F32Add)
+                // 加法
+                F32_BINARY(g + h)
+                NEXT();
+            OPCODE(F32Sub)
+                // 减法
+                F32_BINARY(g - h)
+                NEXT();
+            OPCODE(F32Mul)
+                // 乘法
+                F32_BINARY(g * h)
+                NEXT();
+            OPCODE(F32Div)
+                // 除法
+                // 注：按照 IEEE 754 规范，浮点数除以 0 的结果为正负无穷或者 NaN，不会引发运行时错误
+                F32_BINARY(g / h)
+                NEXT();
+            OPCODE(F32Min)
+                // 取两者之间的最小值
+                F32_BINARY(wa_fminf(g, h))
+                NEXT();
+            OPCODE(F32Max)
+                // 取两者之间的最大值
+                F32_BINARY(wa_fmaxf(g, h))
+                NEXT();
+            OPCODE(F32CopySign)
+                // 获取带有第二个浮点数符号的第一个浮点数
+                // 注：signbit 函数用于判断参数的符号位的正负，为负的时候返回 true，否则返回 false
+                F32_BINARY(signbit(h) ? -fabsf(g) : fabsf(g))
+                NEXT();
+            OPCODE(F64Abs)
                 // 取绝对值（64 位浮点型）
-                stack[m->sp].value.f32 = (float) fabs(stack[m->sp].value.f64);
-                continue;
-            case F64Neg:
+                stack[SP].value.f64 = fabs(stack[SP].value.f64);
+                NEXT();
+            OPCODE(F64Neg)
                 // 取反（64 位浮点型）
-                stack[m->sp].value.f64 = -stack[m->sp].value.f64;
-                continue;
-            case F64Ceil:
+                stack[SP].value.f64 = -stack[SP].value.f64;
+                NEXT();
+            OPCODE(F64Ceil)
                 // 获取大于或等于操作数栈顶值的最小的整数值（64 位浮点型）
-                stack[m->sp].value.f64 = ceil(stack[m->sp].value.f64);
-                continue;
-            case F64Floor:
+                stack[SP].value.f64 = ceil(stack[SP].value.f64);
+                NEXT();
+            OPCODE(F64Floor)
                 // 获取小于或等于操作数栈顶值的最小的整数值（64 位浮点型）
-                stack[m->sp].value.f64 = floor(stack[m->sp].value.f64);
-                continue;
-            case F64Trunc:
+                stack[SP].value.f64 = floor(stack[SP].value.f64);
+                NEXT();
+            OPCODE(F64Trunc)
                 // 将小数部分截去，保留整数（64 位浮点型）
-                stack[m->sp].value.f64 = trunc(stack[m->sp].value.f64);
-                continue;
-            case F64Nearest:
+                stack[SP].value.f64 = trunc(stack[SP].value.f64);
+                NEXT();
+            OPCODE(F64Nearest)
                 // 获取最接近操作数栈顶值的整数，如果有 2 个数同样接近，则取偶数的整数（64 位浮点型）
-                stack[m->sp].value.f64 = rint(stack[m->sp].value.f64);
-                continue;
-            case F64Sqrt:
+                stack[SP].value.f64 = rint(stack[SP].value.f64);
+                NEXT();
+            OPCODE(F64Sqrt)
                 // 取平方根（64 位浮点型）
-                stack[m->sp].value.f64 = sqrt(stack[m->sp].value.f64);
-                continue;
-            case F64Add ... F64CopySign:
-                // 指令作用：获取操作数栈的栈顶和次栈顶的值（64 位浮点数），根据具体指令对两个值进行计算，并用计算结果覆盖当前操作数栈顶值
-
-                j = stack[m->sp - 1].value.f64;
-                k = stack[m->sp].value.f64;
-                m->sp -= 1;
-
-                switch (opcode) {
-                    case F64Add:
-                        // 加法
-                        l = j + k;
-                        break;
-                    case F64Sub:
-                        // 减法
-                        l = j - k;
-                        break;
-                    case F64Mul:
-                        // 乘法
-                        l = j * k;
-                        break;
-                    case F64Div:
-                        // 除法
-                        if (k == 0) {
-                            sprintf(exception, "integer divide by zero");
-                            return false;
-                        }
-                        l = j / k;
-                        break;
-                    case F64Min:
-                        // 取两者之间的最小值
-                        l = wa_fmin(j, k);
-                        break;
-                    case F64Max:
-                        // 取两者之间的最大值
-                        l = wa_fmax(j, k);
-                        break;
-                    case F64CopySign:
-                        // 获取带有第二个浮点数符号的第一个浮点数
-                        // 注：signbit 函数用于判断参数的符号位的正负，为负的时候返回 true，否则返回 false
-                        l = signbit(k) ? -fabs(j) : fabs(j);
-                        break;
-                    default:
-                        break;
-                }
+                stack[SP].value.f64 = sqrt(stack[SP].value.f64);
+                NEXT();
+            OPCODE(F64Add)
+                // 加法
+                F64_BINARY(j + k)
+                NEXT();
+            OPCODE(F64Sub)
+                // 减法
+                F64_BINARY(j - k)
+                NEXT();
+            OPCODE(F64Mul)
+                // 乘法
+                F64_BINARY(j * k)
+                NEXT();
+            OPCODE(F64Div)
+                // 除法
+                // 注：按照 IEEE 754 规范，浮点数除以 0 的结果为正负无穷或者 NaN，不会引发运行时错误
+                F64_BINARY(j / k)
+                NEXT();
+            OPCODE(F64Min)
+                // 取两者之间的最小值
+                F64_BINARY(wa_fmin(j, k))
+                NEXT();
+            OPCODE(F64Max)
+                // 取两者之间的最大值
+                F64_BINARY(wa_fmax(j, k))
+                NEXT();
+            OPCODE(F64CopySign)
+                // 获取带有第二个浮点数符号的第一个浮点数
+                // 注：signbit 函数用于判断参数的符号位的正负，为负的时候返回 true，否则返回 false
+                F64_BINARY(signbit(k) ? -fabs(j) : fabs(j))
+                NEXT();
 
-                stack[m->sp].value.f64 = l;
-                continue;
 
             /*
              * 数值指令--类型转换指令（31 条）
@@ -1391,149 +1757,149 @@ bool interpret(Module *m) {
              * 注：类型转换指令的助记符是 t'.conv_t，
              * 其中操作数在类型转换之前的类型是 t，之后的类型是 t'，转换操作是 conv
              * */
-            case I32WrapI64:
+            OPCODE(I32WrapI64)
                 // 指令作用：将 64 位整数截断为 32 位整数
-                stack[m->sp].value.uint64 &= 0x00000000ffffffff;
-                stack[m->sp].value_type = I32;
-                continue;
-            case I32TruncF32S:
+                stack[SP].value.uint64 &= 0x00000000ffffffff;
+                SET_VALUE_TYPE(stack[SP], I32)
+                NEXT();
+            OPCODE(I32TruncF32S)
                 // 指令作用：将 32 位浮点数截断为 32 有符号位整数（截掉小数部分）
-                OP_I32_TRUNC_F32(stack[m->sp].value.int32, stack[m->sp].value.f32)
-                stack[m->sp].value_type = I32;
-                continue;
-            case I32TruncF32U:
+                OP_I32_TRUNC_F32(stack[SP].value.int32, stack[SP].value.f32)
+                SET_VALUE_TYPE(stack[SP], I32)
+                NEXT();
+            OPCODE(I32TruncF32U)
                 // 指令作用：将 32 位浮点数截断为 32 位无符号整数（截掉小数部分）
-                OP_U32_TRUNC_F32(stack[m->sp].value.uint32, stack[m->sp].value.f32)
-                stack[m->sp].value_type = I32;
-                continue;
-            case I32TruncF64S:
+                OP_U32_TRUNC_F32(stack[SP].value.uint32, stack[SP].value.f32)
+                SET_VALUE_TYPE(stack[SP], I32)
+                NEXT();
+            OPCODE(I32TruncF64S)
                 // 指令作用：将 64 位浮点数截断为 32 位有符号整数（截掉小数部分）
-                OP_I32_TRUNC_F64(stack[m->sp].value.int32, stack[m->sp].value.f64)
-                stack[m->sp].value_type = I32;
-                continue;
-            case I32TruncF64U:
+                OP_I32_TRUNC_F64(stack[SP].value.int32, stack[SP].value.f64)
+                SET_VALUE_TYPE(stack[SP], I32)
+                NEXT();
+            OPCODE(I32TruncF64U)
                 // 指令作用：将 64 位浮点数截断为 32 位无符号整数（截掉小数部分）
-                OP_U32_TRUNC_F64(stack[m->sp].value.uint32, stack[m->sp].value.f64)
-                stack[m->sp].value_type = I32;
-                continue;
-            case I64ExtendI32S:
+                OP_U32_TRUNC_F64(stack[SP].value.uint32, stack[SP].value.f64)
+                SET_VALUE_TYPE(stack[SP], I32)
+                NEXT();
+            OPCODE(I64ExtendI32S)
                 // 指令作用：将 32 位有符号整数位数拉升为 64 位整数
-                stack[m->sp].value.uint64 = stack[m->sp].value.uint32;
-                sext_32_64(&stack[m->sp].value.uint64);
-                stack[m->sp].value_type = I64;
-                continue;
-            case I64ExtendI32U:
+                stack[SP].value.uint64 = stack[SP].value.uint32;
+                sext_32_64(&stack[SP].value.uint64);
+                SET_VALUE_TYPE(stack[SP], I64)
+                NEXT();
+            OPCODE(I64ExtendI32U)
                 // 指令作用：将 32 位无符号整数位数拉升为 64 位整数
-                stack[m->sp].value.uint64 = stack[m->sp].value.uint32;
-                stack[m->sp].value_type = I64;
-                continue;
-            case I64TruncF32S:
+                stack[SP].value.uint64 = stack[SP].value.uint32;
+                SET_VALUE_TYPE(stack[SP], I64)
+                NEXT();
+            OPCODE(I64TruncF32S)
                 // 指令作用：将 32 位浮点数截断为 64 位有符号整数（截掉小数部分）
-                OP_I64_TRUNC_F32(stack[m->sp].value.int64, stack[m->sp].value.f32)
-                stack[m->sp].value_type = I64;
-                continue;
-            case I64TruncF32U:
+                OP_I64_TRUNC_F32(stack[SP].value.int64, stack[SP].value.f32)
+                SET_VALUE_TYPE(stack[SP], I64)
+                NEXT();
+            OPCODE(I64TruncF32U)
                 // 指令作用：将 32 位浮点数截断为 64 位无符号整数（截掉小数部分）
-                OP_U64_TRUNC_F32(stack[m->sp].value.uint64, stack[m->sp].value.f32)
-                stack[m->sp].value_type = I64;
-                continue;
-            case I64TruncF64S:
+                OP_U64_TRUNC_F32(stack[SP].value.uint64, stack[SP].value.f32)
+                SET_VALUE_TYPE(stack[SP], I64)
+                NEXT();
+            OPCODE(I64TruncF64S)
                 // 指令作用：将 64 位浮点数截断为 64 位有符号整数（截掉小数部分）
-                OP_I64_TRUNC_F64(stack[m->sp].value.int64, stack[m->sp].value.f64)
-                stack[m->sp].value_type = I64;
-                continue;
-            case I64TruncF64U:
+                OP_I64_TRUNC_F64(stack[SP].value.int64, stack[SP].value.f64)
+                SET_VALUE_TYPE(stack[SP], I64)
+                NEXT();
+            OPCODE(I64TruncF64U)
                 // 指令作用：将 64 位无符号浮点数截断为 64 位无符号整数（截掉小数部分）
-                OP_U64_TRUNC_F64(stack[m->sp].value.uint64, stack[m->sp].value.f64)
-                stack[m->sp].value_type = I64;
-                continue;
-            case F32ConvertI32S:
+                OP_U64_TRUNC_F64(stack[SP].value.uint64, stack[SP].value.f64)
+                SET_VALUE_TYPE(stack[SP], I64)
+                NEXT();
+            OPCODE(F32ConvertI32S)
                 // 指令作用：将 32 位有符号整数转化为 32 位浮点数
-                stack[m->sp].value.f32 = (float) stack[m->sp].value.int32;
-                stack[m->sp].value_type = F32;
-                continue;
-            case F32ConvertI32U:
+                stack[SP].value.f32 = (float) stack[SP].value.int32;
+                SET_VALUE_TYPE(stack[SP], F32)
+                NEXT();
+            OPCODE(F32ConvertI32U)
                 // 指令作用：将 32 位无符号整数转化为 32 位浮点数
-                stack[m->sp].value.f32 = (float) stack[m->sp].value.uint32;
-                stack[m->sp].value_type = F32;
-                continue;
-            case F32ConvertI64S:
+                stack[SP].value.f32 = (float) stack[SP].value.uint32;
+                SET_VALUE_TYPE(stack[SP], F32)
+                NEXT();
+            OPCODE(F32ConvertI64S)
                 // 指令作用：将 64 位有符号整数转化为 32 位浮点数
-                stack[m->sp].value.f32 = (float) stack[m->sp].value.int64;
-                stack[m->sp].value_type = F32;
-                continue;
-            case F32ConvertI64U:
+                stack[SP].value.f32 = (float) stack[SP].value.int64;
+                SET_VALUE_TYPE(stack[SP], F32)
+                NEXT();
+            OPCODE(F32ConvertI64U)
                 // 指令作用：将 64 位无符号整数转化为 32 位浮点数
-                stack[m->sp].value.f32 = (float) stack[m->sp].value.uint64;
-                stack[m->sp].value_type = F32;
-                continue;
-            case F32DemoteF64:
+                stack[SP].value.f32 = (float) stack[SP].value.uint64;
+                SET_VALUE_TYPE(stack[SP], F32)
+                NEXT();
+            OPCODE(F32DemoteF64)
                 // 指令作用：将 64 位浮点数精度降低到 32 位
-                stack[m->sp].value.f32 = (float) stack[m->sp].value.f64;
-                stack[m->sp].value_type = F32;
-                continue;
-            case F64ConvertI32S:
+                stack[SP].value.f32 = (float) stack[SP].value.f64;
+                SET_VALUE_TYPE(stack[SP], F32)
+                NEXT();
+            OPCODE(F64ConvertI32S)
                 // 指令作用：将 32 位有符号整数转化为 64 位浮点数
-                stack[m->sp].value.f64 = stack[m->sp].value.int32;
-                stack[m->sp].value_type = F64;
-                continue;
-            case F64ConvertI32U:
+                stack[SP].value.f64 = stack[SP].value.int32;
+                SET_VALUE_TYPE(stack[SP], F64)
+                NEXT();
+            OPCODE(F64ConvertI32U)
                 // 指令作用：将 32 位无符号整数转化为 64 位浮点数
-                stack[m->sp].value.f64 = stack[m->sp].value.uint32;
-                stack[m->sp].value_type = F64;
-                continue;
-            case F64ConvertI64S:
+                stack[SP].value.f64 = stack[SP].value.uint32;
+                SET_VALUE_TYPE(stack[SP], F64)
+                NEXT();
+            OPCODE(F64ConvertI64S)
                 // 指令作用：将 64 位有符号整数转化为 64 位浮点数
-                stack[m->sp].value.f64 = (double) stack[m->sp].value.int64;
-                stack[m->sp].value_type = F64;
-                continue;
-            case F64ConvertI64U:
+                stack[SP].value.f64 = (double) stack[SP].value.int64;
+                SET_VALUE_TYPE(stack[SP], F64)
+                NEXT();
+            OPCODE(F64ConvertI64U)
                 // 指令作用：将 64 位无符号整数转化为 64 位浮点数
-                stack[m->sp].value.f64 = (double) stack[m->sp].value.uint64;
-                stack[m->sp].value_type = F64;
-                continue;
-            case F64PromoteF32:
+                stack[SP].value.f64 = (double) stack[SP].value.uint64;
+                SET_VALUE_TYPE(stack[SP], F64)
+                NEXT();
+            OPCODE(F64PromoteF32)
                 // 指令作用：将 32 位浮点数精度提升到 64 位
-                stack[m->sp].value.f64 = stack[m->sp].value.f32;
-                stack[m->sp].value_type = F64;
-                continue;
-            case I32ReinterpretF32:
+                stack[SP].value.f64 = stack[SP].value.f32;
+                SET_VALUE_TYPE(stack[SP], F64)
+                NEXT();
+            OPCODE(I32ReinterpretF32)
                 // 指令作用：将 64 位浮点数重新解释为 32 位整数类型，但不改变比特位
-                stack[m->sp].value_type = I32;
-                continue;
-            case I64ReinterpretF64:
+                SET_VALUE_TYPE(stack[SP], I32)
+                NEXT();
+            OPCODE(I64ReinterpretF64)
                 // 指令作用：将 64 位浮点数重新解释为 64 位整数类型，但不改变比特位
-                stack[m->sp].value_type = I64;
-                continue;
-            case F32ReinterpretI32:
+                SET_VALUE_TYPE(stack[SP], I64)
+                NEXT();
+            OPCODE(F32ReinterpretI32)
                 // 指令作用：将 32 位整数重新解释为 32 位浮点数类型，但不改变比特位
-                stack[m->sp].value_type = F32;
-                continue;
-            case F64ReinterpretI64:
+                SET_VALUE_TYPE(stack[SP], F32)
+                NEXT();
+            OPCODE(F64ReinterpretI64)
                 // 指令作用：将 64 位整数重新解释为 64 位浮点数类型，但不改变比特位
-                stack[m->sp].value_type = F64;
-                continue;
-            case I32Extend8S:
+                SET_VALUE_TYPE(stack[SP], F64)
+                NEXT();
+            OPCODE(I32Extend8S)
                 // 指令作用：将 8 位有符号整数位数拉升为 32 位整数
-                stack[m->sp].value.int32 = ((int32_t) (int8_t) stack[m->sp].value.int32);
-                continue;
-            case I32Extend16S:
+                stack[SP].value.int32 = ((int32_t) (int8_t) stack[SP].value.int32);
+                NEXT();
+            OPCODE(I32Extend16S)
                 // 指令作用：将 16 位有符号整数位数拉升为 32 位整数
-                stack[m->sp].value.int32 = ((int32_t) (int16_t) stack[m->sp].value.int32);
-                continue;
-            case I64Extend8S:
+                stack[SP].value.int32 = ((int32_t) (int16_t) stack[SP].value.int32);
+                NEXT();
+            OPCODE(I64Extend8S)
                 // 指令作用：将 8 位有符号整数位数拉升为 64 位整数
-                stack[m->sp].value.int64 = ((int64_t) (int8_t) stack[m->sp].value.int64);
-                continue;
-            case I64Extend16S:
+                stack[SP].value.int64 = ((int64_t) (int8_t) stack[SP].value.int64);
+                NEXT();
+            OPCODE(I64Extend16S)
                 // 指令作用：将 16 位有符号整数位数拉升为 64 位整数
-                stack[m->sp].value.int64 = ((int64_t) (int16_t) stack[m->sp].value.int64);
-                continue;
-            case I64Extend32S:
+                stack[SP].value.int64 = ((int64_t) (int16_t) stack[SP].value.int64);
+                NEXT();
+            OPCODE(I64Extend32S)
                 // 指令作用：将 32 位有符号整数位数拉升为 64 位整数
-                stack[m->sp].value.int64 = ((int64_t) (int32_t) stack[m->sp].value.int64);
-                continue;
-            case TruncSat: {
+                stack[SP].value.int64 = ((int64_t) (int32_t) stack[SP].value.int64);
+                NEXT();
+            OPCODE(TruncSat) {
                 // 饱和截断指令
                 // Wasm 支持的 4 种基本类型都是固定长度：i32 和 f32 类型占 4 字节，i64 和 f64 类型占 8 字节
                 // 定长的数据类型只能表达有限的数值，因此对 2 个某种类型的数进行计算，其结果可能会超出该类型的表达范围，也就是溢出：包括上溢和下溢
@@ -1548,107 +1914,248 @@ bool interpret(Module *m) {
                 // 这 8 条指令是通过一条特殊的操作码前缀 0xFC 引入的，操作码前缀 0xFC 未来可能会用来增加其他指令。
                 // 为了保持统一，我们仍将 0xFC 作为一个普通操作码，将跟在它后面的字节当作它的立即数，这样就可以认为只有一条饱和截断指令
 
-                // 在读取一个字节，用来区分不同类型的浮点数和整数之间的转换
-                uint8_t type = read_LEB_unsigned(bytes, &m->pc, 8);
+                // 立即数 a 用来区分不同类型的浮点数和整数之间的转换
+                uint8_t type = ins->a;
                 switch (type) {
                     case 0x00:
                         // 指令作用：将 32 位浮点数饱和截断为 32 有符号位整数（截掉小数部分）
-                        OP_I32_TRUNC_SAT_F32(stack[m->sp].value.int32, stack[m->sp].value.f32)
-                        stack[m->sp].value_type = I32;
+                        OP_I32_TRUNC_SAT_F32(stack[SP].value.int32, stack[SP].value.f32)
+                        SET_VALUE_TYPE(stack[SP], I32)
                         break;
                     case 0x01:
                         // 指令作用：将 32 位浮点数截断为 32 位无符号整数（截掉小数部分）
-                        OP_U32_TRUNC_SAT_F32(stack[m->sp].value.uint32, stack[m->sp].value.f32)
-                        stack[m->sp].value_type = I32;
+                        OP_U32_TRUNC_SAT_F32(stack[SP].value.uint32, stack[SP].value.f32)
+                        SET_VALUE_TYPE(stack[SP], I32)
                         break;
                     case 0x02:
                         // 指令作用：将 64 位浮点数截断为 32 位有符号整数（截掉小数部分）
-                        OP_I32_TRUNC_SAT_F64(stack[m->sp].value.int32, stack[m->sp].value.f64)
-                        stack[m->sp].value_type = I32;
+                        OP_I32_TRUNC_SAT_F64(stack[SP].value.int32, stack[SP].value.f64)
+                        SET_VALUE_TYPE(stack[SP], I32)
                         break;
                     case 0x03:
                         // 指令作用：将 64 位浮点数截断为 32 位无符号整数（截掉小数部分）
-                        OP_U32_TRUNC_SAT_F64(stack[m->sp].value.uint32, stack[m->sp].value.f64)
-                        stack[m->sp].value_type = I32;
+                        OP_U32_TRUNC_SAT_F64(stack[SP].value.uint32, stack[SP].value.f64)
+                        SET_VALUE_TYPE(stack[SP], I32)
                         break;
                     case 0x04:
                         // 指令作用：将 32 位浮点数截断为 64 位有符号整数（截掉小数部分）
-                        OP_I64_TRUNC_SAT_F32(stack[m->sp].value.int64, stack[m->sp].value.f32)
-                        stack[m->sp].value_type = I64;
+                        OP_I64_TRUNC_SAT_F32(stack[SP].value.int64, stack[SP].value.f32)
+                        SET_VALUE_TYPE(stack[SP], I64)
                         break;
                     case 0x05:
                         // 指令作用：将 32 位浮点数截断为 64 位无符号整数（截掉小数部分）
-                        OP_U64_TRUNC_SAT_F32(stack[m->sp].value.uint64, stack[m->sp].value.f32)
-                        stack[m->sp].value_type = I64;
+                        OP_U64_TRUNC_SAT_F32(stack[SP].value.uint64, stack[SP].value.f32)
+                        SET_VALUE_TYPE(stack[SP], I64)
                         break;
                     case 0x06:
                         // 指令作用：将 64 位浮点数截断为 64 位有符号整数（截掉小数部分）
-                        OP_I64_TRUNC_SAT_F64(stack[m->sp].value.int64, stack[m->sp].value.f64)
-                        stack[m->sp].value_type = I64;
+                        OP_I64_TRUNC_SAT_F64(stack[SP].value.int64, stack[SP].value.f64)
+                        SET_VALUE_TYPE(stack[SP], I64)
                         break;
                     case 0x07:
                         // 指令作用：将 64 位无符号浮点数截断为 64 位无符号整数（截掉小数部分）
-                        OP_U64_TRUNC_SAT_F64(stack[m->sp].value.uint64, stack[m->sp].value.f64)
-                        stack[m->sp].value_type = I64;
+                        OP_U64_TRUNC_SAT_F64(stack[SP].value.uint64, stack[SP].value.f64)
+                        SET_VALUE_TYPE(stack[SP], I64)
                         break;
                     default:
                         break;
                 }
-                continue;
+                NEXT();
             }
+
+            /*
+             * 超级指令（9 条）
+             * 指令作用：一次完成多条连续指令的操作，从而减少指令分派的次数以及操作数栈的读写
+             *
+             * 注：超级指令是在加载模块时由 fuse_instructions 将指令序列中第一条指令的操作码替换而来的，
+             * 指令序列中的其余指令保持不变，所以 handler 直接从 ins[1] ins[2] ... 中读取这些指令的立即数，
+             * 执行完成后需要跳过这些指令（即 PC 再加上指令序列长度减 1）
+             * */
+            OPCODE(LocalGetI32ConstI32Add)
+                // local.get a; i32.const b; i32.add
+                stack[++SP].value.uint32 = stack[FP + ins->a].value.uint32 + ins[1].b.uint32;
+                SET_VALUE_TYPE(stack[SP], I32)
+                PC += 2;
+                NEXT();
+            OPCODE(LocalGetI32ConstI32Sub)
+                // local.get a; i32.const b; i32.sub
+                stack[++SP].value.uint32 = stack[FP + ins->a].value.uint32 - ins[1].b.uint32;
+                SET_VALUE_TYPE(stack[SP], I32)
+                PC += 2;
+                NEXT();
+            OPCODE(LocalGetLocalGetI32Add)
+                // local.get a; local.get b; i32.add
+                stack[++SP].value.uint32 = stack[FP + ins->a].value.uint32 + stack[FP + ins[1].a].value.uint32;
+                SET_VALUE_TYPE(stack[SP], I32)
+                PC += 2;
+                NEXT();
+            OPCODE(LocalGetLocalGetI32LtSBrIf)
+                // local.get a; local.get b; i32.lt_s; br_if depth
+                if (stack[FP + ins->a].value.int32 < stack[FP + ins[1].a].value.int32) {
+                    BRANCH(&ins[3])
+                } else {
+                    PC += 3;
+                }
+                NEXT();
+            OPCODE(LocalGetI32ConstI32LtSBrIf)
+                // local.get a; i32.const b; i32.lt_s; br_if depth
+                if (stack[FP + ins->a].value.int32 < ins[1].b.int32) {
+                    BRANCH(&ins[3])
+                } else {
+                    PC += 3;
+                }
+                NEXT();
+            OPCODE(I32ConstI32GtSBrIf)
+                // i32.const b; i32.gt_s; br_if depth（与操作数栈顶值比较，并弹出栈顶值）
+                if (stack[SP--].value.int32 > ins->b.int32) {
+                    BRANCH(&ins[2])
+                } else {
+                    PC += 2;
+                }
+                NEXT();
+            OPCODE(LocalTeeBrIf)
+                // local.tee a; br_if depth（将操作数栈顶值保存到局部变量中，再将其弹出作为判断条件）
+                stack[FP + ins->a] = stack[SP];
+                if (stack[SP--].value.uint32) {
+                    BRANCH(&ins[1])
+                } else {
+                    PC += 1;
+                }
+                NEXT();
+            OPCODE(I32ConstLocalSet)
+                // i32.const b; local.set a
+                SET_VALUE_TYPE(stack[FP + ins[1].a], I32)
+                stack[FP + ins[1].a].value.uint32 = ins->b.uint32;
+                PC += 1;
+                NEXT();
+            OPCODE(I32ConstLocalGetI32Store)
+                // i32.const addr; local.get a; i32.store offset（将局部变量的值存储到常量内存地址）
+                MEMORY_ADDRESS(&ins[2], ins->b, 4)
+                memcpy(maddr, &stack[FP + ins[1].a].value.uint32, 4);
+                PC += 2;
+                NEXT();
+#if WASMC_TAIL_CALLS
+            OPCODE(Illegal)
+#elif WASMC_COMPUTED_GOTO
+            L_Illegal:
+#else
             default:
-                // 无法识别的非法操作码（不在 Wasm 规定的字节码）
+#endif
+                // 无法识别的非法操作码（不在 Wasm 规定的字节码，或者属于 wasmc 尚未支持的提案），记录异常信息并返回 false
+                sprintf(exception, "illegal opcode 0x%x", ins->opcode);
                 return false;
+#if !WASMC_COMPUTED_GOTO && !WASMC_TAIL_CALLS
         }
     }
+#endif
 
     // 正常情况不会执行到这里
     return false;
 }
 
-// 调用索引为 fidx 的函数
-bool invoke(Module *m, uint32_t fidx) {
+// 调用索引为 fidx 的函数（不设置越界访问陷阱的恢复点）
+static bool call_function(Module *m, uint32_t fidx) {
+    Block *func = &m->functions[fidx];
     bool result;
 
+    // 分层执行：统计函数的调用次数，达到阈值时将其提升到更快的执行层
+    if (options.tier == TierAuto && func->hotness < options.hot_calls && ++func->hotness == options.hot_calls) {
+        promote_function(m, func);
+    }
+
+    // 如果被调用函数的栈帧超出了操作数栈的容量，则记录异常信息并返回 false（调用栈是否溢出由调用方校验）
+    if (m->sp - (int) func->frame.param_count + (int) func->frame.max_depth >= STACK_SIZE) {
+        sprintf(exception, "call stack exhausted");
+        return false;
+    }
+
     // 调用函数前的设置，主要设置内容如下：
     // 1. 将当前函数关联的栈帧压入到调用栈顶成为当前栈帧，同时保存该栈帧被压入调用栈顶前的运行时状态，例如 sp fp ra 等
     // 2. 将当前函数的局部变量压入到操作数栈顶（默认初始值为 0）
     // 3. 将函数的字节码部分的【起始地址】设置为 pc（即下一条待执行指令的地址），即开始执行函数字节码中的指令流
     setup_call(m, fidx);
 
-    // 虚拟机执行起始函数的字节码中的指令流
-    result = interpret(m);
+    // 根据函数所在的执行层，选择 JIT 编译得到的机器码、寄存器虚拟机或者栈式解释器执行函数
+    if (func->jit_code) {
+        result = jit_run(m, func);
+    } else if (func->rcode) {
+        result = reg_interpret(m, func);
+    } else {
+        result = interpret(m);
+    }
 
     // 返回虚拟机的执行指令的结果
     // 如果结果为 false，表示执行过程中出现异常。如果结果为 true，表示成功执行完指令流。
     return result;
 }
 
+bool invoke(Module *m, uint32_t fidx) {
+    // 由各执行层发起的嵌套调用直接执行，越界访问统一由最外层的调用处理
+    if (memory_trap_point) {
+        return call_function(m, fidx);
+    }
+
+    // 最外层的调用：设置越界访问陷阱的恢复点，执行过程中访问了线性内存的保护页时，
+    // 信号处理函数会通过 siglongjmp 返回到这里（sigsetjmp 返回非 0），此时记录异常信息并返回 false
+    // 注：调用栈、操作数栈等运行时状态由调用方在下次调用前重置，所以无需恢复
+    sigjmp_buf point;
+    if (sigsetjmp(point, 1)) {
+        memory_trap_point = NULL;
+        sprintf(exception, MEMORY_OOB_MESSAGE);
+        return false;
+    }
+    memory_trap_point = &point;
+    memory_trap_memory = &m->memory;
+    bool result = call_function(m, fidx);
+    memory_trap_point = NULL;
+    return result;
+}
+
 // 计算初始化表达式
 // 参数 type 为初始化表达式的返回值类型
 // 参数 *pc 为初始化表达式的字节码部分的【起始地址】
+// 注：根据当前版本的 Wasm 标准，初始化表达式只能由一条常量指令或者 global.get 指令组成，并以 End_ 指令结尾，
+// 所以无需将其翻译成内部指令流交给虚拟机执行，直接解码并求值即可
 void run_init_expr(Module *m, uint8_t type, uint32_t *pc) {
-    m->pc = *pc;// 将控制块中字节码部分的【起始地址】赋值给程序计数器 m->pc（程序计数器，记录下一条即将执行的指令的地址）
+    // 初始化表达式的计算结果压入到操作数栈顶
+    StackValue *sv = &m->stack[++m->sp];
+    // 计算结果的值类型
+    uint8_t value_type;
+    uint32_t gidx;
+
+    uint8_t opcode = m->bytes[(*pc)++];
+    switch (opcode) {
+        case I32Const:
+            value_type = I32;
+            sv->value.uint32 = read_LEB_signed(m->bytes, pc, 32);
+            break;
+        case I64Const:
+            value_type = I64;
+            sv->value.int64 = (int64_t) read_LEB_signed(m->bytes, pc, 64);
+            break;
+        case F32Const:
+            value_type = F32;
+            memcpy(&sv->value.uint32, m->bytes + *pc, 4);
+            *pc += 4;
+            break;
+        case F64Const:
+            value_type = F64;
+            memcpy(&sv->value.uint64, m->bytes + *pc, 8);
+            *pc += 8;
+            break;
+        case GlobalGet:
+            gidx = read_LEB_unsigned(m->bytes, pc, 32);
+            value_type = m->global_types[gidx];
+            *sv = m->globals[gidx];
+            break;
+        default:
+            FATAL("Init_expr opcode 0x%x unsupported\n", opcode)
+    }
 
-    Block block = {
-            .block_type = 0x01,          // 控制块类型为初始化表达式
-            .type = get_block_type(type),// 控制块签名（返回值数量和类型）由参数 type 决定
-            .start_addr = *pc            // 控制块中字节码部分的【起始地址】
-    };
-    // 初始化表达式的字节码中的指令流被执行前，将【待调用的初始化表达式控制块关联的栈帧】压入到调用栈顶，成为当前栈帧，
-    // 同时保存该栈帧被压入调用栈顶前的运行时状态，例如 sp fp ra 等
-    push_block(m, &block, m->sp);
-
-    // 虚拟机执行初始化表达式的字节码中的指令流
-    interpret(m);
-
-    // 当初始化表达式的字节码中的指令流被执行完成后，需要将在 Wasm 二进制字节码中的当前位置的地址赋给参数 *pc，以便继续解析后面的 Wasm 二进制字节码
-    // 注：run_init_expr 函数是在解析 Wasm 二进制字节码的 load_module 函数中调用，
-    // 在调用 run_init_expr 函数计算初始化表达式结果后，仍需要继续解析后面的二进制字节码内容
-    *pc = m->pc;
-
-    // 初始化表达式的字节码中的指令流执行完成后，操作数栈顶保存的就是指令流的执行结果，也就是初始化表达式计算的返回值
-    // 由于初始化表达式计算一定会有返回值，且目前版本的 Wasm 规范规定控制块最多只能有一个返回值，所以初始化表达式计算必定会有一个返回值
-    // 所以可以通过比对保存在操作数栈顶的值类型和参数 type 是否相同，来判断计算得到的返回值的类型是否正确
-    ASSERT(m->stack[m->sp].value_type == type, "Init_expr type mismatch 0x%x != 0x%x\n", m->stack[m->sp].value_type, type)
+    // 初始化表达式必须以 End_ 指令结尾
+    ASSERT(m->bytes[(*pc)++] == End_, "Init_expr did not end with 0xb\n")
+
+    // 通过比对计算结果的值类型和参数 type 是否相同，来判断计算得到的返回值的类型是否正确
+    ASSERT(value_type == type, "Init_expr type mismatch 0x%x != 0x%x\n", value_type, type)
+    SET_VALUE_TYPE(*sv, value_type)
 }
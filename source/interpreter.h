@@ -2,19 +2,68 @@
 #define WASMC_INTERPRETER_H
 
 #include "module.h"
+#include "opcode.h"
 #include <stdbool.h>
 #include <stdint.h>
 
+// 是否启用直接线索化分派（direct threading，即 computed goto）
+// 该模式基于 GCC/Clang 的标签地址（labels as values）扩展：每条指令都有独立的处理代码（handler），
+// 每个 handler 执行结束时直接读取下一条指令并通过跳转表跳转到对应的 handler，
+// 相比于 switch 分派，省去了跳转表的边界检查，且每个 handler 都有独立的间接跳转指令，CPU 分支预测的准确率更高
+// 注：可以在构建时通过 -DWASMC_COMPUTED_GOTO=0 关闭，退回到 switch 分派
+#ifndef WASMC_COMPUTED_GOTO
+#if defined(__GNUC__)
+#define WASMC_COMPUTED_GOTO 1
+#else
+#define WASMC_COMPUTED_GOTO 0
+#endif
+#endif
+
+// 是否启用尾调用分派（tail-call threading），默认关闭，可以在构建时通过 -DWASMC_TAIL_CALLS=1 开启
+// 该模式下每种操作码的 handler 都是一个独立的函数，并保存在以操作码为索引的 handler 表中，
+// PC、SP、FP 以及操作数栈等运行时状态作为参数在 handler 之间传递，每个 handler 执行结束时直接尾调用下一条指令的 handler，
+// 相比于 computed goto，每个 handler 都是独立的小函数，编译器可以为每个 handler 单独分配寄存器，运行时状态也始终位于参数寄存器中
+// 注：只有在编译器能够保证尾调用不增长本机栈时才能启用该模式，否则执行深层循环时本机栈会溢出：
+// Clang 通过 musttail 属性保证；GCC 不支持 musttail，但开启优化（-O2）时会将其优化为尾调用（sibling call），
+// 其他情况下自动退回到 computed goto 或 switch 分派
+#ifndef WASMC_TAIL_CALLS
+#define WASMC_TAIL_CALLS 0
+#endif
+#if WASMC_TAIL_CALLS
+#if defined(__has_attribute)
+#if __has_attribute(musttail)
+#define MUSTTAIL __attribute__((musttail))
+#endif
+#endif
+#if !defined(MUSTTAIL) && defined(__GNUC__) && defined(__OPTIMIZE__)
+#define MUSTTAIL
+#endif
+#if !defined(MUSTTAIL)
+#undef WASMC_TAIL_CALLS
+#define WASMC_TAIL_CALLS 0
+#endif
+#endif
+
+// 当前控制块（包含函数）执行结束后，将关联的当前栈帧从调用栈顶中弹出，
+// 同时恢复该栈帧被压入调用栈顶前的运行时状态，例如 sp fp ra 等
+Block *pop_block(Module *m);
+
 // 调用函数前的设置，主要设置内容如下：
 // 1. 将当前函数关联的栈帧压入到调用栈顶成为当前栈帧，同时保存该栈帧被压入调用栈顶前的运行时状态，例如 sp fp ra 等
 // 2. 将当前函数的局部变量压入到操作数栈顶（默认初始值为 0）
 // 3. 将函数的字节码部分的【起始地址】设置为 pc（即下一条待执行指令的地址），即开始执行函数字节码中的指令流
 void setup_call(Module *m, uint32_t fidx);
 
-// 虚拟机执行字节码中的指令流
+// 尾调用前的设置：被调用函数（参数已经压入操作数栈顶）直接复用当前栈帧，函数返回时直接返回到当前函数的调用方，
+// 设置完成后 pc 为被调用函数的字节码部分的【起始地址】；如果出现异常（例如操作数栈溢出），则记录异常信息并返回 false
+bool setup_tail_call(Module *m, uint32_t fidx);
+
+// 虚拟机执行字节码中的指令流，当前函数（即进入时位于调用栈顶的函数）返回时退出
 bool interpret(Module *m);
 
-// 调用索引为 fidx 的函数
+// 调用索引为 fidx 的函数（参数已经压入操作数栈顶）
+// 如果该函数已被翻译成寄存器指令，则交给寄存器虚拟机执行，否则交给栈式解释器执行
+// 注：最外层的调用（即不是由各执行层发起的嵌套调用）执行过程中访问了线性内存的保护页时，记录异常信息 "out of bounds memory access" 并返回 false
 bool invoke(Module *m, uint32_t fidx);
 
 // 计算初始化表达式
@@ -22,4 +71,11 @@ bool invoke(Module *m, uint32_t fidx);
 // 参数 *pc 为初始化表达式的字节码部分的【起始地址】
 void run_init_expr(Module *m, uint8_t type, uint32_t *pc);
 
+#if WASMC_PROFILE
+// 每种操作码被执行的次数（仅在构建时开启 WASMC_PROFILE 时统计）
+extern uint64_t opcode_profile[OPCODE_COUNT];
+// 每对相邻指令被连续执行的次数（仅在构建时开启 WASMC_PROFILE 时统计）
+extern uint64_t opcode_pair_profile[OPCODE_COUNT][OPCODE_COUNT];
+#endif
+
 #endif
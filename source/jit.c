@@ -0,0 +1,863 @@
+#include "jit.h"
+#include "interpreter.h"
+#include "memory.h"
+#include "module.h"
+#include "opcode.h"
+#include "regvm.h"
+#include "utils.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * JIT 编译的背景知识：
+ * 寄存器虚拟机虽然省去了大部分操作数栈的读写，但每条指令仍然需要一次取指和分派，且操作数的槽位编号需要在运行时从指令中读取
+ * 而 JIT（just-in-time）编译会在加载模块时直接将每个函数编译成机器码，槽位编号被编码为机器指令中的内存偏移量，
+ * 例如寄存器指令 i32.add c, a, b 会被编译成如下三条 x86-64 指令（rbx 保存当前栈帧的操作数栈底 fp）：
+ * mov eax, [rbx + a * sizeof(StackValue)]
+ * add eax, [rbx + b * sizeof(StackValue)]
+ * mov [rbx + c * sizeof(StackValue)], eax
+ *
+ * 这里实现的是最简单的模板式（template）基线编译器：逐条遍历函数的寄存器指令流，为每条指令拼接一段固定的机器码模板，
+ * 不做寄存器分配等任何优化，所有操作数仍然保存在操作数栈的槽位中，所以编译速度很快，且栈帧布局与寄存器虚拟机完全一致
+ *
+ * 对于不常见或者实现起来较复杂的指令（例如浮点数转换、整数除法、间接调用等），不会为其生成机器码模板，
+ * 而是为该指令生成一段只包含该指令和 RExit 指令的寄存器指令流，在机器码中调用 reg_execute 借助寄存器虚拟机执行
+ *
+ * 生成的机器码遵循 System V AMD64 调用约定，函数签名为 JitFunction，运行时寄存器的用途如下：
+ * rbx：当前栈帧的操作数栈底 fp
+ * r12：模块 m
+ * rax/rcx/rdx/xmm0：临时寄存器
+ * */
+
+#if WASMC_JIT
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// x86-64 通用寄存器编号
+typedef enum {
+    RAX = 0,
+    RCX = 1,
+    RDX = 2,
+    RBX = 3,
+    RSP = 4,
+    RSI = 6,
+    RDI = 7,
+    R12 = 12,
+    R13 = 13,
+} Register;
+
+// 用到的 x86-64 指令的操作码，大于 0xFF 的操作码的高字节为 0x0F 转义字节
+typedef enum {
+    X86_ADD_STORE = 0x01,// add r/m, r
+    X86_OR = 0x0B,       // or r, r/m
+    X86_AND = 0x23,      // and r, r/m
+    X86_SUB = 0x2B,      // sub r, r/m
+    X86_XOR = 0x33,      // xor r, r/m
+    X86_CMP = 0x3B,      // cmp r, r/m
+    X86_ADD = 0x03,      // add r, r/m
+    X86_MOVSXD = 0x63,   // movsxd r64, r/m32
+    X86_GROUP1 = 0x83,   // add/or/.../cmp r/m, imm8（由 ModRM 的 reg 字段区分，其中 7 为 cmp）
+    X86_TEST8 = 0x84,    // test r/m8, r8
+    X86_TEST = 0x85,     // test r/m, r
+    X86_STORE8 = 0x88,   // mov r/m8, r8
+    X86_STORE = 0x89,    // mov r/m, r
+    X86_LOAD = 0x8B,     // mov r, r/m
+    X86_STORE_IMM8 = 0xC6,// mov r/m8, imm8
+    X86_SHIFT = 0xD3,    // rol/ror/shl/shr/sar r/m, cl（由 ModRM 的 reg 字段区分）
+    X86_GROUP5 = 0xFF,   // call/jmp r/m（由 ModRM 的 reg 字段区分，其中 2 为 call，4 为 jmp）
+    X86_MOVS_LOAD = 0x0F10, // movss/movsd xmm, m
+    X86_MOVS_STORE = 0x0F11,// movss/movsd m, xmm
+    X86_CMOVE = 0x0F44,  // cmove r, r/m
+    X86_ADDS = 0x0F58,   // addss/addsd xmm, m
+    X86_MULS = 0x0F59,   // mulss/mulsd xmm, m
+    X86_SUBS = 0x0F5C,   // subss/subsd xmm, m
+    X86_DIVS = 0x0F5E,   // divss/divsd xmm, m
+    X86_JCC = 0x0F80,    // jcc rel32（低 4 位为条件码）
+    X86_SETCC = 0x0F90,  // setcc r/m8（低 4 位为条件码）
+    X86_IMUL = 0x0FAF,   // imul r, r/m
+    X86_MOVZX8 = 0x0FB6, // movzx r, r/m8
+    X86_MOVZX16 = 0x0FB7,// movzx r, r/m16
+    X86_MOVSX8 = 0x0FBE, // movsx r, r/m8
+    X86_MOVSX16 = 0x0FBF,// movsx r, r/m16
+    X86_JMP = 0xE9,      // jmp rel32
+} X86Opcode;
+
+// x86-64 条件码
+typedef enum {
+    CC_B = 0x2, // 无符号小于
+    CC_AE = 0x3,// 无符号大于等于
+    CC_E = 0x4, // 等于
+    CC_NE = 0x5,// 不等于
+    CC_BE = 0x6,// 无符号小于等于
+    CC_A = 0x7, // 无符号大于
+    CC_L = 0xC, // 有符号小于
+    CC_GE = 0xD,// 有符号大于等于
+    CC_LE = 0xE,// 有符号小于等于
+    CC_G = 0xF, // 有符号大于
+} Condition;
+
+// 整数比较指令对应的条件码，下标为操作码相对于 I32Eq（或者 I64Eq）的偏移量
+static const uint8_t compare_conditions[] = {CC_E, CC_NE, CC_L, CC_B, CC_G, CC_A, CC_LE, CC_BE, CC_GE, CC_AE};
+
+// 槽位 n 的值/值类型相对于栈帧操作数栈底的偏移量
+#define VALUE(n) ((int32_t) ((n) * sizeof(StackValue) + offsetof(StackValue, value)))
+#define SLOT(n) ((int32_t) ((n) * sizeof(StackValue)))
+
+// 需要在函数的机器码全部生成后回填的位置
+typedef struct Fixup {
+    uint32_t pos;   // 需要回填的 32 位偏移量在机器码中的位置
+    uint32_t target;// 跳转的目标标签（寄存器指令的地址），或者 br_table 指令的地址
+} Fixup;
+
+// 编译过程中的状态
+typedef struct Compiler {
+    Module *m;
+
+    uint8_t *code;    // 所有函数的机器码
+    uint32_t size;    // 机器码的字节数
+    uint32_t capacity;// 机器码的容量
+
+    // 每条寄存器指令对应的机器码在 code 中的位置，另外最后两个标签分别为函数的异常出口和正常出口
+    uint32_t *labels;
+    uint32_t fail;// 异常出口标签，返回 false
+    uint32_t exit;// 正常出口标签，返回 eax 中保存的结果
+
+    Fixup *jumps;         // 所有跳转指令的 rel32 偏移量
+    uint32_t jump_count;  // 跳转指令的数量
+    uint32_t jump_capacity;
+    Fixup *tables;        // 所有 br_table 指令中 lea 指令的 rel32 偏移量
+    uint32_t table_count; // br_table 指令的数量
+    uint32_t table_capacity;
+
+    Block **loops;        // 所有 loop 类型的控制块，用于在机器码全部生成后设置其 OSR 入口
+    uint32_t *osr_entries;// 每个 loop 对应的 OSR 入口在 code 中的位置
+    uint32_t loop_count;  // loop 的数量
+    uint32_t loop_capacity;
+
+    // 借助寄存器虚拟机执行的指令的寄存器指令流，每段 2 项（该指令本身和 RExit 指令），
+    // 与机器码一起拷贝到可执行内存中，从而随可执行内存一同释放
+    RInstr *stubs;
+    uint32_t *stub_refs;  // 每段指令流的地址（64 位立即数）在 code 中的位置，拷贝到可执行内存后回填
+    uint32_t stub_count;  // 指令流的段数
+    uint32_t stub_capacity;
+} Compiler;
+
+// 发射 1 字节的机器码
+static void emit_byte(Compiler *c, uint8_t v) {
+    if (c->size == c->capacity) {
+        uint32_t capacity = c->capacity ? c->capacity * 2 : 4096;
+        c->code = arecalloc(c->code, c->capacity, capacity, sizeof(uint8_t), "Compiler->code");
+        c->capacity = capacity;
+    }
+    c->code[c->size++] = v;
+}
+
+// 以小端序发射 4 字节的立即数
+static void emit_u32(Compiler *c, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        emit_byte(c, (uint8_t) (v >> (i * 8)));
+    }
+}
+
+// 以小端序发射 8 字节的立即数
+static void emit_u64(Compiler *c, uint64_t v) {
+    emit_u32(c, (uint32_t) v);
+    emit_u32(c, (uint32_t) (v >> 32));
+}
+
+// 以小端序回填 4 字节的偏移量
+static void patch_u32(Compiler *c, uint32_t pos, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        c->code[pos + i] = (uint8_t) (v >> (i * 8));
+    }
+}
+
+// 发射前缀、REX 前缀以及操作码，其中 reg 和 rm 为 ModRM 中 reg 和 r/m 字段对应的寄存器编号，w 表示是否为 64 位操作数
+static void emit_opcode(Compiler *c, uint8_t prefix, uint16_t opcode, bool w, int reg, int rm) {
+    uint8_t rex = 0x40 | (w << 3) | ((reg >> 3) << 2) | (rm >> 3);
+
+    if (prefix) {
+        emit_byte(c, prefix);
+    }
+    if (rex != 0x40) {
+        emit_byte(c, rex);
+    }
+    if (opcode > 0xFF) {
+        emit_byte(c, opcode >> 8);
+    }
+    emit_byte(c, opcode & 0xFF);
+}
+
+// 发射操作数为寄存器 reg 和内存 [base + disp] 的指令
+static void emit_mem(Compiler *c, uint8_t prefix, uint16_t opcode, bool w, int reg, int base, int32_t disp) {
+    emit_opcode(c, prefix, opcode, w, reg, base);
+    // ModRM 的 mod 字段为 10，即使用 32 位偏移量
+    emit_byte(c, 0x80 | ((reg & 7) << 3) | (base & 7));
+    // 基址寄存器为 rsp/r12 时，需要额外的 SIB 字节
+    if ((base & 7) == RSP) {
+        emit_byte(c, 0x24);
+    }
+    emit_u32(c, (uint32_t) disp);
+}
+
+// 发射操作数为寄存器 reg 和寄存器 rm 的指令
+static void emit_reg(Compiler *c, uint8_t prefix, uint16_t opcode, bool w, int reg, int rm) {
+    emit_opcode(c, prefix, opcode, w, reg, rm);
+    emit_byte(c, 0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+// 发射跳转到标签 target 的跳转指令（jmp 或者 jcc），偏移量在函数的机器码全部生成后回填
+static void emit_jump(Compiler *c, uint16_t opcode, uint32_t target) {
+    emit_opcode(c, 0, opcode, false, 0, 0);
+
+    if (c->jump_count == c->jump_capacity) {
+        uint32_t capacity = c->jump_capacity ? c->jump_capacity * 2 : 64;
+        c->jumps = arecalloc(c->jumps, c->jump_capacity, capacity, sizeof(Fixup), "Compiler->jumps");
+        c->jump_capacity = capacity;
+    }
+    c->jumps[c->jump_count++] = (Fixup){c->size, target};
+    emit_u32(c, 0);
+}
+
+// 发射调用 C 函数 fn 的指令，参数需要提前按照调用约定保存到 rdi/rsi/rdx 中
+// 注：机器码和 C 函数之间的距离可能超过 32 位偏移量的范围，所以先将函数地址保存到 rax 中再间接调用
+static void emit_call(Compiler *c, void *fn) {
+    emit_opcode(c, 0, 0xB8 + RAX, true, 0, 0);
+    emit_u64(c, (uint64_t) (uintptr_t) fn);
+    emit_reg(c, 0, X86_GROUP5, false, 2, RAX);
+}
+
+// 发射检查 C 函数返回值的指令，如果返回值为 false，则跳转到异常出口
+// 注：按照调用约定，bool 类型的返回值只保证 al 有效
+static void emit_check(Compiler *c) {
+    emit_reg(c, 0, X86_TEST8, false, RAX, RAX);
+    emit_jump(c, X86_JCC | CC_E, c->fail);
+}
+
+// 发射将 32 位立即数保存到寄存器 reg 的指令
+static void emit_mov_imm32(Compiler *c, int reg, uint32_t imm) {
+    emit_opcode(c, 0, 0xB8 + (reg & 7), false, 0, reg);
+    emit_u32(c, imm);
+}
+
+// 发射设置槽位 n 的值类型标记的指令（使用不带类型标记的槽位时为空操作）
+static void emit_tag(Compiler *c, uint32_t n, uint8_t type) {
+#if WASMC_UNTAGGED_SLOTS
+    (void) c;
+    (void) n;
+    (void) type;
+#else
+    emit_mem(c, 0, X86_STORE_IMM8, false, 0, RBX, SLOT(n) + (int32_t) offsetof(StackValue, value_type));
+    emit_byte(c, type);
+#endif
+}
+
+// 发射将槽位 [src_base + SLOT(src)] 整体（包含值类型标记）拷贝到槽位 [dst_base + SLOT(dst)] 的指令
+static void emit_copy(Compiler *c, int dst_base, uint32_t dst, int src_base, uint32_t src) {
+    for (int32_t i = 0; i < (int32_t) sizeof(StackValue); i += 8) {
+        emit_mem(c, 0, X86_LOAD, true, RAX, src_base, SLOT(src) + i);
+        emit_mem(c, 0, X86_STORE, true, RAX, dst_base, SLOT(dst) + i);
+    }
+}
+
+// 发射计算实际内存地址的指令，计算完成后 rcx 保存 m->memory.bytes 与源操作数 a 之和，返回值为需要再加上的内存偏移量
+// 注：与寄存器虚拟机一致，无需校验实际内存地址是否越界，越界访问会落在线性内存的保护页中
+static int32_t emit_address(Compiler *c, RInstr *ins) {
+    emit_mem(c, 0, X86_LOAD, false, RAX, RBX, VALUE(ins->a));
+    emit_mem(c, 0, X86_LOAD, true, RCX, R12, (int32_t) offsetof(Module, memory.bytes));
+    emit_reg(c, 0, X86_ADD_STORE, true, RAX, RCX);
+
+    // 内存偏移量超出 32 位有符号偏移量的范围时，需要先将其加到 rcx 中
+    if (ins->imm.uint32 > INT32_MAX) {
+        emit_mov_imm32(c, RDX, ins->imm.uint32);
+        emit_reg(c, 0, X86_ADD_STORE, true, RDX, RCX);
+        return 0;
+    }
+    return (int32_t) ins->imm.uint32;
+}
+
+// 由机器码调用：调用索引为 fidx 的函数，函数参数已经位于槽位 top 之前的槽位中
+static bool jit_call(Module *m, uint32_t fidx, uint32_t top) {
+    // 如果调用栈溢出，则记录异常信息并返回 false
+    if (m->csp >= CALLSTACK_SIZE - 1) {
+        sprintf(exception, "call stack exhausted");
+        return false;
+    }
+    m->sp = m->fp + (int) top - 1;
+    return invoke(m, fidx);
+}
+
+// 由机器码调用：将返回值所在的槽位 top 设置为操作数栈顶，由 pop_block 拷贝到调用方的操作数栈顶，并弹出当前函数的栈帧
+static bool jit_return(Module *m, uint32_t top) {
+    m->sp = m->fp + (int) top;
+    return pop_block(m) != NULL;
+}
+
+// 为指令 ins 生成借助寄存器虚拟机执行的机器码
+static void compile_fallback(Compiler *c, RInstr *ins) {
+    // 该指令的寄存器指令流只包含该指令本身和 RExit 指令，执行完该指令后立即退出寄存器虚拟机
+    if (c->stub_count == c->stub_capacity) {
+        uint32_t capacity = c->stub_capacity ? c->stub_capacity * 2 : 64;
+        c->stubs = arecalloc(c->stubs, c->stub_capacity * 2, capacity * 2, sizeof(RInstr), "Compiler->stubs");
+        c->stub_refs = arecalloc(c->stub_refs, c->stub_capacity, capacity, sizeof(uint32_t), "Compiler->stub_refs");
+        c->stub_capacity = capacity;
+    }
+    c->stubs[c->stub_count * 2] = *ins;
+    c->stubs[c->stub_count * 2 + 1].opcode = RExit;
+
+    // 指令流的地址在可执行内存分配好之后才能确定，先写入 0，之后回填
+    emit_reg(c, 0, X86_STORE, true, R12, RDI);
+    emit_opcode(c, 0, 0xB8 + (RSI & 7), true, 0, RSI);
+    c->stub_refs[c->stub_count++] = c->size;
+    emit_u64(c, 0);
+    emit_call(c, (void *) reg_execute);
+    emit_check(c);
+}
+
+// 为寄存器指令流 code 中地址为 idx 的指令生成机器码
+static void compile_instr(Compiler *c, RInstr *code, uint32_t idx) {
+    RInstr *ins = &code[idx];
+    uint16_t opcode = ins->opcode;
+    bool w;
+
+    // 生成的内存访问指令依赖线性内存的保护页，且 memory.size 只会写入 32 位的结果，
+    // 使用其他越界检查方式或者 64 位内存时借助寄存器虚拟机执行（见 memory.c）
+    bool memory_op = opcode >= I32Load && (opcode <= I64Store32 || (c->m->memory.memory64 && opcode <= MemoryGrow));
+    if (memory_op && !MEMORY_GUARDED(c->m->memory)) {
+        compile_fallback(c, ins);
+        return;
+    }
+
+    switch (opcode) {
+        /*
+         * 控制指令
+         * */
+        case Br:
+            emit_jump(c, X86_JMP, ins->imm.uint32);
+            break;
+        case BrIf:
+        case RBrUnless:
+            // cmp dword [a], 0; jne/je target
+            emit_mem(c, 0, X86_GROUP1, false, 7, RBX, VALUE(ins->a));
+            emit_byte(c, 0);
+            emit_jump(c, X86_JCC | (opcode == BrIf ? CC_NE : CC_E), ins->imm.uint32);
+            break;
+        case BrTable: {
+            // 将槽位 a 的值限制在跳转表大小 b 以内（超出时使用跳转表的最后一项，即默认地址）
+            emit_mem(c, 0, X86_LOAD, false, RAX, RBX, VALUE(ins->a));
+            emit_byte(c, 0x3D);// cmp eax, imm32
+            emit_u32(c, ins->b);
+            emit_byte(c, 0x76);// jbe rel8，跳过下面 5 字节的 mov eax, imm32
+            emit_byte(c, 5);
+            emit_mov_imm32(c, RAX, ins->b);
+
+            // lea rcx, [rip + table]，跳转表在函数的机器码全部生成后追加到函数末尾，偏移量在那时回填
+            emit_opcode(c, 0, 0x8D, true, RCX, 0);
+            emit_byte(c, 0x0D);
+            if (c->table_count == c->table_capacity) {
+                uint32_t capacity = c->table_capacity ? c->table_capacity * 2 : 16;
+                c->tables = arecalloc(c->tables, c->table_capacity, capacity, sizeof(Fixup), "Compiler->tables");
+                c->table_capacity = capacity;
+            }
+            c->tables[c->table_count++] = (Fixup){c->size, idx};
+            emit_u32(c, 0);
+
+            // 跳转表中每一项为目标地址相对于跳转表的偏移量：movsxd rax, [rcx + rax * 4]; add rax, rcx; jmp rax
+            emit_opcode(c, 0, X86_MOVSXD, true, RAX, 0);
+            emit_byte(c, 0x04);
+            emit_byte(c, 0x81);
+            emit_reg(c, 0, X86_ADD_STORE, true, RCX, RAX);
+            emit_reg(c, 0, X86_GROUP5, false, 4, RAX);
+            break;
+        }
+        case Return:
+            emit_reg(c, 0, X86_STORE, true, R12, RDI);
+            emit_mov_imm32(c, RSI, ins->a);
+            emit_call(c, (void *) jit_return);
+            emit_jump(c, X86_JMP, c->exit);
+            break;
+        case Call:
+            emit_reg(c, 0, X86_STORE, true, R12, RDI);
+            emit_mov_imm32(c, RSI, ins->a);
+            emit_mov_imm32(c, RDX, ins->b);
+            emit_call(c, (void *) jit_call);
+            emit_check(c);
+            break;
+        case ReturnCall:
+        case ReturnCallIndirect:
+            // 尾调用：由 jit_tail_call 复用当前栈帧并返回被调用函数的机器码入口，
+            // 恢复被调用者保存的寄存器后以 (m, fp) 为参数直接跳转过去，这样尾递归不会增加宿主的调用栈深度
+            emit_reg(c, 0, X86_STORE, true, R12, RDI);
+            emit_opcode(c, 0, 0xB8 + (RSI & 7), true, 0, RSI);
+            emit_u64(c, (uint64_t) (uintptr_t) ins);
+            emit_call(c, (void *) jit_tail_call);
+            emit_reg(c, 0, X86_STORE, true, R12, RDI);
+            emit_reg(c, 0, X86_STORE, true, RBX, RSI);
+            emit_opcode(c, 0, 0x58 + (R13 & 7), false, 0, R13);
+            emit_opcode(c, 0, 0x58 + (R12 & 7), false, 0, R12);
+            emit_byte(c, 0x58 + RBX);
+            emit_reg(c, 0, X86_GROUP5, false, 4, RAX);
+            break;
+
+        /*
+         * 参数指令
+         * */
+        case Select:
+            // 如果槽位 imm 的值为 0，则选择槽位 b 的值，否则选择槽位 a 的值（通过 cmove 实现，没有分支）
+            emit_mem(c, 0, X86_LOAD, false, RCX, RBX, VALUE(ins->imm.uint32));
+            emit_reg(c, 0, X86_TEST, false, RCX, RCX);
+            for (int32_t i = 0; i < (int32_t) sizeof(StackValue); i += 8) {
+                emit_mem(c, 0, X86_LOAD, true, RAX, RBX, SLOT(ins->a) + i);
+                emit_mem(c, 0, X86_LOAD, true, RDX, RBX, SLOT(ins->b) + i);
+                emit_reg(c, 0, X86_CMOVE, true, RAX, RDX);
+                emit_mem(c, 0, X86_STORE, true, RAX, RBX, SLOT(ins->d) + i);
+            }
+            break;
+
+        /*
+         * 变量指令
+         * */
+        case RMove:
+            emit_copy(c, RBX, ins->d, RBX, ins->a);
+            break;
+        case GlobalGet:
+            emit_mem(c, 0, X86_LOAD, true, RDX, R12, (int32_t) offsetof(Module, globals));
+            emit_copy(c, RBX, ins->d, RDX, ins->a);
+            break;
+        case GlobalSet:
+            emit_mem(c, 0, X86_LOAD, true, RDX, R12, (int32_t) offsetof(Module, globals));
+            emit_copy(c, RDX, ins->a, RBX, ins->b);
+            break;
+
+        /*
+         * 内存指令
+         * */
+        case I32Load ... I64Load32U: {
+            // 加载指令对应的 x86 操作码、是否为 64 位操作数以及结果的值类型
+            static const struct {
+                uint16_t opcode;
+                bool w;
+                uint8_t type;
+            } loads[] = {
+                    [I32Load - I32Load] = {X86_LOAD, false, I32},
+                    [I64Load - I32Load] = {X86_LOAD, true, I64},
+                    [F32Load - I32Load] = {X86_LOAD, false, F32},
+                    [F64Load - I32Load] = {X86_LOAD, true, F64},
+                    [I32Load8S - I32Load] = {X86_MOVSX8, false, I32},
+                    [I32Load8U - I32Load] = {X86_MOVZX8, false, I32},
+                    [I32Load16S - I32Load] = {X86_MOVSX16, false, I32},
+                    [I32Load16U - I32Load] = {X86_MOVZX16, false, I32},
+                    [I64Load8S - I32Load] = {X86_MOVSX8, true, I64},
+                    [I64Load8U - I32Load] = {X86_MOVZX8, false, I64},
+                    [I64Load16S - I32Load] = {X86_MOVSX16, true, I64},
+                    [I64Load16U - I32Load] = {X86_MOVZX16, false, I64},
+                    [I64Load32S - I32Load] = {X86_MOVSXD, true, I64},
+                    [I64Load32U - I32Load] = {X86_LOAD, false, I64},
+            };
+            int32_t disp = emit_address(c, ins);
+            // 与寄存器虚拟机一致，加载的值不足 8 字节时高位补 0（32 位操作数的指令会自动将 rax 的高 32 位清零）
+            emit_mem(c, 0, loads[opcode - I32Load].opcode, loads[opcode - I32Load].w, RAX, RCX, disp);
+            emit_mem(c, 0, X86_STORE, true, RAX, RBX, VALUE(ins->d));
+            emit_tag(c, ins->d, loads[opcode - I32Load].type);
+            break;
+        }
+        case I32Store ... I64Store32: {
+            int32_t disp = emit_address(c, ins);
+            emit_mem(c, 0, X86_LOAD, true, RAX, RBX, VALUE(ins->b));
+            switch (opcode) {
+                case I64Store:
+                case F64Store:
+                    emit_mem(c, 0, X86_STORE, true, RAX, RCX, disp);
+                    break;
+                case I32Store:
+                case F32Store:
+                case I64Store32:
+                    emit_mem(c, 0, X86_STORE, false, RAX, RCX, disp);
+                    break;
+                case I32Store16:
+                case I64Store16:
+                    emit_mem(c, 0x66, X86_STORE, false, RAX, RCX, disp);
+                    break;
+                default:
+                    emit_mem(c, 0, X86_STORE8, false, RAX, RCX, disp);
+                    break;
+            }
+            break;
+        }
+        case MemorySize:
+            emit_mem(c, 0, X86_LOAD, false, RAX, R12, (int32_t) offsetof(Module, memory.cur_size));
+            emit_mem(c, 0, X86_STORE, false, RAX, RBX, VALUE(ins->d));
+            emit_tag(c, ins->d, I32);
+            break;
+
+        /*
+         * 数值指令--常量指令
+         * */
+        case I32Const ... F64Const: {
+            static const uint8_t types[] = {I32, I64, F32, F64};
+            emit_opcode(c, 0, 0xB8 + RAX, true, 0, 0);
+            emit_u64(c, ins->imm.uint64);
+            emit_mem(c, 0, X86_STORE, true, RAX, RBX, VALUE(ins->d));
+            emit_tag(c, ins->d, types[opcode - I32Const]);
+            break;
+        }
+
+        /*
+         * 数值指令--测试指令和比较指令
+         * */
+        case I32Eqz:
+        case I64Eqz:
+            // cmp [a], 0; sete al; movzx eax, al
+            emit_mem(c, 0, X86_GROUP1, opcode == I64Eqz, 7, RBX, VALUE(ins->a));
+            emit_byte(c, 0);
+            emit_reg(c, 0, X86_SETCC | CC_E, false, 0, RAX);
+            emit_reg(c, 0, X86_MOVZX8, false, RAX, RAX);
+            emit_mem(c, 0, X86_STORE, false, RAX, RBX, VALUE(ins->d));
+            emit_tag(c, ins->d, I32);
+            break;
+        case I32Eq ... I32GeU:
+        case I64Eq ... I64GeU:
+            // mov rax, [a]; cmp rax, [b]; setcc al; movzx eax, al
+            w = opcode >= I64Eq;
+            emit_mem(c, 0, X86_LOAD, w, RAX, RBX, VALUE(ins->a));
+            emit_mem(c, 0, X86_CMP, w, RAX, RBX, VALUE(ins->b));
+            emit_reg(c, 0, X86_SETCC | compare_conditions[opcode - (w ? I64Eq : I32Eq)], false, 0, RAX);
+            emit_reg(c, 0, X86_MOVZX8, false, RAX, RAX);
+            emit_mem(c, 0, X86_STORE, false, RAX, RBX, VALUE(ins->d));
+            emit_tag(c, ins->d, I32);
+            break;
+
+        /*
+         * 数值指令--算术指令
+         * */
+        case I32Add:
+        case I32Sub:
+        case I32Mul:
+        case I32And:
+        case I32Or:
+        case I32Xor:
+        case I64Add:
+        case I64Sub:
+        case I64Mul:
+        case I64And:
+        case I64Or:
+        case I64Xor: {
+            uint16_t op;
+            switch (opcode) {
+                case I32Add:
+                case I64Add:
+                    op = X86_ADD;
+                    break;
+                case I32Sub:
+                case I64Sub:
+                    op = X86_SUB;
+                    break;
+                case I32Mul:
+                case I64Mul:
+                    op = X86_IMUL;
+                    break;
+                case I32And:
+                case I64And:
+                    op = X86_AND;
+                    break;
+                case I32Or:
+                case I64Or:
+                    op = X86_OR;
+                    break;
+                default:
+                    op = X86_XOR;
+                    break;
+            }
+            // mov rax, [a]; op rax, [b]; mov [d], rax
+            w = opcode >= I64Clz;
+            emit_mem(c, 0, X86_LOAD, w, RAX, RBX, VALUE(ins->a));
+            emit_mem(c, 0, op, w, RAX, RBX, VALUE(ins->b));
+            emit_mem(c, 0, X86_STORE, w, RAX, RBX, VALUE(ins->d));
+            emit_tag(c, ins->d, w ? I64 : I32);
+            break;
+        }
+        case I32Shl ... I32Rotr:
+        case I64Shl ... I64Rotr: {
+            // 移位指令对应的 ModRM reg 字段，下标为操作码相对于 I32Shl（或者 I64Shl）的偏移量
+            // 注：x86 的移位指令会将移位次数按照操作数位数取模，与 Wasm 的语义一致
+            static const uint8_t shifts[] = {4, 7, 5, 0, 1};
+            w = opcode >= I64Clz;
+            emit_mem(c, 0, X86_LOAD, false, RCX, RBX, VALUE(ins->b));
+            emit_mem(c, 0, X86_LOAD, w, RAX, RBX, VALUE(ins->a));
+            emit_reg(c, 0, X86_SHIFT, w, shifts[opcode - (w ? I64Shl : I32Shl)], RAX);
+            emit_mem(c, 0, X86_STORE, w, RAX, RBX, VALUE(ins->d));
+            emit_tag(c, ins->d, w ? I64 : I32);
+            break;
+        }
+        case F32Add:
+        case F32Sub:
+        case F32Mul:
+        case F32Div:
+        case F64Add:
+        case F64Sub:
+        case F64Mul:
+        case F64Div: {
+            // movss/movsd xmm0, [a]; op xmm0, [b]; movss/movsd [d], xmm0
+            uint8_t prefix = opcode >= F64Abs ? 0xF2 : 0xF3;
+            uint16_t op;
+            switch (opcode) {
+                case F32Add:
+                case F64Add:
+                    op = X86_ADDS;
+                    break;
+                case F32Sub:
+                case F64Sub:
+                    op = X86_SUBS;
+                    break;
+                case F32Mul:
+                case F64Mul:
+                    op = X86_MULS;
+                    break;
+                default:
+                    op = X86_DIVS;
+                    break;
+            }
+            emit_mem(c, prefix, X86_MOVS_LOAD, false, 0, RBX, VALUE(ins->a));
+            emit_mem(c, prefix, op, false, 0, RBX, VALUE(ins->b));
+            emit_mem(c, prefix, X86_MOVS_STORE, false, 0, RBX, VALUE(ins->d));
+            emit_tag(c, ins->d, opcode >= F64Abs ? F64 : F32);
+            break;
+        }
+
+        /*
+         * 数值指令--类型转换指令
+         * */
+        case I32WrapI64:
+        case I32ReinterpretF32:
+        case F32ReinterpretI32:
+            emit_mem(c, 0, X86_LOAD, false, RAX, RBX, VALUE(ins->a));
+            emit_mem(c, 0, X86_STORE, false, RAX, RBX, VALUE(ins->d));
+            emit_tag(c, ins->d, opcode == F32ReinterpretI32 ? F32 : I32);
+            break;
+        case I64ReinterpretF64:
+        case F64ReinterpretI64:
+            emit_mem(c, 0, X86_LOAD, true, RAX, RBX, VALUE(ins->a));
+            emit_mem(c, 0, X86_STORE, true, RAX, RBX, VALUE(ins->d));
+            emit_tag(c, ins->d, opcode == F64ReinterpretI64 ? F64 : I64);
+            break;
+        case I64ExtendI32S:
+        case I64ExtendI32U:
+            emit_mem(c, 0, opcode == I64ExtendI32S ? X86_MOVSXD : X86_LOAD, opcode == I64ExtendI32S, RAX, RBX, VALUE(ins->a));
+            emit_mem(c, 0, X86_STORE, true, RAX, RBX, VALUE(ins->d));
+            emit_tag(c, ins->d, I64);
+            break;
+
+        default:
+            // 其余指令借助寄存器虚拟机执行
+            compile_fallback(c, ins);
+            break;
+    }
+}
+
+// 发射函数序言：保存被调用者保存的寄存器（压入 3 个寄存器后栈顶恰好按照 16 字节对齐，便于调用 C 函数），
+// 然后将 m 和 fp 分别保存到 r12 和 rbx 中
+static void emit_prologue(Compiler *c) {
+    emit_byte(c, 0x50 + RBX);
+    emit_opcode(c, 0, 0x50 + (R12 & 7), false, 0, R12);
+    emit_opcode(c, 0, 0x50 + (R13 & 7), false, 0, R13);
+    emit_reg(c, 0, X86_STORE, true, RSI, RBX);
+    emit_reg(c, 0, X86_STORE, true, RDI, R12);
+}
+
+// 将函数 func 的寄存器指令流编译成机器码，返回该函数的机器码在 c->code 中的起始位置
+static uint32_t compile_function(Compiler *c, Block *func) {
+    RInstr *code = func->rcode;
+    uint32_t count = func->rcode_count;
+    uint32_t entry = c->size;
+
+    c->labels = acalloc(count + 2, sizeof(uint32_t), "Compiler->labels");
+    c->fail = count;
+    c->exit = count + 1;
+    c->jump_count = 0;
+    c->table_count = 0;
+
+    // 函数序言
+    emit_prologue(c);
+
+    for (uint32_t i = 0; i < count; i++) {
+        c->labels[i] = c->size;
+        compile_instr(c, code, i);
+    }
+
+    // 异常出口：返回 false
+    c->labels[c->fail] = c->size;
+    emit_reg(c, 0, X86_XOR, false, RAX, RAX);
+
+    // 正常出口：恢复被调用者保存的寄存器后返回 eax 中保存的结果
+    c->labels[c->exit] = c->size;
+    emit_opcode(c, 0, 0x58 + (R13 & 7), false, 0, R13);
+    emit_opcode(c, 0, 0x58 + (R12 & 7), false, 0, R12);
+    emit_byte(c, 0x58 + RBX);
+    emit_byte(c, 0xC3);
+
+    // 将 br_table 指令的跳转表追加到函数末尾，跳转表中每一项为目标地址相对于跳转表的偏移量，并回填 lea 指令的偏移量
+    for (uint32_t i = 0; i < c->table_count; i++) {
+        RInstr *ins = &code[c->tables[i].target];
+        uint32_t table = c->size;
+        patch_u32(c, c->tables[i].pos, table - (c->tables[i].pos + 4));
+        for (uint32_t n = 0; n <= ins->b; n++) {
+            emit_u32(c, c->labels[ins->imm.table[n]] - table);
+        }
+    }
+
+    // 为函数中的每个 loop 生成 OSR 入口：与函数序言相同，之后直接跳转到循环开头对应的机器码
+    // 注：栈式解释器执行到循环的回边时，当前栈帧的布局与寄存器指令流在循环开头处的栈帧布局完全一致，所以无需任何转换
+    for (uint32_t pc = func->start_addr; pc <= func->end_addr; pc++) {
+        if (c->m->code[pc].opcode == Loop) {
+            if (c->loop_count == c->loop_capacity) {
+                uint32_t capacity = c->loop_capacity ? c->loop_capacity * 2 : 16;
+                c->loops = arecalloc(c->loops, c->loop_capacity, capacity, sizeof(Block *), "Compiler->loops");
+                c->osr_entries = arecalloc(c->osr_entries, c->loop_capacity, capacity, sizeof(uint32_t), "Compiler->osr_entries");
+                c->loop_capacity = capacity;
+            }
+            c->loops[c->loop_count] = c->m->code[pc].b.block;
+            c->osr_entries[c->loop_count++] = c->size;
+            emit_prologue(c);
+            emit_jump(c, X86_JMP, c->m->code[pc].b.block->osr_addr);
+        }
+    }
+
+    // 回填所有跳转指令的偏移量
+    for (uint32_t i = 0; i < c->jump_count; i++) {
+        patch_u32(c, c->jumps[i].pos, c->labels[c->jumps[i].target] - (c->jumps[i].pos + 4));
+    }
+
+    free(c->labels);
+    return entry;
+}
+
+// 将索引位于 [first, last) 之间且已被翻译成寄存器指令的函数编译成 x86-64 机器码，保存到函数的 jit_code 中
+static void compile_functions(Module *m, uint32_t first, uint32_t last) {
+    Compiler *c = acalloc(1, sizeof(Compiler), "Compiler");
+    uint32_t *entries = acalloc(m->function_count, sizeof(uint32_t), "jit entries");
+    c->m = m;
+
+    for (uint32_t f = first; f < last; f++) {
+        if (m->functions[f].rcode) {
+            entries[f] = compile_function(c, &m->functions[f]);
+        }
+    }
+
+    // 将所有函数的机器码拷贝到可执行内存中：先映射可读写的内存，拷贝完成后再改为可读可执行
+    // 可执行内存的布局：所有函数的机器码 | 寄存器指令流
+    if (c->size > 0) {
+        uint32_t stubs = (c->size + 15) & ~15u;
+        size_t page = (size_t) sysconf(_SC_PAGESIZE);
+        size_t size = (stubs + c->stub_count * 2 * sizeof(RInstr) + page - 1) / page * page;
+        uint8_t *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        // 映射失败时放弃 JIT 编译，所有函数继续由寄存器虚拟机执行
+        if (mem != MAP_FAILED) {
+            memcpy(mem, c->code, c->size);
+            if (c->stub_count > 0) {
+                memcpy(mem + stubs, c->stubs, c->stub_count * 2 * sizeof(RInstr));
+            }
+            for (uint32_t i = 0; i < c->stub_count; i++) {
+                uint64_t stub = (uint64_t) (uintptr_t) (mem + stubs + i * 2 * sizeof(RInstr));
+                memcpy(mem + c->stub_refs[i], &stub, sizeof(stub));
+            }
+            if (mprotect(mem, size, PROT_READ | PROT_EXEC) == 0) {
+                for (uint32_t f = first; f < last; f++) {
+                    if (m->functions[f].rcode) {
+                        m->functions[f].jit_code = mem + entries[f];
+                    }
+                }
+                for (uint32_t i = 0; i < c->loop_count; i++) {
+                    c->loops[i]->osr_code = mem + c->osr_entries[i];
+                }
+            } else {
+                munmap(mem, size);
+            }
+        }
+    }
+
+    free(entries);
+    free(c->code);
+    free(c->jumps);
+    free(c->tables);
+    free(c->loops);
+    free(c->osr_entries);
+    free(c->stubs);
+    free(c->stub_refs);
+    free(c);
+}
+
+// 将所有已被翻译成寄存器指令的函数编译成 x86-64 机器码，保存到函数的 jit_code 中
+void jit_compile(Module *m) {
+    compile_functions(m, m->import_func_count, m->function_count);
+}
+
+// 将已被翻译成寄存器指令的函数 func 编译成 x86-64 机器码，保存到函数的 jit_code 中
+void jit_compile_function(Module *m, Block *func) {
+    compile_functions(m, func->fidx, func->fidx + 1);
+}
+
+#else
+
+// 不支持 JIT 编译的平台上为空操作，函数继续由寄存器虚拟机执行
+void jit_compile(Module *m) {
+    (void) m;
+}
+
+void jit_compile_function(Module *m, Block *func) {
+    (void) m;
+    (void) func;
+}
+
+#endif
+
+// 执行函数 func 被 JIT 编译得到的机器码，函数返回时退出
+bool jit_run(Module *m, Block *func) {
+    // 如果栈帧所需的槽位超出了操作数栈的容量，则记录异常信息并返回 false
+    if (m->fp + func->slot_count >= STACK_SIZE) {
+        sprintf(exception, "call stack exhausted");
+        return false;
+    }
+
+    return ((JitFunction) func->jit_code)(m, &m->stack[m->fp]);
+}
+
+// 被调用函数已经执行完成（或者出现异常）时，由 jit_tail_call 返回给机器码的出口
+static bool tail_call_done(Module *m, StackValue *fp) {
+    (void) m;
+    (void) fp;
+    return true;
+}
+
+static bool tail_call_failed(Module *m, StackValue *fp) {
+    (void) m;
+    (void) fp;
+    return false;
+}
+
+JitFunction jit_tail_call(Module *m, RInstr *ins) {
+    Block *func = reg_tail_call(m, ins);
+    if (!func) {
+        return tail_call_failed;
+    }
+
+    // 被调用函数已被编译成机器码，则直接跳转过去复用当前栈帧
+    if (func->jit_code && m->fp + func->slot_count < STACK_SIZE) {
+        return (JitFunction) func->jit_code;
+    }
+
+    // 否则交给对应的执行层执行直到函数返回（栈帧所需的槽位超出操作数栈的容量时由 jit_run 记录异常信息）
+    bool result;
+    if (func->jit_code) {
+        result = jit_run(m, func);
+    } else if (func->rcode) {
+        result = reg_interpret(m, func);
+    } else {
+        result = interpret(m);
+    }
+    return result ? tail_call_done : tail_call_failed;
+}
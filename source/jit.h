@@ -0,0 +1,33 @@
+#ifndef WASMC_JIT_H
+#define WASMC_JIT_H
+
+#include "module.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// 是否支持 JIT 编译，目前仅支持 Linux x86-64 平台，其他平台上 jit_compile 为空操作，函数继续由寄存器虚拟机执行
+#if defined(__x86_64__) && defined(__linux__)
+#define WASMC_JIT 1
+#else
+#define WASMC_JIT 0
+#endif
+
+// JIT 编译得到的机器码的函数签名，参数 fp 为当前栈帧的操作数栈底（即 &m->stack[m->fp]），返回值的含义与 invoke 一致
+typedef bool (*JitFunction)(Module *m, StackValue *fp);
+
+// 将所有已被翻译成寄存器指令的函数编译成 x86-64 机器码，保存到函数的 jit_code 中
+// 注：需要在 reg_translate 之后调用，未被翻译成寄存器指令的函数的 jit_code 保持为 NULL
+void jit_compile(Module *m);
+
+// 将已被翻译成寄存器指令的函数 func 编译成 x86-64 机器码，保存到函数的 jit_code 中（用于分层执行时只编译热点函数）
+void jit_compile_function(Module *m, Block *func);
+
+// 执行函数 func 被 JIT 编译得到的机器码，函数返回时退出
+// 注：调用前需要先通过 setup_call 建立该函数的栈帧
+bool jit_run(Module *m, Block *func);
+
+// 由机器码调用：执行尾调用指令 ins（见 reg_tail_call），被调用函数复用当前栈帧，返回之后需要以 (m, fp) 为参数跳转执行的函数：
+// 如果被调用函数已被编译成机器码，则返回其机器码入口；否则直接交给对应的执行层执行直到函数返回，再根据执行结果返回一个直接返回 true 或者 false 的函数
+JitFunction jit_tail_call(Module *m, RInstr *ins);
+
+#endif
@@ -0,0 +1,218 @@
+#define _GNU_SOURCE
+#include "memory.h"
+#include "module.h"
+#include "utils.h"
+#include <setjmp.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+ * 线性内存保护页的背景知识：
+ * 内存加载/存储指令的实际地址为 m->memory.bytes 加上 i32 类型的地址和 32 位内存偏移量，如果每次访问前都显式校验是否越界，
+ * 则每条内存访问指令都要多执行一次比较和分支，对于访存密集的程序大约会慢 10%~20%
+ *
+ * 由于 i32 类型的地址与 32 位内存偏移量之和不会超过 8 GiB，所以可以为线性内存预留 8 GiB 的虚拟地址空间，
+ * 只将其中前 cur_size 页设置为可读写，其余部分全部设置为不可访问（PROT_NONE），即保护页（guard page）
+ * 这样越界访问一定会落在保护页中，由操作系统产生 SIGSEGV 信号，而合法的访问不需要任何额外的校验
+ *
+ * 最外层的 invoke 通过 sigsetjmp 设置恢复点，SIGSEGV 信号处理函数确认访问违例的地址位于线性内存预留的地址空间中后，
+ * 通过 siglongjmp 直接返回到恢复点，由 invoke 记录异常信息 "out of bounds memory access" 并返回 false，
+ * 各执行层（栈式解释器、寄存器虚拟机、JIT/copy-and-patch 编译得到的机器码以及预编译模块）都无需做任何处理
+ *
+ * 注：预留的虚拟地址空间并不占用物理内存，只有被访问过的内存页才会由操作系统分配物理内存，且初始值为 0
+ *
+ * 但在 RLIMIT_AS 受限的环境中可能无法为每个实例预留 8 GiB 的虚拟地址空间，所以还可以通过 options.bounds 选择另外两种越界检查方式：
+ * 1. 显式检查：只为内存分配实际需要的空间，每次访问前比较实际地址加上访问的字节数是否超出内存的当前字节数，
+ *    对于以同一个局部变量为地址的多次访问，同一基本块中只在第一次访问时一并检查（仅栈式解释器，见 module.c 中的 coalesce_bounds_checks）
+ * 2. 掩码：为内存分配 2 的幂次个字节，每次访问时将实际地址与掩码按位与，只需一条与运算，且没有分支，
+ *    越界访问不会引发异常，而是落在为内存分配的空间中的其他位置，只能保证不会读写到宿主程序的内存
+ * JIT 和 copy-and-patch 执行层的机器码以及预编译模块都依赖保护页，使用其他方式时内存访问指令改由寄存器虚拟机执行
+ *
+ * 这两种方式下内存同样是匿名映射得到的，memory.grow 通过 mremap 扩展映射：内核优先原地扩展，无法原地扩展时也只是移动页表项，
+ * 不会像 realloc 那样拷贝整块内存，新增的内存页初始值为 0，也无需再清零
+ *
+ * 数据段的初始化数据同样可以借助映射避免拷贝：使用保护页时，将初始化数据中完整覆盖的内存页以 MAP_PRIVATE 的方式直接映射自模块文件，
+ * 实例化的开销只与之后实际访问的内存页数量有关，且未被写入的内存页由操作系统在多个实例之间共享（见 memory_init_data）
+ * 注：显式检查和掩码方式下 memory.grow 需要通过 mremap 扩展整个映射，而 mremap 要求被扩展的地址范围属于同一个映射，所以仍然拷贝初始化数据
+ * 注：MAP_PRIVATE 只对写入过的内存页做写时复制，尚未写入的内存页仍然反映模块文件的当前内容，
+ *    所以模块执行期间模块文件必须保持不变：文件被改写时这些内存页的内容会随之改变，文件被截断时访问这些内存页会产生 SIGBUS 信号，
+ *    信号处理函数不会将其当作越界访问，而是提示后终止进程
+ *
+ * 64 位内存（memory64 提案）的地址为 i64 类型，保护页无法覆盖 64 位的地址空间，所以无论 options.bounds 为何值都采用显式检查，
+ * 内存同样只映射实际需要的空间（见 MEMORY_GUARDED）
+ * */
+
+sigjmp_buf *memory_trap_point;
+Memory *memory_trap_memory;
+
+// SIGSEGV/SIGBUS 信号原来的处理方式，访问违例不是由 Wasm 函数越界访问引起时恢复原来的处理方式
+static struct sigaction prev_segv_action;
+static struct sigaction prev_bus_action;
+
+// 访问违例的信号处理函数
+static void memory_trap_handler(int sig, siginfo_t *info, void *context) {
+    (void) context;
+    uint8_t *addr = info->si_addr;
+    Memory *mem = memory_trap_memory;
+
+    // 正在执行 Wasm 函数，且访问违例的地址位于线性内存预留的地址空间中
+    if (memory_trap_point && mem && mem->reserved_size && addr >= mem->bytes && addr < mem->bytes + mem->reserved_size) {
+        // 访问保护页产生的是 SIGSEGV 信号，说明是越界访问，则返回到恢复点
+        if (sig == SIGSEGV) {
+            siglongjmp(*memory_trap_point, 1);
+        }
+
+        // 线性内存中只有映射自模块文件的数据段内存页会产生 SIGBUS 信号，说明模块文件在执行过程中被截断，
+        // 映射的内存页已经没有对应的文件内容，这不是 Wasm 程序的越界访问，所以不能作为异常返回，
+        // 输出提示信息后按照默认的方式处理（终止进程）
+        // 注：信号处理函数中只能调用异步信号安全的函数，所以使用 write 而不是 fprintf
+        static const char message[] = "wasmc: module file was truncated while its data segments were mapped into linear memory\n";
+        ssize_t written = write(STDERR_FILENO, message, sizeof(message) - 1);
+        (void) written;
+        signal(SIGBUS, SIG_DFL);
+        return;
+    }
+
+    // 否则恢复原来的处理方式，信号处理函数返回后会重新执行引起访问违例的指令，再次产生的信号按原来的方式处理（通常是终止进程）
+    sigaction(sig, sig == SIGSEGV ? &prev_segv_action : &prev_bus_action, NULL);
+}
+
+// 安装访问违例的信号处理函数（只需安装一次）
+static void install_trap_handler(void) {
+    static bool installed = false;
+    if (installed) {
+        return;
+    }
+    installed = true;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = memory_trap_handler;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGSEGV, &action, &prev_segv_action);
+    sigaction(SIGBUS, &action, &prev_bus_action);
+}
+
+// 越界检查方式为掩码时，可以容纳 pages 页内存的 2 的幂次（至少为 1 页）
+static uint64_t mask_capacity(uint32_t pages) {
+    uint64_t capacity = PAGE_SIZE;
+    while (capacity < (uint64_t) pages * PAGE_SIZE) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// 越界检查方式为显式检查或者掩码时，为当前页数 pages 的内存映射的字节数
+// 注：mmap 不能映射 0 个字节，所以显式检查时至少映射 1 页
+static uint64_t mapped_size(const Memory *mem, uint32_t pages) {
+    if (options.bounds == BoundsMask && !mem->memory64) {
+        return mask_capacity(pages) + MEMORY_MASK_SLACK;
+    }
+    return pages ? (uint64_t) pages * PAGE_SIZE : PAGE_SIZE;
+}
+
+void memory_init(Memory *mem) {
+    if (!MEMORY_GUARDED(*mem)) {
+        // 直接映射匿名内存而不是通过 calloc 分配，这样增长时可以通过 mremap 扩展映射，而无需拷贝已有的内容
+        uint64_t size = mapped_size(mem, mem->cur_size);
+        uint8_t *bytes = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (bytes == MAP_FAILED) {
+            FATAL("Could not allocate %llu bytes for Module->memory.bytes\n", (unsigned long long) size)
+        }
+        mem->bytes = bytes;
+        mem->mask = options.bounds == BoundsMask && !mem->memory64 ? mask_capacity(mem->cur_size) - 1 : 0;
+        mem->reserved_size = 0;
+        return;
+    }
+
+    // 预留不可访问的虚拟地址空间（MAP_NORESERVE 表示不为其预留交换空间）
+    uint8_t *bytes = mmap(NULL, MEMORY_RESERVE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (bytes == MAP_FAILED) {
+        FATAL("Could not reserve %llu bytes for Module->memory.bytes\n", MEMORY_RESERVE_SIZE)
+    }
+
+    // 将前 cur_size 页提交为可读写，匿名映射的内存页初始值为 0，无需再清零
+    if (mem->cur_size && mprotect(bytes, (size_t) mem->cur_size * PAGE_SIZE, PROT_READ | PROT_WRITE) != 0) {
+        FATAL("Could not commit %u pages for Module->memory.bytes\n", mem->cur_size)
+    }
+
+    mem->bytes = bytes;
+    mem->reserved_size = MEMORY_RESERVE_SIZE;
+    install_trap_handler();
+}
+
+bool memory_grow(Memory *mem, uint32_t delta) {
+    // 注：先转换为 64 位整数再相加，避免 delta 很大时溢出
+    if ((uint64_t) mem->cur_size + delta > mem->max_size) {
+        return false;
+    }
+    if (delta == 0) {
+        return true;
+    }
+
+    uint64_t old_bytes = MEMORY_BYTES(*mem);
+    uint64_t new_bytes = old_bytes + (uint64_t) delta * PAGE_SIZE;
+
+    if (MEMORY_GUARDED(*mem)) {
+        // 将紧随当前内存之后的 delta 页保护页原地提交为可读写，内存的地址保持不变
+        if (mprotect(mem->bytes + old_bytes, new_bytes - old_bytes, PROT_READ | PROT_WRITE) != 0) {
+            return false;
+        }
+        mem->cur_size += delta;
+        return true;
+    }
+
+    uint64_t old_size = mapped_size(mem, mem->cur_size);
+    uint64_t new_size = mapped_size(mem, mem->cur_size + delta);
+
+    // 掩码方式下越界写入的值可能已经落在当前字节数之后、映射的空间之内，这部分内存需要清零
+    // 注：MADV_DONTNEED 直接丢弃私有匿名映射中的内存页，之后再访问时由操作系统重新分配值为 0 的内存页，只需 O(delta) 的开销
+    if (mem->mask) {
+        uint64_t dirty_end = new_bytes < old_size ? new_bytes : old_size;
+        if (madvise(mem->bytes + old_bytes, dirty_end - old_bytes, MADV_DONTNEED) != 0) {
+            return false;
+        }
+    }
+
+    // 扩展映射：mremap 优先原地扩展，否则只移动页表项而不拷贝内存的内容，新增的内存页初始值为 0，无需再清零
+    if (new_size > old_size) {
+        uint8_t *bytes = mremap(mem->bytes, old_size, new_size, MREMAP_MAYMOVE);
+        if (bytes == MAP_FAILED) {
+            return false;
+        }
+        mem->bytes = bytes;
+    }
+
+    if (mem->mask) {
+        mem->mask = mask_capacity(mem->cur_size + delta) - 1;
+    }
+    mem->cur_size += delta;
+    return true;
+}
+
+void memory_init_data(Memory *mem, uint64_t offset, const uint8_t *bytes, uint32_t pos, uint32_t size) {
+    int fd = MEMORY_GUARDED(*mem) ? mmap_file_fd(bytes) : -1;
+    uint64_t host_page = (uint64_t) sysconf(_SC_PAGESIZE);
+    uint64_t end = offset + size;
+
+    // 只有内存偏移量与文件偏移量相对于宿主机内存页的对齐方式一致时，才能将文件中的内容映射到内存中，
+    // 映射的范围为初始化数据完整覆盖的宿主机内存页 [map_start, map_end)（均为内存偏移量）
+    uint64_t map_start = (offset + host_page - 1) / host_page * host_page;
+    uint64_t map_end = end / host_page * host_page;
+    if (fd < 0 || (offset - pos) % host_page != 0 || map_start >= map_end ||
+        mmap(mem->bytes + map_start, map_end - map_start, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd,
+             (off_t) (pos + (map_start - offset))) == MAP_FAILED) {
+        memcpy(mem->bytes + offset, bytes + pos, size);
+        return;
+    }
+
+    // 映射范围前后不足一页的部分仍然直接拷贝
+    memcpy(mem->bytes + offset, bytes + pos, map_start - offset);
+    memcpy(mem->bytes + map_end, bytes + pos + (map_end - offset), end - map_end);
+}
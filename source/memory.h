@@ -0,0 +1,60 @@
+#ifndef WASMC_MEMORY_H
+#define WASMC_MEMORY_H
+
+#include "module.h"
+#include "utils.h"
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// 为线性内存预留的虚拟地址空间的字节数：8 GiB 加上一页保护页
+// 注：内存访问的实际地址为 i32 类型的地址与 32 位内存偏移量之和再加上访问的字节数（最多 8 个字节），
+// 所以无论地址和内存偏移量取何值，实际地址都不会超出预留的地址空间
+#define MEMORY_RESERVE_SIZE ((1ULL << 33) + PAGE_SIZE)
+
+// 越界检查方式为掩码时，在为内存分配的空间（2 的幂次）之后额外多分配的字节数，保证掩码后的地址加上访问的字节数仍然落在分配的空间中
+#define MEMORY_MASK_SLACK 8
+
+// 线性内存 MEM 当前的字节数
+#define MEMORY_BYTES(MEM) ((uint64_t) (MEM).cur_size * PAGE_SIZE)
+
+// 线性内存 MEM 是否依赖保护页捕获越界访问（64 位内存无论 options.bounds 为何值都只能显式检查）
+#define MEMORY_GUARDED(MEM) (options.bounds == BoundsGuard && !(MEM).memory64)
+
+// 64 位内存的最大页数：页数以 32 位整数保存，已经远超宿主机实际可以映射的内存
+#define MEMORY64_MAX_PAGES UINT32_MAX
+
+// 越界访问时记录的异常信息
+#define MEMORY_OOB_MESSAGE "out of bounds memory access"
+
+// 64 位内存 mem 中，i64 类型的地址 addr 加上内存偏移量 offset 之后访问 size 个字节是否越界
+// 注：地址和内存偏移量都可以是任意的 64 位整数，所以依次与剩余的字节数比较，避免加法溢出
+static inline bool memory64_out_of_bounds(const Memory *mem, uint64_t addr, uint64_t offset, uint32_t size) {
+    uint64_t bytes = MEMORY_BYTES(*mem);
+    return offset > bytes || addr > bytes - offset || bytes - offset - addr < size;
+}
+
+// 最外层的 invoke 设置的越界访问陷阱的恢复点，为 NULL 表示当前不在执行 Wasm 函数
+extern sigjmp_buf *memory_trap_point;
+
+// 正在执行的 Wasm 函数所在模块的线性内存，信号处理函数据此判断访问违例是否由越界访问引起
+extern Memory *memory_trap_memory;
+
+// 根据越界检查方式（options.bounds）为线性内存 mem 分配空间，如果分配失败则报错退出：
+// 保护页：预留 MEMORY_RESERVE_SIZE 字节的不可访问（PROT_NONE）的虚拟地址空间，并将其中前 mem->cur_size 页提交为可读写，剩余部分作为保护页
+// 显式检查：只映射当前页数的匿名内存
+// 掩码：映射不小于当前字节数的 2 的幂次（再加上 MEMORY_MASK_SLACK）个字节的匿名内存，并设置 mem->mask
+void memory_init(Memory *mem);
+
+// 将线性内存 mem 增长 delta 页，新增的内存页初始值为 0，如果增长后超出内存的最大页数则返回 false
+// 增长的开销只与 delta 有关：使用保护页时原地提交内存页，其他方式下通过 mremap 扩展映射，都不会拷贝已有的内容
+// 注：只有使用保护页时内存的地址保持不变，其他方式下 mremap 可能会移动映射，mem->bytes 随之改变
+bool memory_grow(Memory *mem, uint32_t delta);
+
+// 用 Wasm 模块文件 bytes 中从 pos 开始的 size 个字节（数据段中的初始化数据）初始化线性内存 mem 中从 offset 开始的内存
+// 使用保护页且 bytes 是由 mmap_file 映射得到的时，初始化数据中完整覆盖的内存页直接以写时复制（MAP_PRIVATE）的方式映射自模块文件，
+// 只有被写入的内存页才会被复制，未被写入的内存页可以在多个实例之间共享，其余部分仍然通过 memcpy 拷贝
+// 注：调用前需要确认初始化数据完全落在内存的当前字节数之内
+void memory_init_data(Memory *mem, uint64_t offset, const uint8_t *bytes, uint32_t pos, uint32_t size);
+
+#endif
@@ -1,6 +1,10 @@
 #include "module.h"
+#include "copypatch.h"
 #include "interpreter.h"
+#include "jit.h"
+#include "memory.h"
 #include "opcode.h"
+#include "regvm.h"
 #include "utils.h"
 #include <math.h>
 #include <stdbool.h>
@@ -24,10 +28,10 @@ void skip_immediate(const uint8_t *bytes, uint32_t *pos) {
         case Block_:
         case Loop:
         case If:
-            // Block_/Loop/If 指令的立即数有两部分，第一部分表示控制块的返回值类型（占 1 个字节），
+            // Block_/Loop/If 指令的立即数有两部分，第一部分表示控制块的类型（单字节的返回值类型，或者以 33 位有符号 LEB128 编码的类型索引），
             // 第二部分为子表达式（Block_/Loop 有一个子表达式，If 有两个子表达式）
             // 注：子表达式无需跳过，因为 find_block 主要就是要从控制块的表达式（包括子表达式）收集控制块的相关信息
-            read_LEB_unsigned(bytes, pos, 7);
+            read_LEB_signed(bytes, pos, 33);
             break;
         case Br:
         case BrIf:
@@ -45,11 +49,13 @@ void skip_immediate(const uint8_t *bytes, uint32_t *pos) {
             read_LEB_unsigned(bytes, pos, 32);
             break;
         case Call:
-            // Call 指令的立即数表示被调用函数的索引（占 4 个字节）
+        case ReturnCall:
+            // Call/ReturnCall 指令的立即数表示被调用函数的索引（占 4 个字节）
             read_LEB_unsigned(bytes, pos, 32);
             break;
         case CallIndirect:
-            // CallIndirect 指令有两个立即数，第一个立即数表示被调用函数的类型索引（占 4 个字节），
+        case ReturnCallIndirect:
+            // CallIndirect/ReturnCallIndirect 指令有两个立即数，第一个立即数表示被调用函数的类型索引（占 4 个字节），
             // 第二个立即数为保留立即数（占 1 个比特位），暂无用途
             read_LEB_unsigned(bytes, pos, 32);
             read_LEB_unsigned(bytes, pos, 1);
@@ -71,10 +77,10 @@ void skip_immediate(const uint8_t *bytes, uint32_t *pos) {
          * 内存指令
          * */
         case I32Load ... I64Store32:
-            // 内存加载/存储指令有两个立即数，第一个立即数表示内存偏移量（占 4 个字节），
-            // 第二个立即数表示对齐提示（占 4 个字节）
-            read_LEB_unsigned(bytes, pos, 32);
+            // 内存加载/存储指令有两个立即数，第一个立即数表示对齐提示（占 4 个字节），
+            // 第二个立即数表示内存偏移量（占 4 个字节，64 位内存占 8 个字节，这里统一按 64 位跳过）
             read_LEB_unsigned(bytes, pos, 32);
+            read_LEB_unsigned(bytes, pos, 64);
             break;
         case MemorySize:
         case MemoryGrow:
@@ -111,15 +117,90 @@ void skip_immediate(const uint8_t *bytes, uint32_t *pos) {
     }
 }
 
+// 计算位于字节码地址 pos 的指令对操作数栈高度的影响，即该指令压入的操作数数量减去弹出的操作数数量
+// 注：控制指令（Block_/Loop/If/Else_/End_/Br/BrTable/Return 等）对操作数栈高度的影响由 find_blocks 单独处理
+int get_stack_effect(Module *m, uint32_t pos) {
+    Type *type;
+    uint32_t idx;
+
+    uint8_t opcode = m->bytes[pos++];
+    switch (opcode) {
+        case Call:
+            // 弹出函数参数，压入函数返回值
+            idx = read_LEB_unsigned(m->bytes, &pos, 32);
+            ASSERT(idx < m->function_count, "Call function index %d out of range\n", idx)
+            type = m->functions[idx].type;
+            return (int) type->result_count - (int) type->param_count;
+        case CallIndirect:
+            // 弹出【函数索引值在表中的索引】以及函数参数，压入函数返回值
+            idx = read_LEB_unsigned(m->bytes, &pos, 32);
+            ASSERT(idx < m->type_count, "Call_indirect type index %d out of range\n", idx)
+            type = &m->types[idx];
+            return (int) type->result_count - (int) type->param_count - 1;
+        case ReturnCall:
+            // 尾调用之后的指令不可达，这里只校验函数索引，操作数栈高度的变化无需关心
+            idx = read_LEB_unsigned(m->bytes, &pos, 32);
+            ASSERT(idx < m->function_count, "Return_call function index %d out of range\n", idx)
+            return 0;
+        case ReturnCallIndirect:
+            idx = read_LEB_unsigned(m->bytes, &pos, 32);
+            ASSERT(idx < m->type_count, "Return_call_indirect type index %d out of range\n", idx)
+            return 0;
+        case LocalGet:
+        case GlobalGet:
+        case MemorySize:
+        case I32Const ... F64Const:
+            return 1;
+        case BrIf:
+        case Drop:
+        case LocalSet:
+        case GlobalSet:
+        case I32Eq ... I32GeU:
+        case I64Eq ... F64Ge:
+        case I32Add ... I32Rotr:
+        case I64Add ... I64Rotr:
+        case F32Add ... F32CopySign:
+        case F64Add ... F64CopySign:
+            // 二元运算以及比较指令：弹出 2 个操作数，压入 1 个结果
+            return -1;
+        case Select:
+        case I32Store ... I64Store32:
+            return -2;
+        default:
+            // 其余指令（一元运算、类型转换、内存加载、local.tee、memory.grow 等）弹出和压入的操作数数量相同
+            return 0;
+    }
+}
+
+// 根据函数 function 的局部变量类型准备栈帧描述符中局部变量的初始值
+static void init_frame_locals(Block *function) {
+#if !WASMC_UNTAGGED_SLOTS
+    // 局部变量的初始值为 0，但每个槽位带有各自的值类型标记，所以预先准备好局部变量的初始值，调用时整体拷贝即可
+    FrameDesc *frame = &function->frame;
+    free(frame->locals);
+    frame->locals = acalloc(function->local_count + 1, sizeof(StackValue), "FrameDesc->locals");
+    for (uint32_t l = 0; l < function->local_count; l++) {
+        frame->locals[l].value_type = function->locals[l];
+    }
+#endif
+}
+
 // 收集所有本地模块定义的函数中 Block_/Loop/If 控制块的相关信息，例如起始地址、结束地址、跳转地址、控制块类型等，
-// 便于后续虚拟机解释执行指令时可以借助这些信息
-void find_blocks(Module *m) {
+// 便于后续将函数翻译成内部指令流时可以借助这些信息
+// 同时静态地计算进入每个控制块时的操作数栈高度，这样跳转指令在翻译时就能确定跳转后需要恢复的操作数栈高度，
+// 虚拟机执行时控制块无需再压入/弹出调用栈，只有真正的函数调用才会使用调用栈
+// 注：参数 block_lookup 为模块中所有 Block 的 map，其中 key 为对应操作码 Block_/Loop/If 的地址
+void find_blocks(Module *m, Block **block_lookup) {
     Block *function;
     Block *block;
     // 声明用于在遍历过程中存储控制块 block 的相关信息的栈
     Block *blockstack[BLOCKSTACK_SIZE];
     int top = -1;
     uint8_t opcode = Unreachable;
+    // 当前指令执行前当前栈帧的操作数栈高度（相对于 fp，包含参数和局部变量）
+    int height;
+    // 函数执行过程中当前栈帧的操作数栈的最大高度
+    int max_height;
 
     // 遍历 m->functions 中所有的本地模块定义的函数，从每个函数字节码部分中收集 Block_/Loop/If 控制块的相关信息
     // 注：跳过从外部模块导入的函数，原因是导入函数的执行只需要执行 func_ptr 指针所指向的真实函数即可，无需通过虚拟机执行指令的方式
@@ -127,6 +208,11 @@ void find_blocks(Module *m) {
         // 获取单个函数对应的结构体
         function = &m->functions[f];
 
+        // 函数的操作数栈开头存储的是参数和局部变量，所以函数体开始执行时操作数栈高度为参数和局部变量的数量之和
+        function->height = function->type->param_count + function->local_count;
+        height = (int) function->height;
+        max_height = height;
+
         // 从该函数的字节码部分的【起始地址】开始收集 Block_/Loop/If 控制块的相关信息--遍历字节码中的每条指令
         uint32_t pos = function->start_addr;
         // 直到该函数的字节码部分的【结束地址】结束
@@ -145,20 +231,29 @@ void find_blocks(Module *m) {
                     // 设置控制块的块类型：Block_/Loop/If
                     block->block_type = opcode;
 
-                    // 由于 Block_/Loop/If 操作码的立即数用于表示该控制块的类型（占一个字节）
-                    // 所以可以根据该立即数，来获取控制块的类型，即控制块的返回值的数量和类型
+                    // 由于 Block_/Loop/If 操作码的立即数用于表示该控制块的类型
+                    // 所以可以根据该立即数，来获取控制块的类型，即控制块的参数以及返回值的数量和类型
 
-                    // get_block_type 根据表示该控制块的类型的值（占一个字节），返回控制块的签名，即控制块的返回值的数量和类型
-                    // 0x7f 表示有一个 i32 类型返回值、0x7e 表示有一个 i64 类型返回值、0x7d 表示有一个 f32 类型返回值、0x7c 表示有一个 f64 类型返回值、0x40 表示没有返回值
-                    // 注：目前多返回值提案还没有进入 Wasm 标准，根据当前版本的 Wasm 标准，控制块不能有参数，且最多只能有一个返回值
-                    block->type = get_block_type(m->bytes[pos + 1]);
+                    // get_block_type 根据表示该控制块的类型的立即数，返回控制块的签名，即控制块的参数以及返回值的数量和类型
+                    // 0x7f 表示有一个 i32 类型返回值、0x7e 表示有一个 i64 类型返回值、0x7d 表示有一个 f32 类型返回值、0x7c 表示有一个 f64 类型返回值、0x40 表示没有返回值，
+                    // 其余情况为类型段中的函数签名的索引（多返回值提案），此时控制块可以有参数和多个返回值
+                    block->type = get_block_type(m, pos + 1);
                     // 设置控制块的起始地址
                     block->start_addr = pos;
 
+                    // 记录进入控制块时的操作数栈高度（If 指令会先从操作数栈顶弹出判断条件）
+                    // 注：控制块的参数位于进入控制块前的操作数栈顶，属于控制块自己的操作数，所以进入控制块时的操作数栈高度不包含参数
+                    if (opcode == If) {
+                        height -= 1;
+                    }
+                    height -= (int) block->type->param_count;
+                    block->height = height > (int) function->height ? height : function->height;
+                    height += (int) block->type->param_count;
+
                     // 向控制块栈中添加该控制块对应结构体
                     blockstack[++top] = block;
-                    // 向 m->block_lookup 映射中添加该控制块对应结构体，其中 key 为对应操作码 Block_/Loop/If 的地址
-                    m->block_lookup[pos] = block;
+                    // 向 block_lookup 映射中添加该控制块对应结构体，其中 key 为对应操作码 Block_/Loop/If 的地址
+                    block_lookup[pos] = block;
                     break;
                 case Else_:
                     // 如果当前控制块中存在操作码为 Else_ 的指令，则当前控制块的块类型必须为 If
@@ -167,6 +262,9 @@ void find_blocks(Module *m) {
                     // 将 Else_ 指令的下一条指令地址，设置为该控制块的 else_addr，即 else 分支对应的字节码的首地址，
                     // 便于后续虚拟机在执行指令时，根据条件跳转到 else 分支对应的字节码继续执行指令
                     blockstack[top]->else_addr = pos + 1;
+
+                    // else 分支开始执行时的操作数栈中同样只有进入控制块前的操作数以及控制块的参数
+                    height = (int) (blockstack[top]->height + blockstack[top]->type->param_count);
                     break;
                 case End_:
                     // 如果操作码 End_ 的地址就是函数的字节码部分的【结束地址】，说明该控制块为该函数的最后一个控制块，则直接退出
@@ -185,14 +283,25 @@ void find_blocks(Module *m) {
                     // 设置控制块的跳转地址 br_addr
                     if (block->block_type == Loop) {
                         // 如果是 Loop 类型的控制块，需要循环执行，所以跳转地址就是该控制块开头指令（即 Loop 指令）的下一条指令地址
-                        // 注：Loop 指令占用两个字节（1 字节操作码 + 1 字节操作数），所以需要加 2
-                        block->br_addr = block->start_addr + 2;
+                        // 注：Loop 指令的立即数可能是单字节的返回值类型，也可能是多字节的类型索引，所以直接跳过 Loop 指令
+                        block->br_addr = block->start_addr;
+                        skip_immediate(m->bytes, &block->br_addr);
                     } else {
                         // 如果是非 Loop 类型的控制块，则跳转地址就是该控制块的结尾地址，也就是操作码 End_ 的地址
                         block->br_addr = pos;
                     }
+
+                    // 控制块执行结束后，操作数栈中只剩下进入控制块前的操作数以及控制块的返回值
+                    height = (int) (block->height + block->type->result_count);
                     break;
                 default:
+                    // 注：br/br_table/return/unreachable 之后直到控制块的 else 分支或者结尾的指令都不可达，
+                    // 不可达指令计算出的操作数栈高度没有意义，到 else 分支或者结尾时会重新设置
+                    height += get_stack_effect(m, pos);
+                    // 注：不可达指令计算出的操作数栈高度可能偏大，只会使栈帧描述符中的最大深度偏保守，不影响正确性
+                    if (height > max_height) {
+                        max_height = height;
+                    }
                     break;
             }
             // 在单条指令中，除了占一个字节的操作码之外，后面可能也会紧跟着立即数，如果有立即数，则直接跳过立即数去处理下一条指令的操作码
@@ -203,9 +312,1034 @@ void find_blocks(Module *m) {
         ASSERT(top == -1, "Function ended in middle of block\n")
         // 控制块应该以操作码 End_ 结束
         ASSERT(opcode == End_, "Function block did not end with 0xb\n")
+
+        // 预先计算函数的栈帧描述符，调用函数时无需再逐个读取函数签名和局部变量的类型
+        FrameDesc *frame = &function->frame;
+        frame->param_count = function->type->param_count;
+        frame->local_count = function->local_count;
+        frame->max_depth = (uint32_t) max_height;
+        frame->result_count = function->type->result_count;
+        init_frame_locals(function);
+    }
+}
+
+// 设置跳转指令 ins 的跳转目标为控制块 block（包含函数），参数 depth 为目标标签索引
+// 跳转时需要将操作数栈顶的 arity 个值拷贝到进入目标控制块时的操作数栈高度处，然后从目标控制块的跳转地址继续执行
+// 注：跳转到 loop 类型的控制块时携带控制块的参数（跳转到循环开头，重新开始一次循环），跳转到其他控制块（包含函数）时携带控制块的返回值
+void resolve_branch(Instr *ins, Block *block, uint32_t depth, const uint32_t *addr_map) {
+    ins->a = depth;
+    ins->arity = block->block_type == Loop ? block->type->param_count : block->type->result_count;
+    ins->b.br.addr = addr_map[block->br_addr];
+    ins->b.br.height = block->height;
+}
+
+// 将所有本地模块定义的函数的字节码翻译成定长的内部指令流 m->code
+// 翻译过程中会完成以下工作：
+// 1. 提前解码所有指令的 LEB128 立即数，虚拟机执行时直接从 Instr 中读取即可
+// 2. 提前计算好跳转指令（If/Else_/Br/BrIf/BrTable/Return）的目标地址和跳转后的操作数栈高度，
+//    虚拟机执行时控制块无需压入/弹出调用栈，跳转也无需查找调用栈中的控制块
+// 3. 将函数和控制块中记录的字节码地址统一换算为内部指令流中的地址
+void translate_functions(Module *m, Block **block_lookup) {
+    Block *function;
+    Block *block;
+    // 声明用于在遍历过程中存储控制块 block 的栈，用于计算跳转指令的目标地址
+    Block *blockstack[BLOCKSTACK_SIZE];
+    int top;
+    uint32_t pos;
+    uint8_t opcode;
+
+    // 字节码地址到内部指令流地址的映射，其中 key 为字节码中某条指令的地址，value 为该指令在内部指令流中的地址
+    uint32_t *addr_map = acalloc(m->byte_count + 1, sizeof(uint32_t), "addr_map");
+
+    /* 1. 第一遍遍历：统计指令数量，同时记录每条指令在内部指令流中的地址 */
+
+    // 由于内部指令是定长的，且一条字节码指令只对应一条内部指令，所以指令的数量就是内部指令流的长度
+    uint32_t count = 0;
+    for (uint32_t f = m->import_func_count; f < m->function_count; f++) {
+        function = &m->functions[f];
+        pos = function->start_addr;
+        while (pos <= function->end_addr) {
+            addr_map[pos] = count++;
+            skip_immediate(m->bytes, &pos);
+        }
+    }
+
+    m->code = acalloc(count, sizeof(Instr), "Module->code");
+    m->code_count = count;
+
+    /* 2. 第二遍遍历：逐条翻译指令，解码立即数并计算跳转目标地址 */
+
+    for (uint32_t f = m->import_func_count; f < m->function_count; f++) {
+        function = &m->functions[f];
+        top = -1;
+        pos = function->start_addr;
+        while (pos <= function->end_addr) {
+            uint32_t addr = pos;
+            Instr *ins = &m->code[addr_map[addr]];
+            opcode = m->bytes[pos++];
+            ins->opcode = opcode;
+            switch (opcode) {
+                case Block_:
+                case Loop:
+                case If:
+                    // 控制块的类型已经在 find_blocks 中记录在控制块的签名中，所以跳过即可
+                    read_LEB_signed(m->bytes, &pos, 33);
+                    // 直接将对应的控制块保存到指令中，虚拟机执行时无需再通过 block_lookup 查找
+                    block = block_lookup[addr];
+                    ins->b.block = block;
+                    blockstack[++top] = block;
+                    if (opcode == If) {
+                        // 立即数 a 为判断条件为 false 时的跳转地址：else 分支的起始地址，如果没有 else 分支则为控制块的结尾
+                        ins->a = addr_map[block->else_addr ? block->else_addr : block->end_addr];
+                    }
+                    break;
+                case Else_:
+                    // Else_ 指令的作用是跳转到 if 控制块的结尾指令，所以提前计算好跳转目标地址
+                    ins->a = addr_map[blockstack[top]->br_addr];
+                    break;
+                case End_:
+                    // 函数最后的 End_ 指令没有对应的控制块，立即数 a 为 1 表示该指令为函数结尾，执行时需要函数返回
+                    // 注：控制块执行到结尾时，操作数栈中恰好是进入控制块前的操作数以及控制块的返回值，所以控制块的 End_ 指令无需任何操作
+                    if (top < 0) {
+                        ins->a = 1;
+                        break;
+                    }
+                    // 控制块结束时，所有跳转到该控制块的指令都已经翻译完成，所以可以将该控制块记录的字节码地址换算为内部指令流中的地址
+                    block = blockstack[top--];
+                    block->start_addr = addr_map[block->start_addr];
+                    block->end_addr = addr_map[block->end_addr];
+                    block->br_addr = addr_map[block->br_addr];
+                    if (block->else_addr) {
+                        block->else_addr = addr_map[block->else_addr];
+                    }
+                    break;
+                case Br:
+                case BrIf: {
+                    // 立即数 a 为跳转的目标标签索引，立即数 b 为跳转目标（目标控制块的跳转地址以及跳转后的操作数栈高度）
+                    // 注：当目标标签索引等于当前控制块嵌套层数时，目标控制块就是函数本身
+                    uint32_t depth = read_LEB_unsigned(m->bytes, &pos, 32);
+                    ASSERT((int) depth <= top + 1, "Branch depth %d out of range\n", depth)
+                    block = (int) depth == top + 1 ? function : blockstack[top - depth];
+                    resolve_branch(ins, block, depth, addr_map);
+                    break;
+                }
+                case BrTable: {
+                    // 立即数 a 为索引表的大小，立即数 b 为跳转表，其中前 a 项对应索引表中的标签索引，最后一项对应默认标签索引
+                    uint32_t count = read_LEB_unsigned(m->bytes, &pos, 32);
+                    ins->a = count;
+                    ins->b.table = acalloc(count + 1, sizeof(Instr), "br_table");
+                    for (uint32_t n = 0; n <= count; n++) {
+                        uint32_t depth = read_LEB_unsigned(m->bytes, &pos, 32);
+                        ASSERT((int) depth <= top + 1, "Branch depth %d out of range\n", depth)
+                        block = (int) depth == top + 1 ? function : blockstack[top - depth];
+                        ins->b.table[n].opcode = Br;
+                        resolve_branch(&ins->b.table[n], block, depth, addr_map);
+                    }
+                    break;
+                }
+                case Return:
+                    // 函数返回等同于跳转到函数本身
+                    resolve_branch(ins, function, top + 1, addr_map);
+                    break;
+                case Call:
+                case ReturnCall:
+                case LocalGet:
+                case LocalSet:
+                case LocalTee:
+                case GlobalGet:
+                case GlobalSet:
+                    // 立即数 a 为函数索引或变量索引
+                    ins->a = read_LEB_unsigned(m->bytes, &pos, 32);
+                    break;
+                case CallIndirect:
+                case ReturnCallIndirect:
+                    // 立即数 a 为被调用函数的类型索引，第二个立即数为保留立即数，直接跳过
+                    // 立即数 b 为该调用点的内联缓存在 m->call_caches 中的索引（内联缓存在所有指令翻译完成后统一分配）
+                    ins->a = read_LEB_unsigned(m->bytes, &pos, 32);
+                    read_LEB_unsigned(m->bytes, &pos, 1);
+                    ins->b.uint32 = m->call_cache_count++;
+                    break;
+                case I32Load ... I64Store32:
+                    // 对齐方式只起提示作用，直接跳过；立即数 a 为内存偏移量
+                    // 64 位内存的内存偏移量为 64 位整数，完整保存在立即数 b 中（见 coalesce_bounds_checks）
+                    read_LEB_unsigned(m->bytes, &pos, 32);
+                    if (m->memory.memory64) {
+                        ins->b.uint64 = read_LEB_unsigned(m->bytes, &pos, 64);
+                        ins->a = (uint32_t) ins->b.uint64;
+                    } else {
+                        ins->a = read_LEB_unsigned(m->bytes, &pos, 32);
+                    }
+                    break;
+                case MemorySize:
+                case MemoryGrow:
+                    // 立即数表示当前操作的是第几块内存，目前必须为 0，直接跳过
+                    read_LEB_unsigned(m->bytes, &pos, 1);
+                    break;
+                case I32Const:
+                    ins->b.uint32 = read_LEB_signed(m->bytes, &pos, 32);
+                    break;
+                case I64Const:
+                    ins->b.int64 = (int64_t) read_LEB_signed(m->bytes, &pos, 64);
+                    break;
+                case F32Const:
+                    memcpy(&ins->b.uint32, m->bytes + pos, 4);
+                    pos += 4;
+                    break;
+                case F64Const:
+                    memcpy(&ins->b.uint64, m->bytes + pos, 8);
+                    pos += 8;
+                    break;
+                case TruncSat:
+                    // 立即数 a 用来区分不同类型的浮点数和整数之间的转换
+                    ins->a = read_LEB_unsigned(m->bytes, &pos, 8);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        // 将函数记录的字节码地址换算为内部指令流中的地址
+        function->start_addr = addr_map[function->start_addr];
+        function->end_addr = addr_map[function->end_addr];
+        function->br_addr = addr_map[function->br_addr];
+    }
+
+    // 为所有 call_indirect 指令分配内联缓存，初始时缓存为空
+    if (m->call_cache_count) {
+        m->call_caches = acalloc(m->call_cache_count, sizeof(CallCache), "Module->call_caches");
+    }
+
+    free(addr_map);
+}
+
+// 将表中的索引 slot 以及对应的被调用函数 func 组成的目标记录到内联缓存 cache 中
+// 注：只在缓存未命中且函数签名校验通过后调用，缓存已满时依次轮换替换旧的目标
+void call_cache_insert(CallCache *cache, uint32_t slot, Block *func) {
+    uint32_t n = cache->count;
+    if (n < CALL_CACHE_SIZE) {
+        cache->count++;
+    } else {
+        n = cache->next;
+        cache->next = (cache->next + 1) % CALL_CACHE_SIZE;
+    }
+    cache->slots[n] = slot;
+    cache->funcs[n] = func;
+}
+
+// 超级指令融合规则：将 length 条连续的指令 sequence 融合为一条超级指令 fused
+typedef struct FusionRule {
+    uint16_t fused;      // 超级指令的操作码
+    uint32_t length;     // 指令序列的长度
+    uint16_t sequence[4];// 指令序列中每条指令的操作码
+} FusionRule;
+
+// 超级指令融合规则表，对于每条指令会按顺序依次尝试匹配，所以较长的指令序列需要排在前面
+// 注：可以根据以 WASMC_PROFILE 构建的 wasmc-bench 打印出的相邻指令执行次数来调整该表，
+// 新增规则时还需要在 opcode.h 中定义超级指令的操作码，并在 interpret 中实现对应的 handler
+static const FusionRule fusion_rules[] = {
+        {LocalGetLocalGetI32LtSBrIf, 4, {LocalGet, LocalGet, I32LtS, BrIf}},
+        {LocalGetI32ConstI32LtSBrIf, 4, {LocalGet, I32Const, I32LtS, BrIf}},
+        {LocalGetI32ConstI32Add, 3, {LocalGet, I32Const, I32Add}},
+        {LocalGetI32ConstI32Sub, 3, {LocalGet, I32Const, I32Sub}},
+        {LocalGetLocalGetI32Add, 3, {LocalGet, LocalGet, I32Add}},
+        {I32ConstI32GtSBrIf, 3, {I32Const, I32GtS, BrIf}},
+        {I32ConstLocalGetI32Store, 3, {I32Const, LocalGet, I32Store}},
+        {LocalTeeBrIf, 2, {LocalTee, BrIf}},
+        {I32ConstLocalSet, 2, {I32Const, LocalSet}},
+};
+
+// 将函数 function 中常见的指令序列融合为超级指令
+void fuse_function(Module *m, Block *function) {
+    for (uint32_t pc = function->start_addr; pc <= function->end_addr; pc++) {
+        for (uint32_t r = 0; r < sizeof(fusion_rules) / sizeof(fusion_rules[0]); r++) {
+            const FusionRule *rule = &fusion_rules[r];
+            uint32_t n = 0;
+            while (n < rule->length && pc + n <= function->end_addr && m->code[pc + n].opcode == rule->sequence[n]) {
+                n++;
+            }
+            if (n == rule->length) {
+                m->code[pc].opcode = rule->fused;
+                pc += rule->length - 1;
+                break;
+            }
+        }
+    }
+}
+
+// 将内部指令流中常见的指令序列融合为超级指令，从而减少指令分派的次数以及操作数栈的读写
+// 注：融合时只将指令序列中第一条指令的操作码替换为超级指令，其余指令保持不变，
+// 超级指令的 handler 直接从这些指令中读取立即数，一次完成整个序列的操作后跳过这些指令，
+// 由于其余指令保持不变，所以即使有跳转指令的目标地址位于指令序列中间，也仍然可以正常执行
+void fuse_instructions(Module *m) {
+    for (uint32_t f = m->import_func_count; f < m->function_count; f++) {
+        Block *function = &m->functions[f];
+
+        // 已被翻译成寄存器指令的函数不再由栈式解释器执行，无需融合
+        if (function->rcode) {
+            continue;
+        }
+
+        fuse_function(m, function);
+    }
+}
+
+// 将函数 func 中的超级指令还原为融合前的原始指令
+// 注：由于融合时只替换了指令序列中第一条指令的操作码，所以只需将其还原为规则中第一条指令的操作码即可，
+// 即使该函数此时仍有栈帧正在由栈式解释器执行，还原后的指令序列也可以继续正常执行
+void unfuse_function(Module *m, Block *func) {
+    for (uint32_t pc = func->start_addr; pc <= func->end_addr; pc++) {
+        for (uint32_t r = 0; r < sizeof(fusion_rules) / sizeof(fusion_rules[0]); r++) {
+            if (m->code[pc].opcode == fusion_rules[r].fused) {
+                m->code[pc].opcode = fusion_rules[r].sequence[0];
+                break;
+            }
+        }
+    }
+}
+
+// 内部指令流中删除或者插入指令之后，根据旧地址到新地址的映射 addr_map 将新指令流 m->code 的前 count 条指令中的跳转目标地址，
+// 以及控制块和函数中记录的地址，统一换算为新指令流中的地址
+static void remap_code(Module *m, uint32_t count, const uint32_t *addr_map) {
+    for (uint32_t pc = 0; pc < count; pc++) {
+        Instr *ins = &m->code[pc];
+        switch (ins->opcode) {
+            case Block_:
+            case Loop:
+            case If: {
+                Block *block = ins->b.block;
+                block->start_addr = addr_map[block->start_addr];
+                block->end_addr = addr_map[block->end_addr];
+                block->br_addr = addr_map[block->br_addr];
+                if (block->else_addr) {
+                    block->else_addr = addr_map[block->else_addr];
+                }
+                if (ins->opcode == If) {
+                    ins->a = addr_map[ins->a];
+                }
+                break;
+            }
+            case Else_:
+                ins->a = addr_map[ins->a];
+                break;
+            case Br:
+            case BrIf:
+            case Return:
+                ins->b.br.addr = addr_map[ins->b.br.addr];
+                break;
+            case BrTable:
+                for (uint32_t n = 0; n <= ins->a; n++) {
+                    ins->b.table[n].b.br.addr = addr_map[ins->b.table[n].b.br.addr];
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    for (uint32_t f = m->import_func_count; f < m->function_count; f++) {
+        Block *function = &m->functions[f];
+        function->start_addr = addr_map[function->start_addr];
+        function->end_addr = addr_map[function->end_addr];
+        function->br_addr = addr_map[function->br_addr];
+    }
+}
+
+// 内联阈值：函数体（不包含结尾的 End_ 指令）的指令数量不超过该值的叶子函数才会被内联到调用者中
+#define INLINE_MAX_SIZE 20
+
+// 判断函数 func 能否被内联：函数体足够小，且只包含直线代码，即不包含控制块、跳转、返回以及任何函数调用
+// 注：这类函数（例如 C++ 编译得到的访问器函数）内联后无需调整任何跳转目标，函数结尾时操作数栈中恰好只剩下返回值
+static bool is_inlinable(Module *m, Block *func) {
+    if (func->end_addr - func->start_addr > INLINE_MAX_SIZE) {
+        return false;
+    }
+    for (uint32_t pc = func->start_addr; pc < func->end_addr; pc++) {
+        switch (m->code[pc].opcode) {
+            case Block_:
+            case Loop:
+            case If:
+            case Else_:
+            case End_:
+            case Br:
+            case BrIf:
+            case BrTable:
+            case Return:
+            case Call:
+            case CallIndirect:
+            case ReturnCall:
+            case ReturnCallIndirect:
+                return false;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+// 内联函数 func 后，调用点的 Call 指令被替换成的指令数量：
+// 将参数逐个保存到局部变量中的 local.set 指令、将局部变量初始化为 0 的常量指令和 local.set 指令，以及函数体中的全部指令
+static uint32_t inline_size(Block *func) {
+    return func->type->param_count + 2 * func->local_count + (func->end_addr - func->start_addr);
+}
+
+// 将内联函数 func 的函数体展开到新指令流 out[*n] 开始的位置，函数的参数和局部变量依次对应调用者中从 base 开始的局部变量
+static void inline_call(Module *m, Block *func, uint32_t base, Instr *out, uint32_t *n) {
+    uint32_t param_count = func->type->param_count;
+
+    // 调用前参数位于操作数栈顶，最后一个参数在最上面，所以逆序保存到局部变量中
+    for (uint32_t p = param_count; p > 0; p--) {
+        out[(*n)++] = (Instr) {.opcode = LocalSet, .a = base + p - 1};
+    }
+
+    // 每次调用时局部变量的初始值都为 0
+    for (uint32_t l = 0; l < func->local_count; l++) {
+        uint16_t opcode;
+        switch (func->locals[l]) {
+            case I64: opcode = I64Const; break;
+            case F32: opcode = F32Const; break;
+            case F64: opcode = F64Const; break;
+            default: opcode = I32Const; break;
+        }
+        out[(*n)++] = (Instr) {.opcode = opcode};
+        out[(*n)++] = (Instr) {.opcode = LocalSet, .a = base + param_count + l};
+    }
+
+    // 函数体中的局部变量索引加上 base，函数结尾的 End_ 指令无需保留，此时操作数栈顶恰好是函数的返回值
+    for (uint32_t pc = func->start_addr; pc < func->end_addr; pc++) {
+        Instr ins = m->code[pc];
+        if (ins.opcode == LocalGet || ins.opcode == LocalSet || ins.opcode == LocalTee) {
+            ins.a += base;
+        }
+        out[(*n)++] = ins;
+    }
+}
+
+// 将调用者 function 的新指令流写入 out[*n] 开始的位置，其中对可内联函数的调用被替换为被调用函数的函数体
+// 被内联的函数的参数和局部变量作为调用者新增的局部变量（同一个被调用函数的多个调用点共用这些局部变量），
+// 由于操作数栈位于参数和局部变量之后，所以调用者中所有的操作数栈高度（控制块以及跳转指令中记录的高度）都要相应增加
+static void inline_function(Module *m, Block *function, const bool *inlinable, uint32_t *bases, uint32_t *addr_map, Instr *out, uint32_t *n) {
+    uint32_t local_total = function->type->param_count + function->local_count;
+    uint32_t extra = 0;
+    uint32_t depth = 0;
+
+    // 1. 为每个被内联的函数分配局部变量，并记录其操作数栈的最大深度
+    for (uint32_t pc = function->start_addr; pc <= function->end_addr; pc++) {
+        Instr *ins = &m->code[pc];
+        if (ins->opcode != Call || !inlinable[ins->a] || bases[ins->a] != UINT32_MAX) {
+            continue;
+        }
+        Block *callee = &m->functions[ins->a];
+        bases[ins->a] = local_total + extra;
+        if (callee->height) {
+            function->locals = arecalloc(function->locals, function->local_count + extra,
+                                         function->local_count + extra + callee->height, sizeof(uint32_t), "function->locals");
+        }
+        for (uint32_t p = 0; p < callee->type->param_count; p++) {
+            function->locals[function->local_count + extra++] = callee->type->params[p];
+        }
+        for (uint32_t l = 0; l < callee->local_count; l++) {
+            function->locals[function->local_count + extra++] = callee->locals[l];
+        }
+        if (callee->frame.max_depth - callee->height > depth) {
+            depth = callee->frame.max_depth - callee->height;
+        }
+    }
+
+    // 2. 逐条写入指令，同时将操作数栈高度增加 extra
+    for (uint32_t pc = function->start_addr; pc <= function->end_addr; pc++) {
+        Instr ins = m->code[pc];
+        addr_map[pc] = *n;
+        switch (ins.opcode) {
+            case Call:
+                if (inlinable[ins.a]) {
+                    inline_call(m, &m->functions[ins.a], bases[ins.a], out, n);
+                    continue;
+                }
+                break;
+            case Block_:
+            case Loop:
+            case If:
+                ins.b.block->height += extra;
+                break;
+            case Br:
+            case BrIf:
+            case Return:
+                ins.b.br.height += extra;
+                break;
+            case BrTable:
+                for (uint32_t t = 0; t <= ins.a; t++) {
+                    ins.b.table[t].b.br.height += extra;
+                }
+                break;
+            default:
+                break;
+        }
+        out[(*n)++] = ins;
+    }
+
+    // 3. 更新调用者的局部变量数量以及栈帧描述符，并重置 bases 供下一个调用者使用
+    if (extra) {
+        function->local_count += extra;
+        function->height += extra;
+        function->frame.local_count = function->local_count;
+        function->frame.max_depth += extra + depth;
+        init_frame_locals(function);
+    }
+    for (uint32_t pc = function->start_addr; pc <= function->end_addr; pc++) {
+        if (m->code[pc].opcode == Call) {
+            bases[m->code[pc].a] = UINT32_MAX;
+        }
+    }
+}
+
+// 将函数体足够小的叶子函数内联到其调用者中，从而省去函数调用时压入栈帧、初始化局部变量以及返回时弹出栈帧的开销
+// 注：内联后内部指令流的长度会发生变化，所以会生成新的指令流，并通过 remap_code 将所有地址换算为新指令流中的地址；
+// 被内联的函数本身保持不变，仍然可以被导出、被间接调用或者被其他无法内联的调用点调用
+void inline_functions(Module *m) {
+    bool *inlinable = acalloc(m->function_count, sizeof(bool), "inlinable");
+    uint32_t *bases = acalloc(m->function_count, sizeof(uint32_t), "bases");
+    memset(bases, 0xff, m->function_count * sizeof(uint32_t));
+
+    for (uint32_t f = m->import_func_count; f < m->function_count; f++) {
+        inlinable[f] = is_inlinable(m, &m->functions[f]);
+    }
+
+    // 计算内联后指令流的长度
+    uint32_t count = 0;
+    uint32_t sites = 0;
+    for (uint32_t pc = 0; pc < m->code_count; pc++) {
+        Instr *ins = &m->code[pc];
+        if (ins->opcode == Call && inlinable[ins->a]) {
+            count += inline_size(&m->functions[ins->a]);
+            sites++;
+        } else {
+            count++;
+        }
+    }
+
+    if (sites) {
+        Instr *code = acalloc(count + 1, sizeof(Instr), "Module->code");
+        uint32_t *addr_map = acalloc(m->code_count + 1, sizeof(uint32_t), "addr_map");
+        uint32_t n = 0;
+        for (uint32_t f = m->import_func_count; f < m->function_count; f++) {
+            inline_function(m, &m->functions[f], inlinable, bases, addr_map, code, &n);
+        }
+        addr_map[m->code_count] = n;
+
+        free(m->code);
+        m->code = code;
+        m->code_count = n;
+        remap_code(m, n, addr_map);
+        free(addr_map);
+    }
+
+    free(inlinable);
+    free(bases);
+}
+
+// 返回无副作用且不会触发陷阱的指令 opcode 从操作数栈弹出的操作数数量（这类指令都只压入一个值），其他指令返回 -1
+// 注：这类指令的结果如果被 drop 直接丢弃，则可以连同计算其操作数的指令一起删除
+static int pure_arity(uint16_t opcode) {
+    switch (opcode) {
+        case I32Const:
+        case I64Const:
+        case F32Const:
+        case F64Const:
+        case LocalGet:
+        case GlobalGet:
+            return 0;
+        case I32Eqz:
+        case I64Eqz:
+        case I32Clz ... I32PopCnt:
+        case I64Clz ... I64PopCnt:
+        case F32Abs ... F32Sqrt:
+        case F64Abs ... F64Sqrt:
+        case I32WrapI64:
+        case I64ExtendI32S:
+        case I64ExtendI32U:
+        case F32ConvertI32S ... I64Extend32S:
+            return 1;
+        case I32Eq ... I32GeU:
+        case I64Eq ... F64Ge:
+        case I32Add ... I32Mul:
+        case I32And ... I32Rotr:
+        case I64Add ... I64Mul:
+        case I64And ... I64Rotr:
+        case F32Add ... F32CopySign:
+        case F64Add ... F64CopySign:
+            return 2;
+        default:
+            return -1;
+    }
+}
+
+// 将常量指令 x 设置为值为 value 的 i32.const 指令
+static void set_i32_const(Instr *x, uint32_t value) {
+    x->opcode = I32Const;
+    x->b.uint64 = 0;
+    x->b.uint32 = value;
+}
+
+// 将常量指令 x 设置为值为 value 的 i64.const 指令
+static void set_i64_const(Instr *x, uint64_t value) {
+    x->opcode = I64Const;
+    x->b.uint64 = value;
+}
+
+// 常量折叠：对常量指令 x 执行一元运算 opcode，并将 x 替换为保存计算结果的常量指令，无法折叠时返回 false
+static bool fold_unary(uint16_t opcode, Instr *x) {
+    uint32_t a = x->b.uint32;
+    uint64_t c = x->b.uint64;
+
+    if (x->opcode == I32Const) {
+        switch (opcode) {
+            case I32Eqz: set_i32_const(x, a == 0); return true;
+            case I32Clz: set_i32_const(x, a == 0 ? 32 : __builtin_clz(a)); return true;
+            case I32Ctz: set_i32_const(x, a == 0 ? 32 : __builtin_ctz(a)); return true;
+            case I32PopCnt: set_i32_const(x, __builtin_popcount(a)); return true;
+            case I32Extend8S: set_i32_const(x, (uint32_t) (int8_t) a); return true;
+            case I32Extend16S: set_i32_const(x, (uint32_t) (int16_t) a); return true;
+            case I64ExtendI32S: set_i64_const(x, (uint64_t) (int64_t) (int32_t) a); return true;
+            case I64ExtendI32U: set_i64_const(x, a); return true;
+            default: return false;
+        }
+    }
+
+    if (x->opcode == I64Const) {
+        switch (opcode) {
+            case I64Eqz: set_i32_const(x, c == 0); return true;
+            case I64Clz: set_i64_const(x, c == 0 ? 64 : __builtin_clzll(c)); return true;
+            case I64Ctz: set_i64_const(x, c == 0 ? 64 : __builtin_ctzll(c)); return true;
+            case I64PopCnt: set_i64_const(x, __builtin_popcountll(c)); return true;
+            case I64Extend8S: set_i64_const(x, (uint64_t) (int8_t) c); return true;
+            case I64Extend16S: set_i64_const(x, (uint64_t) (int16_t) c); return true;
+            case I64Extend32S: set_i64_const(x, (uint64_t) (int32_t) c); return true;
+            case I32WrapI64: set_i32_const(x, (uint32_t) c); return true;
+            default: return false;
+        }
+    }
+
+    return false;
+}
+
+// 常量折叠：对常量指令 x、y（x 为第一个操作数）执行二元运算 opcode，并将 x 替换为保存计算结果的常量指令，
+// 无法折叠时返回 false，包括运算会触发陷阱（例如整数除以 0）的情况，此时保留原始指令，由执行时触发陷阱
+static bool fold_binary(uint16_t opcode, Instr *x, const Instr *y) {
+    if (x->opcode == I32Const && y->opcode == I32Const) {
+        uint32_t a = x->b.uint32, b = y->b.uint32;
+        switch (opcode) {
+            case I32Eq: set_i32_const(x, a == b); return true;
+            case I32Ne: set_i32_const(x, a != b); return true;
+            case I32LtS: set_i32_const(x, (int32_t) a < (int32_t) b); return true;
+            case I32LtU: set_i32_const(x, a < b); return true;
+            case I32GtS: set_i32_const(x, (int32_t) a > (int32_t) b); return true;
+            case I32GtU: set_i32_const(x, a > b); return true;
+            case I32LeS: set_i32_const(x, (int32_t) a <= (int32_t) b); return true;
+            case I32LeU: set_i32_const(x, a <= b); return true;
+            case I32GeS: set_i32_const(x, (int32_t) a >= (int32_t) b); return true;
+            case I32GeU: set_i32_const(x, a >= b); return true;
+            case I32Add: set_i32_const(x, a + b); return true;
+            case I32Sub: set_i32_const(x, a - b); return true;
+            case I32Mul: set_i32_const(x, a * b); return true;
+            case I32DivS:
+                if (b == 0 || (a == 0x80000000 && b == UINT32_MAX)) {
+                    return false;
+                }
+                set_i32_const(x, (uint32_t) ((int32_t) a / (int32_t) b));
+                return true;
+            case I32DivU:
+                if (b == 0) {
+                    return false;
+                }
+                set_i32_const(x, a / b);
+                return true;
+            case I32RemS:
+                if (b == 0) {
+                    return false;
+                }
+                // 注：INT32_MIN % -1 在 C 语言中是未定义行为，而 Wasm 规定其结果为 0
+                set_i32_const(x, b == UINT32_MAX ? 0 : (uint32_t) ((int32_t) a % (int32_t) b));
+                return true;
+            case I32RemU:
+                if (b == 0) {
+                    return false;
+                }
+                set_i32_const(x, a % b);
+                return true;
+            case I32And: set_i32_const(x, a & b); return true;
+            case I32Or: set_i32_const(x, a | b); return true;
+            case I32Xor: set_i32_const(x, a ^ b); return true;
+            case I32Shl: set_i32_const(x, a << (b & 31)); return true;
+            case I32ShrS: set_i32_const(x, (uint32_t) ((int32_t) a >> (b & 31))); return true;
+            case I32ShrU: set_i32_const(x, a >> (b & 31)); return true;
+            case I32Rotl: set_i32_const(x, rotl32(a, b)); return true;
+            case I32Rotr: set_i32_const(x, rotr32(a, b)); return true;
+            default: return false;
+        }
+    }
+
+    if (x->opcode == I64Const && y->opcode == I64Const) {
+        uint64_t a = x->b.uint64, b = y->b.uint64;
+        switch (opcode) {
+            case I64Eq: set_i32_const(x, a == b); return true;
+            case I64Ne: set_i32_const(x, a != b); return true;
+            case I64LtS: set_i32_const(x, (int64_t) a < (int64_t) b); return true;
+            case I64LtU: set_i32_const(x, a < b); return true;
+            case I64GtS: set_i32_const(x, (int64_t) a > (int64_t) b); return true;
+            case I64GtU: set_i32_const(x, a > b); return true;
+            case I64LeS: set_i32_const(x, (int64_t) a <= (int64_t) b); return true;
+            case I64LeU: set_i32_const(x, a <= b); return true;
+            case I64GeS: set_i32_const(x, (int64_t) a >= (int64_t) b); return true;
+            case I64GeU: set_i32_const(x, a >= b); return true;
+            case I64Add: set_i64_const(x, a + b); return true;
+            case I64Sub: set_i64_const(x, a - b); return true;
+            case I64Mul: set_i64_const(x, a * b); return true;
+            case I64DivS:
+                if (b == 0 || (a == 0x8000000000000000 && b == UINT64_MAX)) {
+                    return false;
+                }
+                set_i64_const(x, (uint64_t) ((int64_t) a / (int64_t) b));
+                return true;
+            case I64DivU:
+                if (b == 0) {
+                    return false;
+                }
+                set_i64_const(x, a / b);
+                return true;
+            case I64RemS:
+                if (b == 0) {
+                    return false;
+                }
+                set_i64_const(x, b == UINT64_MAX ? 0 : (uint64_t) ((int64_t) a % (int64_t) b));
+                return true;
+            case I64RemU:
+                if (b == 0) {
+                    return false;
+                }
+                set_i64_const(x, a % b);
+                return true;
+            case I64And: set_i64_const(x, a & b); return true;
+            case I64Or: set_i64_const(x, a | b); return true;
+            case I64Xor: set_i64_const(x, a ^ b); return true;
+            case I64Shl: set_i64_const(x, a << (b & 63)); return true;
+            case I64ShrS: set_i64_const(x, (uint64_t) ((int64_t) a >> (b & 63))); return true;
+            case I64ShrU: set_i64_const(x, a >> (b & 63)); return true;
+            case I64Rotl: set_i64_const(x, rotl64(a, b)); return true;
+            case I64Rotr: set_i64_const(x, rotr64(a, b)); return true;
+            default: return false;
+        }
+    }
+
+    return false;
+}
+
+// 强度削减：第二个操作数为常量指令 y 且其值为 2 的幂时，将乘法、无符号除法和无符号取余替换为移位和按位与运算，
+// 替换后的指令（opcode 以及 y 中新的常量值）直接写回 opcode 和 y，值为 1 时乘法和除法无需任何运算，opcode 被置为 Nop
+// 注：有符号除法对负数向零取整，与算术右移的结果不同，所以不做替换；无法替换时返回 false
+static bool reduce_strength(uint16_t *opcode, Instr *y) {
+    if (y->opcode == I32Const && y->b.uint32 != 0 && (y->b.uint32 & (y->b.uint32 - 1)) == 0) {
+        uint32_t b = y->b.uint32;
+        switch (*opcode) {
+            case I32Mul:
+            case I32DivU:
+                *opcode = b == 1 ? Nop : *opcode == I32Mul ? I32Shl : I32ShrU;
+                set_i32_const(y, __builtin_ctz(b));
+                return true;
+            case I32RemU:
+                *opcode = I32And;
+                set_i32_const(y, b - 1);
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    if (y->opcode == I64Const && y->b.uint64 != 0 && (y->b.uint64 & (y->b.uint64 - 1)) == 0) {
+        uint64_t b = y->b.uint64;
+        switch (*opcode) {
+            case I64Mul:
+            case I64DivU:
+                *opcode = b == 1 ? Nop : *opcode == I64Mul ? I64Shl : I64ShrU;
+                set_i64_const(y, __builtin_ctzll(b));
+                return true;
+            case I64RemU:
+                *opcode = I64And;
+                set_i64_const(y, b - 1);
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    return false;
+}
+
+// 对函数 function 的内部指令流做窥孔优化，优化后的指令依次写入 m->code[*out] 开始的位置（*out 不超过函数的起始地址，即原地压缩），
+// 同时将每条原始指令在压缩后的指令流中的地址记录到 addr_map 中
+// 优化是在输出的指令序列末尾进行匹配的，所以一次替换后产生的新序列可以继续参与后续的匹配（例如多个常量连续折叠），
+// 但是匹配只能回看到 barrier 为止：跳转目标（is_target）对应的指令在输出中的位置之前的指令不能与之后的指令合并，
+// 否则从跳转目标进入时会漏掉被合并到前面的运算
+void peephole_function(Module *m, Block *function, const bool *is_target, uint32_t *addr_map, uint32_t *out) {
+    Instr *code = m->code;
+    uint32_t barrier = *out;
+    uint32_t n = *out;
+
+    for (uint32_t pc = function->start_addr; pc <= function->end_addr; pc++) {
+        Instr ins = code[pc];
+
+        // 被删除的指令对应的地址为其后第一条被保留的指令的地址
+        addr_map[pc] = n;
+        if (is_target[pc]) {
+            barrier = n;
+        }
+
+        // 输出序列末尾可以参与匹配的指令数量，以及末尾的两条指令
+        uint32_t avail = n - barrier;
+        Instr *x = avail >= 2 ? &code[n - 2] : NULL;
+        Instr *y = avail >= 1 ? &code[n - 1] : NULL;
+
+        switch (ins.opcode) {
+            case Nop:
+                // 直接删除空指令
+                continue;
+            case LocalGet:
+                // local.set x; local.get x 替换为 local.tee x
+                if (y && y->opcode == LocalSet && y->a == ins.a) {
+                    y->opcode = LocalTee;
+                    continue;
+                }
+                break;
+            case Drop: {
+                // local.tee x; drop 替换为 local.set x
+                if (y && y->opcode == LocalTee) {
+                    y->opcode = LocalSet;
+                    continue;
+                }
+                // 从输出序列末尾向前查找结果被 drop 丢弃的完整表达式（由无副作用且不会触发陷阱的指令组成），
+                // 找到后连同 drop 一起删除，否则保留原始指令
+                uint32_t pending = 1;
+                uint32_t start = n;
+                while (pending > 0 && start > barrier && pure_arity(code[start - 1].opcode) >= 0) {
+                    pending += pure_arity(code[--start].opcode) - 1;
+                }
+                if (pending == 0) {
+                    n = start;
+                    continue;
+                }
+                break;
+            }
+            default:
+                if (y && pure_arity(ins.opcode) == 1 && fold_unary(ins.opcode, y)) {
+                    continue;
+                }
+                if (x && fold_binary(ins.opcode, x, y)) {
+                    n--;
+                    continue;
+                }
+                if (y && reduce_strength(&ins.opcode, y)) {
+                    if (ins.opcode == Nop) {
+                        n--;
+                        continue;
+                    }
+                }
+                break;
+        }
+
+        code[n++] = ins;
+    }
+
+    *out = n;
+}
+
+// 收集内部指令流中所有跳转指令的目标地址，返回的数组中 is_target[pc] 为 true 表示地址 pc 是某条跳转指令的目标
+static bool *collect_branch_targets(Module *m) {
+    bool *is_target = acalloc(m->code_count, sizeof(bool), "is_target");
+    for (uint32_t pc = 0; pc < m->code_count; pc++) {
+        Instr *ins = &m->code[pc];
+        switch (ins->opcode) {
+            case If:
+            case Else_:
+                is_target[ins->a] = true;
+                break;
+            case Br:
+            case BrIf:
+            case Return:
+                is_target[ins->b.br.addr] = true;
+                break;
+            case BrTable:
+                for (uint32_t n = 0; n <= ins->a; n++) {
+                    is_target[ins->b.table[n].b.br.addr] = true;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return is_target;
+}
+
+// 对所有本地模块定义的函数的内部指令流做窥孔优化，包括常量折叠、将 local.set x; local.get x 替换为 local.tee x、
+// 将乘除以 2 的幂替换为移位运算以及删除结果被 drop 直接丢弃的无副作用表达式
+// 注：删除指令后内部指令流会被原地压缩，所以最后需要通过 remap_code 将所有跳转目标地址以及函数和控制块中记录的地址都换算为压缩后的地址
+void peephole_optimize(Module *m) {
+    bool *is_target = collect_branch_targets(m);
+    uint32_t *addr_map = acalloc(m->code_count + 1, sizeof(uint32_t), "addr_map");
+
+    uint32_t out = 0;
+    for (uint32_t f = m->import_func_count; f < m->function_count; f++) {
+        peephole_function(m, &m->functions[f], is_target, addr_map, &out);
+    }
+    addr_map[m->code_count] = out;
+
+    remap_code(m, out, addr_map);
+    m->code_count = out;
+
+    free(is_target);
+    free(addr_map);
+}
+
+// 内存加载/存储指令（I32Load ... I64Store32）访问的字节数，按操作码顺序排列
+static const uint8_t access_sizes[] = {
+        4, 8, 4, 8, 1, 1, 2, 2, 1, 1, 2, 2, 4, 4,// i32.load ... i64.load32_u
+        4, 8, 4, 8, 1, 2, 1, 2, 4,               // i32.store ... i64.store32
+};
+
+// 同一基本块中以同一个局部变量为地址的一组内存访问，只由其中第一条访问指令（leader）一并做越界检查
+typedef struct AccessGroup {
+    uint32_t local; // 作为地址的局部变量的索引
+    uint32_t leader;// 第一条访问指令的地址
+} AccessGroup;
+
+// 同时跟踪的访问组的最大数量，超出时放弃最早的访问组
+#define MAX_ACCESS_GROUPS 8
+
+// 返回在基本块内部不会改变线性内存的大小、不会产生副作用（局部变量除外）且不会触发除越界访问以外的陷阱的指令 opcode 是否可以出现在访问组中间
+static bool keeps_access_groups(uint16_t opcode) {
+    switch (opcode) {
+        case Nop:
+        case Drop:
+        case Select:
+        case LocalSet:
+        case LocalTee:
+        case I32Load ... I64Load32U:
+        case MemorySize:
+            return true;
+        default:
+            return pure_arity(opcode) >= 0;
     }
 }
 
+// 如果地址 pc 处的内存访问指令的地址（i32 类型）在基本块内部直接来自 local.get 指令，则返回 true 并将局部变量的索引保存到 local
+static bool access_base_local(const Instr *code, uint32_t start, uint32_t pc, const bool *is_target, uint32_t *local) {
+    if (is_target[pc]) {
+        return false;
+    }
+    if (code[pc].opcode <= I64Load32U) {
+        // 加载：local.get x; load
+        if (pc > start && code[pc - 1].opcode == LocalGet) {
+            *local = code[pc - 1].a;
+            return true;
+        }
+        return false;
+    }
+    // 存储：local.get x; (local.get|global.get|const); store，中间的指令只压入待存储的值
+    if (pc < start + 2 || is_target[pc - 1] || code[pc - 2].opcode != LocalGet || pure_arity(code[pc - 1].opcode) != 0) {
+        return false;
+    }
+    *local = code[pc - 2].a;
+    return true;
+}
+
+// 根据越界检查方式（options.bounds）确定每条内存加载/存储指令的越界检查方式（保存在指令的 arity 中，见 ACCESS_*），
+// 并在显式检查时做基本块内的检查合并：同一基本块中以同一个局部变量 x 为地址的多次访问（例如 local.get x; i32.load offset=0 ... local.get x; i32.load offset=8）
+// 只在第一次访问时检查 x 加上这组访问中最大的【内存偏移量加访问字节数】是否越界，之后的访问无需再检查
+// 注：合并只发生在基本块内部，不会将检查提到循环之外，循环体中的访问每次迭代都会检查；
+// 合并的结果只记录在内部指令流中，所以只有栈式解释器受益，寄存器虚拟机（包括 JIT 和 copy-and-patch 执行层）仍然逐条检查
+// 注：第一次访问与之后的访问之间只能出现 keeps_access_groups 允许的指令，这样提前检查到的越界与逐条检查时的结果一致，
+// 都在执行任何存储或者其他有副作用的指令之前触发陷阱，且异常信息相同；x 被重新赋值或者遇到跳转目标时，访问组结束
+// 64 位内存无法使用保护页，每次访问都以 ACCESS_CHECKED64 方式检查，内存偏移量保持在立即数 b 中
+void coalesce_bounds_checks(Module *m) {
+    if (MEMORY_GUARDED(m->memory)) {
+        return;
+    }
+
+    Instr *code = m->code;
+    bool *is_target = collect_branch_targets(m);
+
+    for (uint32_t f = m->import_func_count; f < m->function_count; f++) {
+        Block *function = &m->functions[f];
+        AccessGroup groups[MAX_ACCESS_GROUPS];
+        uint32_t group_count = 0;
+
+        for (uint32_t pc = function->start_addr; pc <= function->end_addr; pc++) {
+            Instr *ins = &code[pc];
+
+            // 跳转目标是新的基本块的开始，所有访问组结束
+            if (is_target[pc]) {
+                group_count = 0;
+            }
+
+            if (ins->opcode < I32Load || ins->opcode > I64Store32) {
+                if (ins->opcode == LocalSet || ins->opcode == LocalTee) {
+                    // 作为地址的局部变量被重新赋值，以其为地址的访问组结束
+                    for (uint32_t g = 0; g < group_count; g++) {
+                        if (groups[g].local == ins->a) {
+                            groups[g] = groups[--group_count];
+                            break;
+                        }
+                    }
+                } else if (!keeps_access_groups(ins->opcode)) {
+                    group_count = 0;
+                }
+                continue;
+            }
+
+            if (m->memory.memory64) {
+                ins->arity = ACCESS_CHECKED64;
+                continue;
+            }
+            if (options.bounds == BoundsMask) {
+                ins->arity = ACCESS_MASKED;
+                continue;
+            }
+
+            // 默认逐条检查，越界检查覆盖的字节数为内存偏移量加访问的字节数
+            ins->arity = ACCESS_CHECKED;
+            ins->b.uint64 = (uint64_t) ins->a + access_sizes[ins->opcode - I32Load];
+
+            uint32_t local;
+            if (access_base_local(code, function->start_addr, pc, is_target, &local)) {
+                uint32_t g = 0;
+                while (g < group_count && groups[g].local != local) {
+                    g++;
+                }
+                if (g < group_count) {
+                    // 加入已有的访问组，由 leader 一并检查
+                    Instr *leader = &code[groups[g].leader];
+                    if (ins->b.uint64 > leader->b.uint64) {
+                        leader->b.uint64 = ins->b.uint64;
+                    }
+                    ins->arity = ACCESS_UNCHECKED;
+                } else {
+                    // 成为新的访问组的 leader
+                    if (group_count == MAX_ACCESS_GROUPS) {
+                        memmove(groups, groups + 1, (MAX_ACCESS_GROUPS - 1) * sizeof(AccessGroup));
+                        group_count--;
+                    }
+                    groups[group_count++] = (AccessGroup){local, pc};
+                }
+            }
+
+            // 存储指令有副作用，之后的访问不能再由之前的 leader 提前检查，所有访问组结束
+            if (ins->opcode >= I32Store) {
+                group_count = 0;
+            }
+        }
+    }
+
+    free(is_target);
+}
+
 // 解析表段中的表 table_type（目前表段只会包含一张表）
 // 表 table_type 编码如下：
 // table_type: 0x70|limits
@@ -244,22 +1378,29 @@ void parse_table_type(Module *m, uint32_t *pos) {
 void parse_memory_type(Module *m, uint32_t *pos) {
     // 由于内存段中只会有一块内存，所以无需遍历
 
-    // flags 为标记位，如果为 0 表示只指定内存大小的下限；为 1 表示既指定内存大小的上限，又指定内存大小的下限
+    // flags 为标记位，其中第 0 位为 1 表示既指定内存大小的上限，又指定内存大小的下限，否则只指定内存大小的下限；
+    // 第 2 位为 1 表示 64 位内存（memory64 提案），此时内存大小的上下限都是 64 位整数
     uint32_t flags = read_LEB_unsigned(m->bytes, pos, 32);
+    bool memory64 = flags & 0x4;
+    uint32_t bits = memory64 ? 64 : 32;
+    // 32 位内存的最大上限为 2GB，64 位内存的页数以 32 位整数保存，最大上限为 MEMORY64_MAX_PAGES
+    uint64_t limit = memory64 ? MEMORY64_MAX_PAGES : 0x8000;
+    m->memory.memory64 = memory64;
+
     // 先读取内存大小的下限，并设置为该内存的初始大小
-    uint32_t pages = read_LEB_unsigned(m->bytes, pos, 32);
-    m->memory.min_size = pages;
-    m->memory.cur_size = pages;
+    uint64_t pages = read_LEB_unsigned(m->bytes, pos, bits);
+    ASSERT(pages <= limit, "Memory minimum size %llu pages is too large\n", (unsigned long long) pages)
+    m->memory.min_size = (uint32_t) pages;
+    m->memory.cur_size = (uint32_t) pages;
 
-    // flags 为 1 表示既指定内存大小上限，又指定内存大小下限
+    // flags 第 0 位为 1 表示既指定内存大小上限，又指定内存大小下限
     if (flags & 0x1) {
-        // 读取内存大小上限
-        pages = read_LEB_unsigned(m->bytes, pos, 32);
-        // 内存大小最大上限为 2GB，如果读取的内存大小上限值超过 2GB，则默认设置 2GB，否则设置为读取的值即可
-        m->memory.max_size = (uint32_t) fmin(0x8000, pages);
+        // 读取内存大小上限，如果读取的内存大小上限值超过最大上限，则默认设置为最大上限，否则设置为读取的值即可
+        pages = read_LEB_unsigned(m->bytes, pos, bits);
+        m->memory.max_size = (uint32_t) (pages < limit ? pages : limit);
     } else {
-        // flags 为 0，表示没有特别指定内存大小上限，所以设置为默认的 2GB 即可
-        m->memory.max_size = 0x8000;
+        // 没有特别指定内存大小上限，所以设置为默认的最大上限即可
+        m->memory.max_size = (uint32_t) limit;
     }
 }
 
@@ -281,7 +1422,9 @@ struct Module *load_module(const uint8_t *bytes, const uint32_t byte_count) {
 
     m->bytes = bytes;
     m->byte_count = byte_count;
-    m->block_lookup = acalloc(m->byte_count, sizeof(Block *), "function->block_lookup");
+
+    // 模块中所有 Block 的 map，其中 key 为对应操作码 Block_/Loop/If 的地址，仅在加载模块期间使用
+    Block **block_lookup = acalloc(m->byte_count, sizeof(Block *), "block_lookup");
 
     // 起始函数索引初始值设置为 -1
     m->start_function = -1;
@@ -365,8 +1508,8 @@ struct Module *load_module(const uint8_t *bytes, const uint32_t byte_count) {
                         type->results[r] = read_LEB_unsigned(bytes, &pos, 32);
                     }
 
-                    // 基于函数签名计算的唯一掩码值
-                    type->mask = get_type_mask(type);
+                    // 将函数签名加入规范类型表，间接调用时通过比较规范类型 ID 校验函数签名
+                    type->type_id = intern_type(type);
                 }
                 break;
             }
@@ -460,6 +1603,8 @@ struct Module *load_module(const uint8_t *bytes, const uint32_t byte_count) {
                             m->functions = arecalloc(m->functions, fidx, m->import_func_count, sizeof(Block), "Block(imports)");
                             // 获取当前的导入函数对应在本地模块的函数
                             Block *func = &m->functions[fidx];
+                            // 设置导入函数在所有函数中的索引
+                            func->fidx = fidx;
                             // 设置【导入函数的导入模块名】为【本地模块中对应函数的导入模块名】
                             func->import_module = import_module;
                             // 设置【导入函数的导入成员名】为【本地模块中对应函数的导入成员名】
@@ -500,6 +1645,9 @@ struct Module *load_module(const uint8_t *bytes, const uint32_t byte_count) {
                             m->memory.max_size = mval->max_size;
                             // 设置【导入内存的存储的数据】为【本地模块内存的存储的数据】
                             m->memory.bytes = mval->bytes;
+                            m->memory.reserved_size = mval->reserved_size;
+                            m->memory.mask = mval->mask;
+                            ASSERT(m->memory.memory64 == mval->memory64, "Imported memory has a different index type\n")
                             break;
                         case KIND_GLOBAL:
                             // 导入项为全局变量的情况
@@ -509,11 +1657,13 @@ struct Module *load_module(const uint8_t *bytes, const uint32_t byte_count) {
 
                             // 为全局变量申请内存，在原有模块本身的全局变量基础上，再添加导入的全局变量对应的全局变量
                             m->globals = arecalloc(m->globals, m->global_count - 1, m->global_count, sizeof(StackValue), "globals");
+                            m->global_types = arecalloc(m->global_types, m->global_count - 1, m->global_count, sizeof(uint8_t), "global_types");
+                            m->global_types[m->global_count - 1] = global_type;
                             // 获取当前的导入全局变量对应在本地模块中的全局变量
                             StackValue *glob = &m->globals[m->global_count - 1];
                             // 设置【导入全局变量的值类型】为【本地模块中对应全局变量的值类型】
                             // 注：变量的值类型主要为 I32/I64/F32/F64
-                            glob->value_type = global_type;
+                            SET_VALUE_TYPE(*glob, global_type)
                             // 根据全局变量的值类型，设置【导入全局变量的值】为【本地模块中对应全局变量的值】
                             switch (global_type) {
                                 case I32:
@@ -618,8 +1768,9 @@ struct Module *load_module(const uint8_t *bytes, const uint32_t byte_count) {
                 // 解析内存段中内存 mem_type（目前模块只会包含一块内存）
                 parse_memory_type(m, &pos);
 
-                // 为存储内存中的数据申请内存（在解析数据段时会用到--将数据段中的数据存储到刚申请的内存中）
-                m->memory.bytes = acalloc(m->memory.cur_size * PAGE_SIZE, sizeof(uint32_t), "Module->memory.bytes");
+                // 为存储内存中的数据预留虚拟地址空间并提交当前页数的内存（在解析数据段时会用到--将数据段中的数据存储到刚申请的内存中）
+                // 注：超出当前页数的部分为保护页，越界访问时产生的 SIGSEGV 信号会被转换为 "out of bounds memory access" 异常
+                memory_init(&m->memory);
                 break;
             }
             case GlobalID: {
@@ -654,6 +1805,8 @@ struct Module *load_module(const uint8_t *bytes, const uint32_t byte_count) {
 
                     // 由于新增一个全局变量，所以需要重新申请内存，调用 arecalloc 函数在原有内存基础上重新申请内存
                     m->globals = arecalloc(m->globals, gidx, m->global_count, sizeof(StackValue), "globals");
+                    m->global_types = arecalloc(m->global_types, gidx, m->global_count, sizeof(uint8_t), "global_types");
+                    m->global_types[gidx] = type;
 
                     // 计算初始化表达式 init_expr，并将计算结果设置为当前全局变量的初始值
                     run_init_expr(m, type, &pos);
@@ -892,18 +2045,22 @@ struct Module *load_module(const uint8_t *bytes, const uint32_t byte_count) {
                     // 目前 Wasm 版本规定一个模块只能定义一块内存，所以 index 只能为 0
                     ASSERT(index == 0, "Only 1 default memory in MVP\n")
 
-                    // 计算初始化表达式 offset_expr，并将计算结果设置为当前内存偏移量 offset
-                    run_init_expr(m, I32, &pos);
+                    // 计算初始化表达式 offset_expr，并将计算结果设置为当前内存偏移量 offset（64 位内存的内存偏移量为 i64 类型）
+                    run_init_expr(m, m->memory.memory64 ? I64 : I32, &pos);
 
                     // 计算初始化表达式 offset_expr 也就是栈式虚拟机执行表达式的字节码中的指令流过程，最终操作数栈顶保存的就是表达式的返回值，即计算结果
                     // 将栈顶的值弹出并赋值给当前内存偏移量 offset
-                    uint32_t offset = m->stack[m->sp--].value.uint32;
+                    uint64_t offset = m->memory.memory64 ? m->stack[m->sp].value.uint64 : m->stack[m->sp].value.uint32;
+                    m->sp--;
 
                     // 读取初始化数据所占内存大小
                     uint32_t size = read_LEB_unsigned(bytes, &pos, 32);
 
-                    // 将写在二进制文件中的初始化数据拷贝到指定偏移量的内存中
-                    memcpy(m->memory.bytes + offset, bytes + pos, size);
+                    // 初始化数据必须完全落在内存的当前字节数之内（显式检查和掩码方式下内存之后没有保护页）
+                    ASSERT(offset <= MEMORY_BYTES(m->memory) && size <= MEMORY_BYTES(m->memory) - offset, "Data segment does not fit in memory\n")
+
+                    // 将写在二进制文件中的初始化数据拷贝（或者直接映射）到指定偏移量的内存中
+                    memory_init_data(&m->memory, offset, bytes, pos, size);
                     pos += size;
                 }
                 break;
@@ -918,8 +2075,46 @@ struct Module *load_module(const uint8_t *bytes, const uint32_t byte_count) {
     }
 
     // 收集所有本地模块定义的函数中 Block_/Loop/If 控制块的相关信息，例如起始地址、结束地址、跳转地址、控制块类型等，
-    // 便于后续虚拟机解释执行指令时可以借助这些信息
-    find_blocks(m);
+    // 便于后续将函数翻译成内部指令流时可以借助这些信息
+    find_blocks(m, block_lookup);
+
+    // 将所有本地模块定义的函数的字节码翻译成定长的内部指令流，后续虚拟机直接执行内部指令流
+    translate_functions(m, block_lookup);
+    free(block_lookup);
+
+    // 将函数体足够小的叶子函数内联到其调用者中
+    if (!options.no_inline) {
+        inline_functions(m);
+    }
+
+    // 对内部指令流做窥孔优化，例如常量折叠、强度削减等，之后所有执行层都基于优化后的内部指令流执行或者翻译
+    if (!options.no_peephole) {
+        peephole_optimize(m);
+    }
+
+    // 根据越界检查方式确定每条内存访问指令如何检查越界，显式检查时合并同一基本块中以同一个局部变量为地址的多次检查（仅栈式解释器）
+    coalesce_bounds_checks(m);
+
+    // 如果选择了寄存器执行层、JIT 执行层或者 copy-and-patch 执行层，则将内部指令流进一步翻译成寄存器指令流
+    if (options.tier == TierRegister || options.tier == TierJit || options.tier == TierStencil) {
+        reg_translate(m);
+    }
+
+    // 如果选择了 JIT 执行层，则将寄存器指令流进一步编译成机器码
+    if (options.tier == TierJit) {
+        jit_compile(m);
+    }
+
+    // 如果选择了 copy-and-patch 执行层，则将寄存器指令流对应的指令模板拼接成机器码
+    if (options.tier == TierStencil) {
+        cp_compile(m);
+    }
+
+    // 将栈式解释器执行的函数中常见的指令序列融合为超级指令
+    // 注：分层执行时所有函数都先由栈式解释器执行，成为热点后才会被翻译成寄存器指令（见 invoke），所以加载模块时无需任何翻译和编译
+    if (!options.no_fusion) {
+        fuse_instructions(m);
+    }
 
     // 起始函数 m->start_function 是在【模块完成初始化后】，【被导出函数可调用之前】自动被调用的函数
     // 可以将起始函数视为一种初始化全局变量或内存的函数，且起始函数必须处于本地模块内部，不能是从外部导入的函数
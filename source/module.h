@@ -1,6 +1,7 @@
 #ifndef WASMC_MODULE_H
 #define WASMC_MODULE_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -11,7 +12,6 @@
 #define STACK_SIZE 0x10000    // 操作数栈的容量 65536，即 64 * 1024，也就是 64KB
 #define CALLSTACK_SIZE 0x1000 // 调用栈的容量 4096，即 4 * 1024，也就是 4KB
 #define BLOCKSTACK_SIZE 0x1000// 控制块栈的容量 4096，即 4 * 1024，也就是 4KB
-#define BR_TABLE_SIZE 0x10000 // 跳转指令索引表大小 65536，即 64 * 1024，也就是 64KB
 
 #define I32 0x7f    // -0x01
 #define I64 0x7e    // -0x02
@@ -43,34 +43,103 @@ typedef enum {
 } SecID;
 
 // 控制块（包含函数）签名结构体
-// 注：目前多返回值提案还没有进入 Wasm 标准，根据当前版本的 Wasm 标准，非函数类型的控制块不能有参数，且最多只能有一个返回值
+// 注：根据多返回值提案，函数和控制块都可以有多个返回值，控制块还可以有参数（此时控制块的签名就是类型段中的函数签名）
 typedef struct Type {
     uint32_t param_count; // 参数数量
     uint32_t *params;     // 参数类型集合
     uint32_t result_count;// 返回值数量
     uint32_t *results;    // 返回值类型集合
-    uint64_t mask;        // 基于控制块（包含函数）签名计算的唯一掩码值
+    uint32_t type_id;     // 规范类型 ID（见 intern_type），签名相同的函数的规范类型 ID 相同（仅针对函数签名）
 } Type;
 
+// 函数的栈帧描述符，在加载模块时预先计算好，调用函数时据此一次性完成栈帧的容量校验以及局部变量的初始化
+typedef struct FrameDesc {
+    uint32_t param_count;      // 参数数量
+    uint32_t local_count;      // 局部变量数量
+    uint32_t max_depth;        // 栈帧在操作数栈中占用的最大槽位数量，即参数、局部变量以及操作数栈最大深度之和
+    uint32_t result_count;     // 返回值数量
+    struct StackValue *locals; // 局部变量的初始值（值为 0，并带有各自的值类型标记），调用时整体拷贝到栈帧中（使用不带类型标记的槽位时为 NULL，直接清零即可）
+} FrameDesc;
+
 // 控制块（包含函数）结构体
 typedef struct Block {
     uint8_t block_type;// 控制块类型，包含 5 种，分别是 0x00: function, 0x01: init_exp, 0x02: block, 0x03: loop, 0x04: if
-    Type *type;        // 控制块签名，即控制块的返回值的数量和类型
+    Type *type;        // 控制块签名，即控制块的参数以及返回值的数量和类型
     uint32_t fidx;     // 函数在所有函数中的索引（仅针对控制块类型为函数的情况）
 
     uint32_t local_count;// 局部变量数量（仅针对控制块类型为函数的情况）
     uint32_t *locals;    // 用于存储局部变量的值（仅针对控制块类型为函数的情况）
+    FrameDesc frame;     // 栈帧描述符（仅针对控制块类型为函数的情况）
 
+    // 注：以下四个地址在 find_blocks 中记录的是字节码中的地址，
+    // 在 translate_functions 将函数翻译成内部指令流之后，统一换算为内部指令流 m->code 中的下标
     uint32_t start_addr;// 控制块中字节码部分的【起始地址】
     uint32_t end_addr;  // 控制块中字节码部分的【结束地址】
     uint32_t else_addr; // 控制块中字节码部分的【else 地址】(仅针对控制块类型为 if 的情况)
     uint32_t br_addr;   // 控制块中字节码部分的【跳转地址】
+    uint32_t height;    // 进入控制块时当前栈帧的操作数栈高度（相对于 fp，包含参数和局部变量），跳转到该控制块时以此恢复操作数栈
 
     char *import_module;// 导入函数的导入模块名（仅针对从外部模块导入的函数）
     char *import_field; // 导入函数的导入成员名（仅针对从外部模块导入的函数）
     void *(*func_ptr)();// 导入函数的实际值（仅针对从外部模块导入的函数）
+
+    struct RInstr *rcode;// 寄存器执行层的指令流（仅针对已被翻译成寄存器指令的函数），为 NULL 表示该函数由栈式解释器执行
+    uint32_t rcode_count;// 寄存器执行层的指令流中的指令数量
+    uint32_t slot_count; // 寄存器执行层中该函数栈帧占用的槽位数量，即参数、局部变量以及操作数栈最大深度之和
+    void *jit_code;      // JIT 编译得到的机器码入口（仅针对已被 JIT 编译的函数），为 NULL 表示该函数未被 JIT 编译
+
+    // 热度计数器（仅针对分层执行）：函数为被调用的次数，loop 类型的控制块为其回边（即跳回循环开头）的执行次数
+    uint32_t hotness;
+
+    // 以下两个字段仅针对所在函数已被翻译成寄存器指令的 loop 类型的控制块，用于分层执行时的栈上替换（OSR）
+    uint32_t osr_addr;// 循环开头在所在函数的寄存器指令流中的地址
+    void *osr_code;   // 循环开头对应的机器码入口，签名与 JitFunction 一致，为 NULL 表示 OSR 后由寄存器虚拟机执行
 } Block;
 
+// 预解码后的内部指令结构体（定长）
+// 在加载模块时，函数的字节码会被翻译成由 Instr 组成的内部指令流，指令的立即数都已提前完成 LEB128 解码，
+// 跳转指令的目标地址也已提前计算好，虚拟机执行时无需再解码立即数或者查找控制块
+typedef struct Instr {
+    uint16_t opcode;// 操作码
+    uint16_t arity; // 跳转时需要携带到目标控制块的值的数量（仅针对跳转指令）；内存加载/存储指令的越界检查方式（ACCESS_*）
+    uint32_t a;     // 立即数 a：局部/全局变量索引、函数索引、类型索引、跳转的目标标签索引、内存偏移量等
+    union {
+        uint32_t uint32;
+        int32_t int32;
+        uint64_t uint64;
+        int64_t int64;
+        float f32;
+        double f64;
+        Block *block;
+        struct {
+            uint32_t addr;  // 跳转的目标地址
+            uint32_t height;// 跳转后当前栈帧的操作数栈高度（相对于 fp，包含参数和局部变量）
+        } br;
+        struct Instr *table;// br_table 指令的跳转表，其中每一项都是一条已经计算好跳转目标的 br 指令
+    } b;// 立即数 b：常量值、跳转目标、控制块、内联缓存的索引、内存加载/存储指令的越界检查所覆盖的字节数或者 64 位内存偏移量等
+} Instr;
+
+// 内存加载/存储指令的越界检查方式，保存在指令的 arity 中（见 coalesce_bounds_checks）
+#define ACCESS_UNCHECKED 0// 无需检查：使用保护页，或者已由同一基本块中更早的访问一并检查过
+#define ACCESS_CHECKED 1  // 显式检查：地址加上立即数 b（越界检查所覆盖的字节数，即内存偏移量加上访问的字节数）不能超出内存的当前字节数
+#define ACCESS_MASKED 2   // 掩码：地址与内存偏移量之和同内存的掩码按位与
+#define ACCESS_CHECKED64 3// 64 位内存的显式检查：i64 类型的地址加上立即数 b（64 位的内存偏移量）再加上访问的字节数不能超出内存的当前字节数
+
+// 寄存器执行层的指令结构体（定长，三地址形式）
+// 与 Instr 不同，RInstr 的操作数不再隐式地位于操作数栈顶，而是直接给出其在当前栈帧中的槽位（slot）编号，
+// 槽位 n 对应 m->stack[m->fp + n]，其中前 param_count + local_count 个槽位为参数和局部变量，之后的槽位为操作数
+typedef struct RInstr {
+    uint16_t opcode;// 操作码
+    uint32_t d;     // 目的操作数的槽位
+    uint32_t a;     // 源操作数 a 的槽位，或者函数索引、全局变量索引等
+    uint32_t b;     // 源操作数 b 的槽位，或者类型索引、栈帧顶部的槽位等
+    union {
+        uint32_t uint32;
+        uint64_t uint64;
+        uint32_t *table;
+    } imm;// 立即数：常量值、内存偏移量、跳转的目标地址、跳转表等
+} RInstr;
+
 // 表结构体
 typedef struct Table {
     uint8_t elem_type;// 表中元素的类型（必须为函数引用，编码为 0x70）
@@ -82,12 +151,40 @@ typedef struct Table {
 
 // 内存结构体
 typedef struct Memory {
-    uint32_t min_size;// 最小页数
-    uint32_t max_size;// 最大页数
-    uint32_t cur_size;// 当前页数
-    uint8_t *bytes;   // 用于存储数据
+    uint32_t min_size;     // 最小页数
+    uint32_t max_size;     // 最大页数
+    uint32_t cur_size;     // 当前页数
+    uint8_t *bytes;        // 用于存储数据
+    uint64_t reserved_size;// 为内存预留的虚拟地址空间的字节数（见 memory.h 中的 memory_init），为 0 表示内存不是由 memory_init 分配的
+    uint64_t mask;         // 越界检查方式为掩码时实际地址的掩码，即为内存分配的字节数（2 的幂次）减 1
+    bool memory64;         // 是否为 64 位内存（memory64 提案），其地址、内存偏移量以及 memory.size/memory.grow 的页数均为 i64 类型
 } Memory;
 
+// call_indirect 指令的内联缓存（inline cache）能够记住的目标数量
+// 注：只有 1 项被使用时为单态（monomorphic）缓存，多于 1 项时为多态（polymorphic）缓存，已满时新的目标依次轮换替换旧的目标
+#define CALL_CACHE_SIZE 4
+
+// call_indirect 指令的内联缓存，每个调用点各有一个
+// 缓存中记录的是该调用点已经成功调用过的【表中的索引】以及对应的被调用函数，也就是函数签名已经校验通过的目标
+// 由于表中的元素只在实例化时由元素段写入，之后不会再改变（当前不支持 table.set/table.grow 等指令），所以表中的索引相同时被调用函数一定相同，
+// 再次遇到相同的表中的索引时，可以跳过表的越界校验、读取表中的函数索引、查找函数以及函数签名和参数类型的校验，直接调用该函数
+typedef struct CallCache {
+    uint32_t slots[CALL_CACHE_SIZE];// 【函数索引值】在表中的索引
+    Block *funcs[CALL_CACHE_SIZE];  // 对应的被调用函数
+    uint32_t count;                 // 已缓存的目标数量
+    uint32_t next;                  // 缓存已满时下一个被替换的位置
+} CallCache;
+
+// 在内联缓存 CACHE 中查找表中的索引 SLOT，找到时将 FUNC 设置为对应的被调用函数，否则设置为 NULL
+#define CALL_CACHE_LOOKUP(CACHE, SLOT, FUNC)                      \
+    FUNC = NULL;                                                  \
+    for (uint32_t _k = 0; _k < (CACHE)->count; _k++) {            \
+        if ((CACHE)->slots[_k] == (SLOT)) {                       \
+            FUNC = (CACHE)->funcs[_k];                            \
+            break;                                                \
+        }                                                         \
+    }
+
 // 导出项结构体
 typedef struct Export {
     char *export_name;     // 导出项成员名
@@ -95,9 +192,21 @@ typedef struct Export {
     void *value;           // 用于存储导出项的值
 } Export;
 
+// 是否使用不带类型标记的 8 字节槽位保存操作数栈、局部变量以及全局变量的值
+// 默认情况下每个槽位除了 8 字节的值之外还带有 1 字节的值类型标记（对齐后每个槽位占 16 字节），每次压栈都要写入该标记，
+// 而对于合法的 Wasm 模块，每条指令的操作数类型在加载模块时就已经确定，运行期间无需再记录类型，
+// 开启该模式后槽位只保存值，操作数栈的内存占用以及读写的内存带宽都减半，
+// 原本依赖类型标记的地方改为使用静态的类型信息：函数签名（打印函数返回值、校验间接调用的函数类型）以及全局变量类型（校验初始化表达式）
+// 注：可以在构建时通过 -DWASMC_UNTAGGED_SLOTS=1 开启
+#ifndef WASMC_UNTAGGED_SLOTS
+#define WASMC_UNTAGGED_SLOTS 0
+#endif
+
 // 全局变量值/操作数栈的值结构体
 typedef struct StackValue {
+#if !WASMC_UNTAGGED_SLOTS
     uint8_t value_type;// 值类型
+#endif
     union {
         uint32_t uint32;
         int32_t int32;
@@ -108,6 +217,13 @@ typedef struct StackValue {
     } value;// 值
 } StackValue;
 
+// 设置槽位 SV 的值类型标记（使用不带类型标记的槽位时为空操作）
+#if WASMC_UNTAGGED_SLOTS
+#define SET_VALUE_TYPE(SV, TYPE)
+#else
+#define SET_VALUE_TYPE(SV, TYPE) (SV).value_type = (TYPE);
+#endif
+
 /*
  * 栈式虚拟机的背景知识：
  * 调用栈--callstack
@@ -157,13 +273,19 @@ typedef struct Module {
     uint32_t import_func_count;// 导入函数的数量
     uint32_t function_count;   // 所有函数的数量（包括导入函数）
     Block *functions;          // 用于存储模块中所有函数（包括导入函数和模块内定义函数）
-    Block **block_lookup;      // 模块中所有 Block 的 map，其中 key 为为对应操作码 Block_/Loop/If 的地址
+
+    Instr *code;        // 内部指令流，所有本地函数的字节码都会被翻译成定长的内部指令并依次存放在这里
+    uint32_t code_count;// 内部指令流中的指令数量
+
+    CallCache *call_caches;   // 所有 call_indirect 指令的内联缓存，指令中保存其对应的缓存在这里的索引
+    uint32_t call_cache_count;// call_indirect 指令的数量
 
     Table table;// 表
 
     Memory memory;// 内存
 
     StackValue *globals;  // 用于存储全局变量的相关数据（值以及值类型等）
+    uint8_t *global_types;// 用于存储全局变量的值类型（不依赖于槽位中的类型标记）
     uint32_t global_count;// 全局变量的数量
 
     Export *exports;      // 用于存储导出项的相关数据（导出项的值、成员名以及类型等）
@@ -172,16 +294,36 @@ typedef struct Module {
     uint32_t start_function;// 起始函数在本地模块所有函数中索引，而起始函数是在【模块完成初始化后】，【被导出函数可调用之前】自动被调用的函数
 
     // 下面属性用于记录运行时（即栈式虚拟机执行指令流的过程）状态，相关背景知识请查看上面栈帧结构体的注释
-    uint32_t pc;                     // program counter 程序计数器，记录下一条即将执行的指令的地址
-    int sp;                          // operand stack pointer 操作数栈顶指针，指向完整的操作数栈顶（注：所有栈帧共享一个完整的操作数栈，分别占用其中的某一部分）
-    int fp;                          // current frame pointer into stack 当前栈帧的帧指针，指向当前栈帧的操作数栈底
-    StackValue stack[STACK_SIZE];    // operand stack 操作数栈，用于存储参数、局部变量、操作数
-    int csp;                         // callstack pointer 调用栈指针，保存处在调用栈顶的栈帧索引，即当前栈帧在调用栈中的索引
-    Frame callstack[CALLSTACK_SIZE]; // callstack 调用栈，用于存储栈帧
-    uint32_t br_table[BR_TABLE_SIZE];// 跳转指令索引表
+    uint32_t pc;                    // program counter 程序计数器，记录下一条即将执行的指令在内部指令流 m->code 中的地址
+    int sp;                         // operand stack pointer 操作数栈顶指针，指向完整的操作数栈顶（注：所有栈帧共享一个完整的操作数栈，分别占用其中的某一部分）
+    int fp;                         // current frame pointer into stack 当前栈帧的帧指针，指向当前栈帧的操作数栈底
+    StackValue stack[STACK_SIZE];   // operand stack 操作数栈，用于存储参数、局部变量、操作数
+    int csp;                        // callstack pointer 调用栈指针，保存处在调用栈顶的栈帧索引，即当前栈帧在调用栈中的索引
+    Frame callstack[CALLSTACK_SIZE];// callstack 调用栈，用于存储栈帧
+    int csp_base;                   // 进入栈式虚拟机时当前栈帧在调用栈中的索引（仅尾调用分派使用，见 interpreter.h 中的 WASMC_TAIL_CALLS）
 } Module;
 
 // 解析 Wasm 二进制文件内容，将其转化成内存格式 Module
 struct Module *load_module(const uint8_t *bytes, uint32_t byte_count);
 
+// 将表中的索引 slot 以及对应的被调用函数 func 组成的目标（函数签名已经校验通过）记录到内联缓存 cache 中
+void call_cache_insert(CallCache *cache, uint32_t slot, Block *func);
+
+// 将函数体足够小的叶子函数内联到其调用者的内部指令流中
+void inline_functions(Module *m);
+
+// 对内部指令流做窥孔优化（常量折叠、强度削减、删除冗余指令等），并将内部指令流原地压缩
+void peephole_optimize(Module *m);
+
+// 根据越界检查方式（options.bounds）确定每条内存加载/存储指令的越界检查方式，并合并同一基本块中可以一并完成的检查
+// 注：只在基本块内部合并，不会将检查提到循环之外，且合并后的检查只由栈式解释器执行
+void coalesce_bounds_checks(Module *m);
+
+// 将函数 function 中常见的指令序列融合为超级指令
+void fuse_function(Module *m, Block *function);
+
+// 将函数 func 中的超级指令还原为融合前的原始指令
+// 注：分层执行时在将函数翻译成寄存器指令之前调用，因为寄存器执行层的翻译只能识别原始指令
+void unfuse_function(Module *m, Block *func);
+
 #endif
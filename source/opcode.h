@@ -1,23 +1,30 @@
 #ifndef WASMC_OPCODE_H
 #define WASMC_OPCODE_H
 
-// 共 178 种指令，可分为 5 大类：
+// 操作码的取值范围，即虚拟机跳转表的大小
+// 注：Wasm 标准的操作码只占 1 个字节（0x00 ~ 0xFF），内部指令流和寄存器指令流中新增的操作码从 0x100 开始编号，
+// 这样即使模块中出现 wasmc 尚未支持的提案中的操作码，也不会被当成内部操作码执行
+#define OPCODE_COUNT 0x110
+
+// 共 180 种指令，可分为 5 大类：
 // 1.控制指令 2.参数指令 3.变量指令 4.内存指令 5.数值指令
 typedef enum {
     /* 控制指令 */
-    Unreachable = 0x00, // unreachable
-    Nop = 0x01,         // nop
-    Block_ = 0x02,      // block rt in* end
-    Loop = 0x03,        // loop rt in* end
-    If = 0x04,          // if rt in* else in* end
-    Else_ = 0x05,       // else
-    End_ = 0x0B,        // end
-    Br = 0x0C,          // br l
-    BrIf = 0x0D,        // br_if l
-    BrTable = 0x0E,     // br_table l* lN
-    Return = 0x0F,      // return
-    Call = 0x10,        // call x
-    CallIndirect = 0x11,// call_indirect x
+    Unreachable = 0x00,       // unreachable
+    Nop = 0x01,               // nop
+    Block_ = 0x02,            // block rt in* end
+    Loop = 0x03,              // loop rt in* end
+    If = 0x04,                // if rt in* else in* end
+    Else_ = 0x05,             // else
+    End_ = 0x0B,              // end
+    Br = 0x0C,                // br l
+    BrIf = 0x0D,              // br_if l
+    BrTable = 0x0E,           // br_table l* lN
+    Return = 0x0F,            // return
+    Call = 0x10,              // call x
+    CallIndirect = 0x11,      // call_indirect x
+    ReturnCall = 0x12,        // return_call x（尾调用提案）
+    ReturnCallIndirect = 0x13,// return_call_indirect x（尾调用提案）
 
     /* 参数指令 */
     Drop = 0x1A,  // drop
@@ -191,6 +198,20 @@ typedef enum {
     I64Extend16S = 0xC3,     // i64.extend16_s
     I64Extend32S = 0xC4,     // i64.extend32_s
     TruncSat = 0xFC,         // <i32|64>.trunc_sat_<f32|64>_<s|u>
+
+    /* 超级指令（superinstruction）
+     * 由常见的指令序列融合而成，只在内部指令流中使用，取值从 0x100 开始，不会与任何 Wasm 操作码重叠
+     * （0xD0 ~ 0xD6 等看似空闲的单字节操作码已被引用类型、函数引用等提案占用）
+     * 具体融合哪些指令序列由 module.c 中的融合规则表 fusion_rules 决定 */
+    LocalGetI32ConstI32Add = 0x100,    // local.get x; i32.const c; i32.add
+    LocalGetI32ConstI32Sub = 0x101,    // local.get x; i32.const c; i32.sub
+    LocalGetLocalGetI32Add = 0x102,    // local.get x; local.get y; i32.add
+    LocalGetLocalGetI32LtSBrIf = 0x103,// local.get x; local.get y; i32.lt_s; br_if l
+    LocalGetI32ConstI32LtSBrIf = 0x104,// local.get x; i32.const c; i32.lt_s; br_if l
+    I32ConstI32GtSBrIf = 0x105,        // i32.const c; i32.gt_s; br_if l
+    LocalTeeBrIf = 0x106,              // local.tee x; br_if l
+    I32ConstLocalSet = 0x107,          // i32.const c; local.set x
+    I32ConstLocalGetI32Store = 0x108,  // i32.const c; local.get x; i32.store m
 } OPCODE;
 
 #endif
@@ -0,0 +1,1681 @@
+#include "regvm.h"
+#include "interpreter.h"
+#include "jit.h"
+#include "memory.h"
+#include "module.h"
+#include "opcode.h"
+#include "utils.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * 寄存器执行层的背景知识：
+ * 栈式解释器中，所有指令的操作数都隐式地位于操作数栈顶，例如 local.get a; local.get b; i32.add; local.set c
+ * 需要将 a 和 b 依次压入操作数栈，相加后再将结果弹出保存到 c，一共 4 次操作数栈的读写和 4 次指令分派
+ * 而寄存器执行层会把栈帧中的每个位置都看作一个寄存器（即槽位 slot），指令直接给出操作数和结果所在的槽位，
+ * 上面的 4 条指令就可以翻译成一条三地址指令 i32.add c, a, b
+ *
+ * 由于 Wasm 经过验证后，每条指令执行前的操作数栈高度在编译期就是确定的，所以操作数栈中第 n 个操作数的槽位也是确定的，
+ * 即 param_count + local_count + n，这样就可以在翻译时静态地计算出每条指令的操作数所在的槽位
+ *
+ * 翻译过程中主要做了以下优化：
+ * 1. local.get 不生成任何指令，只是在翻译时的操作数栈中记录该操作数就是该局部变量（即别名），后续指令直接读取局部变量所在的槽位
+ * 2. local.set/local.tee 如果紧跟在一条计算指令之后，则直接将该计算指令的结果槽位改为局部变量所在的槽位
+ * 3. 控制块不再需要压入/弹出调用栈，跳转指令在翻译时就确定了目标地址，只需要将控制块的返回值拷贝到目标槽位后直接跳转即可
+ *
+ * 注：寄存器执行层和栈式解释器共享同一个操作数栈和调用栈，栈帧布局也完全一致，所以两者之间可以互相调用
+ * */
+
+// 表示不存在的指令地址，例如跳转目标地址链表的结尾
+#define NONE UINT32_MAX
+
+// 翻译过程中使用的控制块（包含函数）信息
+typedef struct Label {
+    uint8_t block_type;// 控制块类型，0x00: function, 0x02: block, 0x03: loop, 0x04: if
+    uint32_t height;   // 进入控制块时的操作数栈高度，控制块的返回值也从该高度对应的槽位开始存放
+    uint32_t arity;    // 控制块的返回值数量
+    uint32_t params;   // 控制块的参数数量（控制块的参数从 height 对应的槽位开始存放，跳转到 loop 类型的控制块时需要携带参数）
+    uint32_t start;    // 控制块起始处在寄存器指令流中的地址（仅针对 loop 类型的控制块，即跳转目标地址）
+    uint32_t else_fixup;// if 控制块中判断条件为 false 时的跳转指令地址，在翻译到 else 分支或者结尾时回填目标地址（仅针对 if 类型的控制块）
+    uint32_t fixups;   // 所有跳转到该控制块结尾的指令组成的链表表头，链表通过指令的 imm.uint32 串联，在翻译到控制块结尾时统一回填目标地址
+} Label;
+
+// 翻译过程中的状态
+typedef struct Translator {
+    Module *m;
+
+    RInstr *code;     // 正在翻译的函数的寄存器指令流
+    uint32_t count;   // 寄存器指令流中的指令数量
+    uint32_t capacity;// 寄存器指令流的容量
+
+    uint32_t *stack;     // 翻译时的操作数栈，记录每个操作数当前所在的槽位（为局部变量的槽位时表示该操作数就是该局部变量的别名）
+    uint32_t height;     // 翻译时的操作数栈高度
+    uint32_t max_height; // 翻译时的操作数栈最大高度
+    uint32_t local_count;// 参数和局部变量的数量，即第一个操作数的槽位
+
+    Label labels[BLOCKSTACK_SIZE];// 控制块栈，其中索引 0 为函数本身
+    int top;                      // 控制块栈顶索引
+
+    int last_def;// 最后一条可以改写结果槽位的计算指令的地址，为 -1 表示不存在
+    bool failed; // 是否翻译失败
+} Translator;
+
+// 发射一条寄存器指令，返回该指令的地址
+static uint32_t emit(Translator *t, uint16_t opcode, uint32_t d, uint32_t a, uint32_t b) {
+    if (t->count == t->capacity) {
+        uint32_t capacity = t->capacity ? t->capacity * 2 : 256;
+        t->code = arecalloc(t->code, t->capacity, capacity, sizeof(RInstr), "RInstr");
+        t->capacity = capacity;
+    }
+    RInstr *r = &t->code[t->count];
+    r->opcode = opcode;
+    r->d = d;
+    r->a = a;
+    r->b = b;
+    r->imm.uint64 = 0;
+    return t->count++;
+}
+
+// 向翻译时的操作数栈压入一个位于槽位 slot 的操作数
+static void push_slot(Translator *t, uint32_t slot) {
+    t->stack[t->height++] = slot;
+    if (t->height > t->max_height) {
+        t->max_height = t->height;
+    }
+}
+
+// 向翻译时的操作数栈压入一个新的操作数，并返回其对应的槽位
+static uint32_t push(Translator *t) {
+    uint32_t slot = t->local_count + t->height;
+    push_slot(t, slot);
+    return slot;
+}
+
+// 从翻译时的操作数栈弹出一个操作数，并返回其当前所在的槽位
+static uint32_t pop(Translator *t) {
+    if (t->height == 0) {
+        t->failed = true;
+        return 0;
+    }
+    return t->stack[--t->height];
+}
+
+// 发射一条结果写入新操作数槽位的计算指令，其结果槽位可以被紧随其后的 local.set/local.tee 改写
+static uint32_t define(Translator *t, uint16_t opcode, uint32_t a, uint32_t b) {
+    uint32_t d = push(t);
+    t->last_def = (int) emit(t, opcode, d, a, b);
+    return t->last_def;
+}
+
+// 如果翻译时操作数栈中第 n 个操作数是局部变量的别名，则将局部变量的值拷贝到该操作数自己的槽位
+static void materialize(Translator *t, uint32_t n) {
+    uint32_t slot = t->local_count + n;
+    if (t->stack[n] != slot) {
+        emit(t, RMove, slot, t->stack[n], 0);
+        t->stack[n] = slot;
+    }
+}
+
+// 将操作数栈中第 from 个到栈顶的所有操作数都拷贝到各自的槽位
+static void materialize_from(Translator *t, uint32_t from) {
+    for (uint32_t n = from; n < t->height; n++) {
+        materialize(t, n);
+    }
+}
+
+// 将所有跳转到当前位置的指令的目标地址回填为当前地址
+// 注：当前位置成为跳转目标后，其前面的计算指令的结果槽位就不能再被改写了
+static void bind(Translator *t, uint32_t fixups) {
+    while (fixups != NONE) {
+        uint32_t next = t->code[fixups].imm.uint32;
+        t->code[fixups].imm.uint32 = t->count;
+        fixups = next;
+    }
+    t->last_def = -1;
+}
+
+// 设置跳转指令 idx 的目标为控制块 l 的跳转地址
+// loop 类型的控制块跳转地址在其开头，已经确定；其余控制块跳转地址在其结尾，需要先加入待回填链表
+static void jump_to(Translator *t, Label *l, uint32_t idx) {
+    if (l->block_type == Loop) {
+        t->code[idx].imm.uint32 = l->start;
+    } else {
+        t->code[idx].imm.uint32 = l->fixups;
+        l->fixups = idx;
+    }
+}
+
+// 跳转到控制块 l 时需要携带的值的数量：跳转到 loop 类型的控制块时携带其参数，跳转到其他控制块时携带其返回值
+static uint32_t label_arity(Label *l) {
+    return l->block_type == Loop ? l->params : l->arity;
+}
+
+// 操作数栈顶的 arity 个值是否已经依次位于控制块 l 的返回值槽位中，即跳转到控制块 l 时无需拷贝
+static bool in_place(Translator *t, Label *l, uint32_t arity) {
+    if (t->height < arity) {
+        return false;
+    }
+    for (uint32_t n = 0; n < arity; n++) {
+        if (t->stack[t->height - arity + n] != t->local_count + l->height + n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 控制块 l 执行结束或者跳转到控制块 l 时，如果需要携带 arity 个值，则需要将操作数栈顶的 arity 个值依次拷贝到控制块的返回值槽位
+// 注：从低到高依次拷贝即可，源槽位要么是局部变量，要么不低于对应的目的槽位，所以不会覆盖尚未拷贝的值
+static void move_result(Translator *t, Label *l, uint32_t arity) {
+    if (t->height < arity) {
+        t->failed = true;
+        return;
+    }
+    for (uint32_t n = 0; n < arity; n++) {
+        uint32_t slot = t->local_count + l->height + n;
+        uint32_t src = t->stack[t->height - arity + n];
+        if (src != slot) {
+            emit(t, RMove, slot, src, 0);
+        }
+    }
+}
+
+// 发射无条件跳转到第 depth 层控制块的指令
+// 注：跳转到函数本身等同于函数返回
+static void branch(Translator *t, uint32_t depth) {
+    Label *l = &t->labels[t->top - depth];
+    if (l->block_type == 0x00) {
+        if (t->height < l->arity) {
+            t->failed = true;
+            return;
+        }
+        if (l->arity <= 1) {
+            emit(t, Return, 0, l->arity ? t->stack[t->height - 1] : 0, 0);
+            return;
+        }
+        // 多个返回值需要位于连续的槽位中，由 pop_block 整体拷贝到调用方的操作数栈顶，所以先将局部变量的别名拷贝到各自的槽位
+        // 注：这里可能位于条件跳转中，所以不能修改翻译时的操作数栈，只发射拷贝指令
+        for (uint32_t n = t->height - l->arity; n < t->height; n++) {
+            if (t->stack[n] != t->local_count + n) {
+                emit(t, RMove, t->local_count + n, t->stack[n], 0);
+            }
+        }
+        emit(t, Return, 0, t->local_count + t->height - 1, 0);
+        return;
+    }
+    move_result(t, l, label_arity(l));
+    jump_to(t, l, emit(t, Br, 0, 0, 0));
+}
+
+// 发射根据槽位 cond 的值决定是否跳转到第 depth 层控制块的指令
+static void branch_if(Translator *t, uint32_t depth, uint32_t cond) {
+    Label *l = &t->labels[t->top - depth];
+    if (l->block_type != 0x00 && in_place(t, l, label_arity(l))) {
+        // 跳转时不需要拷贝返回值，直接条件跳转即可
+        jump_to(t, l, emit(t, BrIf, 0, cond, 0));
+    } else {
+        // 跳转时需要拷贝返回值或者函数返回，则条件不成立时跳过这些指令
+        uint32_t skip = emit(t, RBrUnless, 0, cond, 0);
+        branch(t, depth);
+        t->code[skip].imm.uint32 = t->count;
+    }
+    t->last_def = -1;
+}
+
+// 发射函数调用指令，其中函数参数需要位于各自的槽位，从而成为被调用函数栈帧中的参数
+// 注：对于 call_indirect 指令，d 为该调用点的内联缓存在 m->call_caches 中的索引
+static void call(Translator *t, uint16_t opcode, uint32_t d, uint32_t a, Type *type, uint32_t index) {
+    if (t->height < type->param_count) {
+        t->failed = true;
+        return;
+    }
+    materialize_from(t, t->height - type->param_count);
+    // 立即数 b 为函数参数之后的第一个槽位，调用时以此设置操作数栈顶指针
+    uint32_t idx = emit(t, opcode, d, a, t->local_count + t->height);
+    t->code[idx].imm.uint32 = index;
+    t->height -= type->param_count;
+    for (uint32_t n = 0; n < type->result_count; n++) {
+        push(t);
+    }
+    t->last_def = -1;
+}
+
+// 将操作数栈顶的值保存到局部变量 idx 中，如果 tee 为 true 则不弹出操作数栈顶值
+static void set_local(Translator *t, uint32_t idx, bool tee) {
+    uint32_t src = pop(t);
+    if (src != idx) {
+        // 局部变量的值即将被修改，所以先将操作数栈中该局部变量的别名拷贝到各自的槽位
+        for (uint32_t n = 0; n < t->height; n++) {
+            if (t->stack[n] == idx) {
+                materialize(t, n);
+            }
+        }
+        if (t->last_def >= 0 && (uint32_t) t->last_def == t->count - 1 && t->code[t->last_def].d == src &&
+            src == t->local_count + t->height) {
+            // 栈顶值刚刚由上一条计算指令写入，则直接将该计算指令的结果槽位改为局部变量所在的槽位
+            t->code[t->last_def].d = idx;
+        } else {
+            emit(t, RMove, idx, src, 0);
+        }
+    }
+    t->last_def = -1;
+    if (tee) {
+        push_slot(t, idx);
+    }
+}
+
+// 判断数值指令是否为一元运算（包括测试指令和类型转换指令），否则为二元运算（包括比较指令）
+static bool is_unary(uint16_t opcode) {
+    return opcode == I32Eqz || opcode == I64Eqz ||
+           (opcode >= I32Clz && opcode <= I32PopCnt) ||
+           (opcode >= I64Clz && opcode <= I64PopCnt) ||
+           (opcode >= F32Abs && opcode <= F32Sqrt) ||
+           (opcode >= F64Abs && opcode <= F64Sqrt) ||
+           opcode >= I32WrapI64;
+}
+
+// 将函数 func 的内部指令流翻译成寄存器指令流，如果翻译失败（例如遇到暂不支持的指令）则返回 false
+static bool translate_function(Translator *t, Block *func) {
+    Module *m = t->m;
+    Label *l;
+    uint32_t a, b, cond, idx;
+    bool reachable = true;// 当前指令是否可达（br/br_table/return/unreachable 之后直到控制块结尾的指令都不可达）
+    uint32_t skip = 0;    // 不可达代码中嵌套的控制块层数
+
+    t->count = 0;
+    t->height = 0;
+    t->max_height = 0;
+    t->local_count = func->type->param_count + func->local_count;
+    t->last_def = -1;
+    t->failed = false;
+
+    // 操作数栈的最大高度不会超过栈帧描述符中的最大深度（多返回值的函数调用一次可以压入多个操作数，所以不能以指令数量为上限）
+    t->stack = acalloc(func->frame.max_depth + 1, sizeof(uint32_t), "Translator->stack");
+
+    // 控制块栈底为函数本身
+    t->top = 0;
+    l = &t->labels[0];
+    l->block_type = 0x00;
+    l->height = 0;
+    l->arity = func->type->result_count;
+    l->params = 0;
+    l->else_fixup = NONE;
+    l->fixups = NONE;
+
+    for (uint32_t pc = func->start_addr; pc <= func->end_addr && !t->failed; pc++) {
+        Instr *ins = &m->code[pc];
+        uint16_t opcode = ins->opcode;
+
+        // 跳过不可达的指令，直到当前控制块的 else 分支或者结尾
+        if (!reachable) {
+            if (opcode == Block_ || opcode == Loop || opcode == If) {
+                skip++;
+                continue;
+            }
+            if (opcode != Else_ && opcode != End_) {
+                continue;
+            }
+            if (skip) {
+                if (opcode == End_) {
+                    skip--;
+                }
+                continue;
+            }
+        }
+
+        switch (opcode) {
+            case Unreachable:
+                emit(t, Unreachable, 0, 0, 0);
+                reachable = false;
+                break;
+            case Nop:
+                break;
+            case Block_:
+            case Loop:
+            case If: {
+                Block *block = ins->b.block;
+                cond = opcode == If ? pop(t) : 0;
+                // 控制块内的指令可能执行多次（loop）或者不执行（if），所以进入控制块前需要将局部变量的别名都拷贝到各自的槽位
+                materialize_from(t, 0);
+                if (t->top + 1 >= BLOCKSTACK_SIZE) {
+                    t->failed = true;
+                    break;
+                }
+                if (t->height < block->type->param_count) {
+                    t->failed = true;
+                    break;
+                }
+                // 控制块的参数位于操作数栈顶，从进入控制块时的操作数栈高度对应的槽位开始存放
+                l = &t->labels[++t->top];
+                l->block_type = block->block_type;
+                l->height = t->height - block->type->param_count;
+                l->arity = block->type->result_count;
+                l->params = block->type->param_count;
+                l->start = t->count;
+                if (opcode == Loop) {
+                    // 记录循环开头的地址，栈式解释器执行到该循环的回边时可以据此转移到寄存器指令流中继续执行（OSR）
+                    block->osr_addr = t->count;
+                }
+                l->else_fixup = NONE;
+                l->fixups = NONE;
+                if (opcode == If) {
+                    // 判断条件为 false 时跳转到 else 分支或者结尾，目标地址待回填
+                    l->else_fixup = emit(t, RBrUnless, 0, cond, 0);
+                }
+                t->last_def = -1;
+                break;
+            }
+            case Else_:
+                l = &t->labels[t->top];
+                if (l->else_fixup == NONE) {
+                    t->failed = true;
+                    break;
+                }
+                if (reachable) {
+                    // if 分支执行完成后，将返回值拷贝到控制块的返回值槽位，并跳转到控制块结尾
+                    move_result(t, l, l->arity);
+                    jump_to(t, l, emit(t, Br, 0, 0, 0));
+                }
+                t->code[l->else_fixup].imm.uint32 = t->count;
+                l->else_fixup = NONE;
+                t->last_def = -1;
+                // else 分支开始时操作数栈中只有控制块的参数，进入控制块时已经位于各自的槽位
+                t->height = l->height + l->params;
+                for (uint32_t n = l->height; n < t->height; n++) {
+                    t->stack[n] = t->local_count + n;
+                }
+                reachable = true;
+                break;
+            case End_:
+                l = &t->labels[t->top];
+                if (t->top == 0) {
+                    // 函数结尾，即函数返回
+                    if (reachable) {
+                        branch(t, 0);
+                    }
+                    break;
+                }
+                if (reachable) {
+                    move_result(t, l, l->arity);
+                }
+                if (l->else_fixup != NONE) {
+                    // 没有 else 分支的 if 控制块，判断条件为 false 时直接跳转到结尾
+                    t->code[l->else_fixup].imm.uint32 = t->count;
+                }
+                bind(t, l->fixups);
+                // 控制块结束后，其返回值位于进入控制块时的操作数栈顶之上
+                t->height = l->height;
+                for (uint32_t n = 0; n < l->arity; n++) {
+                    push(t);
+                }
+                t->top--;
+                reachable = true;
+                break;
+            case Br:
+                if (ins->a > (uint32_t) t->top) {
+                    t->failed = true;
+                    break;
+                }
+                branch(t, ins->a);
+                reachable = false;
+                break;
+            case BrIf:
+                if (ins->a > (uint32_t) t->top) {
+                    t->failed = true;
+                    break;
+                }
+                cond = pop(t);
+                branch_if(t, ins->a, cond);
+                break;
+            case BrTable: {
+                // 立即数 a 为索引表的大小，立即数 b 为栈式解释器的跳转表，其中每一项的立即数 a 为目标标签索引
+                // 翻译时为每个不同的目标标签索引生成一段跳转指令，跳转表中直接保存这段跳转指令的地址，
+                // 执行时只需根据操作数查表即可跳转
+                uint32_t count = ins->a;
+                uint32_t *table = acalloc(count + 1, sizeof(uint32_t), "br_table");
+                uint32_t *targets = acalloc(t->top + 1, sizeof(uint32_t), "br_table targets");
+                memset(targets, 0xff, (t->top + 1) * sizeof(uint32_t));
+                uint32_t index = pop(t);
+                idx = emit(t, BrTable, 0, index, count);
+                t->code[idx].imm.table = table;
+                for (uint32_t n = 0; n <= count; n++) {
+                    uint32_t depth = ins->b.table[n].a;
+                    if (depth > (uint32_t) t->top) {
+                        t->failed = true;
+                        break;
+                    }
+                    if (targets[depth] == NONE) {
+                        l = &t->labels[t->top - depth];
+                        if (l->block_type == Loop && in_place(t, l, l->params)) {
+                            targets[depth] = l->start;
+                        } else {
+                            targets[depth] = t->count;
+                            branch(t, depth);
+                        }
+                    }
+                    table[n] = targets[depth];
+                }
+                free(targets);
+                reachable = false;
+                break;
+            }
+            case Return:
+                branch(t, t->top);
+                reachable = false;
+                break;
+            case Call:
+                // 暂不支持调用外部导入函数，交给栈式解释器执行
+                if (ins->a < m->import_func_count) {
+                    t->failed = true;
+                    break;
+                }
+                call(t, Call, 0, ins->a, m->functions[ins->a].type, 0);
+                break;
+            case CallIndirect:
+                // 立即数 imm 为【函数索引值在表中的索引】所在的槽位，d 为该调用点的内联缓存的索引
+                a = pop(t);
+                call(t, CallIndirect, ins->b.uint32, ins->a, &m->types[ins->a], a);
+                break;
+            case ReturnCall:
+                // 尾调用之后的指令不可达
+                if (ins->a < m->import_func_count) {
+                    t->failed = true;
+                    break;
+                }
+                call(t, ReturnCall, 0, ins->a, m->functions[ins->a].type, 0);
+                reachable = false;
+                break;
+            case ReturnCallIndirect:
+                a = pop(t);
+                call(t, ReturnCallIndirect, ins->b.uint32, ins->a, &m->types[ins->a], a);
+                reachable = false;
+                break;
+            case Drop:
+                pop(t);
+                break;
+            case Select:
+                cond = pop(t);
+                b = pop(t);
+                a = pop(t);
+                idx = define(t, Select, a, b);
+                t->code[idx].imm.uint32 = cond;
+                break;
+            case LocalGet:
+                // 不生成任何指令，操作数直接作为该局部变量的别名
+                push_slot(t, ins->a);
+                break;
+            case LocalSet:
+                set_local(t, ins->a, false);
+                break;
+            case LocalTee:
+                set_local(t, ins->a, true);
+                break;
+            case GlobalGet:
+                define(t, GlobalGet, ins->a, 0);
+                break;
+            case GlobalSet:
+                a = pop(t);
+                emit(t, GlobalSet, 0, ins->a, a);
+                break;
+            case I32Load ... I64Load32U:
+                // 立即数 imm 为内存偏移量（64 位内存的内存偏移量保存在立即数 b 中）
+                a = pop(t);
+                idx = define(t, opcode, a, 0);
+                t->code[idx].imm.uint64 = m->memory.memory64 ? ins->b.uint64 : ins->a;
+                break;
+            case I32Store ... I64Store32:
+                b = pop(t);
+                a = pop(t);
+                idx = emit(t, opcode, 0, a, b);
+                t->code[idx].imm.uint64 = m->memory.memory64 ? ins->b.uint64 : ins->a;
+                break;
+            case MemorySize:
+                define(t, MemorySize, 0, 0);
+                break;
+            case MemoryGrow:
+                a = pop(t);
+                define(t, MemoryGrow, a, 0);
+                break;
+            case I32Const ... F64Const:
+                // 立即数 imm 为常量值
+                idx = define(t, opcode, 0, 0);
+                t->code[idx].imm.uint64 = ins->b.uint64;
+                break;
+            case I32Eqz ... I64Extend32S:
+                if (is_unary(opcode)) {
+                    a = pop(t);
+                    define(t, opcode, a, 0);
+                } else {
+                    b = pop(t);
+                    a = pop(t);
+                    define(t, opcode, a, b);
+                }
+                break;
+            case TruncSat:
+                // 立即数 b 用来区分不同类型的浮点数和整数之间的转换
+                a = pop(t);
+                define(t, TruncSat, a, ins->a);
+                break;
+            default:
+                t->failed = true;
+                break;
+        }
+    }
+
+    free(t->stack);
+
+    if (t->failed) {
+        return false;
+    }
+
+    func->rcode = acalloc(t->count, sizeof(RInstr), "Block->rcode");
+    memcpy(func->rcode, t->code, t->count * sizeof(RInstr));
+    func->rcode_count = t->count;
+    func->slot_count = t->local_count + t->max_height;
+    return true;
+}
+
+// 将所有本地模块定义的函数从内部指令流 m->code 翻译成寄存器指令流，保存到函数的 rcode 中
+void reg_translate(Module *m) {
+    Translator *t = acalloc(1, sizeof(Translator), "Translator");
+    t->m = m;
+
+    for (uint32_t f = m->import_func_count; f < m->function_count; f++) {
+        translate_function(t, &m->functions[f]);
+    }
+
+    free(t->code);
+    free(t);
+}
+
+// 将函数 func 从内部指令流 m->code 翻译成寄存器指令流，保存到函数的 rcode 中，如果翻译失败则返回 false
+bool reg_translate_function(Module *m, Block *func) {
+    Translator *t = acalloc(1, sizeof(Translator), "Translator");
+    t->m = m;
+
+    bool result = translate_function(t, func);
+
+    free(t->code);
+    free(t);
+    return result;
+}
+
+// 取指：读取下一条指令，并将程序计数器指向再下一条指令
+#define FETCH() ins = pc++;
+
+#if WASMC_COMPUTED_GOTO
+#define OPCODE(op) L_##op:
+#define NEXT()                                  \
+    do {                                        \
+        FETCH()                                 \
+        goto *dispatch_table[ins->opcode];      \
+    } while (0)
+#else
+#define OPCODE(op) case op:
+#define NEXT() continue
+#endif
+
+// 源操作数 a 所在槽位的值
+#define SRC fp[ins->a].value
+
+// 将计算结果（类型为 TYPE，对应 StackValue 中的 FIELD 字段）写入目的操作数所在的槽位
+#define RESULT(TYPE, FIELD, EXPR)          \
+    fp[ins->d].value.FIELD = (EXPR);       \
+    SET_VALUE_TYPE(fp[ins->d], TYPE)
+
+// 以下宏用于定义数值指令的 handler，其中 EXPR 为计算表达式
+// 注：先将源操作数读取到临时变量中再计算，所以目的操作数和源操作数可以是同一个槽位
+#define I32_UNARY(EXPR)                    \
+    a = SRC.uint32;                        \
+    RESULT(I32, uint32, EXPR)
+
+#define I64_UNARY(EXPR)                    \
+    d = SRC.uint64;                        \
+    RESULT(I64, uint64, EXPR)
+
+#define F32_UNARY(EXPR)                    \
+    g = SRC.f32;                           \
+    RESULT(F32, f32, EXPR)
+
+#define F64_UNARY(EXPR)                    \
+    j = SRC.f64;                           \
+    RESULT(F64, f64, EXPR)
+
+#define BINARY(X, Y, FIELD, TYPE, RFIELD, EXPR) \
+    X = fp[ins->a].value.FIELD;                 \
+    Y = fp[ins->b].value.FIELD;                 \
+    RESULT(TYPE, RFIELD, EXPR)
+
+#define I32_BINARY(EXPR) BINARY(a, b, uint32, I32, uint32, EXPR)
+#define I64_BINARY(EXPR) BINARY(d, e, uint64, I64, uint64, EXPR)
+#define F32_BINARY(EXPR) BINARY(g, h, f32, F32, f32, EXPR)
+#define F64_BINARY(EXPR) BINARY(j, k, f64, F64, f64, EXPR)
+
+// 比较运算的结果为布尔值，用 32 位整数表示
+#define I32_COMPARE(EXPR) BINARY(a, b, uint32, I32, uint32, EXPR)
+#define I64_COMPARE(EXPR) BINARY(d, e, uint64, I32, uint32, EXPR)
+#define F32_COMPARE(EXPR) BINARY(g, h, f32, I32, uint32, EXPR)
+#define F64_COMPARE(EXPR) BINARY(j, k, f64, I32, uint32, EXPR)
+
+// 根据越界检查方式（options.bounds）计算访问 SIZE 个字节的实际内存地址 maddr，其中 ADDR 为保存地址的值（StackValue 中的 value）：
+// 使用保护页时与栈式解释器一致，越界访问由线性内存的保护页捕获（见 memory.c）；
+// 显式检查时如果越界则记录异常信息并返回 false 退出虚拟机执行；掩码时实际地址始终落在为内存分配的空间中
+// 注：寄存器指令中没有记录栈式解释器中合并后的检查（见 coalesce_bounds_checks），所以显式检查时每次访问都要检查；
+// 64 位内存无论 options.bounds 为何值都只能显式检查，地址为 i64 类型
+#define MEMORY_ADDRESS(ADDR, SIZE)                                                          \
+    if (m->memory.memory64) {                                                               \
+        if (memory64_out_of_bounds(&m->memory, (ADDR).uint64, ins->imm.uint64, SIZE)) {     \
+            sprintf(exception, MEMORY_OOB_MESSAGE);                                         \
+            return false;                                                                   \
+        }                                                                                   \
+        maddr = m->memory.bytes + (ADDR).uint64 + ins->imm.uint64;                          \
+    } else if (options.bounds == BoundsGuard) {                                             \
+        maddr = m->memory.bytes + ins->imm.uint32 + (ADDR).uint32;                          \
+    } else if (options.bounds == BoundsExplicit) {                                          \
+        if ((uint64_t) ins->imm.uint32 + (ADDR).uint32 + (SIZE) > MEMORY_BYTES(m->memory)) {\
+            sprintf(exception, MEMORY_OOB_MESSAGE);                                         \
+            return false;                                                                   \
+        }                                                                                   \
+        maddr = m->memory.bytes + ins->imm.uint32 + (ADDR).uint32;                          \
+    } else {                                                                                \
+        maddr = m->memory.bytes + (((uint64_t) ins->imm.uint32 + (ADDR).uint32) & m->memory.mask);\
+    }
+
+// 内存加载：将源操作数（地址）和内存偏移量（立即数 imm）相加得到实际内存地址，
+// 将该地址里保存的 SIZE 个字节拷贝到目的操作数所在的槽位（类型为 TYPE，高位补 0）
+#define LOAD(TYPE, SIZE)                                  \
+    MEMORY_ADDRESS(SRC, SIZE)                             \
+    fp[ins->d].value.uint64 = 0;                          \
+    memcpy(&fp[ins->d].value, maddr, SIZE);               \
+    SET_VALUE_TYPE(fp[ins->d], TYPE)
+
+// 内存存储：将源操作数 a（地址）和内存偏移量（立即数 imm）相加得到实际内存地址，
+// 将源操作数 b（类型对应 StackValue 中的 FIELD 字段）的前 SIZE 个字节拷贝到实际内存地址
+#define STORE(FIELD, SIZE)                                \
+    MEMORY_ADDRESS(SRC, SIZE)                             \
+    memcpy(maddr, &fp[ins->b].value.FIELD, SIZE);
+
+// 整数除法/取余的除数为 0 时，记录异常信息并返回 false 退出虚拟机执行
+#define DIVISOR_CHECK(FIELD)                              \
+    if (fp[ins->b].value.FIELD == 0) {                    \
+        sprintf(exception, "integer divide by zero");     \
+        return false;                                     \
+    }
+
+// 寄存器虚拟机从寄存器指令流 code 中地址为 start 的指令处开始执行，直到遇到 Return 或者 RExit 指令时退出
+// 注：跳转指令的目标地址都是相对于 code 的，所以从指令流中间开始执行时仍需传入指令流的起始地址
+static bool execute(Module *m, RInstr *code, uint32_t start) {
+    StackValue *fp = &m->stack[m->fp];// 当前栈帧的操作数栈底，槽位 n 即 fp[n]
+    RInstr *pc = code + start;        // 程序计数器，指向下一条即将执行的指令
+    RInstr *ins;                      // 当前指令
+    uint32_t fidx;                    // 函数索引
+    uint8_t *maddr;                   // 实际内存地址指针
+    uint32_t a, b;                    // 用于 I32 数值计算
+    uint64_t d, e;                    // 用于 I64 数值计算
+    float g, h;                       // 用于 F32 数值计算
+    double j, k;                      // 用于 F64 数值计算
+
+#if WASMC_COMPUTED_GOTO
+    // 跳转表，其中 key 为操作码，value 为该操作码对应的 handler 的标签地址
+    static const void *const dispatch_table[OPCODE_COUNT] = {
+            [0 ... OPCODE_COUNT - 1] = &&L_Illegal,
+            [Unreachable] = &&L_Unreachable,
+            [Br] = &&L_Br,
+            [BrIf] = &&L_BrIf,
+            [BrTable] = &&L_BrTable,
+            [Return] = &&L_Return,
+            [Call] = &&L_Call,
+            [CallIndirect] = &&L_CallIndirect,
+            [ReturnCall] = &&L_ReturnCall,
+            [ReturnCallIndirect] = &&L_ReturnCallIndirect,
+            [Select] = &&L_Select,
+            [GlobalGet] = &&L_GlobalGet,
+            [GlobalSet] = &&L_GlobalSet,
+            [I32Load] = &&L_I32Load,
+            [I64Load] = &&L_I64Load,
+            [F32Load] = &&L_F32Load,
+            [F64Load] = &&L_F64Load,
+            [I32Load8S] = &&L_I32Load8S,
+            [I32Load8U] = &&L_I32Load8U,
+            [I32Load16S] = &&L_I32Load16S,
+            [I32Load16U] = &&L_I32Load16U,
+            [I64Load8S] = &&L_I64Load8S,
+            [I64Load8U] = &&L_I64Load8U,
+            [I64Load16S] = &&L_I64Load16S,
+            [I64Load16U] = &&L_I64Load16U,
+            [I64Load32S] = &&L_I64Load32S,
+            [I64Load32U] = &&L_I64Load32U,
+            [I32Store] = &&L_I32Store,
+            [I64Store] = &&L_I64Store,
+            [F32Store] = &&L_F32Store,
+            [F64Store] = &&L_F64Store,
+            [I32Store8] = &&L_I32Store8,
+            [I32Store16] = &&L_I32Store16,
+            [I64Store8] = &&L_I64Store8,
+            [I64Store16] = &&L_I64Store16,
+            [I64Store32] = &&L_I64Store32,
+            [MemorySize] = &&L_MemorySize,
+            [MemoryGrow] = &&L_MemoryGrow,
+            [I32Const] = &&L_I32Const,
+            [I64Const] = &&L_I64Const,
+            [F32Const] = &&L_F32Const,
+            [F64Const] = &&L_F64Const,
+            [I32Eqz] = &&L_I32Eqz,
+            [I32Eq] = &&L_I32Eq,
+            [I32Ne] = &&L_I32Ne,
+            [I32LtS] = &&L_I32LtS,
+            [I32LtU] = &&L_I32LtU,
+            [I32GtS] = &&L_I32GtS,
+            [I32GtU] = &&L_I32GtU,
+            [I32LeS] = &&L_I32LeS,
+            [I32LeU] = &&L_I32LeU,
+            [I32GeS] = &&L_I32GeS,
+            [I32GeU] = &&L_I32GeU,
+            [I64Eqz] = &&L_I64Eqz,
+            [I64Eq] = &&L_I64Eq,
+            [I64Ne] = &&L_I64Ne,
+            [I64LtS] = &&L_I64LtS,
+            [I64LtU] = &&L_I64LtU,
+            [I64GtS] = &&L_I64GtS,
+            [I64GtU] = &&L_I64GtU,
+            [I64LeS] = &&L_I64LeS,
+            [I64LeU] = &&L_I64LeU,
+            [I64GeS] = &&L_I64GeS,
+            [I64GeU] = &&L_I64GeU,
+            [F32Eq] = &&L_F32Eq,
+            [F32Ne] = &&L_F32Ne,
+            [F32Lt] = &&L_F32Lt,
+            [F32Gt] = &&L_F32Gt,
+            [F32Le] = &&L_F32Le,
+            [F32Ge] = &&L_F32Ge,
+            [F64Eq] = &&L_F64Eq,
+            [F64Ne] = &&L_F64Ne,
+            [F64Lt] = &&L_F64Lt,
+            [F64Gt] = &&L_F64Gt,
+            [F64Le] = &&L_F64Le,
+            [F64Ge] = &&L_F64Ge,
+            [I32Clz] = &&L_I32Clz,
+            [I32Ctz] = &&L_I32Ctz,
+            [I32PopCnt] = &&L_I32PopCnt,
+            [I32Add] = &&L_I32Add,
+            [I32Sub] = &&L_I32Sub,
+            [I32Mul] = &&L_I32Mul,
+            [I32DivS] = &&L_I32DivS,
+            [I32DivU] = &&L_I32DivU,
+            [I32RemS] = &&L_I32RemS,
+            [I32RemU] = &&L_I32RemU,
+            [I32And] = &&L_I32And,
+            [I32Or] = &&L_I32Or,
+            [I32Xor] = &&L_I32Xor,
+            [I32Shl] = &&L_I32Shl,
+            [I32ShrS] = &&L_I32ShrS,
+            [I32ShrU] = &&L_I32ShrU,
+            [I32Rotl] = &&L_I32Rotl,
+            [I32Rotr] = &&L_I32Rotr,
+            [I64Clz] = &&L_I64Clz,
+            [I64Ctz] = &&L_I64Ctz,
+            [I64PopCnt] = &&L_I64PopCnt,
+            [I64Add] = &&L_I64Add,
+            [I64Sub] = &&L_I64Sub,
+            [I64Mul] = &&L_I64Mul,
+            [I64DivS] = &&L_I64DivS,
+            [I64DivU] = &&L_I64DivU,
+            [I64RemS] = &&L_I64RemS,
+            [I64RemU] = &&L_I64RemU,
+            [I64And] = &&L_I64And,
+            [I64Or] = &&L_I64Or,
+            [I64Xor] = &&L_I64Xor,
+            [I64Shl] = &&L_I64Shl,
+            [I64ShrS] = &&L_I64ShrS,
+            [I64ShrU] = &&L_I64ShrU,
+            [I64Rotl] = &&L_I64Rotl,
+            [I64Rotr] = &&L_I64Rotr,
+            [F32Abs] = &&L_F32Abs,
+            [F32Neg] = &&L_F32Neg,
+            [F32Ceil] = &&L_F32Ceil,
+            [F32Floor] = &&L_F32Floor,
+            [F32Trunc] = &&L_F32Trunc,
+            [F32Nearest] = &&L_F32Nearest,
+            [F32Sqrt] = &&L_F32Sqrt,
+            [F32Add] = &&L_F32Add,
+            [F32Sub] = &&L_F32Sub,
+            [F32Mul] = &&L_F32Mul,
+            [F32Div] = &&L_F32Div,
+            [F32Min] = &&L_F32Min,
+            [F32Max] = &&L_F32Max,
+            [F32CopySign] = &&L_F32CopySign,
+            [F64Abs] = &&L_F64Abs,
+            [F64Neg] = &&L_F64Neg,
+            [F64Ceil] = &&L_F64Ceil,
+            [F64Floor] = &&L_F64Floor,
+            [F64Trunc] = &&L_F64Trunc,
+            [F64Nearest] = &&L_F64Nearest,
+            [F64Sqrt] = &&L_F64Sqrt,
+            [F64Add] = &&L_F64Add,
+            [F64Sub] = &&L_F64Sub,
+            [F64Mul] = &&L_F64Mul,
+            [F64Div] = &&L_F64Div,
+            [F64Min] = &&L_F64Min,
+            [F64Max] = &&L_F64Max,
+            [F64CopySign] = &&L_F64CopySign,
+            [I32WrapI64] = &&L_I32WrapI64,
+            [I32TruncF32S] = &&L_I32TruncF32S,
+            [I32TruncF32U] = &&L_I32TruncF32U,
+            [I32TruncF64S] = &&L_I32TruncF64S,
+            [I32TruncF64U] = &&L_I32TruncF64U,
+            [I64ExtendI32S] = &&L_I64ExtendI32S,
+            [I64ExtendI32U] = &&L_I64ExtendI32U,
+            [I64TruncF32S] = &&L_I64TruncF32S,
+            [I64TruncF32U] = &&L_I64TruncF32U,
+            [I64TruncF64S] = &&L_I64TruncF64S,
+            [I64TruncF64U] = &&L_I64TruncF64U,
+            [F32ConvertI32S] = &&L_F32ConvertI32S,
+            [F32ConvertI32U] = &&L_F32ConvertI32U,
+            [F32ConvertI64S] = &&L_F32ConvertI64S,
+            [F32ConvertI64U] = &&L_F32ConvertI64U,
+            [F32DemoteF64] = &&L_F32DemoteF64,
+            [F64ConvertI32S] = &&L_F64ConvertI32S,
+            [F64ConvertI32U] = &&L_F64ConvertI32U,
+            [F64ConvertI64S] = &&L_F64ConvertI64S,
+            [F64ConvertI64U] = &&L_F64ConvertI64U,
+            [F64PromoteF32] = &&L_F64PromoteF32,
+            [I32ReinterpretF32] = &&L_I32ReinterpretF32,
+            [I64ReinterpretF64] = &&L_I64ReinterpretF64,
+            [F32ReinterpretI32] = &&L_F32ReinterpretI32,
+            [F64ReinterpretI64] = &&L_F64ReinterpretI64,
+            [I32Extend8S] = &&L_I32Extend8S,
+            [I32Extend16S] = &&L_I32Extend16S,
+            [I64Extend8S] = &&L_I64Extend8S,
+            [I64Extend16S] = &&L_I64Extend16S,
+            [I64Extend32S] = &&L_I64Extend32S,
+            [TruncSat] = &&L_TruncSat,
+            [RMove] = &&L_RMove,
+            [RBrUnless] = &&L_RBrUnless,
+            [RExit] = &&L_RExit,
+    };
+
+    NEXT();
+#else
+    while (true) {
+        FETCH()
+
+        switch (ins->opcode) {
+#endif
+            /*
+             * 控制指令
+             * */
+            OPCODE(Unreachable)
+                sprintf(exception, "%s", "unreachable");
+                return false;
+            OPCODE(Br)
+                // 直接跳转到目标地址（保存在立即数 imm 中）
+                pc = code + ins->imm.uint32;
+                NEXT();
+            OPCODE(BrIf)
+                // 如果槽位 a 的值不为 0，则跳转到目标地址
+                if (SRC.uint32) {
+                    pc = code + ins->imm.uint32;
+                }
+                NEXT();
+            OPCODE(RBrUnless)
+                // 如果槽位 a 的值为 0，则跳转到目标地址
+                if (!SRC.uint32) {
+                    pc = code + ins->imm.uint32;
+                }
+                NEXT();
+            OPCODE(BrTable) {
+                // 如果槽位 a 的值小于索引表大小（保存在 b 中），则跳转到跳转表中对应的地址，否则跳转到默认地址（跳转表的最后一项）
+                uint32_t n = SRC.uint32;
+                if (n > ins->b) {
+                    n = ins->b;
+                }
+                pc = code + ins->imm.table[n];
+                NEXT();
+            }
+            OPCODE(RExit)
+                // 直接退出虚拟机执行，不弹出当前函数的栈帧（用于 JIT 编译的代码借助寄存器虚拟机执行单条指令）
+                return true;
+            OPCODE(Return)
+                // 将返回值所在的槽位设置为操作数栈顶，由 pop_block 拷贝到调用方的操作数栈顶，并弹出当前函数的栈帧
+                m->sp = m->fp + (int) ins->a;
+                return pop_block(m) != NULL;
+            OPCODE(Call)
+                // 如果调用栈溢出，则记录异常信息并返回 false 退出虚拟机执行
+                if (m->csp >= CALLSTACK_SIZE - 1) {
+                    sprintf(exception, "call stack exhausted");
+                    return false;
+                }
+                // 函数参数已经位于槽位 b 之前的槽位中，只需设置操作数栈顶指针，再调用函数即可
+                // 函数返回后，返回值位于第一个参数的槽位，同时 m->fp 已恢复为当前栈帧的操作数栈底
+                m->sp = m->fp + (int) ins->b - 1;
+                if (!invoke(m, ins->a)) {
+                    return false;
+                }
+                NEXT();
+            OPCODE(CallIndirect) {
+                // 立即数 imm 所在槽位的值是【函数索引值】在表 table 中的索引
+                uint32_t val = fp[ins->imm.uint32].value.uint32;
+
+                // 查找该调用点的内联缓存（索引保存在 d 中），命中时直接调用缓存的函数，
+                // 未命中时才需要读取表并校验函数签名：如果【实际函数类型】和【指令中对应的函数类型（类型索引保存在 a 中）】不相同，
+                // 则记录异常信息并返回 false 退出虚拟机执行，否则将该目标记录到内联缓存中
+                CallCache *cache = &m->call_caches[ins->d];
+                Block *func;
+                CALL_CACHE_LOOKUP(cache, val, func)
+                if (!func) {
+                    if (val >= m->table.max_size) {
+                        sprintf(exception, "undefined element 0x%x (max: 0x%x) in table", val, m->table.max_size);
+                        return false;
+                    }
+
+                    func = &m->functions[m->table.entries[val]];
+
+                    // TODO: 暂时忽略调用外部引入函数情况
+                    if (func->fidx < m->import_func_count) {
+                        NEXT();
+                    }
+
+                    if (func->type->type_id != m->types[ins->a].type_id) {
+                        sprintf(exception, "indirect call type mismatch (call type and function type differ)");
+                        return false;
+                    }
+                    call_cache_insert(cache, val, func);
+                }
+                fidx = func->fidx;
+
+                if (m->csp >= CALLSTACK_SIZE - 1) {
+                    sprintf(exception, "call stack exhausted");
+                    return false;
+                }
+
+                m->sp = m->fp + (int) ins->b - 1;
+                if (!invoke(m, fidx)) {
+                    return false;
+                }
+                NEXT();
+            }
+            OPCODE(ReturnCall)
+            OPCODE(ReturnCallIndirect) {
+                // 尾调用：被调用函数直接复用当前栈帧（操作数栈底 fp 保持不变）
+                // 如果被调用函数已被 JIT 编译或者未被翻译成寄存器指令，则交给对应的执行层执行，其返回时当前栈帧已被弹出，直接退出即可；
+                // 否则直接切换到被调用函数的寄存器指令流继续执行，不会增加宿主的调用栈深度
+                Block *func = reg_tail_call(m, ins);
+                if (!func) {
+                    return false;
+                }
+                if (func->jit_code) {
+                    return jit_run(m, func);
+                }
+                if (!func->rcode) {
+                    return interpret(m);
+                }
+                if (m->fp + func->slot_count >= STACK_SIZE) {
+                    sprintf(exception, "call stack exhausted");
+                    return false;
+                }
+                code = func->rcode;
+                pc = code;
+                NEXT();
+            }
+
+            /*
+             * 参数指令
+             * */
+            OPCODE(Select)
+                // 如果槽位 imm 的值不为 0，则选择槽位 a 的值，否则选择槽位 b 的值
+                fp[ins->d] = fp[ins->imm.uint32].value.uint32 ? fp[ins->a] : fp[ins->b];
+                NEXT();
+
+            /*
+             * 变量指令
+             * */
+            OPCODE(RMove)
+                fp[ins->d] = fp[ins->a];
+                NEXT();
+            OPCODE(GlobalGet)
+                fp[ins->d] = m->globals[ins->a];
+                NEXT();
+            OPCODE(GlobalSet)
+                m->globals[ins->a] = fp[ins->b];
+                NEXT();
+
+            /*
+             * 内存指令
+             * */
+            OPCODE(I32Load)
+                LOAD(I32, 4)
+                NEXT();
+            OPCODE(I64Load)
+                LOAD(I64, 8)
+                NEXT();
+            OPCODE(F32Load)
+                LOAD(F32, 4)
+                NEXT();
+            OPCODE(F64Load)
+                LOAD(F64, 8)
+                NEXT();
+            OPCODE(I32Load8S)
+                LOAD(I32, 1)
+                sext_8_32(&fp[ins->d].value.uint32);
+                NEXT();
+            OPCODE(I32Load8U)
+                LOAD(I32, 1)
+                NEXT();
+            OPCODE(I32Load16S)
+                LOAD(I32, 2)
+                sext_16_32(&fp[ins->d].value.uint32);
+                NEXT();
+            OPCODE(I32Load16U)
+                LOAD(I32, 2)
+                NEXT();
+            OPCODE(I64Load8S)
+                LOAD(I64, 1)
+                sext_8_64(&fp[ins->d].value.uint64);
+                NEXT();
+            OPCODE(I64Load8U)
+                LOAD(I64, 1)
+                NEXT();
+            OPCODE(I64Load16S)
+                LOAD(I64, 2)
+                sext_16_64(&fp[ins->d].value.uint64);
+                NEXT();
+            OPCODE(I64Load16U)
+                LOAD(I64, 2)
+                NEXT();
+            OPCODE(I64Load32S)
+                LOAD(I64, 4)
+                sext_32_64(&fp[ins->d].value.uint64);
+                NEXT();
+            OPCODE(I64Load32U)
+                LOAD(I64, 4)
+                NEXT();
+            OPCODE(I32Store)
+                STORE(uint32, 4)
+                NEXT();
+            OPCODE(I64Store)
+                STORE(uint64, 8)
+                NEXT();
+            OPCODE(F32Store)
+                STORE(f32, 4)
+                NEXT();
+            OPCODE(F64Store)
+                STORE(f64, 8)
+                NEXT();
+            OPCODE(I32Store8)
+                STORE(uint32, 1)
+                NEXT();
+            OPCODE(I32Store16)
+                STORE(uint32, 2)
+                NEXT();
+            OPCODE(I64Store8)
+                STORE(uint64, 1)
+                NEXT();
+            OPCODE(I64Store16)
+                STORE(uint64, 2)
+                NEXT();
+            OPCODE(I64Store32)
+                STORE(uint64, 4)
+                NEXT();
+            OPCODE(MemorySize)
+                // 64 位内存的页数为 i64 类型
+                RESULT(m->memory.memory64 ? I64 : I32, uint64, m->memory.cur_size)
+                NEXT();
+            OPCODE(MemoryGrow) {
+                // 超过内存最大页数或者宿主无法提供所需的内存时增长失败，结果为 -1（32 位内存为 i32 类型的 0xFFFFFFFF，64 位内存为 i64 类型的全 1）
+                uint32_t prev_pages = m->memory.cur_size;
+                uint64_t delta = m->memory.memory64 ? SRC.uint64 : SRC.uint32;
+                uint64_t pages = prev_pages;
+                if (delta > m->memory.max_size - prev_pages ||
+                    (delta != 0 && !memory_grow(&m->memory, (uint32_t) delta))) {
+                    pages = m->memory.memory64 ? UINT64_MAX : UINT32_MAX;
+                }
+                RESULT(m->memory.memory64 ? I64 : I32, uint64, pages)
+                NEXT();
+            }
+
+            /*
+             * 数值指令--常量指令
+             * */
+            OPCODE(I32Const)
+                RESULT(I32, uint64, ins->imm.uint64)
+                NEXT();
+            OPCODE(I64Const)
+                RESULT(I64, uint64, ins->imm.uint64)
+                NEXT();
+            OPCODE(F32Const)
+                RESULT(F32, uint64, ins->imm.uint64)
+                NEXT();
+            OPCODE(F64Const)
+                RESULT(F64, uint64, ins->imm.uint64)
+                NEXT();
+
+            /*
+             * 数值指令--测试指令和比较指令
+             * */
+            OPCODE(I32Eqz)
+                RESULT(I32, uint32, SRC.uint32 == 0)
+                NEXT();
+            OPCODE(I64Eqz)
+                RESULT(I32, uint32, SRC.uint64 == 0)
+                NEXT();
+            OPCODE(I32Eq)
+                I32_COMPARE(a == b)
+                NEXT();
+            OPCODE(I32Ne)
+                I32_COMPARE(a != b)
+                NEXT();
+            OPCODE(I32LtS)
+                I32_COMPARE((int32_t) a < (int32_t) b)
+                NEXT();
+            OPCODE(I32LtU)
+                I32_COMPARE(a < b)
+                NEXT();
+            OPCODE(I32GtS)
+                I32_COMPARE((int32_t) a > (int32_t) b)
+                NEXT();
+            OPCODE(I32GtU)
+                I32_COMPARE(a > b)
+                NEXT();
+            OPCODE(I32LeS)
+                I32_COMPARE((int32_t) a <= (int32_t) b)
+                NEXT();
+            OPCODE(I32LeU)
+                I32_COMPARE(a <= b)
+                NEXT();
+            OPCODE(I32GeS)
+                I32_COMPARE((int32_t) a >= (int32_t) b)
+                NEXT();
+            OPCODE(I32GeU)
+                I32_COMPARE(a >= b)
+                NEXT();
+            OPCODE(I64Eq)
+                I64_COMPARE(d == e)
+                NEXT();
+            OPCODE(I64Ne)
+                I64_COMPARE(d != e)
+                NEXT();
+            OPCODE(I64LtS)
+                I64_COMPARE((int64_t) d < (int64_t) e)
+                NEXT();
+            OPCODE(I64LtU)
+                I64_COMPARE(d < e)
+                NEXT();
+            OPCODE(I64GtS)
+                I64_COMPARE((int64_t) d > (int64_t) e)
+                NEXT();
+            OPCODE(I64GtU)
+                I64_COMPARE(d > e)
+                NEXT();
+            OPCODE(I64LeS)
+                I64_COMPARE((int64_t) d <= (int64_t) e)
+                NEXT();
+            OPCODE(I64LeU)
+                I64_COMPARE(d <= e)
+                NEXT();
+            OPCODE(I64GeS)
+                I64_COMPARE((int64_t) d >= (int64_t) e)
+                NEXT();
+            OPCODE(I64GeU)
+                I64_COMPARE(d >= e)
+                NEXT();
+            OPCODE(F32Eq)
+                F32_COMPARE(g == h)
+                NEXT();
+            OPCODE(F32Ne)
+                F32_COMPARE(g != h)
+                NEXT();
+            OPCODE(F32Lt)
+                F32_COMPARE(g < h)
+                NEXT();
+            OPCODE(F32Gt)
+                F32_COMPARE(g > h)
+                NEXT();
+            OPCODE(F32Le)
+                F32_COMPARE(g <= h)
+                NEXT();
+            OPCODE(F32Ge)
+                F32_COMPARE(g >= h)
+                NEXT();
+            OPCODE(F64Eq)
+                F64_COMPARE(j == k)
+                NEXT();
+            OPCODE(F64Ne)
+                F64_COMPARE(j != k)
+                NEXT();
+            OPCODE(F64Lt)
+                F64_COMPARE(j < k)
+                NEXT();
+            OPCODE(F64Gt)
+                F64_COMPARE(j > k)
+                NEXT();
+            OPCODE(F64Le)
+                F64_COMPARE(j <= k)
+                NEXT();
+            OPCODE(F64Ge)
+                F64_COMPARE(j >= k)
+                NEXT();
+
+            /*
+             * 数值指令--算术指令
+             * */
+            OPCODE(I32Clz)
+                I32_UNARY(a == 0 ? 32 : __builtin_clz(a))
+                NEXT();
+            OPCODE(I32Ctz)
+                I32_UNARY(a == 0 ? 32 : __builtin_ctz(a))
+                NEXT();
+            OPCODE(I32PopCnt)
+                I32_UNARY(__builtin_popcount(a))
+                NEXT();
+            OPCODE(I32Add)
+                I32_BINARY(a + b)
+                NEXT();
+            OPCODE(I32Sub)
+                I32_BINARY(a - b)
+                NEXT();
+            OPCODE(I32Mul)
+                I32_BINARY(a * b)
+                NEXT();
+            OPCODE(I32DivS)
+                DIVISOR_CHECK(uint32)
+                if (fp[ins->a].value.uint32 == 0x80000000 && fp[ins->b].value.int32 == -1) {
+                    sprintf(exception, "integer overflow");
+                    return false;
+                }
+                I32_BINARY((int32_t) a / (int32_t) b)
+                NEXT();
+            OPCODE(I32DivU)
+                DIVISOR_CHECK(uint32)
+                I32_BINARY(a / b)
+                NEXT();
+            OPCODE(I32RemS)
+                DIVISOR_CHECK(uint32)
+                I32_BINARY((a == 0x80000000 && b == (uint32_t) -1) ? 0 : (int32_t) a % (int32_t) b)
+                NEXT();
+            OPCODE(I32RemU)
+                DIVISOR_CHECK(uint32)
+                I32_BINARY(a % b)
+                NEXT();
+            OPCODE(I32And)
+                I32_BINARY(a & b)
+                NEXT();
+            OPCODE(I32Or)
+                I32_BINARY(a | b)
+                NEXT();
+            OPCODE(I32Xor)
+                I32_BINARY(a ^ b)
+                NEXT();
+            OPCODE(I32Shl)
+                I32_BINARY(a << b)
+                NEXT();
+            OPCODE(I32ShrS)
+                I32_BINARY(((int32_t) a) >> b)
+                NEXT();
+            OPCODE(I32ShrU)
+                I32_BINARY(a >> b)
+                NEXT();
+            OPCODE(I32Rotl)
+                I32_BINARY(rotl32(a, b))
+                NEXT();
+            OPCODE(I32Rotr)
+                I32_BINARY(rotr32(a, b))
+                NEXT();
+            OPCODE(I64Clz)
+                I64_UNARY(d == 0 ? 64 : __builtin_clzll(d))
+                NEXT();
+            OPCODE(I64Ctz)
+                I64_UNARY(d == 0 ? 64 : __builtin_ctzll(d))
+                NEXT();
+            OPCODE(I64PopCnt)
+                I64_UNARY(__builtin_popcountll(d))
+                NEXT();
+            OPCODE(I64Add)
+                I64_BINARY(d + e)
+                NEXT();
+            OPCODE(I64Sub)
+                I64_BINARY(d - e)
+                NEXT();
+            OPCODE(I64Mul)
+                I64_BINARY(d * e)
+                NEXT();
+            OPCODE(I64DivS)
+                DIVISOR_CHECK(uint64)
+                if (fp[ins->a].value.uint64 == 0x8000000000000000 && fp[ins->b].value.int64 == -1) {
+                    sprintf(exception, "integer overflow");
+                    return false;
+                }
+                I64_BINARY((int64_t) d / (int64_t) e)
+                NEXT();
+            OPCODE(I64DivU)
+                DIVISOR_CHECK(uint64)
+                I64_BINARY(d / e)
+                NEXT();
+            OPCODE(I64RemS)
+                DIVISOR_CHECK(uint64)
+                I64_BINARY((d == 0x8000000000000000 && e == (uint64_t) -1) ? 0 : (int64_t) d % (int64_t) e)
+                NEXT();
+            OPCODE(I64RemU)
+                DIVISOR_CHECK(uint64)
+                I64_BINARY(d % e)
+                NEXT();
+            OPCODE(I64And)
+                I64_BINARY(d & e)
+                NEXT();
+            OPCODE(I64Or)
+                I64_BINARY(d | e)
+                NEXT();
+            OPCODE(I64Xor)
+                I64_BINARY(d ^ e)
+                NEXT();
+            OPCODE(I64Shl)
+                I64_BINARY(d << e)
+                NEXT();
+            OPCODE(I64ShrS)
+                I64_BINARY(((int64_t) d) >> e)
+                NEXT();
+            OPCODE(I64ShrU)
+                I64_BINARY(d >> e)
+                NEXT();
+            OPCODE(I64Rotl)
+                I64_BINARY(rotl64(d, e))
+                NEXT();
+            OPCODE(I64Rotr)
+                I64_BINARY(rotr64(d, e))
+                NEXT();
+            OPCODE(F32Abs)
+                F32_UNARY(fabsf(g))
+                NEXT();
+            OPCODE(F32Neg)
+                F32_UNARY(-g)
+                NEXT();
+            OPCODE(F32Ceil)
+                F32_UNARY(ceilf(g))
+                NEXT();
+            OPCODE(F32Floor)
+                F32_UNARY(floorf(g))
+                NEXT();
+            OPCODE(F32Trunc)
+                F32_UNARY(truncf(g))
+                NEXT();
+            OPCODE(F32Nearest)
+                F32_UNARY(rintf(g))
+                NEXT();
+            OPCODE(F32Sqrt)
+                F32_UNARY(sqrtf(g))
+                NEXT();
+            OPCODE(F32Add)
+                F32_BINARY(g + h)
+                NEXT();
+            OPCODE(F32Sub)
+                F32_BINARY(g - h)
+                NEXT();
+            OPCODE(F32Mul)
+                F32_BINARY(g * h)
+                NEXT();
+            OPCODE(F32Div)
+                F32_BINARY(g / h)
+                NEXT();
+            OPCODE(F32Min)
+                F32_BINARY(wa_fminf(g, h))
+                NEXT();
+            OPCODE(F32Max)
+                F32_BINARY(wa_fmaxf(g, h))
+                NEXT();
+            OPCODE(F32CopySign)
+                F32_BINARY(signbit(h) ? -fabsf(g) : fabsf(g))
+                NEXT();
+            OPCODE(F64Abs)
+                F64_UNARY(fabs(j))
+                NEXT();
+            OPCODE(F64Neg)
+                F64_UNARY(-j)
+                NEXT();
+            OPCODE(F64Ceil)
+                F64_UNARY(ceil(j))
+                NEXT();
+            OPCODE(F64Floor)
+                F64_UNARY(floor(j))
+                NEXT();
+            OPCODE(F64Trunc)
+                F64_UNARY(trunc(j))
+                NEXT();
+            OPCODE(F64Nearest)
+                F64_UNARY(rint(j))
+                NEXT();
+            OPCODE(F64Sqrt)
+                F64_UNARY(sqrt(j))
+                NEXT();
+            OPCODE(F64Add)
+                F64_BINARY(j + k)
+                NEXT();
+            OPCODE(F64Sub)
+                F64_BINARY(j - k)
+                NEXT();
+            OPCODE(F64Mul)
+                F64_BINARY(j * k)
+                NEXT();
+            OPCODE(F64Div)
+                F64_BINARY(j / k)
+                NEXT();
+            OPCODE(F64Min)
+                F64_BINARY(wa_fmin(j, k))
+                NEXT();
+            OPCODE(F64Max)
+                F64_BINARY(wa_fmax(j, k))
+                NEXT();
+            OPCODE(F64CopySign)
+                F64_BINARY(signbit(k) ? -fabs(j) : fabs(j))
+                NEXT();
+
+            /*
+             * 数值指令--类型转换指令
+             * */
+            OPCODE(I32WrapI64)
+                RESULT(I32, uint64, SRC.uint64 & 0x00000000ffffffff)
+                NEXT();
+            OPCODE(I32TruncF32S)
+                OP_I32_TRUNC_F32(fp[ins->d].value.int32, SRC.f32)
+                SET_VALUE_TYPE(fp[ins->d], I32)
+                NEXT();
+            OPCODE(I32TruncF32U)
+                OP_U32_TRUNC_F32(fp[ins->d].value.uint32, SRC.f32)
+                SET_VALUE_TYPE(fp[ins->d], I32)
+                NEXT();
+            OPCODE(I32TruncF64S)
+                OP_I32_TRUNC_F64(fp[ins->d].value.int32, SRC.f64)
+                SET_VALUE_TYPE(fp[ins->d], I32)
+                NEXT();
+            OPCODE(I32TruncF64U)
+                OP_U32_TRUNC_F64(fp[ins->d].value.uint32, SRC.f64)
+                SET_VALUE_TYPE(fp[ins->d], I32)
+                NEXT();
+            OPCODE(I64ExtendI32S)
+                RESULT(I64, int64, (int64_t) SRC.int32)
+                NEXT();
+            OPCODE(I64ExtendI32U)
+                RESULT(I64, uint64, (uint64_t) SRC.uint32)
+                NEXT();
+            OPCODE(I64TruncF32S)
+                OP_I64_TRUNC_F32(fp[ins->d].value.int64, SRC.f32)
+                SET_VALUE_TYPE(fp[ins->d], I64)
+                NEXT();
+            OPCODE(I64TruncF32U)
+                OP_U64_TRUNC_F32(fp[ins->d].value.uint64, SRC.f32)
+                SET_VALUE_TYPE(fp[ins->d], I64)
+                NEXT();
+            OPCODE(I64TruncF64S)
+                OP_I64_TRUNC_F64(fp[ins->d].value.int64, SRC.f64)
+                SET_VALUE_TYPE(fp[ins->d], I64)
+                NEXT();
+            OPCODE(I64TruncF64U)
+                OP_U64_TRUNC_F64(fp[ins->d].value.uint64, SRC.f64)
+                SET_VALUE_TYPE(fp[ins->d], I64)
+                NEXT();
+            OPCODE(F32ConvertI32S)
+                RESULT(F32, f32, (float) SRC.int32)
+                NEXT();
+            OPCODE(F32ConvertI32U)
+                RESULT(F32, f32, (float) SRC.uint32)
+                NEXT();
+            OPCODE(F32ConvertI64S)
+                RESULT(F32, f32, (float) SRC.int64)
+                NEXT();
+            OPCODE(F32ConvertI64U)
+                RESULT(F32, f32, (float) SRC.uint64)
+                NEXT();
+            OPCODE(F32DemoteF64)
+                RESULT(F32, f32, (float) SRC.f64)
+                NEXT();
+            OPCODE(F64ConvertI32S)
+                RESULT(F64, f64, (double) SRC.int32)
+                NEXT();
+            OPCODE(F64ConvertI32U)
+                RESULT(F64, f64, (double) SRC.uint32)
+                NEXT();
+            OPCODE(F64ConvertI64S)
+                RESULT(F64, f64, (double) SRC.int64)
+                NEXT();
+            OPCODE(F64ConvertI64U)
+                RESULT(F64, f64, (double) SRC.uint64)
+                NEXT();
+            OPCODE(F64PromoteF32)
+                RESULT(F64, f64, (double) SRC.f32)
+                NEXT();
+            OPCODE(I32ReinterpretF32)
+                RESULT(I32, uint64, SRC.uint64)
+                NEXT();
+            OPCODE(I64ReinterpretF64)
+                RESULT(I64, uint64, SRC.uint64)
+                NEXT();
+            OPCODE(F32ReinterpretI32)
+                RESULT(F32, uint64, SRC.uint64)
+                NEXT();
+            OPCODE(F64ReinterpretI64)
+                RESULT(F64, uint64, SRC.uint64)
+                NEXT();
+            OPCODE(I32Extend8S)
+                RESULT(I32, int32, (int32_t) (int8_t) SRC.int32)
+                NEXT();
+            OPCODE(I32Extend16S)
+                RESULT(I32, int32, (int32_t) (int16_t) SRC.int32)
+                NEXT();
+            OPCODE(I64Extend8S)
+                RESULT(I64, int64, (int64_t) (int8_t) SRC.int64)
+                NEXT();
+            OPCODE(I64Extend16S)
+                RESULT(I64, int64, (int64_t) (int16_t) SRC.int64)
+                NEXT();
+            OPCODE(I64Extend32S)
+                RESULT(I64, int64, (int64_t) (int32_t) SRC.int64)
+                NEXT();
+            OPCODE(TruncSat) {
+                // 饱和截断指令，立即数 b 用来区分不同类型的浮点数和整数之间的转换
+                switch (ins->b) {
+                    case 0x00:
+                        OP_I32_TRUNC_SAT_F32(fp[ins->d].value.int32, SRC.f32)
+                        SET_VALUE_TYPE(fp[ins->d], I32)
+                        break;
+                    case 0x01:
+                        OP_U32_TRUNC_SAT_F32(fp[ins->d].value.uint32, SRC.f32)
+                        SET_VALUE_TYPE(fp[ins->d], I32)
+                        break;
+                    case 0x02:
+                        OP_I32_TRUNC_SAT_F64(fp[ins->d].value.int32, SRC.f64)
+                        SET_VALUE_TYPE(fp[ins->d], I32)
+                        break;
+                    case 0x03:
+                        OP_U32_TRUNC_SAT_F64(fp[ins->d].value.uint32, SRC.f64)
+                        SET_VALUE_TYPE(fp[ins->d], I32)
+                        break;
+                    case 0x04:
+                        OP_I64_TRUNC_SAT_F32(fp[ins->d].value.int64, SRC.f32)
+                        SET_VALUE_TYPE(fp[ins->d], I64)
+                        break;
+                    case 0x05:
+                        OP_U64_TRUNC_SAT_F32(fp[ins->d].value.uint64, SRC.f32)
+                        SET_VALUE_TYPE(fp[ins->d], I64)
+                        break;
+                    case 0x06:
+                        OP_I64_TRUNC_SAT_F64(fp[ins->d].value.int64, SRC.f64)
+                        SET_VALUE_TYPE(fp[ins->d], I64)
+                        break;
+                    case 0x07:
+                        OP_U64_TRUNC_SAT_F64(fp[ins->d].value.uint64, SRC.f64)
+                        SET_VALUE_TYPE(fp[ins->d], I64)
+                        break;
+                    default:
+                        break;
+                }
+                NEXT();
+            }
+#if WASMC_COMPUTED_GOTO
+            L_Illegal:
+#else
+            default:
+#endif
+                // 无法识别的非法操作码
+                sprintf(exception, "illegal opcode 0x%x", ins->opcode);
+                return false;
+#if !WASMC_COMPUTED_GOTO
+        }
+    }
+#endif
+
+    // 正常情况不会执行到这里
+    return false;
+}
+
+Block *reg_tail_call(Module *m, RInstr *ins) {
+    uint32_t fidx = ins->a;
+
+    if (ins->opcode == ReturnCallIndirect) {
+        // 立即数 imm 所在槽位的值是【函数索引值】在表 table 中的索引，a 为指令中对应的函数类型索引，d 为该调用点的内联缓存的索引
+        // 内联缓存命中时直接尾调用缓存的函数，未命中时才需要读取表并校验函数签名
+        uint32_t val = m->stack[m->fp + (int) ins->imm.uint32].value.uint32;
+        CallCache *cache = &m->call_caches[ins->d];
+        Block *func;
+        CALL_CACHE_LOOKUP(cache, val, func)
+        if (!func) {
+            if (val >= m->table.max_size) {
+                sprintf(exception, "undefined element 0x%x (max: 0x%x) in table", val, m->table.max_size);
+                return NULL;
+            }
+
+            func = &m->functions[m->table.entries[val]];
+            if (func->type->type_id != m->types[ins->a].type_id) {
+                sprintf(exception, "indirect call type mismatch (call type and function type differ)");
+                return NULL;
+            }
+            call_cache_insert(cache, val, func);
+        }
+        fidx = func->fidx;
+    }
+
+    // 函数参数已经位于槽位 b 之前的槽位中，设置操作数栈顶指针后即可复用当前栈帧
+    m->sp = m->fp + (int) ins->b - 1;
+    if (!setup_tail_call(m, fidx)) {
+        return NULL;
+    }
+    return &m->functions[fidx];
+}
+
+// 寄存器虚拟机执行函数 func 的寄存器指令流，函数返回时退出
+bool reg_interpret(Module *m, Block *func) {
+    // 如果栈帧所需的槽位超出了操作数栈的容量，则记录异常信息并返回 false 退出虚拟机执行
+    if (m->fp + func->slot_count >= STACK_SIZE) {
+        sprintf(exception, "call stack exhausted");
+        return false;
+    }
+
+    return execute(m, func->rcode, 0);
+}
+
+bool reg_execute(Module *m, RInstr *code) {
+    return execute(m, code, 0);
+}
+
+bool reg_resume(Module *m, Block *func, uint32_t addr) {
+    return execute(m, func->rcode, addr);
+}
@@ -0,0 +1,40 @@
+#ifndef WASMC_REGVM_H
+#define WASMC_REGVM_H
+
+#include "module.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// 寄存器执行层新增的内部操作码（与超级指令一样从 0x100 开始编号，紧随 opcode.h 中的超级指令之后，不会与任何 Wasm 操作码重叠）
+// 注：其余指令直接复用 Wasm 的操作码，只是指令的操作数由隐式的操作数栈顶改为显式的栈帧槽位
+typedef enum {
+    RMove = 0x109,    // 将槽位 a 的值拷贝到槽位 d
+    RBrUnless = 0x10A,// 如果槽位 a 的值为 0，则跳转到立即数指定的地址继续执行
+    RExit = 0x10B,    // 退出寄存器虚拟机且不弹出栈帧（仅用于 JIT 编译的代码借助寄存器虚拟机执行单条指令）
+} ROPCODE;
+
+// 将所有本地模块定义的函数从内部指令流 m->code 翻译成寄存器指令流，保存到函数的 rcode 中
+// 注：无法翻译的函数（例如调用了外部导入函数）的 rcode 保持为 NULL，继续由栈式解释器执行
+void reg_translate(Module *m);
+
+// 将函数 func 从内部指令流 m->code 翻译成寄存器指令流，保存到函数的 rcode 中，如果翻译失败则返回 false
+// 注：用于分层执行时只翻译热点函数，函数中不能包含超级指令（需要先通过 unfuse_function 还原）
+bool reg_translate_function(Module *m, Block *func);
+
+// 寄存器虚拟机执行函数 func 的寄存器指令流，函数返回时退出
+// 注：调用前需要先通过 setup_call 建立该函数的栈帧
+bool reg_interpret(Module *m, Block *func);
+
+// 寄存器虚拟机从 code 处开始执行寄存器指令流，直到遇到 Return 或者 RExit 指令时退出
+// 注：与 reg_interpret 不同，不会校验栈帧所需的槽位是否超出操作数栈的容量，调用方需自行保证
+bool reg_execute(Module *m, RInstr *code);
+
+// 寄存器虚拟机从函数 func 的寄存器指令流中地址为 addr 的指令处开始执行，函数返回时退出
+// 注：用于分层执行时的栈上替换（OSR），调用方需保证当前栈帧的布局与寄存器指令流在该地址处的栈帧布局一致，且栈帧所需的槽位未超出操作数栈的容量
+bool reg_resume(Module *m, Block *func, uint32_t addr);
+
+// 执行尾调用指令 ins（ReturnCall 或者 ReturnCallIndirect）：确定被调用函数，并通过 setup_tail_call 使其复用当前栈帧，
+// 返回被调用函数，之后由调用方从被调用函数的起始地址开始执行；如果出现异常，则记录异常信息并返回 NULL
+Block *reg_tail_call(Module *m, RInstr *ins);
+
+#endif
@@ -17,6 +17,15 @@
 // 全局的异常信息，用于收集运行时（即虚拟机执行指令过程）中的异常信息
 char exception[4096];
 
+// 全局的运行时选项，例如执行层等，由命令行参数在加载模块之前设置
+Options options = {
+        .tier = TierInterp,
+        .hot_tier = TierJit,
+        .hot_calls = 1000,
+        .hot_loops = 10000,
+        .bounds = BoundsGuard,
+};
+
 /*
  * LEB128（Little Endian Base 128）变长编码格式目的是节约空间
  * 对于 32 位整数，编码后可能是 1 到 5 个字节
@@ -146,23 +155,81 @@ bool resolve_sym(char *filename, char *symbol, void **val, char **err) {
     return true;
 }
 
-// 基于函数签名计算唯一的掩码值
-uint64_t get_type_mask(Type *type) {
-    uint64_t mask = 0x80;
+// 规范类型表（canonical type table）：进程中所有模块共享，参数和返回值类型完全相同的函数签名对应同一个规范类型 ID，
+// 所以间接调用时只需比较两个 32 位的规范类型 ID 即可判断函数签名是否相同，跨模块链接时也可以直接使用该 ID
+static Type *canonical_types;      // 所有规范类型，下标即为规范类型 ID
+static uint32_t canonical_count;   // 规范类型的数量
+static uint32_t canonical_capacity;// 规范类型表的容量
+static uint32_t *canonical_buckets;// 以函数签名的哈希值为 key 的开放寻址哈希表，value 为规范类型 ID 加 1，为 0 表示空位
+static uint32_t bucket_count;      // 哈希表的容量（2 的幂）
+
+// 计算函数签名的哈希值（32 位 FNV-1a 哈希）
+static uint32_t hash_type(Type *type) {
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ type->param_count) * 16777619u;
+    for (uint32_t p = 0; p < type->param_count; p++) {
+        hash = (hash ^ type->params[p]) * 16777619u;
+    }
+    hash = (hash ^ type->result_count) * 16777619u;
+    for (uint32_t r = 0; r < type->result_count; r++) {
+        hash = (hash ^ type->results[r]) * 16777619u;
+    }
+    return hash;
+}
+
+// 判断两个函数签名的参数和返回值类型是否完全相同
+static bool same_type(Type *a, Type *b) {
+    return a->param_count == b->param_count && a->result_count == b->result_count &&
+           memcmp(a->params, b->params, a->param_count * sizeof(uint32_t)) == 0 &&
+           memcmp(a->results, b->results, a->result_count * sizeof(uint32_t)) == 0;
+}
+
+// 将函数签名 type 加入规范类型表，返回其规范类型 ID
+uint32_t intern_type(Type *type) {
+    // 哈希表的装载因子超过 1/2 时扩容，并将已有的规范类型重新插入哈希表
+    if ((canonical_count + 1) * 2 > bucket_count) {
+        uint32_t count = bucket_count ? bucket_count * 2 : 64;
+        free(canonical_buckets);
+        canonical_buckets = acalloc(count, sizeof(uint32_t), "canonical type buckets");
+        bucket_count = count;
+        for (uint32_t id = 0; id < canonical_count; id++) {
+            uint32_t b = hash_type(&canonical_types[id]) & (bucket_count - 1);
+            while (canonical_buckets[b]) {
+                b = (b + 1) & (bucket_count - 1);
+            }
+            canonical_buckets[b] = id + 1;
+        }
+    }
 
-    if (type->result_count == 1) {
-        mask |= 0x80 - type->results[0];
+    // 在哈希表中查找签名相同的规范类型
+    uint32_t b = hash_type(type) & (bucket_count - 1);
+    while (canonical_buckets[b]) {
+        if (same_type(&canonical_types[canonical_buckets[b] - 1], type)) {
+            return canonical_buckets[b] - 1;
+        }
+        b = (b + 1) & (bucket_count - 1);
     }
-    mask = mask << 4;
-    for (uint32_t p = 0; p < type->param_count; p++) {
-        mask = ((uint64_t) mask) << 4;
-        mask |= 0x80 - type->params[p];
+
+    // 未找到时新增一个规范类型，保存函数签名的副本，避免依赖于模块中 Type 的生命周期
+    if (canonical_count == canonical_capacity) {
+        uint32_t capacity = canonical_capacity ? canonical_capacity * 2 : 32;
+        canonical_types = arecalloc(canonical_types, canonical_capacity, capacity, sizeof(Type), "canonical types");
+        canonical_capacity = capacity;
     }
-    return mask;
+    Type *canonical = &canonical_types[canonical_count];
+    canonical->param_count = type->param_count;
+    canonical->params = acalloc(type->param_count + 1, sizeof(uint32_t), "canonical type params");
+    memcpy(canonical->params, type->params, type->param_count * sizeof(uint32_t));
+    canonical->result_count = type->result_count;
+    canonical->results = acalloc(type->result_count + 1, sizeof(uint32_t), "canonical type results");
+    memcpy(canonical->results, type->results, type->result_count * sizeof(uint32_t));
+    canonical->type_id = canonical_count;
+
+    canonical_buckets[b] = canonical_count + 1;
+    return canonical_count++;
 }
 
-// 根据目前版本的 Wasm 标准，控制块不能有参数，且最多只能有一个返回值
-// 注：目前多返回值提案还没有进入 Wasm 标准
+// 单字节形式的控制块类型：没有参数，且最多只有一个返回值
 uint32_t block_type_results[4][1] = {{I32}, {I64}, {F32}, {F64}};
 
 Type block_types[5] = {
@@ -186,11 +253,11 @@ Type block_types[5] = {
                 .results = block_type_results[3],
         }};
 
-// 根据表示该控制块的签名的值（占一个字节），返回控制块的签名，即控制块的返回值的数量和类型
-// 0x7f 表示有一个 i32 类型返回值、0x7e 表示有一个 i64 类型返回值、0x7d 表示有一个 f32 类型返回值、0x7c 表示有一个 f64 类型返回值、0x40 表示没有返回值
-// 注：目前多返回值提案还没有进入 Wasm 标准，根据当前版本的 Wasm 标准，控制块不能有参数，且最多只能有一个返回值
-Type *get_block_type(uint8_t value_type) {
-    switch (value_type) {
+// 根据字节码地址 pos 处表示控制块类型的立即数，返回控制块的签名，即控制块的参数以及返回值的数量和类型
+// 0x7f 表示有一个 i32 类型返回值、0x7e 表示有一个 i64 类型返回值、0x7d 表示有一个 f32 类型返回值、0x7c 表示有一个 f64 类型返回值、0x40 表示没有返回值，
+// 除此之外，根据多返回值提案，立即数还可以是以 33 位有符号 LEB128 编码的非负数，表示类型段中的函数签名的索引，此时控制块可以有参数和多个返回值
+Type *get_block_type(Module *m, uint32_t pos) {
+    switch (m->bytes[pos]) {
         case BLOCK:
             return &block_types[0];
         case I32:
@@ -201,8 +268,13 @@ Type *get_block_type(uint8_t value_type) {
             return &block_types[3];
         case F64:
             return &block_types[4];
-        default:
-            FATAL("Invalid block_type value_type: %d\n", value_type)
+        default: {
+            int64_t tidx = (int64_t) read_LEB_signed(m->bytes, &pos, 33);
+            if (tidx < 0 || tidx >= (int64_t) m->type_count) {
+                FATAL("Invalid block_type type index: %lld\n", (long long) tidx)
+            }
+            return &m->types[tidx];
+        }
     }
 }
 
@@ -275,6 +347,10 @@ uint64_t rotr64(uint64_t n, unsigned int c) {
 
 // 32 位浮点型比较两数之间最大值
 float wa_fmaxf(float a, float b) {
+    // 与 C 标准库的 fmaxf 等函数忽略 NaN 操作数不同，Wasm 规范要求只要有一个操作数为 NaN，结果即为 NaN
+    if (isnan(a) || isnan(b)) {
+        return a + b;
+    }
     float c = fmaxf(a, b);
     if (c == 0 && a == b) {
         return signbit(a) ? b : a;
@@ -284,6 +360,9 @@ float wa_fmaxf(float a, float b) {
 
 // 32 位浮点型比较两数之间最小值
 float wa_fminf(float a, float b) {
+    if (isnan(a) || isnan(b)) {
+        return a + b;
+    }
     float c = fminf(a, b);
     if (c == 0 && a == b) {
         return signbit(a) ? a : b;
@@ -293,6 +372,9 @@ float wa_fminf(float a, float b) {
 
 // 64 位浮点型比较两数之间最大值
 double wa_fmax(double a, double b) {
+    if (isnan(a) || isnan(b)) {
+        return a + b;
+    }
     double c = fmax(a, b);
     if (c == 0 && a == b) {
         return signbit(a) ? b : a;
@@ -302,6 +384,9 @@ double wa_fmax(double a, double b) {
 
 // 64 位浮点型比较两数之间最小值
 double wa_fmin(double a, double b) {
+    if (isnan(a) || isnan(b)) {
+        return a + b;
+    }
     double c = fmin(a, b);
     if (c == 0 && a == b) {
         return signbit(a) ? a : b;
@@ -310,9 +395,10 @@ double wa_fmin(double a, double b) {
 }
 
 // 将 StackValue 类型数值用字符串形式展示，展示形式 "<value>:<value_type>"
+// 注：值类型由调用方根据静态的类型信息（例如函数签名中的返回值类型）给出，不依赖于槽位中的类型标记
 char value_str[256];
-char *value_repr(StackValue *v) {
-    switch (v->value_type) {
+char *value_repr(StackValue *v, uint8_t value_type) {
+    switch (value_type) {
         case I32:
             snprintf(value_str, 255, "0x%x:i32", v->value.uint32);
             break;
@@ -343,6 +429,14 @@ void *get_export(Module *m, char *name) {
     return NULL;
 }
 
+// mmap_file 映射过的文件，记录映射得到的内存及其文件描述符
+#define MAPPED_FILE_COUNT 16
+static struct {
+    const uint8_t *bytes;// 映射得到的内存
+    int fd;              // 文件描述符
+} mapped_files[MAPPED_FILE_COUNT];
+static int mapped_file_count = 0;
+
 // 打开文件并将文件映射进内存
 uint8_t *mmap_file(char *path, int *len) {
     int fd;
@@ -369,9 +463,25 @@ uint8_t *mmap_file(char *path, int *len) {
     if (bytes == MAP_FAILED) {
         FATAL("Could not mmap file '%s'", path)
     }
+
+    // 记录文件描述符，超出记录数量时只是无法再次映射该文件中的内容
+    if (mapped_file_count < MAPPED_FILE_COUNT) {
+        mapped_files[mapped_file_count].bytes = bytes;
+        mapped_files[mapped_file_count].fd = fd;
+        mapped_file_count++;
+    }
     return bytes;
 }
 
+int mmap_file_fd(const uint8_t *bytes) {
+    for (int i = 0; i < mapped_file_count; i++) {
+        if (mapped_files[i].bytes == bytes) {
+            return mapped_files[i].fd;
+        }
+    }
+    return -1;
+}
+
 // 将字符串 str 按照空格拆分成多个参数
 // 其中 argc 被赋值为拆分字符串 str 得到的参数数量
 char *argv_buf[100];
@@ -398,7 +508,7 @@ void parse_args(Module *m, Type *type, int argc, char **argv) {
         // 将参数压入到操作数栈顶
         StackValue *sv = &m->stack[m->sp];
         // 设置参数的值类型
-        sv->value_type = type->params[i];
+        SET_VALUE_TYPE(*sv, type->params[i])
         // 按照参数的值类型，设置参数的值
         switch (type->params[i]) {
             case I32:
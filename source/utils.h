@@ -16,6 +16,37 @@ typedef float f32;
 // 用于保存异常信息内容
 extern char exception[];
 
+// 执行层（tier）
+typedef enum {
+    TierInterp,  // 栈式解释器，直接执行翻译得到的内部指令流 m->code（默认）
+    TierRegister,// 寄存器执行层，先将内部指令流进一步翻译成以栈帧槽位为操作数的三地址指令，再交给寄存器虚拟机执行
+    TierJit,     // JIT 执行层，在寄存器执行层的基础上将三地址指令进一步编译成 x86-64 机器码直接执行
+    TierStencil, // copy-and-patch 执行层，在寄存器执行层的基础上将构建时由 C 编译器生成的指令模板拼接成 x86-64 机器码直接执行
+    TierAuto,    // 分层执行，所有函数先由栈式解释器执行，调用次数或者循环回边执行次数达到阈值的函数再提升到 hot_tier 执行
+} Tier;
+
+// 内存加载/存储指令的越界检查方式
+typedef enum {
+    BoundsGuard,   // 保护页，为内存预留 8 GiB 的虚拟地址空间，越界访问由 SIGSEGV 信号捕获，访问时无需任何检查（默认）
+    BoundsExplicit,// 显式检查，每次访问前比较实际地址是否超出内存的当前字节数，只为内存分配实际需要的空间
+    BoundsMask,    // 掩码，将实际地址与掩码按位与，使其始终落在为内存分配的空间中，越界访问不会引发异常，而是回绕到有效的内存上（放弃越界异常的语义）
+} Bounds;
+
+// 运行时选项，需要在加载模块之前设置
+typedef struct Options {
+    Tier tier;         // 执行层
+    bool no_fusion;    // 是否禁用超级指令融合
+    bool no_peephole;  // 是否禁用内部指令流的窥孔优化
+    bool no_inline;    // 是否禁用小函数内联
+    Tier hot_tier;     // 分层执行时热点函数被提升到的执行层（TierRegister/TierJit/TierStencil）
+    uint32_t hot_calls;// 分层执行时函数被提升前的调用次数阈值
+    uint32_t hot_loops;// 分层执行时函数被提升前其中任一循环的回边执行次数阈值
+    Bounds bounds;     // 内存加载/存储指令的越界检查方式
+} Options;
+
+// 用于保存运行时选项
+extern Options options;
+
 // 报错
 #define FATAL(...)                                             \
     {                                                          \
@@ -57,13 +88,14 @@ void *arecalloc(void *ptr, size_t old_nmemb, size_t nmemb, size_t size, char *na
 // 如果解析失败则返回 false 并设置 err
 bool resolve_sym(char *filename, char *symbol, void **val, char **err);
 
-// 基于函数签名计算唯一的掩码值
-uint64_t get_type_mask(Type *type);
+// 将函数签名 type 加入进程中所有模块共享的规范类型表，返回其规范类型 ID，
+// 参数和返回值类型完全相同的函数签名（无论来自哪个模块）得到的规范类型 ID 都相同
+uint32_t intern_type(Type *type);
 
-// 根据表示该控制块的类型的值（占一个字节），返回控制块的类型（或签名），即控制块的返回值的数量和类型
-// 0x7f 表示有一个 i32 类型返回值、0x7e 表示有一个 i64 类型返回值、0x7d 表示有一个 f32 类型返回值、0x7c 表示有一个 f64 类型返回值、0x40 表示没有返回值
-// 注：目前多返回值提案还没有进入 Wasm 标准，根据当前版本的 Wasm 标准，控制块不能有参数，且最多只能有一个返回值
-Type *get_block_type(uint8_t value_type);
+// 根据字节码地址 pos 处表示控制块类型的立即数，返回控制块的类型（或签名），即控制块的参数以及返回值的数量和类型
+// 0x7f 表示有一个 i32 类型返回值、0x7e 表示有一个 i64 类型返回值、0x7d 表示有一个 f32 类型返回值、0x7c 表示有一个 f64 类型返回值、0x40 表示没有返回值，
+// 其余情况为类型段中的函数签名的索引（多返回值提案），此时控制块可以有参数和多个返回值
+Type *get_block_type(Module *m, uint32_t pos);
 
 // 符号扩展 (sign extension)
 // 分以下两种情况：
@@ -154,7 +186,7 @@ double wa_fmin(double a, double b);
 #define OP_U64_TRUNC_SAT_F64(RES, A) OP_TRUNC_SAT(RES, A, u64, -1.0, 18446744073709551616.0, 0ULL, UINT64_MAX)
 
 // 将 StackValue 类型数值用字符串形式展示，展示形式 "<value>:<value_type>"
-char *value_repr(StackValue *v);
+char *value_repr(StackValue *v, uint8_t value_type);
 
 // 通过名称从 Wasm 模块中查找同名的导出项
 void *get_export(Module *m, char *name);
@@ -162,6 +194,10 @@ void *get_export(Module *m, char *name);
 // 打开文件并将文件映射进内存
 uint8_t *mmap_file(char *path, int *len);
 
+// 返回 mmap_file 映射得到的内存 bytes 对应的文件描述符，bytes 不是由 mmap_file 映射得到的则返回 -1
+// 注：文件描述符在进程退出前一直保持打开，可用于将文件中的部分内容再次映射到其他位置（见 memory.c 中的 memory_init_data）
+int mmap_file_fd(const uint8_t *bytes);
+
 // 将字符串 str 按照空格拆分成多个参数
 // 其中 argc 被赋值为拆分字符串 str 得到的参数数量
 char **split_argv(char *str, int *argc);
@@ -0,0 +1,304 @@
+#include <elf.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * 模板库生成器：从 stencils.c 编译得到的目标文件（x86-64 ELF 可重定位文件）中，
+ * 提取每个模板函数的机器码以及重定位信息（即模板中的空洞），生成可被 copypatch.c 直接包含的模板库头文件 stencils.h
+ *
+ * 用法：stencilgen STENCILS_OBJECT OUTPUT_HEADER
+ *
+ * 注：本程序只在构建时运行，只需要处理 stencils.c 在固定编译选项下可能生成的重定位类型，遇到无法处理的情况直接报错退出
+ * */
+
+// 报错并退出
+#define FATAL(...)                                  \
+    {                                               \
+        fprintf(stderr, "stencilgen: ");            \
+        fprintf(stderr, __VA_ARGS__);               \
+        fprintf(stderr, "\n");                      \
+        exit(1);                                    \
+    }
+
+// 空洞对应的外部符号名称，以及对应的空洞种类（HoleKind）
+static const char *const hole_names[][2] = {
+        {"_HOLE_SLOT_D", "HoleSlotD"},
+        {"_HOLE_SLOT_A", "HoleSlotA"},
+        {"_HOLE_SLOT_B", "HoleSlotB"},
+        {"_HOLE_SLOT_C", "HoleSlotC"},
+        {"_HOLE_ARG_A", "HoleArgA"},
+        {"_HOLE_ARG_B", "HoleArgB"},
+        {"_HOLE_IMM32", "HoleImm32"},
+        {"_HOLE_IMM64", "HoleImm64"},
+        {"_HOLE_CONTINUE", "HoleContinue"},
+        {"_HOLE_JUMP", "HoleJump"},
+};
+
+static uint8_t *bytes;      // 目标文件的内容
+static Elf64_Shdr *sections;// 节头表
+static const char *shstrtab;// 节名称字符串表
+static Elf64_Sym *symbols;  // 符号表
+static const char *strtab;  // 符号名称字符串表
+
+static const char *extern_names[256];// 模板调用的外部函数名称
+static int extern_count;             // 模板调用的外部函数数量
+
+// 读取文件的全部内容
+static uint8_t *read_file(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        FATAL("could not open %s", path)
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = malloc(size);
+    if (fread(buf, 1, size, f) != (size_t) size) {
+        FATAL("could not read %s", path)
+    }
+    fclose(f);
+    return buf;
+}
+
+// 节的名称
+static const char *section_name(int idx) {
+    return shstrtab + sections[idx].sh_name;
+}
+
+// 节是否为模板引用的只读数据（例如字符串常量、浮点数常量）
+static bool is_data_section(int idx) {
+    Elf64_Shdr *s = &sections[idx];
+    return (s->sh_flags & SHF_ALLOC) && !(s->sh_flags & SHF_EXECINSTR) && s->sh_size > 0 &&
+           strcmp(section_name(idx), ".rodata.stencil_slot_size") != 0;
+}
+
+// 外部函数名称在 extern_names 中的下标，不存在时追加
+static int extern_index(const char *name) {
+    for (int i = 0; i < extern_count; i++) {
+        if (strcmp(extern_names[i], name) == 0) {
+            return i;
+        }
+    }
+    extern_names[extern_count] = name;
+    return extern_count++;
+}
+
+// 以 C 数组的形式输出字节序列
+static void print_bytes(FILE *out, const uint8_t *data, uint64_t size) {
+    for (uint64_t i = 0; i < size; i++) {
+        fprintf(out, "%s0x%02x,", i % 12 == 0 ? "\n        " : " ", data[i]);
+    }
+    fprintf(out, "\n");
+}
+
+// 输出名称为 name 的模板（对应节 idx 中的机器码）
+static void print_stencil(FILE *out, const char *name, int idx, int *data_index) {
+    Elf64_Shdr *text = &sections[idx];
+    uint8_t *code = bytes + text->sh_offset;
+    int hole_count = 0;
+    bool tail = false;
+
+    fprintf(out, "static const uint8_t %s_code[] = {", name);
+    print_bytes(out, code, text->sh_size);
+    fprintf(out, "};\n");
+
+    // 查找该节对应的重定位节，其中每个重定位项就是模板中的一个空洞
+    fprintf(out, "static const StencilHole %s_holes[] = {\n", name);
+    for (Elf64_Half r = 0; r < ((Elf64_Ehdr *) bytes)->e_shnum; r++) {
+        if (sections[r].sh_type != SHT_RELA || sections[r].sh_info != (Elf64_Word) idx) {
+            continue;
+        }
+        Elf64_Rela *relas = (Elf64_Rela *) (bytes + sections[r].sh_offset);
+        for (uint64_t n = 0; n < sections[r].sh_size / sizeof(Elf64_Rela); n++) {
+            Elf64_Rela *rela = &relas[n];
+            Elf64_Sym *sym = &symbols[ELF64_R_SYM(rela->r_info)];
+            const char *sym_name = strtab + sym->st_name;
+            const char *reloc;
+            const char *kind = NULL;
+            int index = 0;
+            int64_t addend = rela->r_addend;
+
+            switch (ELF64_R_TYPE(rela->r_info)) {
+                case R_X86_64_32:
+                    reloc = "RelocAbs32";
+                    break;
+                case R_X86_64_32S:
+                    reloc = "RelocAbs32S";
+                    break;
+                case R_X86_64_PC32:
+                case R_X86_64_PLT32:
+                    reloc = "RelocRel32";
+                    break;
+                case R_X86_64_64:
+                    reloc = "RelocAbs64";
+                    break;
+                default:
+                    FATAL("%s: unsupported relocation type %d", name, (int) ELF64_R_TYPE(rela->r_info))
+            }
+
+            if (sym->st_shndx == SHN_UNDEF) {
+                // 未定义的符号：要么是空洞，要么是模板调用的外部函数
+                for (size_t h = 0; h < sizeof(hole_names) / sizeof(hole_names[0]); h++) {
+                    if (strcmp(sym_name, hole_names[h][0]) == 0) {
+                        kind = hole_names[h][1];
+                    }
+                }
+                if (!kind) {
+                    kind = "HoleSymbol";
+                    index = extern_index(sym_name);
+                }
+            } else if (sym->st_shndx < SHN_LORESERVE && data_index[sym->st_shndx] >= 0) {
+                // 引用只读数据：附加值需要加上符号在节内的偏移量
+                kind = "HoleData";
+                index = data_index[sym->st_shndx];
+                addend += (int64_t) sym->st_value;
+            } else {
+                FATAL("%s: unsupported reference to '%s'", name, sym_name)
+            }
+
+            // 跳转到其他指令的空洞只能出现在 jmp/jcc 指令中（即尾调用），否则每条指令都会消耗 C 栈
+            if (strcmp(kind, "HoleContinue") == 0 || strcmp(kind, "HoleJump") == 0) {
+                bool is_jmp = rela->r_offset >= 1 && code[rela->r_offset - 1] == 0xE9;
+                bool is_jcc = rela->r_offset >= 2 && code[rela->r_offset - 2] == 0x0F && (code[rela->r_offset - 1] & 0xF0) == 0x80;
+                if (!is_jmp && !is_jcc) {
+                    FATAL("%s: '%s' is not reached through a tail call", name, sym_name)
+                }
+                // 以跳转到下一条指令的 jmp 结尾
+                if (is_jmp && strcmp(kind, "HoleContinue") == 0 && rela->r_offset + 4 == text->sh_size && addend == -4) {
+                    tail = true;
+                }
+            }
+
+            fprintf(out, "        {%" PRIu64 ", %s, %s, %d, %" PRId64 "},\n", (uint64_t) rela->r_offset, kind, reloc, index, addend);
+            hole_count++;
+        }
+    }
+    fprintf(out, "        {0, 0, 0, 0, 0},\n};\n");
+    fprintf(out, "#define %s_STENCIL {%s_code, %" PRIu64 ", %s_holes, %d, %s}\n\n", name, name, (uint64_t) text->sh_size, name, hole_count, tail ? "true" : "false");
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "The right usage is:\n%s STENCILS_OBJECT OUTPUT_HEADER\n", argv[0]);
+        return 2;
+    }
+
+    bytes = read_file(argv[1]);
+    Elf64_Ehdr *ehdr = (Elf64_Ehdr *) bytes;
+    if (memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 || ehdr->e_ident[EI_CLASS] != ELFCLASS64 ||
+        ehdr->e_machine != EM_X86_64 || ehdr->e_type != ET_REL) {
+        FATAL("%s is not an x86-64 relocatable ELF object", argv[1])
+    }
+
+    sections = (Elf64_Shdr *) (bytes + ehdr->e_shoff);
+    shstrtab = (const char *) bytes + sections[ehdr->e_shstrndx].sh_offset;
+
+    uint64_t symbol_count = 0;
+    for (int i = 0; i < ehdr->e_shnum; i++) {
+        if (sections[i].sh_type == SHT_SYMTAB) {
+            symbols = (Elf64_Sym *) (bytes + sections[i].sh_offset);
+            symbol_count = sections[i].sh_size / sizeof(Elf64_Sym);
+            strtab = (const char *) bytes + sections[sections[i].sh_link].sh_offset;
+        }
+    }
+    if (!symbols) {
+        FATAL("%s has no symbol table", argv[1])
+    }
+
+    // 读取模板编译时的槽位字节数
+    uint32_t slot_size = 0;
+    for (uint64_t i = 0; i < symbol_count; i++) {
+        if (strcmp(strtab + symbols[i].st_name, "stencil_slot_size") == 0 && symbols[i].st_shndx < SHN_LORESERVE) {
+            memcpy(&slot_size, bytes + sections[symbols[i].st_shndx].sh_offset + symbols[i].st_value, sizeof(slot_size));
+        }
+    }
+    if (!slot_size) {
+        FATAL("%s does not define stencil_slot_size", argv[1])
+    }
+
+    FILE *out = fopen(argv[2], "w");
+    if (!out) {
+        FATAL("could not open %s", argv[2])
+    }
+
+    fprintf(out, "// 模板库：由 stencilgen 根据 stencils.c 编译得到的目标文件自动生成，请勿手动修改\n");
+    fprintf(out, "// 注：只能在 copypatch.c 中引入，依赖其中已经引入的 copypatch.h、opcode.h 以及 regvm.h\n");
+    fprintf(out, "#ifndef WASMC_STENCILS_H\n#define WASMC_STENCILS_H\n\n");
+    fprintf(out, "// 模板编译时的槽位字节数\n#define STENCIL_SLOT_SIZE %u\n\n", slot_size);
+
+    // 输出模板引用的只读数据
+    int *data_index = malloc(ehdr->e_shnum * sizeof(int));
+    int data_count = 0;
+    for (int i = 0; i < ehdr->e_shnum; i++) {
+        data_index[i] = -1;
+        if (!is_data_section(i)) {
+            continue;
+        }
+        if (sections[i].sh_flags & SHF_WRITE) {
+            FATAL("stencils must not use writable data (section %s)", section_name(i))
+        }
+        data_index[i] = data_count++;
+        fprintf(out, "static const uint8_t stencil_data_%d[] = {", data_index[i]);
+        if (sections[i].sh_type == SHT_NOBITS) {
+            uint8_t *zeros = calloc(sections[i].sh_size, 1);
+            print_bytes(out, zeros, sections[i].sh_size);
+            free(zeros);
+        } else {
+            print_bytes(out, bytes + sections[i].sh_offset, sections[i].sh_size);
+        }
+        fprintf(out, "};\n");
+    }
+    fprintf(out, "\nstatic const StencilData stencil_data[] = {\n");
+    for (int i = 0; i < ehdr->e_shnum; i++) {
+        if (data_index[i] >= 0) {
+            fprintf(out, "        {stencil_data_%d, %" PRIu64 ", %" PRIu64 "},\n", data_index[i],
+                    (uint64_t) sections[i].sh_size, (uint64_t) (sections[i].sh_addralign ? sections[i].sh_addralign : 1));
+        }
+    }
+    fprintf(out, "        {NULL, 0, 1},\n};\n#define STENCIL_DATA_COUNT %d\n\n", data_count);
+
+    // 输出所有模板：.text.op_XXX 节为操作码 XXX 的模板，.text.aux_XXX 节为辅助模板 stencil_XXX
+    char names[1024][64];
+    int opcode_count = 0;
+    for (int i = 0; i < ehdr->e_shnum; i++) {
+        const char *sname = section_name(i);
+        if (sections[i].sh_type != SHT_PROGBITS || !(sections[i].sh_flags & SHF_EXECINSTR) || sections[i].sh_size == 0) {
+            continue;
+        }
+        if (strncmp(sname, ".text.op_", 9) == 0) {
+            snprintf(names[opcode_count], sizeof(names[0]), "%s", sname + 9);
+            print_stencil(out, names[opcode_count], i, data_index);
+            opcode_count++;
+        } else if (strncmp(sname, ".text.aux_", 10) == 0) {
+            char name[80];
+            snprintf(name, sizeof(name), "stencil_%s", sname + 10);
+            print_stencil(out, name, i, data_index);
+            fprintf(out, "static const Stencil %s = %s_STENCIL;\n\n", name, name);
+        } else {
+            FATAL("unexpected code section %s", sname)
+        }
+    }
+
+    fprintf(out, "// 操作码对应的模板，没有模板的操作码通过 stencil_fallback 借助寄存器虚拟机执行\n");
+    fprintf(out, "static const Stencil stencils[OPCODE_COUNT] = {\n");
+    for (int i = 0; i < opcode_count; i++) {
+        fprintf(out, "        [%s] = %s_STENCIL,\n", names[i], names[i]);
+    }
+    fprintf(out, "};\n\n");
+
+    // 输出模板调用的外部函数名称
+    fprintf(out, "// 模板调用的外部函数\nstatic const char *const stencil_symbols[] = {\n");
+    for (int i = 0; i < extern_count; i++) {
+        fprintf(out, "        \"%s\",\n", extern_names[i]);
+    }
+    fprintf(out, "        NULL,\n};\n#define STENCIL_SYMBOL_COUNT %d\n\n#endif\n", extern_count);
+
+    fclose(out);
+    free(data_index);
+    free(bytes);
+    return 0;
+}
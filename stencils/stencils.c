@@ -0,0 +1,633 @@
+#include "copypatch.h"
+#include "interpreter.h"
+#include "jit.h"
+#include "module.h"
+#include "opcode.h"
+#include "regvm.h"
+#include "utils.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * copy-and-patch 后端的模板（stencil）库
+ *
+ * 本文件不会被链接进 wasmc，而是在构建时以固定的编译选项（-fno-pic -ffunction-sections 等）单独编译成目标文件，
+ * 再由 stencilgen 从目标文件中提取出每个函数的机器码以及重定位信息，生成模板库 stencils.h
+ *
+ * 每个以 op_ 开头的函数就是对应操作码的模板，函数签名与 JitFunction 一致，
+ * 其中的操作数槽位、立即数、下一条指令的地址等都通过引用以 _HOLE_ 开头的外部符号来表示，
+ * 编译器会为这些引用生成重定位项，即模板中的空洞（hole），运行时拼接模板时再根据具体指令填补这些空洞
+ *
+ * 模板执行完成后通过尾调用 _HOLE_CONTINUE 跳转到下一条指令的模板，编译器会将其编译成一条 jmp 指令，
+ * 所以拼接后的机器码中模板之间是直接跳转（或者顺序执行）的，不需要任何分派
+ *
+ * 模板的指令语义与寄存器虚拟机 reg_execute 完全一致，并直接复用 utils.h 中的 OP_TRUNC 系列宏、wa_fmin/wa_fmax、rotl32 等公共方法
+ * */
+
+// 空洞对应的外部符号，编译器会为这些符号的引用生成重定位项
+extern char _HOLE_SLOT_D[], _HOLE_SLOT_A[], _HOLE_SLOT_B[], _HOLE_SLOT_C[];
+extern char _HOLE_ARG_A[], _HOLE_ARG_B[], _HOLE_IMM32[];
+extern const uint64_t _HOLE_IMM64;
+extern bool _HOLE_CONTINUE(Module *m, StackValue *fp);
+extern bool _HOLE_JUMP(Module *m, StackValue *fp);
+
+// 模板中的异常处理统一通过 cp_trap 记录异常信息，这样模板就不需要引用全局变量 exception
+// 注：OP_TRUNC 等宏中的 sprintf(exception, ...) 也会被替换成 cp_trap
+#undef sprintf
+#define sprintf(BUF, MESSAGE) cp_trap(MESSAGE)
+
+// 槽位的字节数，stencilgen 会将其写入模板库，运行时据此确认模板与当前构建的槽位格式一致
+const uint32_t stencil_slot_size = sizeof(StackValue);
+
+// 空洞所表示的值
+#define HOLE(H) ((uintptr_t) (H))
+
+// 空洞所表示的 32 位无符号值
+// 注：编译器默认符号的地址位于低 2GB，可能会将空洞编码为符号扩展的 32 位立即数（R_X86_64_32S），此时大于 INT32_MAX 的值无法填补，
+// 所以先通过空的内联汇编强制将其作为 32 位值加载到寄存器中（R_X86_64_32），主要用于 i32/f32 常量
+// 另外编译器认为外部符号的地址一定不为 0，所以需要与常量比较的空洞（例如 switch 的条件）也必须使用 HOLE32，否则值为 0 的分支可能会被优化掉
+#define HOLE32(H)                          \
+    ({                                     \
+        uint32_t v_ = (uint32_t) HOLE(H);  \
+        __asm__("" : "+r"(v_));            \
+        v_;                                \
+    })
+
+// 空洞所表示的槽位，空洞的值为槽位相对于栈帧操作数栈底的字节偏移量，这样编译器可以直接将其编码为内存操作数的偏移量
+#define SLOT(H) (*(StackValue *) ((char *) fp + HOLE(H)))
+
+// 定义操作码 op 对应的模板
+#define STENCIL(op) bool op_##op(Module *m, StackValue *fp)
+
+// 执行下一条指令
+#define NEXT() return _HOLE_CONTINUE(m, fp)
+
+// 源操作数 a 所在槽位的值
+#define SRC SLOT(_HOLE_SLOT_A).value
+
+// 将计算结果（类型为 TYPE，对应 StackValue 中的 FIELD 字段）写入目的操作数所在的槽位
+#define RESULT(TYPE, FIELD, EXPR)            \
+    SLOT(_HOLE_SLOT_D).value.FIELD = (EXPR); \
+    SET_VALUE_TYPE(SLOT(_HOLE_SLOT_D), TYPE)
+
+// 以下宏用于定义数值指令的模板，与寄存器虚拟机中的同名宏一致
+#define UNARY(CTYPE, FIELD, TYPE, RFIELD, EXPR) \
+    {                                           \
+        CTYPE x = SRC.FIELD;                    \
+        RESULT(TYPE, RFIELD, EXPR)              \
+    }                                           \
+    NEXT();
+
+#define BINARY(CTYPE, FIELD, TYPE, RFIELD, EXPR)   \
+    {                                              \
+        CTYPE x = SLOT(_HOLE_SLOT_A).value.FIELD;  \
+        CTYPE y = SLOT(_HOLE_SLOT_B).value.FIELD;  \
+        RESULT(TYPE, RFIELD, EXPR)                 \
+    }                                              \
+    NEXT();
+
+#define I32_UNARY(EXPR) UNARY(uint32_t, uint32, I32, uint32, EXPR)
+#define I64_UNARY(EXPR) UNARY(uint64_t, uint64, I64, uint64, EXPR)
+#define F32_UNARY(EXPR) UNARY(float, f32, F32, f32, EXPR)
+#define F64_UNARY(EXPR) UNARY(double, f64, F64, f64, EXPR)
+
+#define I32_BINARY(EXPR) BINARY(uint32_t, uint32, I32, uint32, EXPR)
+#define I64_BINARY(EXPR) BINARY(uint64_t, uint64, I64, uint64, EXPR)
+#define F32_BINARY(EXPR) BINARY(float, f32, F32, f32, EXPR)
+#define F64_BINARY(EXPR) BINARY(double, f64, F64, f64, EXPR)
+
+#define I32_COMPARE(EXPR) BINARY(uint32_t, uint32, I32, uint32, EXPR)
+#define I64_COMPARE(EXPR) BINARY(uint64_t, uint64, I32, uint32, EXPR)
+#define F32_COMPARE(EXPR) BINARY(float, f32, I32, uint32, EXPR)
+#define F64_COMPARE(EXPR) BINARY(double, f64, I32, uint32, EXPR)
+
+// 内存加载/存储，与寄存器虚拟机中的同名宏一致
+// 注：与栈式解释器一致，越界访问由线性内存的保护页捕获（见 memory.c）
+#define LOAD(TYPE, SIZE)                                                   \
+    {                                                                      \
+        uint8_t *maddr = m->memory.bytes + HOLE(_HOLE_IMM32) + SRC.uint32; \
+        SLOT(_HOLE_SLOT_D).value.uint64 = 0;                               \
+        memcpy(&SLOT(_HOLE_SLOT_D).value, maddr, SIZE);                    \
+        SET_VALUE_TYPE(SLOT(_HOLE_SLOT_D), TYPE)                           \
+    }
+
+#define STORE(FIELD, SIZE)                                                 \
+    {                                                                      \
+        uint8_t *maddr = m->memory.bytes + HOLE(_HOLE_IMM32) + SRC.uint32; \
+        memcpy(maddr, &SLOT(_HOLE_SLOT_B).value.FIELD, SIZE);              \
+    }                                                                      \
+    NEXT();
+
+// 整数除法/取余的除数为 0 时，记录异常信息并返回 false
+#define DIVISOR_CHECK(FIELD)                              \
+    if (SLOT(_HOLE_SLOT_B).value.FIELD == 0) {            \
+        sprintf(exception, "integer divide by zero");     \
+        return false;                                     \
+    }
+
+// 非饱和截断，结果类型为 TYPE，对应 StackValue 中的 FIELD 字段
+#define TRUNC(OP, TYPE, FIELD, SRC_FIELD)                 \
+    OP(SLOT(_HOLE_SLOT_D).value.FIELD, SRC.SRC_FIELD)     \
+    SET_VALUE_TYPE(SLOT(_HOLE_SLOT_D), TYPE)              \
+    NEXT();
+
+/*
+ * 控制指令
+ * */
+STENCIL(Unreachable) {
+    sprintf(exception, "unreachable");
+    return false;
+}
+
+STENCIL(Br) {
+    return _HOLE_JUMP(m, fp);
+}
+
+// 注：将跳转到下一条指令的分支写在前面，编译器会把它放在模板末尾，拼接时即可省去该 jmp
+STENCIL(BrIf) {
+    if (!SRC.uint32) {
+        NEXT();
+    }
+    return _HOLE_JUMP(m, fp);
+}
+
+STENCIL(RBrUnless) {
+    if (SRC.uint32) {
+        NEXT();
+    }
+    return _HOLE_JUMP(m, fp);
+}
+
+STENCIL(BrTable) {
+    // 如果槽位 a 的值小于跳转表大小（保存在 b 中），则跳转到跳转表中对应的地址，否则跳转到默认地址（跳转表的最后一项）
+    // 注：跳转表中保存的是目标指令的机器码地址，跳转表的地址保存在 64 位立即数中
+    uint32_t n = SRC.uint32;
+    if (n > HOLE32(_HOLE_ARG_B)) {
+        n = HOLE32(_HOLE_ARG_B);
+    }
+    return ((const JitFunction *) (uintptr_t) _HOLE_IMM64)[n](m, fp);
+}
+
+STENCIL(Return) {
+    m->sp = m->fp + (int) HOLE(_HOLE_ARG_A);
+    return pop_block(m) != NULL;
+}
+
+STENCIL(Call) {
+    if (m->csp >= CALLSTACK_SIZE - 1) {
+        sprintf(exception, "call stack exhausted");
+        return false;
+    }
+    m->sp = m->fp + (int) HOLE(_HOLE_ARG_B) - 1;
+    if (!invoke(m, HOLE(_HOLE_ARG_A))) {
+        return false;
+    }
+    NEXT();
+}
+
+// 尾调用：由 jit_tail_call 复用当前栈帧，再尾调用其返回的函数（该指令的寄存器指令的地址保存在 64 位立即数中）
+STENCIL(ReturnCall) {
+    JitFunction next = jit_tail_call(m, (RInstr *) (uintptr_t) _HOLE_IMM64);
+    return next(m, fp);
+}
+
+STENCIL(ReturnCallIndirect) {
+    JitFunction next = jit_tail_call(m, (RInstr *) (uintptr_t) _HOLE_IMM64);
+    return next(m, fp);
+}
+
+// 借助寄存器虚拟机执行单条指令（例如 call_indirect、memory.grow），该指令的寄存器指令流地址保存在 64 位立即数中
+bool aux_fallback(Module *m, StackValue *fp) {
+    if (!reg_execute(m, (RInstr *) (uintptr_t) _HOLE_IMM64)) {
+        return false;
+    }
+    NEXT();
+}
+
+/*
+ * 参数指令
+ * */
+STENCIL(Select) {
+    SLOT(_HOLE_SLOT_D) = SLOT(_HOLE_SLOT_C).value.uint32 ? SLOT(_HOLE_SLOT_A) : SLOT(_HOLE_SLOT_B);
+    NEXT();
+}
+
+/*
+ * 变量指令
+ * */
+STENCIL(RMove) {
+    SLOT(_HOLE_SLOT_D) = SLOT(_HOLE_SLOT_A);
+    NEXT();
+}
+
+STENCIL(GlobalGet) {
+    SLOT(_HOLE_SLOT_D) = m->globals[HOLE(_HOLE_ARG_A)];
+    NEXT();
+}
+
+STENCIL(GlobalSet) {
+    m->globals[HOLE(_HOLE_ARG_A)] = SLOT(_HOLE_SLOT_B);
+    NEXT();
+}
+
+/*
+ * 内存指令
+ * */
+STENCIL(I32Load) {
+    LOAD(I32, 4)
+    NEXT();
+}
+STENCIL(I64Load) {
+    LOAD(I64, 8)
+    NEXT();
+}
+STENCIL(F32Load) {
+    LOAD(F32, 4)
+    NEXT();
+}
+STENCIL(F64Load) {
+    LOAD(F64, 8)
+    NEXT();
+}
+STENCIL(I32Load8S) {
+    LOAD(I32, 1)
+    sext_8_32(&SLOT(_HOLE_SLOT_D).value.uint32);
+    NEXT();
+}
+STENCIL(I32Load8U) {
+    LOAD(I32, 1)
+    NEXT();
+}
+STENCIL(I32Load16S) {
+    LOAD(I32, 2)
+    sext_16_32(&SLOT(_HOLE_SLOT_D).value.uint32);
+    NEXT();
+}
+STENCIL(I32Load16U) {
+    LOAD(I32, 2)
+    NEXT();
+}
+STENCIL(I64Load8S) {
+    LOAD(I64, 1)
+    sext_8_64(&SLOT(_HOLE_SLOT_D).value.uint64);
+    NEXT();
+}
+STENCIL(I64Load8U) {
+    LOAD(I64, 1)
+    NEXT();
+}
+STENCIL(I64Load16S) {
+    LOAD(I64, 2)
+    sext_16_64(&SLOT(_HOLE_SLOT_D).value.uint64);
+    NEXT();
+}
+STENCIL(I64Load16U) {
+    LOAD(I64, 2)
+    NEXT();
+}
+STENCIL(I64Load32S) {
+    LOAD(I64, 4)
+    sext_32_64(&SLOT(_HOLE_SLOT_D).value.uint64);
+    NEXT();
+}
+STENCIL(I64Load32U) {
+    LOAD(I64, 4)
+    NEXT();
+}
+STENCIL(I32Store) {
+    STORE(uint32, 4)
+}
+STENCIL(I64Store) {
+    STORE(uint64, 8)
+}
+STENCIL(F32Store) {
+    STORE(f32, 4)
+}
+STENCIL(F64Store) {
+    STORE(f64, 8)
+}
+STENCIL(I32Store8) {
+    STORE(uint32, 1)
+}
+STENCIL(I32Store16) {
+    STORE(uint32, 2)
+}
+STENCIL(I64Store8) {
+    STORE(uint64, 1)
+}
+STENCIL(I64Store16) {
+    STORE(uint64, 2)
+}
+STENCIL(I64Store32) {
+    STORE(uint64, 4)
+}
+STENCIL(MemorySize) {
+    RESULT(I32, uint32, m->memory.cur_size)
+    NEXT();
+}
+
+/*
+ * 数值指令--常量指令
+ * */
+STENCIL(I32Const) {
+    RESULT(I32, uint64, HOLE32(_HOLE_IMM32))
+    NEXT();
+}
+STENCIL(I64Const) {
+    RESULT(I64, uint64, _HOLE_IMM64)
+    NEXT();
+}
+STENCIL(F32Const) {
+    RESULT(F32, uint64, HOLE32(_HOLE_IMM32))
+    NEXT();
+}
+STENCIL(F64Const) {
+    RESULT(F64, uint64, _HOLE_IMM64)
+    NEXT();
+}
+
+/*
+ * 数值指令--测试指令和比较指令
+ * */
+STENCIL(I32Eqz) {
+    RESULT(I32, uint32, SRC.uint32 == 0)
+    NEXT();
+}
+STENCIL(I64Eqz) {
+    RESULT(I32, uint32, SRC.uint64 == 0)
+    NEXT();
+}
+STENCIL(I32Eq) { I32_COMPARE(x == y) }
+STENCIL(I32Ne) { I32_COMPARE(x != y) }
+STENCIL(I32LtS) { I32_COMPARE((int32_t) x < (int32_t) y) }
+STENCIL(I32LtU) { I32_COMPARE(x < y) }
+STENCIL(I32GtS) { I32_COMPARE((int32_t) x > (int32_t) y) }
+STENCIL(I32GtU) { I32_COMPARE(x > y) }
+STENCIL(I32LeS) { I32_COMPARE((int32_t) x <= (int32_t) y) }
+STENCIL(I32LeU) { I32_COMPARE(x <= y) }
+STENCIL(I32GeS) { I32_COMPARE((int32_t) x >= (int32_t) y) }
+STENCIL(I32GeU) { I32_COMPARE(x >= y) }
+STENCIL(I64Eq) { I64_COMPARE(x == y) }
+STENCIL(I64Ne) { I64_COMPARE(x != y) }
+STENCIL(I64LtS) { I64_COMPARE((int64_t) x < (int64_t) y) }
+STENCIL(I64LtU) { I64_COMPARE(x < y) }
+STENCIL(I64GtS) { I64_COMPARE((int64_t) x > (int64_t) y) }
+STENCIL(I64GtU) { I64_COMPARE(x > y) }
+STENCIL(I64LeS) { I64_COMPARE((int64_t) x <= (int64_t) y) }
+STENCIL(I64LeU) { I64_COMPARE(x <= y) }
+STENCIL(I64GeS) { I64_COMPARE((int64_t) x >= (int64_t) y) }
+STENCIL(I64GeU) { I64_COMPARE(x >= y) }
+STENCIL(F32Eq) { F32_COMPARE(x == y) }
+STENCIL(F32Ne) { F32_COMPARE(x != y) }
+STENCIL(F32Lt) { F32_COMPARE(x < y) }
+STENCIL(F32Gt) { F32_COMPARE(x > y) }
+STENCIL(F32Le) { F32_COMPARE(x <= y) }
+STENCIL(F32Ge) { F32_COMPARE(x >= y) }
+STENCIL(F64Eq) { F64_COMPARE(x == y) }
+STENCIL(F64Ne) { F64_COMPARE(x != y) }
+STENCIL(F64Lt) { F64_COMPARE(x < y) }
+STENCIL(F64Gt) { F64_COMPARE(x > y) }
+STENCIL(F64Le) { F64_COMPARE(x <= y) }
+STENCIL(F64Ge) { F64_COMPARE(x >= y) }
+
+/*
+ * 数值指令--算术指令
+ * */
+STENCIL(I32Clz) { I32_UNARY(x == 0 ? 32 : __builtin_clz(x)) }
+STENCIL(I32Ctz) { I32_UNARY(x == 0 ? 32 : __builtin_ctz(x)) }
+STENCIL(I32PopCnt) { I32_UNARY(__builtin_popcount(x)) }
+STENCIL(I32Add) { I32_BINARY(x + y) }
+STENCIL(I32Sub) { I32_BINARY(x - y) }
+STENCIL(I32Mul) { I32_BINARY(x * y) }
+STENCIL(I32DivS) {
+    DIVISOR_CHECK(uint32)
+    if (SRC.uint32 == 0x80000000 && SLOT(_HOLE_SLOT_B).value.int32 == -1) {
+        sprintf(exception, "integer overflow");
+        return false;
+    }
+    I32_BINARY((int32_t) x / (int32_t) y)
+}
+STENCIL(I32DivU) {
+    DIVISOR_CHECK(uint32)
+    I32_BINARY(x / y)
+}
+STENCIL(I32RemS) {
+    DIVISOR_CHECK(uint32)
+    I32_BINARY((x == 0x80000000 && y == (uint32_t) -1) ? 0 : (int32_t) x % (int32_t) y)
+}
+STENCIL(I32RemU) {
+    DIVISOR_CHECK(uint32)
+    I32_BINARY(x % y)
+}
+STENCIL(I32And) { I32_BINARY(x & y) }
+STENCIL(I32Or) { I32_BINARY(x | y) }
+STENCIL(I32Xor) { I32_BINARY(x ^ y) }
+STENCIL(I32Shl) { I32_BINARY(x << (y & 31)) }
+STENCIL(I32ShrS) { I32_BINARY(((int32_t) x) >> (y & 31)) }
+STENCIL(I32ShrU) { I32_BINARY(x >> (y & 31)) }
+STENCIL(I32Rotl) { I32_BINARY(rotl32(x, y)) }
+STENCIL(I32Rotr) { I32_BINARY(rotr32(x, y)) }
+STENCIL(I64Clz) { I64_UNARY(x == 0 ? 64 : __builtin_clzll(x)) }
+STENCIL(I64Ctz) { I64_UNARY(x == 0 ? 64 : __builtin_ctzll(x)) }
+STENCIL(I64PopCnt) { I64_UNARY(__builtin_popcountll(x)) }
+STENCIL(I64Add) { I64_BINARY(x + y) }
+STENCIL(I64Sub) { I64_BINARY(x - y) }
+STENCIL(I64Mul) { I64_BINARY(x * y) }
+STENCIL(I64DivS) {
+    DIVISOR_CHECK(uint64)
+    if (SRC.uint64 == 0x8000000000000000 && SLOT(_HOLE_SLOT_B).value.int64 == -1) {
+        sprintf(exception, "integer overflow");
+        return false;
+    }
+    I64_BINARY((int64_t) x / (int64_t) y)
+}
+STENCIL(I64DivU) {
+    DIVISOR_CHECK(uint64)
+    I64_BINARY(x / y)
+}
+STENCIL(I64RemS) {
+    DIVISOR_CHECK(uint64)
+    I64_BINARY((x == 0x8000000000000000 && y == (uint64_t) -1) ? 0 : (int64_t) x % (int64_t) y)
+}
+STENCIL(I64RemU) {
+    DIVISOR_CHECK(uint64)
+    I64_BINARY(x % y)
+}
+STENCIL(I64And) { I64_BINARY(x & y) }
+STENCIL(I64Or) { I64_BINARY(x | y) }
+STENCIL(I64Xor) { I64_BINARY(x ^ y) }
+STENCIL(I64Shl) { I64_BINARY(x << (y & 63)) }
+STENCIL(I64ShrS) { I64_BINARY(((int64_t) x) >> (y & 63)) }
+STENCIL(I64ShrU) { I64_BINARY(x >> (y & 63)) }
+STENCIL(I64Rotl) { I64_BINARY(rotl64(x, y)) }
+STENCIL(I64Rotr) { I64_BINARY(rotr64(x, y)) }
+STENCIL(F32Abs) { F32_UNARY(fabsf(x)) }
+STENCIL(F32Neg) { F32_UNARY(-x) }
+STENCIL(F32Ceil) { F32_UNARY(ceilf(x)) }
+STENCIL(F32Floor) { F32_UNARY(floorf(x)) }
+STENCIL(F32Trunc) { F32_UNARY(truncf(x)) }
+STENCIL(F32Nearest) { F32_UNARY(rintf(x)) }
+STENCIL(F32Sqrt) { F32_UNARY(sqrtf(x)) }
+STENCIL(F32Add) { F32_BINARY(x + y) }
+STENCIL(F32Sub) { F32_BINARY(x - y) }
+STENCIL(F32Mul) { F32_BINARY(x * y) }
+STENCIL(F32Div) { F32_BINARY(x / y) }
+STENCIL(F32Min) { F32_BINARY(wa_fminf(x, y)) }
+STENCIL(F32Max) { F32_BINARY(wa_fmaxf(x, y)) }
+STENCIL(F32CopySign) { F32_BINARY(signbit(y) ? -fabsf(x) : fabsf(x)) }
+STENCIL(F64Abs) { F64_UNARY(fabs(x)) }
+STENCIL(F64Neg) { F64_UNARY(-x) }
+STENCIL(F64Ceil) { F64_UNARY(ceil(x)) }
+STENCIL(F64Floor) { F64_UNARY(floor(x)) }
+STENCIL(F64Trunc) { F64_UNARY(trunc(x)) }
+STENCIL(F64Nearest) { F64_UNARY(rint(x)) }
+STENCIL(F64Sqrt) { F64_UNARY(sqrt(x)) }
+STENCIL(F64Add) { F64_BINARY(x + y) }
+STENCIL(F64Sub) { F64_BINARY(x - y) }
+STENCIL(F64Mul) { F64_BINARY(x * y) }
+STENCIL(F64Div) { F64_BINARY(x / y) }
+STENCIL(F64Min) { F64_BINARY(wa_fmin(x, y)) }
+STENCIL(F64Max) { F64_BINARY(wa_fmax(x, y)) }
+STENCIL(F64CopySign) { F64_BINARY(signbit(y) ? -fabs(x) : fabs(x)) }
+
+/*
+ * 数值指令--类型转换指令
+ * */
+STENCIL(I32WrapI64) {
+    RESULT(I32, uint64, SRC.uint64 & 0x00000000ffffffff)
+    NEXT();
+}
+STENCIL(I32TruncF32S) { TRUNC(OP_I32_TRUNC_F32, I32, int32, f32) }
+STENCIL(I32TruncF32U) { TRUNC(OP_U32_TRUNC_F32, I32, uint32, f32) }
+STENCIL(I32TruncF64S) { TRUNC(OP_I32_TRUNC_F64, I32, int32, f64) }
+STENCIL(I32TruncF64U) { TRUNC(OP_U32_TRUNC_F64, I32, uint32, f64) }
+STENCIL(I64ExtendI32S) {
+    RESULT(I64, int64, (int64_t) SRC.int32)
+    NEXT();
+}
+STENCIL(I64ExtendI32U) {
+    RESULT(I64, uint64, (uint64_t) SRC.uint32)
+    NEXT();
+}
+STENCIL(I64TruncF32S) { TRUNC(OP_I64_TRUNC_F32, I64, int64, f32) }
+STENCIL(I64TruncF32U) { TRUNC(OP_U64_TRUNC_F32, I64, uint64, f32) }
+STENCIL(I64TruncF64S) { TRUNC(OP_I64_TRUNC_F64, I64, int64, f64) }
+STENCIL(I64TruncF64U) { TRUNC(OP_U64_TRUNC_F64, I64, uint64, f64) }
+STENCIL(F32ConvertI32S) {
+    RESULT(F32, f32, (float) SRC.int32)
+    NEXT();
+}
+STENCIL(F32ConvertI32U) {
+    RESULT(F32, f32, (float) SRC.uint32)
+    NEXT();
+}
+STENCIL(F32ConvertI64S) {
+    RESULT(F32, f32, (float) SRC.int64)
+    NEXT();
+}
+STENCIL(F32ConvertI64U) {
+    RESULT(F32, f32, (float) SRC.uint64)
+    NEXT();
+}
+STENCIL(F32DemoteF64) {
+    RESULT(F32, f32, (float) SRC.f64)
+    NEXT();
+}
+STENCIL(F64ConvertI32S) {
+    RESULT(F64, f64, (double) SRC.int32)
+    NEXT();
+}
+STENCIL(F64ConvertI32U) {
+    RESULT(F64, f64, (double) SRC.uint32)
+    NEXT();
+}
+STENCIL(F64ConvertI64S) {
+    RESULT(F64, f64, (double) SRC.int64)
+    NEXT();
+}
+STENCIL(F64ConvertI64U) {
+    RESULT(F64, f64, (double) SRC.uint64)
+    NEXT();
+}
+STENCIL(F64PromoteF32) {
+    RESULT(F64, f64, (double) SRC.f32)
+    NEXT();
+}
+STENCIL(I32ReinterpretF32) {
+    RESULT(I32, uint64, SRC.uint64)
+    NEXT();
+}
+STENCIL(I64ReinterpretF64) {
+    RESULT(I64, uint64, SRC.uint64)
+    NEXT();
+}
+STENCIL(F32ReinterpretI32) {
+    RESULT(F32, uint64, SRC.uint64)
+    NEXT();
+}
+STENCIL(F64ReinterpretI64) {
+    RESULT(F64, uint64, SRC.uint64)
+    NEXT();
+}
+STENCIL(I32Extend8S) {
+    RESULT(I32, int32, (int32_t) (int8_t) SRC.int32)
+    NEXT();
+}
+STENCIL(I32Extend16S) {
+    RESULT(I32, int32, (int32_t) (int16_t) SRC.int32)
+    NEXT();
+}
+STENCIL(I64Extend8S) {
+    RESULT(I64, int64, (int64_t) (int8_t) SRC.int64)
+    NEXT();
+}
+STENCIL(I64Extend16S) {
+    RESULT(I64, int64, (int64_t) (int16_t) SRC.int64)
+    NEXT();
+}
+STENCIL(I64Extend32S) {
+    RESULT(I64, int64, (int64_t) (int32_t) SRC.int64)
+    NEXT();
+}
+STENCIL(TruncSat) {
+    // 饱和截断指令，b 用来区分不同类型的浮点数和整数之间的转换
+    switch (HOLE32(_HOLE_ARG_B)) {
+        case 0x00:
+            OP_I32_TRUNC_SAT_F32(SLOT(_HOLE_SLOT_D).value.int32, SRC.f32)
+            SET_VALUE_TYPE(SLOT(_HOLE_SLOT_D), I32)
+            break;
+        case 0x01:
+            OP_U32_TRUNC_SAT_F32(SLOT(_HOLE_SLOT_D).value.uint32, SRC.f32)
+            SET_VALUE_TYPE(SLOT(_HOLE_SLOT_D), I32)
+            break;
+        case 0x02:
+            OP_I32_TRUNC_SAT_F64(SLOT(_HOLE_SLOT_D).value.int32, SRC.f64)
+            SET_VALUE_TYPE(SLOT(_HOLE_SLOT_D), I32)
+            break;
+        case 0x03:
+            OP_U32_TRUNC_SAT_F64(SLOT(_HOLE_SLOT_D).value.uint32, SRC.f64)
+            SET_VALUE_TYPE(SLOT(_HOLE_SLOT_D), I32)
+            break;
+        case 0x04:
+            OP_I64_TRUNC_SAT_F32(SLOT(_HOLE_SLOT_D).value.int64, SRC.f32)
+            SET_VALUE_TYPE(SLOT(_HOLE_SLOT_D), I64)
+            break;
+        case 0x05:
+            OP_U64_TRUNC_SAT_F32(SLOT(_HOLE_SLOT_D).value.uint64, SRC.f32)
+            SET_VALUE_TYPE(SLOT(_HOLE_SLOT_D), I64)
+            break;
+        case 0x06:
+            OP_I64_TRUNC_SAT_F64(SLOT(_HOLE_SLOT_D).value.int64, SRC.f64)
+            SET_VALUE_TYPE(SLOT(_HOLE_SLOT_D), I64)
+            break;
+        case 0x07:
+            OP_U64_TRUNC_SAT_F64(SLOT(_HOLE_SLOT_D).value.uint64, SRC.f64)
+            SET_VALUE_TYPE(SLOT(_HOLE_SLOT_D), I64)
+            break;
+        default:
+            break;
+    }
+    NEXT();
+}
@@ -0,0 +1,119 @@
+// 提前编译（AOT）的测试用例：函数被翻译成 C 代码后，编译后的函数之间直接相互调用，
+// 递归深度、全局变量、跳转表、内存访问以及各类陷阱的行为都必须与解释执行时一致（其他执行层同样运行这些用例）
+const { wasmModule, i32, i64, f64, invoke, assertReturn, assertTrap, assertExhaustion } = require('../wasm')
+
+module.exports = [
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['i32 -> i32', 'i32 -> i64', '-> i64', 'f64 -> f64', 'i32 i64 ->', 'i32 -> f64'],
+            memory: { min: 1 },
+            globals: [
+                { type: 'i64', mutable: true, value: 0 },
+                { type: 'f64', mutable: true, value: 1.5 },
+                { type: 'i32', mutable: false, value: 7 },
+            ],
+            functions: [
+                {
+                    // 0：直接递归
+                    type: 'i32 -> i64',
+                    export: 'fib',
+                    body: `
+                        local.get 0
+                        i32.const 2
+                        i32.lt_u
+                        if (result i64)
+                          local.get 0
+                          i64.extend_i32_u
+                        else
+                          local.get 0
+                          i32.const 1
+                          i32.sub
+                          call 0
+                          local.get 0
+                          i32.const 2
+                          i32.sub
+                          call 0
+                          i64.add
+                        end`,
+                },
+                // 1、2：相互递归
+                { type: 'i32 -> i32', export: 'even', body: 'local.get 0 i32.eqz if (result i32) i32.const 1 else local.get 0 i32.const 1 i32.sub call 2 end' },
+                { type: 'i32 -> i32', export: 'odd', body: 'local.get 0 i32.eqz if (result i32) i32.const 0 else local.get 0 i32.const 1 i32.sub call 1 end' },
+                // 3：无限递归
+                { type: 'i32 -> i32', export: 'runaway', body: 'local.get 0 i32.const 1 i32.add call 3' },
+                {
+                    // 4：修改全局变量，并返回累加后的值
+                    type: '-> i64',
+                    export: 'bump',
+                    body: 'global.get 0 global.get 2 i64.extend_i32_u i64.add global.set 0 global.get 0',
+                },
+                { type: 'f64 -> f64', export: 'scale', body: 'global.get 1 local.get 0 f64.mul global.set 1 global.get 1' },
+                {
+                    // 6：跳转表，超出范围的索引跳转到默认分支
+                    type: 'i32 -> i32',
+                    export: 'classify',
+                    body: `
+                        block
+                          block
+                            block
+                              block
+                                block
+                                  local.get 0
+                                  br_table 0 1 2 3 1 0 4
+                                end
+                                i32.const 10
+                                return
+                              end
+                              i32.const 11
+                              return
+                            end
+                            i32.const 12
+                            return
+                          end
+                          i32.const 13
+                          return
+                        end
+                        i32.const 14`,
+                },
+                // 7、8：内存读写
+                { type: 'i32 i64 ->', export: 'store', body: 'local.get 0 local.get 1 i64.store' },
+                { type: 'i32 -> i64', export: 'load', body: 'local.get 0 i64.load' },
+                // 9：浮点数转整数溢出
+                { type: 'i32 -> i32', export: 'trunc', body: 'local.get 0 f64.convert_i32_s f64.const 1e10 f64.mul i32.trunc_f64_s' },
+                { type: 'i32 -> i32', export: 'unreachable', body: 'unreachable' },
+                { type: 'i32 -> f64', export: 'convert', body: 'local.get 0 f64.convert_i32_u' },
+                // 12：加载的结果被丢弃，越界时仍然必须触发陷阱
+                { type: 'i32 -> i32', export: 'load_dropped', body: 'local.get 0 i32.load8_u drop i32.const 1' },
+            ],
+        }),
+    },
+    assertReturn(invoke('fib', i32(25)), i64(75025)),
+    assertReturn(invoke('even', i32(1001)), i32(0)),
+    assertReturn(invoke('odd', i32(1001)), i32(1)),
+    assertExhaustion(invoke('runaway', i32(0)), 'call stack exhausted'),
+    // 栈耗尽后调用栈已恢复，后续调用不受影响
+    assertReturn(invoke('fib', i32(10)), i64(55)),
+    assertReturn(invoke('bump'), i64(7)),
+    assertReturn(invoke('bump'), i64(14)),
+    assertReturn(invoke('scale', f64(2)), f64(3)),
+    assertReturn(invoke('scale', f64(0.25)), f64(0.75)),
+    assertReturn(invoke('classify', i32(0)), i32(10)),
+    assertReturn(invoke('classify', i32(1)), i32(11)),
+    assertReturn(invoke('classify', i32(2)), i32(12)),
+    assertReturn(invoke('classify', i32(3)), i32(13)),
+    assertReturn(invoke('classify', i32(4)), i32(11)),
+    assertReturn(invoke('classify', i32(5)), i32(10)),
+    assertReturn(invoke('classify', i32(6)), i32(14)),
+    assertReturn(invoke('classify', i32(-1)), i32(14)),
+    { type: 'action', action: invoke('store', i32(8), i64('0x123456789abcdef0')) },
+    assertReturn(invoke('load', i32(8)), i64('0x123456789abcdef0')),
+    assertReturn(invoke('load', i32(12)), i64(0x12345678)),
+    assertTrap(invoke('load', i32(65529)), 'out of bounds memory access'),
+    assertReturn(invoke('load_dropped', i32(65535)), i32(1)),
+    assertTrap(invoke('load_dropped', i32(65536)), 'out of bounds memory access'),
+    assertTrap(invoke('trunc', i32(1)), 'integer overflow'),
+    assertReturn(invoke('trunc', i32(0)), i32(0)),
+    assertTrap(invoke('unreachable', i32(0)), 'unreachable'),
+    assertReturn(invoke('convert', i32(-1)), f64(4294967295)),
+]
@@ -0,0 +1,65 @@
+// 越界检查的测试用例：保护页（-b guard）和显式检查（-b explicit）都必须在越界访问时触发陷阱，
+// 掩码（-b mask）不会触发陷阱，测试运行器在该模式下跳过第一个期望越界陷阱的断言及其之后的断言（见 --no-oob-traps）
+const { wasmModule, i32, i64, invoke, assertReturn, assertTrap } = require('../wasm')
+
+const oob = 'out of bounds memory access'
+
+module.exports = [
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['i32 -> i32', 'i32 i32 ->', 'i32 -> i64', '-> i32'],
+            memory: { min: 1, max: 2 },
+            functions: [
+                { type: 'i32 -> i32', export: 'load', body: 'local.get 0 i32.load' },
+                { type: 'i32 -> i32', export: 'load8', body: 'local.get 0 i32.load8_u' },
+                { type: 'i32 -> i64', export: 'load64', body: 'local.get 0 i64.load' },
+                { type: 'i32 -> i32', export: 'load_far', body: 'local.get 0 i32.load offset=4294967295' },
+                { type: 'i32 i32 ->', export: 'store', body: 'local.get 0 local.get 1 i32.store' },
+                // 同一基本块中以同一个局部变量为地址的多次访问：显式检查时会合并为一次检查，但越界之前的存储仍然必须生效
+                {
+                    type: 'i32 -> i32',
+                    export: 'store_then_load',
+                    body: 'local.get 0 i32.const 42 i32.store local.get 0 i32.load offset=8',
+                },
+                {
+                    type: 'i32 -> i32',
+                    export: 'sum3',
+                    body: 'local.get 0 i32.load local.get 0 i32.load offset=4 i32.add local.get 0 i32.load offset=8 i32.add',
+                },
+                { type: '-> i32', export: 'grow', body: 'i32.const 1 memory.grow' },
+            ],
+        }),
+    },
+    // 边界以内的访问
+    assertReturn(invoke('load', i32(65532)), i32(0)),
+    assertReturn(invoke('load8', i32(65535)), i32(0)),
+    assertReturn(invoke('load64', i32(65528)), i64(0)),
+    assertReturn(invoke('sum3', i32(65524)), i32(0)),
+    {
+        type: 'action',
+        action: invoke('store', i32(65532), i32(0x01020304)),
+    },
+    assertReturn(invoke('load8', i32(65532)), i32(4)),
+    assertReturn(invoke('load', i32(65532)), i32(0x01020304)),
+    // 越界访问，包括部分越界以及地址与偏移量相加超出 32 位的情况
+    assertTrap(invoke('load', i32(65533)), oob),
+    assertTrap(invoke('load8', i32(65536)), oob),
+    assertTrap(invoke('load64', i32(65529)), oob),
+    assertTrap(invoke('load', i32(-1)), oob),
+    assertTrap(invoke('load_far', i32(0)), oob),
+    assertTrap(invoke('load_far', i32(1)), oob),
+    assertTrap(invoke('sum3', i32(65525)), oob),
+    assertTrap(invoke('store', i32(65534), i32(-1)), oob),
+    // 越界的存储不会写入任何字节
+    assertReturn(invoke('load', i32(65532)), i32(0x01020304)),
+    assertTrap(invoke('store_then_load', i32(65528)), oob),
+    assertReturn(invoke('load', i32(65528)), i32(42)),
+    // 内存增长之后，原来越界的地址变为可访问
+    assertReturn(invoke('grow'), i32(1)),
+    assertReturn(invoke('load', i32(65536)), i32(0)),
+    assertReturn(invoke('load', i32(65533)), i32(0x10203)),
+    assertReturn(invoke('load', i32(131068)), i32(0)),
+    assertTrap(invoke('load', i32(131069)), oob),
+    assertReturn(invoke('grow'), i32(-1)),
+]
@@ -0,0 +1,116 @@
+// call_indirect 内联缓存的测试用例：同一个调用点的目标数量超过缓存容量时缓存会轮换替换，
+// 同一个函数位于表中的多个索引时按索引分别缓存，且缓存命中不能跳过其他索引的越界和函数签名校验；
+// 参数较多、只有靠前的参数类型不同的函数签名也必须区分开
+const { wasmModule, i32, invoke, assertReturn, assertTrap } = require('../wasm')
+
+// 表中的索引 0 到 7 对应的函数分别返回参数加上该值，索引 6 和 7 与索引 0 和 3 是同一个函数
+const adds = [0, 1, 2, 3, 4, 5, 0, 3]
+
+// 17 个参数的函数签名，只有第一个参数的类型不同
+// 注：按每个参数 4 位打包成 64 位的签名掩码超过 16 个参数时会丢失第一个参数，两者会被误判为相同的签名
+const wide = ' i32'.repeat(16) + ' -> i32'
+// 依次压入 17 个参数（第一个参数为 first，其余参数为 1 到 16）
+const wideArgs = first => first + Array.from({ length: 16 }, (_, i) => ` i32.const ${i + 1}`).join('')
+
+// 与 cycle 函数相同的计算：第 i 次迭代调用表中索引为 i % slots 的函数
+function cycle(n, slots) {
+    let sum = 0
+    for (let i = 0; i < n; i++) {
+        sum = (sum + i + adds[i % slots]) | 0
+    }
+    return sum
+}
+
+module.exports = [
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['i32 -> i32', 'i32 i32 -> i32', 'i32 i32 i32 -> i32'],
+            table: [0, 1, 2, 3, 4, 5, 0, 3, 6],
+            functions: [
+                { type: 'i32 -> i32', body: 'local.get 0' },
+                { type: 'i32 -> i32', body: 'local.get 0 i32.const 1 i32.add' },
+                { type: 'i32 -> i32', body: 'local.get 0 i32.const 2 i32.add' },
+                { type: 'i32 -> i32', body: 'local.get 0 i32.const 3 i32.add' },
+                { type: 'i32 -> i32', body: 'local.get 0 i32.const 4 i32.add' },
+                { type: 'i32 -> i32', body: 'local.get 0 i32.const 5 i32.add' },
+                // 6：函数签名与调用点不一致
+                { type: 'i32 i32 -> i32', body: 'local.get 0 local.get 1 i32.add' },
+                // 所有目标都经过同一个调用点
+                { type: 'i32 i32 -> i32', export: 'dispatch', body: 'local.get 1 local.get 0 call_indirect 0' },
+                { type: 'i32 i32 -> i32', export: 'tail', body: 'local.get 1 local.get 0 return_call_indirect 0' },
+                {
+                    // 循环中依次调用表中索引 0 到 slots - 1 的函数，并累加结果
+                    type: 'i32 i32 -> i32',
+                    locals: ['i32', 'i32'],
+                    export: 'cycle',
+                    body: `
+                        block
+                          loop
+                            local.get 2
+                            local.get 0
+                            i32.ge_u
+                            br_if 1
+                            local.get 3
+                            local.get 2
+                            local.get 2
+                            local.get 1
+                            i32.rem_u
+                            call_indirect 0
+                            i32.add
+                            local.set 3
+                            local.get 2
+                            i32.const 1
+                            i32.add
+                            local.set 2
+                            br 0
+                          end
+                        end
+                        local.get 3`,
+                },
+            ],
+        }),
+    },
+    assertReturn(invoke('dispatch', i32(0), i32(10)), i32(10)),
+    assertReturn(invoke('dispatch', i32(0), i32(10)), i32(10)),
+    // 索引 8 的函数签名不一致：无论缓存中是否已有其他目标都必须触发陷阱
+    assertTrap(invoke('dispatch', i32(8), i32(10)), 'indirect call type mismatch'),
+    assertReturn(invoke('dispatch', i32(3), i32(10)), i32(13)),
+    assertReturn(invoke('dispatch', i32(6), i32(10)), i32(10)),
+    assertReturn(invoke('dispatch', i32(7), i32(10)), i32(13)),
+    assertTrap(invoke('dispatch', i32(8), i32(10)), 'indirect call type mismatch'),
+    assertReturn(invoke('dispatch', i32(0), i32(10)), i32(10)),
+    // 目标数量不超过缓存容量（单态与多态）
+    assertReturn(invoke('cycle', i32(1000), i32(1)), i32(cycle(1000, 1))),
+    assertReturn(invoke('cycle', i32(1000), i32(4)), i32(cycle(1000, 4))),
+    // 目标数量超过缓存容量，缓存不断轮换替换
+    assertReturn(invoke('cycle', i32(1000), i32(5)), i32(cycle(1000, 5))),
+    assertReturn(invoke('cycle', i32(1000), i32(8)), i32(cycle(1000, 8))),
+    assertTrap(invoke('cycle', i32(1000), i32(9)), 'indirect call type mismatch'),
+    assertReturn(invoke('cycle', i32(1000), i32(8)), i32(cycle(1000, 8))),
+    // 尾调用经过同样的缓存
+    assertReturn(invoke('tail', i32(5), i32(1)), i32(6)),
+    assertReturn(invoke('tail', i32(6), i32(1)), i32(1)),
+    assertTrap(invoke('tail', i32(8), i32(1)), 'indirect call type mismatch'),
+    assertReturn(invoke('tail', i32(7), i32(1)), i32(4)),
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['i64' + wide, 'i32' + wide, 'i32 -> i32'],
+            table: [0, 1],
+            functions: [
+                // 0、1：返回最后一个参数与第一个参数之和
+                { type: 'i64' + wide, body: 'local.get 16 local.get 0 i32.wrap_i64 i32.add' },
+                { type: 'i32' + wide, body: 'local.get 16 local.get 0 i32.add' },
+                { type: 'i32 -> i32', export: 'call_i64', body: wideArgs('i64.const 100') + ' local.get 0 call_indirect 0' },
+                { type: 'i32 -> i32', export: 'call_i32', body: wideArgs('i32.const 200') + ' local.get 0 call_indirect 1' },
+            ],
+        }),
+    },
+    assertReturn(invoke('call_i64', i32(0)), i32(116)),
+    assertReturn(invoke('call_i32', i32(1)), i32(216)),
+    // 签名只在第一个参数上不同，同样必须触发陷阱
+    assertTrap(invoke('call_i64', i32(1)), 'indirect call type mismatch'),
+    assertTrap(invoke('call_i32', i32(0)), 'indirect call type mismatch'),
+    assertReturn(invoke('call_i64', i32(0)), i32(116)),
+]
@@ -0,0 +1,148 @@
+// 控制流指令的测试用例：预解码后的指令流中，跳转目标、块的返回值以及 br_table 的跳转表均在翻译时确定
+const { wasmModule, i32, i64, invoke, assertReturn, assertTrap } = require('../wasm')
+
+module.exports = [
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['i32 -> i32', 'i32 i32 -> i32', 'i64 -> i64'],
+            functions: [
+                {
+                    // 根据参数选择分支，每个分支的块都带有返回值
+                    type: 'i32 -> i32',
+                    export: 'switch',
+                    body: `
+                        block (result i32)
+                          block
+                            block
+                              block
+                                local.get 0
+                                br_table 0 1 2 2
+                              end
+                              i32.const 100
+                              br 2
+                            end
+                            i32.const 101
+                            br 1
+                          end
+                          i32.const 102
+                        end`,
+                },
+                {
+                    // 嵌套循环：计算 sum(i * j)，其中 0 <= i < n，0 <= j < n
+                    type: 'i32 -> i32',
+                    locals: ['i32', 'i32', 'i32'],
+                    export: 'nested',
+                    body: `
+                        block
+                          loop
+                            local.get 1
+                            local.get 0
+                            i32.ge_u
+                            br_if 1
+                            i32.const 0
+                            local.set 2
+                            block
+                              loop
+                                local.get 2
+                                local.get 0
+                                i32.ge_u
+                                br_if 1
+                                local.get 3
+                                local.get 1
+                                local.get 2
+                                i32.mul
+                                i32.add
+                                local.set 3
+                                local.get 2
+                                i32.const 1
+                                i32.add
+                                local.set 2
+                                br 0
+                              end
+                            end
+                            local.get 1
+                            i32.const 1
+                            i32.add
+                            local.set 1
+                            br 0
+                          end
+                        end
+                        local.get 3`,
+                },
+                {
+                    // if/else 带返回值，以及 select
+                    type: 'i32 i32 -> i32',
+                    export: 'max_s',
+                    body: `
+                        local.get 0
+                        local.get 1
+                        i32.gt_s
+                        if (result i32)
+                          local.get 0
+                        else
+                          local.get 1
+                        end
+                        local.get 0
+                        local.get 1
+                        local.get 0
+                        local.get 1
+                        i32.gt_s
+                        select
+                        i32.eq
+                        if (result i32)
+                          local.get 0
+                          local.get 1
+                          local.get 0
+                          local.get 1
+                          i32.gt_s
+                          select
+                        else
+                          unreachable
+                        end`,
+                },
+                {
+                    // 递归实现的阶乘
+                    type: 'i64 -> i64',
+                    export: 'fac',
+                    body: `
+                        local.get 0
+                        i64.eqz
+                        if (result i64)
+                          i64.const 1
+                        else
+                          local.get 0
+                          local.get 0
+                          i64.const 1
+                          i64.sub
+                          call 3
+                          i64.mul
+                        end`,
+                },
+                {
+                    type: 'i32 -> i32',
+                    export: 'trap_if',
+                    body: `
+                        local.get 0
+                        if
+                          unreachable
+                        end
+                        i32.const 7`,
+                },
+            ],
+        }),
+    },
+    assertReturn(invoke('switch', i32(0)), i32(100)),
+    assertReturn(invoke('switch', i32(1)), i32(101)),
+    assertReturn(invoke('switch', i32(2)), i32(102)),
+    assertReturn(invoke('switch', i32(3)), i32(102)),
+    assertReturn(invoke('switch', i32(-1)), i32(102)),
+    assertReturn(invoke('nested', i32(0)), i32(0)),
+    assertReturn(invoke('nested', i32(10)), i32(2025)),
+    assertReturn(invoke('nested', i32(100)), i32(24502500)),
+    assertReturn(invoke('max_s', i32(-5), i32(3)), i32(3)),
+    assertReturn(invoke('max_s', i32(7), i32(-9)), i32(7)),
+    assertReturn(invoke('fac', i64(20)), i64('2432902008176640000')),
+    assertReturn(invoke('trap_if', i32(0)), i32(7)),
+    assertTrap(invoke('trap_if', i32(1)), 'unreachable'),
+]
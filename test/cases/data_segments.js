@@ -0,0 +1,61 @@
+// 数据段初始化的测试用例：使用保护页时，数据段中完整覆盖的宿主机内存页以 MAP_PRIVATE 的方式直接映射自模块文件，
+// 其余部分以及其他越界检查方式下仍然拷贝，两种方式下内存的内容都必须与数据段一致，且写入内存不会改变模块文件的内容
+const { wasmModule, i32, invoke, assertReturn } = require('../wasm')
+
+const page = 4096
+const pattern = (i) => (i * 7 + 3) & 0xff
+const payload = Buffer.from(Array.from({ length: 3 * page + 100 }, (_, i) => pattern(i)))
+
+// 第一个数据段的文件偏移量与其内存偏移量对齐，覆盖 3 个完整的宿主机内存页以及之后的 100 个字节；
+// 第二个数据段改写了第一个数据段中间的 8 个字节，第三个数据段不与宿主机内存页对齐
+const bytes = wasmModule({
+    types: ['i32 -> i32', 'i32 i32 ->', '-> i32'],
+    memory: { min: 1, max: 2 },
+    functions: [
+        { type: 'i32 -> i32', export: 'load8', body: 'local.get 0 i32.load8_u' },
+        { type: 'i32 i32 ->', export: 'store8', body: 'local.get 0 local.get 1 i32.store8' },
+        { type: '-> i32', export: 'grow', body: 'i32.const 1 memory.grow' },
+    ],
+    data: [
+        { offset: page, bytes: payload, pageAligned: true },
+        { offset: 2 * page + 16, bytes: Buffer.from([0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8]) },
+        { offset: 5 * page - 3, bytes: Buffer.from([0xb1, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6]) },
+    ],
+})
+
+function checkPattern() {
+    return [
+        assertReturn(invoke('load8', i32(page - 1)), i32(0)),
+        assertReturn(invoke('load8', i32(page)), i32(pattern(0))),
+        assertReturn(invoke('load8', i32(page + 5000)), i32(pattern(5000))),
+        assertReturn(invoke('load8', i32(4 * page - 1)), i32(pattern(3 * page - 1))),
+        assertReturn(invoke('load8', i32(4 * page + 99)), i32(pattern(3 * page + 99))),
+        assertReturn(invoke('load8', i32(4 * page + 100)), i32(0)),
+        assertReturn(invoke('load8', i32(2 * page + 15)), i32(pattern(page + 15))),
+        assertReturn(invoke('load8', i32(2 * page + 16)), i32(0xa1)),
+        assertReturn(invoke('load8', i32(2 * page + 23)), i32(0xa8)),
+        assertReturn(invoke('load8', i32(2 * page + 24)), i32(pattern(page + 24))),
+        assertReturn(invoke('load8', i32(5 * page - 3)), i32(0xb1)),
+        assertReturn(invoke('load8', i32(5 * page + 2)), i32(0xb6)),
+    ]
+}
+
+module.exports = [
+    { type: 'module', filename: 'data_segments.wasm', bytes },
+    ...checkPattern(),
+    // 写入映射自模块文件的内存页，只改变该实例的内存
+    { type: 'action', action: invoke('store8', i32(page + 5000), i32(0x5a)) },
+    { type: 'action', action: invoke('store8', i32(3 * page), i32(0x5b)) },
+    assertReturn(invoke('load8', i32(page + 5000)), i32(0x5a)),
+    assertReturn(invoke('load8', i32(3 * page)), i32(0x5b)),
+    assertReturn(invoke('load8', i32(page + 5001)), i32(pattern(5001))),
+    // 内存增长之后，映射自模块文件的内存页以及写入过的内容保持不变
+    assertReturn(invoke('grow'), i32(1)),
+    assertReturn(invoke('load8', i32(page + 5000)), i32(0x5a)),
+    assertReturn(invoke('load8', i32(2 * page + 100)), i32(pattern(page + 100))),
+    assertReturn(invoke('load8', i32(65536)), i32(0)),
+    // 重新加载同一个模块文件，内存的内容仍然与数据段一致
+    { type: 'module', filename: 'data_segments.wasm', bytes },
+    ...checkPattern(),
+    assertReturn(invoke('load8', i32(3 * page)), i32(pattern(2 * page))),
+]
@@ -0,0 +1,89 @@
+// 小函数内联的测试用例：函数体足够小的叶子函数被展开到调用者中，其参数和局部变量成为调用者新增的局部变量，
+// 每个调用点都必须重新初始化这些局部变量，且内联前后函数的返回值、陷阱以及对内存和全局变量的修改保持一致
+const { wasmModule, i32, i64, f64, invoke, assertReturn, assertTrap } = require('../wasm')
+
+module.exports = [
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['i32 -> i32', 'i32 i32 -> i32', 'i32 -> i32 i32', 'i32 i32 ->', 'f64 -> f64', 'i32 -> i64', '-> i32'],
+            memory: { min: 1 },
+            globals: [{ type: 'i32', mutable: true, value: 0 }],
+            table: [0, 1],
+            functions: [
+                // 0：局部变量在每次调用时都必须为 0，否则结果会随调用次数累加
+                { type: 'i32 -> i32', locals: ['i32'], export: 'fresh', body: 'local.get 1 local.get 0 i32.add local.tee 1' },
+                // 1：会修改自身参数的函数
+                { type: 'i32 i32 -> i32', body: 'local.get 0 local.get 1 i32.mul local.set 0 local.get 0 local.get 0 i32.add' },
+                // 2：可能触发陷阱的函数
+                { type: 'i32 i32 -> i32', export: 'div', body: 'local.get 0 local.get 1 i32.div_s' },
+                // 3：返回多个值的函数
+                { type: 'i32 -> i32 i32', body: 'local.get 0 i32.const 1 i32.add local.get 0 i32.const 1 i32.sub' },
+                // 4：没有返回值，但会修改内存和全局变量的函数
+                { type: 'i32 i32 ->', body: 'local.get 0 local.get 1 i32.store global.get 0 i32.const 1 i32.add global.set 0' },
+                // 5：浮点局部变量
+                { type: 'f64 -> f64', locals: ['f64'], body: 'local.get 1 f64.const 0.5 f64.add local.get 0 f64.mul' },
+                {
+                    // 循环中调用 fresh：每次调用的结果都等于参数
+                    type: 'i32 -> i64',
+                    locals: ['i64'],
+                    export: 'loop_fresh',
+                    body: `
+                        loop
+                          local.get 1
+                          local.get 0
+                          call 0
+                          i64.extend_i32_u
+                          i64.add
+                          local.set 1
+                          local.get 0
+                          i32.const 1
+                          i32.sub
+                          local.tee 0
+                          br_if 0
+                        end
+                        local.get 1`,
+                },
+                {
+                    // 同一个函数的调用结果作为另一次调用的参数，两次调用共用同一组局部变量
+                    type: 'i32 i32 -> i32',
+                    export: 'compose',
+                    body: 'local.get 0 local.get 1 call 1 local.get 1 local.get 0 call 1 call 1',
+                },
+                {
+                    // 内联函数中的陷阱
+                    type: 'i32 i32 -> i32',
+                    export: 'div_sum',
+                    body: 'local.get 0 local.get 1 call 2 local.get 1 local.get 0 call 2 i32.add',
+                },
+                { type: 'i32 i32 -> i32', export: 'multi', body: 'local.get 0 call 3 i32.mul local.get 1 call 3 i32.sub i32.add' },
+                {
+                    type: 'i32 -> i32',
+                    export: 'stores',
+                    body: 'i32.const 0 local.get 0 call 4 i32.const 4 local.get 0 i32.const 1 i32.add call 4 i32.const 0 i32.load i32.const 4 i32.load i32.add global.get 0 i32.add',
+                },
+                { type: 'f64 -> f64', export: 'float', body: 'local.get 0 call 5 call 5' },
+                // 被内联的函数仍然可以被间接调用
+                { type: 'i32 -> i32', export: 'indirect', body: 'local.get 0 i32.const 0 call_indirect 0' },
+                { type: 'i32 i32 -> i32', export: 'indirect2', body: 'local.get 0 local.get 1 i32.const 1 call_indirect 1' },
+            ],
+        }),
+    },
+    assertReturn(invoke('loop_fresh', i32(1000)), i64(500500)),
+    assertReturn(invoke('fresh', i32(7)), i32(7)),
+    assertReturn(invoke('fresh', i32(7)), i32(7)),
+    // (3 * 4 * 2) = 24，(4 * 3 * 2) = 24，(24 * 24 * 2) = 1152
+    assertReturn(invoke('compose', i32(3), i32(4)), i32(1152)),
+    assertReturn(invoke('div_sum', i32(12), i32(3)), i32(4)),
+    assertTrap(invoke('div_sum', i32(12), i32(0)), 'integer divide by zero'),
+    assertTrap(invoke('div_sum', i32(0), i32(5)), 'integer divide by zero'),
+    assertTrap(invoke('div_sum', i32(-2147483648), i32(-1)), 'integer overflow'),
+    // (6 * 4) + (10 - 8) = 26
+    assertReturn(invoke('multi', i32(5), i32(9)), i32(26)),
+    // 10 + 11 + 2
+    assertReturn(invoke('stores', i32(10)), i32(23)),
+    assertReturn(invoke('stores', i32(10)), i32(25)),
+    assertReturn(invoke('float', f64(3)), f64(0.75)),
+    assertReturn(invoke('indirect', i32(9)), i32(9)),
+    assertReturn(invoke('indirect2', i32(2), i32(5)), i32(20)),
+]
@@ -0,0 +1,56 @@
+// 64 位内存（memory64 提案）的测试用例：地址和内存偏移量为 64 位整数，越界检查不能截断到 32 位，
+// memory.size/memory.grow 的页数为 i64 类型，memory.grow 失败时返回 i64 类型的 -1
+const { wasmModule, i32, i64, invoke, assertReturn, assertTrap } = require('../wasm')
+
+const oob = 'out of bounds memory access'
+
+module.exports = [
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['i64 -> i32', 'i64 i32 ->', 'i64 -> i64', '-> i64'],
+            memory: { min: 1, max: 3, memory64: true },
+            functions: [
+                { type: 'i64 -> i32', export: 'load', body: 'local.get 0 i32.load' },
+                { type: 'i64 -> i32', export: 'load8', body: 'local.get 0 i32.load8_u' },
+                { type: 'i64 i32 ->', export: 'store', body: 'local.get 0 local.get 1 i32.store' },
+                { type: 'i64 -> i64', export: 'load64', body: 'local.get 0 i64.load offset=8' },
+                // 内存偏移量超出 32 位
+                { type: 'i64 -> i32', export: 'load_far', body: 'local.get 0 i32.load offset=4294967296' },
+                // 地址与内存偏移量相加超出 64 位
+                { type: 'i64 -> i32', export: 'load_wrap', body: 'local.get 0 i32.load offset=16' },
+                { type: '-> i64', export: 'size', body: 'memory.size' },
+                { type: 'i64 -> i64', export: 'grow', body: 'local.get 0 memory.grow' },
+            ],
+            data: [{ offset: 65532, bytes: Buffer.from([1, 2, 3, 4]) }],
+        }),
+    },
+    assertReturn(invoke('load', i64(65532)), i32(0x04030201)),
+    assertReturn(invoke('size'), i64(1)),
+    { type: 'action', action: invoke('store', i64(16), i32(0x11223344)) },
+    assertReturn(invoke('load', i64(16)), i32(0x11223344)),
+    assertReturn(invoke('load64', i64(8)), i64(0x11223344)),
+    // 地址的低 32 位在边界以内，但完整的 64 位地址越界
+    assertTrap(invoke('load', i64('0x100000010')), oob),
+    assertTrap(invoke('load8', i64('0x100000000')), oob),
+    assertTrap(invoke('store', i64('0x100000010'), i32(-1)), oob),
+    assertReturn(invoke('load', i64(16)), i32(0x11223344)),
+    assertTrap(invoke('load', i64(65533)), oob),
+    assertTrap(invoke('load64', i64(65521)), oob),
+    assertTrap(invoke('load_far', i64(16)), oob),
+    assertTrap(invoke('load_wrap', i64(-16)), oob),
+    assertTrap(invoke('load_wrap', i64(-1)), oob),
+    assertTrap(invoke('load', i64(-1)), oob),
+    // 页数为 i64 类型，失败时返回 i64 类型的 -1
+    assertReturn(invoke('grow', i64(1)), i64(1)),
+    assertReturn(invoke('size'), i64(2)),
+    assertReturn(invoke('load', i64(65536)), i32(0)),
+    assertReturn(invoke('load', i64(65532)), i32(0x04030201)),
+    assertReturn(invoke('grow', i64(2)), i64(-1)),
+    assertReturn(invoke('grow', i64('0x100000000')), i64(-1)),
+    assertReturn(invoke('grow', i64(-1)), i64(-1)),
+    assertReturn(invoke('size'), i64(2)),
+    assertReturn(invoke('grow', i64(1)), i64(2)),
+    assertReturn(invoke('load', i64(196604)), i32(0)),
+    assertTrap(invoke('load', i64(196605)), oob),
+]
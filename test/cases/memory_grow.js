@@ -0,0 +1,98 @@
+// memory.grow 的测试用例：内存增长之后已有的内容保持不变，新增的页全部为 0，
+// 超出内存的大小上限时 memory.grow 返回 -1 且内存大小不变
+const { wasmModule, i32, invoke, assertReturn, assertTrap } = require('../wasm')
+
+module.exports = [
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['-> i32', 'i32 -> i32', 'i32 i32 ->', 'i32 i32 -> i32'],
+            memory: { min: 1, max: 10 },
+            functions: [
+                { type: '-> i32', export: 'size', body: 'memory.size' },
+                { type: 'i32 -> i32', export: 'grow', body: 'local.get 0 memory.grow' },
+                { type: 'i32 i32 ->', export: 'store', body: 'local.get 0 local.get 1 i32.store' },
+                { type: 'i32 -> i32', export: 'load', body: 'local.get 0 i32.load' },
+                // 以 4 字节为步长，对 [from, to) 中的所有 i32 求按位或，用于检查新增的页是否全部为 0
+                {
+                    type: 'i32 i32 -> i32',
+                    locals: ['i32'],
+                    export: 'or_range',
+                    body: `
+                        block
+                          loop
+                            local.get 0
+                            local.get 1
+                            i32.ge_u
+                            br_if 1
+                            local.get 2
+                            local.get 0
+                            i32.load
+                            i32.or
+                            local.set 2
+                            local.get 0
+                            i32.const 4
+                            i32.add
+                            local.set 0
+                            br 0
+                          end
+                        end
+                        local.get 2`,
+                },
+            ],
+        }),
+    },
+    { type: 'action', action: invoke('store', i32(0), i32(0x11223344)) },
+    { type: 'action', action: invoke('store', i32(65532), i32(0x55667788)) },
+    assertReturn(invoke('size'), i32(1)),
+    assertReturn(invoke('grow', i32(0)), i32(1)),
+    assertReturn(invoke('grow', i32(1)), i32(1)),
+    assertReturn(invoke('size'), i32(2)),
+    // 增长之后已有的内容保持不变，新增的页全部为 0
+    assertReturn(invoke('load', i32(0)), i32(0x11223344)),
+    assertReturn(invoke('load', i32(65532)), i32(0x55667788)),
+    assertReturn(invoke('or_range', i32(65536), i32(131072)), i32(0)),
+    { type: 'action', action: invoke('store', i32(131068), i32(-1)) },
+    // 超出大小上限时返回 -1，内存大小和内容都保持不变
+    assertReturn(invoke('grow', i32(9)), i32(-1)),
+    assertReturn(invoke('grow', i32(-1)), i32(-1)),
+    assertReturn(invoke('grow', i32(0x10000)), i32(-1)),
+    assertReturn(invoke('size'), i32(2)),
+    assertReturn(invoke('load', i32(131068)), i32(-1)),
+    assertTrap(invoke('load', i32(131072)), 'out of bounds memory access'),
+    // 多次增长直到大小上限
+    assertReturn(invoke('grow', i32(3)), i32(2)),
+    assertReturn(invoke('grow', i32(5)), i32(5)),
+    assertReturn(invoke('size'), i32(10)),
+    assertReturn(invoke('load', i32(0)), i32(0x11223344)),
+    assertReturn(invoke('load', i32(65532)), i32(0x55667788)),
+    assertReturn(invoke('load', i32(131068)), i32(-1)),
+    assertReturn(invoke('or_range', i32(131072), i32(655360)), i32(0)),
+    assertReturn(invoke('load', i32(655356)), i32(0)),
+    assertReturn(invoke('grow', i32(1)), i32(-1)),
+    assertReturn(invoke('grow', i32(0)), i32(10)),
+    // 虚拟地址空间受限时，显式检查方式下 mremap 无法扩展内存映射，memory.grow 同样返回 -1，且内存的大小和内容都保持不变
+    {
+        type: 'module',
+        flags: ['-b', 'explicit'],
+        addressSpace: 1024 * 1024,
+        bytes: wasmModule({
+            types: ['-> i32', 'i32 -> i32', 'i32 i32 ->'],
+            memory: { min: 1 },
+            functions: [
+                { type: '-> i32', export: 'size', body: 'memory.size' },
+                { type: 'i32 -> i32', export: 'grow', body: 'local.get 0 memory.grow' },
+                { type: 'i32 i32 ->', export: 'store', body: 'local.get 0 local.get 1 i32.store' },
+                { type: 'i32 -> i32', export: 'load', body: 'local.get 0 i32.load' },
+            ],
+        }),
+    },
+    { type: 'action', action: invoke('store', i32(65532), i32(0x55667788)) },
+    assertReturn(invoke('grow', i32(0x4000)), i32(-1)),
+    assertReturn(invoke('size'), i32(1)),
+    assertReturn(invoke('load', i32(65532)), i32(0x55667788)),
+    assertTrap(invoke('load', i32(65536)), 'out of bounds memory access'),
+    assertReturn(invoke('grow', i32(1)), i32(1)),
+    assertReturn(invoke('load', i32(65532)), i32(0x55667788)),
+    assertReturn(invoke('load', i32(65536)), i32(0)),
+]
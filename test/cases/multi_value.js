@@ -0,0 +1,111 @@
+// 多返回值的测试用例：多返回值的函数、带参数和多个返回值的控制块，以及携带多个值的跳转
+const { wasmModule, i32, i64, f32, f64, invoke, assertReturn } = require('../wasm')
+
+module.exports = [
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: [
+                'i32 i32 -> i32 i32',
+                'i32 i64 f32 f64 -> f64 f32 i64 i32',
+                'i32 -> i32 i32',
+                'i32 i32 -> i32',
+                'i32 -> i32',
+                '-> i32 i64',
+            ],
+            functions: [
+                // 0：交换两个参数
+                { type: 'i32 i32 -> i32 i32', export: 'swap', body: 'local.get 1 local.get 0' },
+                // 1：逆序返回 4 个不同类型的参数
+                {
+                    type: 'i32 i64 f32 f64 -> f64 f32 i64 i32',
+                    export: 'reverse',
+                    body: 'local.get 3 local.get 2 local.get 1 local.get 0',
+                },
+                // 2：调用多返回值的函数，再将两个返回值相减
+                { type: 'i32 i32 -> i32', export: 'call_swap', body: 'local.get 0 local.get 1 call 0 i32.sub' },
+                // 3：带两个参数、两个返回值的 block，块内通过 br 携带两个值跳出
+                {
+                    type: 'i32 i32 -> i32 i32',
+                    export: 'block_br',
+                    body: `
+                        local.get 0
+                        local.get 1
+                        block (type 0)
+                          i32.const 1
+                          i32.add
+                          local.get 0
+                          br_if 0
+                          i32.const 100
+                          i32.add
+                        end`,
+                },
+                // 4：带参数的 loop 计算 1 + 2 + ... + n，循环的参数即为当前的累加值
+                {
+                    type: 'i32 -> i32',
+                    export: 'loop_sum',
+                    body: `
+                        i32.const 0
+                        loop (type 4)
+                          local.get 0
+                          i32.add
+                          local.get 0
+                          i32.const 1
+                          i32.sub
+                          local.tee 0
+                          br_if 0
+                        end`,
+                },
+                // 5：带两个返回值的 if/else
+                {
+                    type: 'i32 -> i32 i32',
+                    export: 'if_pair',
+                    body: `
+                        local.get 0
+                        if (type 2)
+                          i32.const 1
+                          i32.const 2
+                        else
+                          i32.const 3
+                          i32.const 4
+                        end`,
+                },
+                // 6：通过 br_table 携带两个值跳转到不同深度的控制块
+                {
+                    type: 'i32 -> i32 i32',
+                    export: 'table_pair',
+                    body: `
+                        block (type 5)
+                          block (type 5)
+                            i32.const 10
+                            i64.const 20
+                            local.get 0
+                            br_table 0 1
+                          end
+                          i64.const 1
+                          i64.add
+                        end
+                        i32.wrap_i64`,
+                },
+                // 7：函数体直接以 return 返回多个值，且 return 之前的操作数栈中还有其他值
+                {
+                    type: '-> i32 i64',
+                    export: 'return_pair',
+                    body: 'i32.const 99 i32.const 7 i64.const -1 return',
+                },
+            ],
+        }),
+    },
+    assertReturn(invoke('swap', i32(1), i32(2)), i32(2), i32(1)),
+    assertReturn(invoke('reverse', i32(1), i64(-2), f32(3.5), f64(-4.25)), f64(-4.25), f32(3.5), i64(-2), i32(1)),
+    assertReturn(invoke('call_swap', i32(10), i32(3)), i32(-7)),
+    assertReturn(invoke('block_br', i32(0), i32(5)), i32(0), i32(106)),
+    assertReturn(invoke('block_br', i32(1), i32(5)), i32(1), i32(6)),
+    assertReturn(invoke('loop_sum', i32(100)), i32(5050)),
+    assertReturn(invoke('if_pair', i32(1)), i32(1), i32(2)),
+    assertReturn(invoke('if_pair', i32(0)), i32(3), i32(4)),
+    assertReturn(invoke('table_pair', i32(0)), i32(10), i32(21)),
+    assertReturn(invoke('table_pair', i32(1)), i32(10), i32(20)),
+    assertReturn(invoke('table_pair', i32(5)), i32(10), i32(20)),
+    assertReturn(invoke('return_pair'), i32(7), i64(-1)),
+]
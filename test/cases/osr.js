@@ -0,0 +1,138 @@
+// 栈上替换（OSR）的测试用例：在分层执行模式下，只被调用一次的函数会在循环的回边处从解释器切换到
+// 寄存器虚拟机或机器码继续执行，切换前后局部变量、操作数栈上位于循环之外的值以及循环的迭代状态都必须保持一致
+const { wasmModule, i32, i64, f64, invoke, assertReturn, assertTrap } = require('../wasm')
+
+// 与 harmonic 函数相同的求和顺序：从 1/n 累加到 1/1
+function harmonic(n) {
+    let sum = 0
+    for (let i = n; i > 0; i--) {
+        sum += 1 / i
+    }
+    return sum
+}
+
+module.exports = [
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['i32 -> i32', 'i32 -> i64', 'i32 -> f64', 'i32 i32 -> i32'],
+            globals: [{ type: 'i32', mutable: true, value: 0 }],
+            functions: [
+                {
+                    // 循环之前压入操作数栈的值在 OSR 后仍需参与计算
+                    type: 'i32 -> i32',
+                    locals: ['i32', 'i32'],
+                    export: 'sum',
+                    body: `
+                        i32.const 1000
+                        block
+                          loop
+                            local.get 1
+                            local.get 0
+                            i32.ge_u
+                            br_if 1
+                            local.get 2
+                            local.get 1
+                            i32.add
+                            local.set 2
+                            local.get 1
+                            i32.const 1
+                            i32.add
+                            local.set 1
+                            br 0
+                          end
+                        end
+                        local.get 2
+                        i32.add`,
+                },
+                {
+                    // 嵌套循环：外层循环的迭代状态在内层循环发生 OSR 后保持不变
+                    type: 'i32 -> i64',
+                    locals: ['i32', 'i32', 'i64'],
+                    export: 'nested',
+                    body: `
+                        loop
+                          i32.const 0
+                          local.set 2
+                          loop
+                            local.get 3
+                            local.get 1
+                            i64.extend_i32_u
+                            local.get 2
+                            i64.extend_i32_u
+                            i64.mul
+                            i64.add
+                            local.set 3
+                            local.get 2
+                            i32.const 1
+                            i32.add
+                            local.tee 2
+                            local.get 0
+                            i32.lt_u
+                            br_if 0
+                          end
+                          local.get 1
+                          i32.const 1
+                          i32.add
+                          local.tee 1
+                          local.get 0
+                          i32.lt_u
+                          br_if 0
+                        end
+                        local.get 3`,
+                },
+                {
+                    // 浮点局部变量在 OSR 前后保持不变
+                    type: 'i32 -> f64',
+                    locals: ['f64'],
+                    export: 'harmonic',
+                    body: `
+                        loop
+                          local.get 1
+                          f64.const 1
+                          local.get 0
+                          f64.convert_i32_u
+                          f64.div
+                          f64.add
+                          local.set 1
+                          local.get 0
+                          i32.const 1
+                          i32.sub
+                          local.tee 0
+                          br_if 0
+                        end
+                        local.get 1`,
+                },
+                {
+                    // 循环中修改全局变量，并在第 N 次迭代时触发陷阱
+                    type: 'i32 i32 -> i32',
+                    export: 'trap_at',
+                    body: `
+                        loop
+                          global.get 0
+                          i32.const 1
+                          i32.add
+                          global.set 0
+                          i32.const 1
+                          local.get 1
+                          global.get 0
+                          i32.sub
+                          i32.div_u
+                          drop
+                          global.get 0
+                          local.get 0
+                          i32.lt_u
+                          br_if 0
+                        end
+                        global.get 0`,
+                },
+                { type: 'i32 -> i32', export: 'counter', body: 'global.get 0' },
+            ],
+        }),
+    },
+    assertReturn(invoke('sum', i32(100000)), i32(1000 + 4999950000 % 4294967296)),
+    assertReturn(invoke('nested', i32(300)), i64(44850 * 44850)),
+    assertReturn(invoke('harmonic', i32(5000)), f64(harmonic(5000))),
+    assertTrap(invoke('trap_at', i32(1000), i32(500)), 'integer divide by zero'),
+    assertReturn(invoke('counter', i32(0)), i32(500)),
+]
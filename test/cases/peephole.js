@@ -0,0 +1,100 @@
+// 窥孔优化的测试用例：常量折叠、local.set/local.get 合并为 local.tee、乘法和无符号除法的强度削减以及删除被丢弃的纯表达式，
+// 优化前后的执行结果必须一致，所以同一个模块分别在开启和关闭（-P）窥孔优化时执行同一组断言；
+// 会触发陷阱的运算（整数除以 0、有符号除法溢出、越界加载以及浮点数转换溢出）即使结果被丢弃也不能被折叠或删除
+const { wasmModule, i32, i64, invoke, assertReturn, assertTrap } = require('../wasm')
+
+const bytes = wasmModule({
+    types: ['-> i32', '-> i64', 'i32 -> i32', 'i64 -> i64', 'i32 -> i64'],
+    memory: { min: 1 },
+    functions: [
+        // 常量折叠，折叠后的结果可以继续参与折叠：((3 + 4) * 5 - 1) << 2，加法溢出回绕
+        { type: '-> i32', export: 'fold_i32', body: 'i32.const 3 i32.const 4 i32.add i32.const 5 i32.mul i32.const 1 i32.sub i32.const 2 i32.shl' },
+        { type: '-> i32', export: 'fold_wrap', body: 'i32.const 0x7fffffff i32.const 1 i32.add' },
+        { type: '-> i32', export: 'fold_shr', body: 'i32.const -8 i32.const 33 i32.shr_u i32.const -8 i32.const 1 i32.shr_s i32.xor' },
+        { type: '-> i32', export: 'fold_unary', body: 'i32.const 0x00f00000 i32.clz i32.const 0x80 i32.extend8_s i32.add i32.const 0 i32.eqz i32.add' },
+        { type: '-> i32', export: 'fold_rotl', body: 'i32.const 0x80000001 i32.const 4 i32.rotl' },
+        { type: '-> i64', export: 'fold_i64', body: 'i64.const 0x100000000 i64.const 0x100000001 i64.mul i64.const -1 i64.add' },
+        { type: '-> i64', export: 'fold_extend', body: 'i32.const -2 i64.extend_i32_s i32.const -2 i64.extend_i32_u i64.xor' },
+        { type: '-> i32', export: 'fold_cmp', body: 'i32.const -1 i32.const 1 i32.lt_s i32.const -1 i32.const 1 i32.lt_u i32.const 1 i32.shl i32.or' },
+        { type: '-> i32', export: 'fold_div', body: 'i32.const -7 i32.const 2 i32.div_s i32.const -7 i32.const 2 i32.rem_s i32.const 10 i32.mul i32.add' },
+        // INT_MIN % -1 在 Wasm 中结果为 0，而不是触发陷阱
+        { type: '-> i32', export: 'rem_s_min', body: 'i32.const 0x80000000 i32.const -1 i32.rem_s' },
+        { type: '-> i64', export: 'rem_s_min64', body: 'i64.const 0x8000000000000000 i64.const -1 i64.rem_s' },
+        // 会触发陷阱的运算不能被折叠
+        { type: '-> i32', export: 'div_s_overflow', body: 'i32.const 0x80000000 i32.const -1 i32.div_s' },
+        { type: '-> i32', export: 'div_s_zero', body: 'i32.const 7 i32.const 0 i32.div_s' },
+        { type: '-> i64', export: 'rem_u_zero64', body: 'i64.const 7 i64.const 0 i64.rem_u' },
+        { type: 'i32 -> i32', export: 'div_s_zero_local', body: 'local.get 0 i32.const 0 i32.div_s' },
+        // 结果被丢弃的纯表达式会被删除，但是会触发陷阱的运算必须保留
+        { type: 'i32 -> i32', export: 'drop_pure', body: 'local.get 0 i32.const 1 i32.add i32.const 3 i32.mul drop local.get 0' },
+        { type: 'i32 -> i32', export: 'drop_div', body: 'i32.const 1 local.get 0 i32.div_u drop i32.const 1' },
+        { type: '-> i32', export: 'drop_load', body: 'i32.const 65536 i32.load drop i32.const 1' },
+        { type: '-> i32', export: 'drop_trunc', body: 'f32.const nan i32.trunc_f32_s drop i32.const 1' },
+        { type: '-> i32', export: 'drop_trunc_overflow', body: 'f64.const 1e10 i32.trunc_f64_u drop i32.const 1' },
+        // local.set x; local.get x 替换为 local.tee x，local.tee x; drop 替换为 local.set x
+        {
+            type: 'i32 -> i32',
+            locals: ['i32'],
+            export: 'tee',
+            body: 'local.get 0 i32.const 1 i32.add local.set 1 local.get 1 local.get 1 i32.mul local.get 0 local.tee 1 drop local.get 1 i32.add',
+        },
+        // 乘以、无符号除以 2 的幂以及对 2 的幂无符号取余替换为移位和按位与运算，乘以、除以 1 直接删除
+        { type: 'i32 -> i32', export: 'mul8', body: 'local.get 0 i32.const 8 i32.mul' },
+        { type: 'i32 -> i32', export: 'div_u16', body: 'local.get 0 i32.const 16 i32.div_u' },
+        { type: 'i32 -> i32', export: 'rem_u16', body: 'local.get 0 i32.const 16 i32.rem_u' },
+        { type: 'i32 -> i32', export: 'mul1_div1', body: 'local.get 0 i32.const 1 i32.mul i32.const 1 i32.div_u' },
+        { type: 'i32 -> i32', export: 'mul_min', body: 'local.get 0 i32.const 0x80000000 i32.mul' },
+        // 有符号除法对负数向零取整，不做替换
+        { type: 'i32 -> i32', export: 'div_s4', body: 'local.get 0 i32.const 4 i32.div_s' },
+        { type: 'i64 -> i64', export: 'mul64', body: 'local.get 0 i64.const 0x100000000 i64.mul' },
+        { type: 'i64 -> i64', export: 'div_u64', body: 'local.get 0 i64.const 1024 i64.div_u' },
+        { type: 'i64 -> i64', export: 'rem_u64', body: 'local.get 0 i64.const 1024 i64.rem_u' },
+        { type: 'i32 -> i64', export: 'extend_mul', body: 'local.get 0 i64.extend_i32_u i64.const 2 i64.mul' },
+        // 跳转目标之前的指令不能与之后的指令合并：以 br_if 跳出控制块时结果为 1 + 2，而不是把 i32.const 5 与之后的加法折叠成 7
+        { type: 'i32 -> i32', export: 'branch_fold', body: 'block (result i32) i32.const 1 local.get 0 br_if 0 drop i32.const 5 end i32.const 2 i32.add' },
+    ],
+})
+
+function run(flags) {
+    return [
+        { type: 'module', bytes, flags },
+        assertReturn(invoke('fold_i32'), i32(136)),
+        assertReturn(invoke('fold_wrap'), i32(0x80000000 | 0)),
+        assertReturn(invoke('fold_shr'), i32((-8 >>> 1) ^ (-8 >> 1))),
+        assertReturn(invoke('fold_unary'), i32(8 - 128 + 1)),
+        assertReturn(invoke('fold_rotl'), i32(0x18)),
+        assertReturn(invoke('fold_i64'), i64('4294967295')),
+        assertReturn(invoke('fold_extend'), i64('-4294967296')),
+        assertReturn(invoke('fold_cmp'), i32(1)),
+        assertReturn(invoke('fold_div'), i32(-13)),
+        assertReturn(invoke('rem_s_min'), i32(0)),
+        assertReturn(invoke('rem_s_min64'), i64(0)),
+        assertTrap(invoke('div_s_overflow'), 'integer overflow'),
+        assertTrap(invoke('div_s_zero'), 'integer divide by zero'),
+        assertTrap(invoke('rem_u_zero64'), 'integer divide by zero'),
+        assertTrap(invoke('div_s_zero_local', i32(5)), 'integer divide by zero'),
+        assertReturn(invoke('drop_pure', i32(5)), i32(5)),
+        assertReturn(invoke('drop_div', i32(3)), i32(1)),
+        assertTrap(invoke('drop_div', i32(0)), 'integer divide by zero'),
+        assertTrap(invoke('drop_load'), 'out of bounds memory access'),
+        assertTrap(invoke('drop_trunc'), 'invalid conversion to integer'),
+        assertTrap(invoke('drop_trunc_overflow'), 'integer overflow'),
+        assertReturn(invoke('tee', i32(4)), i32(29)),
+        assertReturn(invoke('mul8', i32(-3)), i32(-24)),
+        assertReturn(invoke('mul8', i32(0x20000001)), i32(8)),
+        assertReturn(invoke('div_u16', i32(-1)), i32(0x0fffffff)),
+        assertReturn(invoke('div_u16', i32(33)), i32(2)),
+        assertReturn(invoke('rem_u16', i32(-1)), i32(15)),
+        assertReturn(invoke('mul1_div1', i32(-7)), i32(-7)),
+        assertReturn(invoke('mul_min', i32(3)), i32(0x80000000 | 0)),
+        assertReturn(invoke('div_s4', i32(-7)), i32(-1)),
+        assertReturn(invoke('mul64', i64(-3)), i64('-12884901888')),
+        assertReturn(invoke('div_u64', i64(-1)), i64('18014398509481983')),
+        assertReturn(invoke('rem_u64', i64(-1)), i64(1023)),
+        assertReturn(invoke('extend_mul', i32(-1)), i64('8589934590')),
+        assertReturn(invoke('branch_fold', i32(1)), i32(3)),
+        assertReturn(invoke('branch_fold', i32(0)), i32(7)),
+    ]
+}
+
+module.exports = [...run([]), ...run(['-P'])]
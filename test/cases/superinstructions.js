@@ -0,0 +1,111 @@
+// 超级指令的测试用例：常见的指令序列在内部指令流中融合成一条超级指令，融合前后的执行结果必须一致；
+// 超级指令的操作码从 0x100 开始编号，模块中出现的 0xD0 ~ 0xD8 等单字节操作码（属于 wasmc 尚未支持的提案）不能被当成超级指令执行
+const { wasmModule, i32, invoke, assertReturn, assertTrap } = require('../wasm')
+
+// 曾经被超级指令占用的单字节操作码
+const formerOpcodes = [0xd0, 0xd1, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8]
+
+module.exports = [
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['i32 -> i32'],
+            memory: { min: 1 },
+            functions: [
+                {
+                    // 0：求 0 + 1 + ... + (n - 1)，覆盖 i32.const; local.set、local.get; i32.const; i32.lt_s; br_if、
+                    // local.get; local.get; i32.add、local.get; i32.const; i32.add 以及 local.get; local.get; i32.lt_s; br_if
+                    type: 'i32 -> i32',
+                    locals: ['i32', 'i32'],
+                    export: 'sum',
+                    body: `
+                        i32.const 0
+                        local.set 1
+                        i32.const 0
+                        local.set 2
+                        block
+                          local.get 0
+                          i32.const 1
+                          i32.lt_s
+                          br_if 0
+                          loop
+                            local.get 2
+                            local.get 1
+                            i32.add
+                            local.set 2
+                            local.get 1
+                            i32.const 1
+                            i32.add
+                            local.set 1
+                            local.get 1
+                            local.get 0
+                            i32.lt_s
+                            br_if 0
+                          end
+                        end
+                        local.get 2`,
+                },
+                {
+                    // 1：统计 n 递减到 0 的迭代次数，覆盖 local.get; i32.const; i32.sub 以及 local.tee; br_if
+                    type: 'i32 -> i32',
+                    locals: ['i32'],
+                    export: 'countdown',
+                    body: `
+                        loop
+                          local.get 1
+                          i32.const 1
+                          i32.add
+                          local.set 1
+                          local.get 0
+                          i32.const 1
+                          i32.sub
+                          local.tee 0
+                          br_if 0
+                        end
+                        local.get 1`,
+                },
+                {
+                    // 2：将参数截断到 100 以内，覆盖 i32.const; i32.gt_s; br_if
+                    type: 'i32 -> i32',
+                    export: 'clamp',
+                    body: `
+                        block
+                          local.get 0
+                          i32.const 100
+                          i32.gt_s
+                          br_if 0
+                          local.get 0
+                          return
+                        end
+                        i32.const 100`,
+                },
+                // 3：存储到常量地址再读出，覆盖 i32.const; local.get; i32.store
+                { type: 'i32 -> i32', export: 'store', body: 'i32.const 8 local.get 0 i32.store offset=4 i32.const 12 i32.load' },
+            ],
+        }),
+    },
+    assertReturn(invoke('sum', i32(10)), i32(45)),
+    assertReturn(invoke('sum', i32(1)), i32(0)),
+    assertReturn(invoke('sum', i32(0)), i32(0)),
+    assertReturn(invoke('sum', i32(-5)), i32(0)),
+    assertReturn(invoke('countdown', i32(5)), i32(5)),
+    assertReturn(invoke('countdown', i32(1)), i32(1)),
+    assertReturn(invoke('clamp', i32(5)), i32(5)),
+    assertReturn(invoke('clamp', i32(100)), i32(100)),
+    assertReturn(invoke('clamp', i32(101)), i32(100)),
+    assertReturn(invoke('clamp', i32(-1)), i32(-1)),
+    assertReturn(invoke('store', i32(-7)), i32(-7)),
+    // 这些函数的函数体以 wasmc 尚未支持的单字节操作码开头，执行时必须触发陷阱，而不是执行对应编号的超级指令
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['i32 -> i32'],
+            functions: formerOpcodes.map((code) => ({
+                type: 'i32 -> i32',
+                export: `op_${code.toString(16)}`,
+                body: `0x${code.toString(16)} i32.const 7 local.set 0 local.get 0`,
+            })),
+        }),
+    },
+    ...formerOpcodes.map((code) => assertTrap(invoke(`op_${code.toString(16)}`, i32(3)), 'illegal opcode')),
+]
@@ -0,0 +1,142 @@
+// 尾调用的测试用例：return_call/return_call_indirect 直接复用当前栈帧，无论尾调用的层数有多深，调用栈和操作数栈都不会增长，
+// 被调用函数的参数和局部变量数量可以与当前函数不同，被调用函数返回时直接返回到当前函数的调用方；
+// 导入函数没有可以复用的栈帧，直接或通过表尾调用导入函数时在所有执行层都会触发陷阱
+const { wasmModule, i32, i64, f64, invoke, assertReturn, assertTrap } = require('../wasm')
+
+module.exports = [
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['i32 i32 -> i32', 'i32 -> i32', 'i64 i64 -> i64', 'f64 i32 -> f64', 'i32 i64 f64 -> f64'],
+            table: [1, 2, 6],
+            functions: [
+                {
+                    // 0：尾递归 n 次，返回 acc + n
+                    type: 'i32 i32 -> i32',
+                    export: 'countdown',
+                    body: `
+                        local.get 0
+                        i32.eqz
+                        if
+                          local.get 1
+                          return
+                        end
+                        local.get 0
+                        i32.const 1
+                        i32.sub
+                        local.get 1
+                        i32.const 1
+                        i32.add
+                        return_call 0`,
+                },
+                // 1、2：相互尾递归，其中 odd 通过表间接尾调用 even
+                {
+                    type: 'i32 -> i32',
+                    export: 'even',
+                    body: 'local.get 0 i32.eqz if (result i32) i32.const 1 else local.get 0 i32.const 1 i32.sub return_call 2 end',
+                },
+                {
+                    type: 'i32 -> i32',
+                    export: 'odd',
+                    body: 'local.get 0 i32.eqz if (result i32) i32.const 0 else local.get 0 i32.const 1 i32.sub i32.const 0 return_call_indirect 1 end',
+                },
+                {
+                    // 3：尾递归计算阶乘（64 位）
+                    type: 'i64 i64 -> i64',
+                    export: 'fac',
+                    body: `
+                        local.get 0
+                        i64.eqz
+                        if
+                          local.get 1
+                          return
+                        end
+                        local.get 0
+                        i64.const 1
+                        i64.sub
+                        local.get 0
+                        local.get 1
+                        i64.mul
+                        return_call 3`,
+                },
+                {
+                    // 4：尾调用参数和局部变量更多的函数，被调用函数的局部变量必须重新初始化为 0
+                    type: 'f64 i32 -> f64',
+                    locals: ['i64', 'f64'],
+                    export: 'widen',
+                    body: `
+                        i64.const 99
+                        local.set 2
+                        f64.const 99
+                        local.set 3
+                        local.get 1
+                        local.get 1
+                        i64.extend_i32_s
+                        local.get 0
+                        return_call 5`,
+                },
+                {
+                    // 5：返回 a + b + c + 局部变量（应为 0）
+                    type: 'i32 i64 f64 -> f64',
+                    locals: ['f64', 'i64'],
+                    body: `
+                        local.get 0
+                        f64.convert_i32_s
+                        local.get 1
+                        f64.convert_i64_s
+                        f64.add
+                        local.get 2
+                        f64.add
+                        local.get 3
+                        f64.add
+                        local.get 4
+                        f64.convert_i64_s
+                        f64.add`,
+                },
+                // 6：函数签名与调用点不一致
+                { type: 'i32 i32 -> i32', body: 'local.get 0' },
+                // 7：通过表间接尾调用
+                { type: 'i32 i32 -> i32', export: 'indirect', body: 'local.get 0 local.get 1 return_call_indirect 1' },
+                // 8：调用以尾调用结尾的函数之后继续执行，检查尾调用只替换了被调用函数的栈帧
+                {
+                    type: 'i32 -> i32',
+                    export: 'caller',
+                    body: 'local.get 0 i32.const 0 call 0 i32.const 1 i32.add local.get 0 call 1 i32.add local.get 0 i32.const 0 call 7 i32.add',
+                },
+            ],
+        }),
+    },
+    assertReturn(invoke('countdown', i32(10), i32(5)), i32(15)),
+    // 尾调用不会增长调用栈，所以深度远超调用栈容量的尾递归也不会耗尽调用栈
+    assertReturn(invoke('countdown', i32(1000000), i32(0)), i32(1000000)),
+    assertReturn(invoke('even', i32(100001)), i32(0)),
+    assertReturn(invoke('odd', i32(100001)), i32(1)),
+    assertReturn(invoke('fac', i64(20), i64(1)), i64('2432902008176640000')),
+    assertReturn(invoke('widen', f64(0.5), i32(3)), f64(6.5)),
+    assertReturn(invoke('widen', f64(-4), i32(-1)), f64(-6)),
+    assertReturn(invoke('indirect', i32(7), i32(0)), i32(0)),
+    assertReturn(invoke('indirect', i32(7), i32(1)), i32(1)),
+    assertTrap(invoke('indirect', i32(7), i32(2)), 'indirect call type mismatch'),
+    // countdown(n, 0) + 1 + even(n) + even(n)
+    assertReturn(invoke('caller', i32(10)), i32(13)),
+    assertReturn(invoke('caller', i32(7)), i32(8)),
+    {
+        type: 'module',
+        bytes: wasmModule({
+            types: ['i32 -> i32'],
+            // 0：导入 libc 中的 abs 函数
+            imports: [{ module: 'libc.so.6', name: 'abs', type: 'i32 -> i32' }],
+            table: [0],
+            functions: [
+                { type: 'i32 -> i32', export: 'inc', body: 'local.get 0 i32.const 1 i32.add' },
+                { type: 'i32 -> i32', export: 'tail_import', body: 'local.get 0 return_call 0' },
+                { type: 'i32 -> i32', export: 'tail_import_indirect', body: 'local.get 0 i32.const 0 return_call_indirect 0' },
+            ],
+        }),
+    },
+    assertReturn(invoke('inc', i32(-5)), i32(-4)),
+    assertTrap(invoke('tail_import', i32(-5)), 'tail call to imported function is not supported'),
+    assertTrap(invoke('tail_import_indirect', i32(-5)), 'tail call to imported function is not supported'),
+    // 陷阱之后模块仍然可以继续执行
+    assertReturn(invoke('inc', i32(7)), i32(8)),
+]
@@ -0,0 +1,393 @@
+// 测试运行器：依次加载 res/spectest 中由 wast2json 生成的官方测试用例以及 test/cases 中的测试用例，
+// 通过命令行交互的方式（即每行输入一条 "函数名 参数..." 命令）调用 wasmc 执行导出函数，并检查执行结果。
+//
+// 用法：node test/runTests.js [--suite spectest|cases|all] [--aot WASMC_AOT] [--no-oob-traps] WASMC [wasmc 选项...]
+//
+// --aot WASMC_AOT：先使用 wasmc-aot 将每个模块预编译成 C 代码，再编译成共享库，通过 -a 选项加载执行
+// --no-oob-traps：用于 -b mask，该模式下越界访问不会触发陷阱，所以遇到期望越界陷阱的断言时，跳过该模块中剩余的断言
+//
+// 由于 wasmc 的命令行只能调用导出函数，且参数以空格分隔，以下测试命令会被跳过：
+// 1. 导入 spectest 模块或者其他已注册模块的模块（wasmc 只能通过 dlopen/dlsym 解析宿主机共享库中的导入函数）
+// 2. 读取导出全局变量（get）以及调用其他具名模块的命令
+// 3. 函数名包含空格或者不可打印字符的命令，以及参数或返回值为引用类型的命令
+// 4. 参数为非规范 NaN（即带有特定载荷的 NaN）的命令
+// 5. assert_invalid、assert_malformed、assert_unlinkable 等只校验模块本身的命令
+const fs = require('fs')
+const os = require('os')
+const path = require('path')
+const spawnSync = require('child_process').spawnSync
+
+const root = path.resolve(__dirname, '..')
+
+// 每条命令之后输入一个不存在的函数名，wasmc 对其的报错信息用于切分每条命令的输出
+const sentinel = '__wasmc_test_sentinel__'
+const sentinelError = `no exported function named '${sentinel}'`
+
+// 已知与 res/spectest 中的模块二进制格式不一致的断言：生成这些测试文件的 wast2json 版本
+// 在函数签名只通过类型索引给出时，将具名局部变量错误地编号为 0（即参数），导致断言期望读取局部变量，而模块实际读取的是参数
+const knownBroken = new Set(['func.wast:483', 'func.wast:484'])
+
+function parseOptions(argv) {
+    const options = { suite: 'all', aot: null, noOobTraps: false, wasmc: null, flags: [] }
+    let i = 0
+    while (i < argv.length && argv[i].startsWith('--')) {
+        if (argv[i] === '--suite') {
+            options.suite = argv[i + 1]
+            i += 2
+        } else if (argv[i] === '--aot') {
+            options.aot = argv[i + 1]
+            i += 2
+        } else if (argv[i] === '--no-oob-traps') {
+            options.noOobTraps = true
+            i += 1
+        } else {
+            throw new Error(`unknown option ${argv[i]}`)
+        }
+    }
+    options.wasmc = argv[i]
+    options.flags = argv.slice(i + 1)
+    if (!options.wasmc || !['spectest', 'cases', 'all'].includes(options.suite)) {
+        console.error(
+            'The right usage is:\nnode test/runTests.js [--suite spectest|cases|all] [--aot WASMC_AOT] [--no-oob-traps] WASMC [WASMC_OPTIONS...]'
+        )
+        process.exit(2)
+    }
+    return options
+}
+
+// 解析 Wasm 模块的导入段，返回所有导入项所属的模块名
+function importModules(bytes) {
+    const modules = []
+    let pos = 8
+    const uleb = () => {
+        let result = 0
+        let shift = 0
+        let byte
+        do {
+            byte = bytes[pos++]
+            result += (byte & 0x7f) * 2 ** shift
+            shift += 7
+        } while (byte & 0x80)
+        return result
+    }
+    const name = () => {
+        const length = uleb()
+        pos += length
+        return bytes.toString('utf8', pos - length, pos)
+    }
+    while (pos < bytes.length) {
+        const id = bytes[pos++]
+        const size = uleb()
+        const end = pos + size
+        if (id === 2) {
+            const count = uleb()
+            for (let i = 0; i < count; i++) {
+                modules.push(name())
+                name()
+                // 跳过导入项的描述：函数（类型索引）、表（引用类型和限制）、内存（限制）、全局变量（值类型和可变性）
+                const kind = bytes[pos++]
+                if (kind === 0) {
+                    uleb()
+                } else if (kind === 1) {
+                    pos++
+                    const flags = bytes[pos++]
+                    uleb()
+                    if (flags & 1) {
+                        uleb()
+                    }
+                } else if (kind === 2) {
+                    const flags = bytes[pos++]
+                    uleb()
+                    if (flags & 1) {
+                        uleb()
+                    }
+                } else {
+                    pos += 2
+                }
+            }
+        }
+        pos = end
+    }
+    return modules
+}
+
+// 加载 res/spectest 中的官方测试用例，每个测试文件对应一组模块及其测试命令
+function loadSpectest() {
+    const dir = path.resolve(root, 'res/spectest')
+    const groups = []
+    for (const name of fs.readdirSync(dir).sort()) {
+        const json = path.resolve(dir, name, `${name}.json`)
+        if (!fs.existsSync(json)) {
+            continue
+        }
+        const commands = JSON.parse(fs.readFileSync(json, 'utf8')).commands
+        const registered = new Set(['spectest'])
+        for (const command of commands) {
+            if (command.type === 'register') {
+                registered.add(command.as)
+            }
+        }
+        let current = null
+        for (const command of commands) {
+            if (command.type === 'module') {
+                const bytes = fs.readFileSync(path.resolve(dir, name, command.filename))
+                const skip = importModules(bytes).some((m) => registered.has(m))
+                current = { name: `${name}/${command.filename}`, file: path.resolve(dir, name, command.filename), skip, commands: [] }
+                groups.push(current)
+            } else if (current && command.action && !knownBroken.has(`${name}.wast:${command.line}`)) {
+                current.commands.push({ ...command, label: `${name}.wast:${command.line}` })
+            }
+        }
+    }
+    return groups
+}
+
+// 加载 test/cases 中的测试用例，每个文件导出一组 wast2json 格式的命令，其中 module 命令直接包含模块的二进制格式，
+// 还可以通过 flags 为该模块追加 wasmc 选项（例如指定越界检查方式），通过 addressSpace 限制 wasmc 进程的虚拟地址空间（单位为 KiB），
+// 通过 filename 指定模块文件名，同名的模块共用同一个模块文件（所有模块文件都在执行之前写入）
+function loadCases(tmpdir) {
+    const dir = path.resolve(__dirname, 'cases')
+    const groups = []
+    for (const name of fs.readdirSync(dir).sort()) {
+        if (!name.endsWith('.js')) {
+            continue
+        }
+        const commands = require(path.resolve(dir, name))
+        let current = null
+        commands.forEach((command, i) => {
+            if (command.type === 'module') {
+                const file = path.resolve(tmpdir, command.filename || `${name.slice(0, -3)}.${groups.length}.wasm`)
+                if (!fs.existsSync(file)) {
+                    fs.writeFileSync(file, command.bytes)
+                }
+                current = {
+                    name: `${name}#${i}`,
+                    file,
+                    skip: false,
+                    flags: command.flags || [],
+                    addressSpace: command.addressSpace,
+                    commands: [],
+                }
+                groups.push(current)
+            } else {
+                current.commands.push({ ...command, label: `${name}#${i}` })
+            }
+        })
+    }
+    return groups
+}
+
+const numberTypes = ['i32', 'i64', 'f32', 'f64']
+
+// 将 wast2json 格式的参数转换成 wasmc 命令行中的参数，无法表示时返回 null
+function formatArg(arg) {
+    if (!numberTypes.includes(arg.type)) {
+        return null
+    }
+    if (arg.type === 'i32' || arg.type === 'i64') {
+        return arg.value
+    }
+    const value = floatValue(arg)
+    if (Number.isNaN(value)) {
+        // wasmc 只能构造规范 NaN，其他载荷的 NaN 无法通过命令行传入
+        const bits = BigInt(arg.value)
+        const canonical = arg.type === 'f32' ? [0x7fc00000n, 0xffc00000n] : [0x7ff8000000000000n, 0xfff8000000000000n]
+        if (bits === canonical[0]) {
+            return 'nan'
+        }
+        return bits === canonical[1] ? '-nan' : null
+    }
+    return Object.is(value, -0) ? '-0' : String(value)
+}
+
+// 将浮点数参数或者期望值的二进制表示转换成 JS 中的数值
+function floatValue(v) {
+    const buffer = Buffer.alloc(8)
+    if (v.type === 'f32') {
+        buffer.writeUInt32LE(Number(v.value))
+        return buffer.readFloatLE()
+    }
+    buffer.writeBigUInt64LE(BigInt(v.value))
+    return buffer.readDoubleLE()
+}
+
+// 检查 wasmc 打印的单个返回值（例如 0x2a:i32）是否与期望值一致，浮点数按照 wasmc 打印的 7 位有效数字近似比较
+function matchResult(expected, actual) {
+    const [text, type] = actual.split(':')
+    if (type !== expected.type) {
+        return false
+    }
+    if (type === 'i32') {
+        return text === `0x${Number(expected.value).toString(16)}`
+    }
+    if (type === 'i64') {
+        return text === expected.value
+    }
+    if (expected.value.startsWith('nan:')) {
+        return /nan/.test(text)
+    }
+    const want = floatValue(expected)
+    const got = text === 'inf' ? Infinity : text === '-inf' ? -Infinity : Number(text)
+    if (Number.isNaN(want)) {
+        return /nan/.test(text)
+    }
+    if (want === 0 || !Number.isFinite(want)) {
+        return Object.is(want, got)
+    }
+    return Math.abs(got - want) <= Math.abs(want) * 1e-6
+}
+
+// 检查单条命令的输出是否符合期望，返回失败原因，成功时返回 null
+function check(command, output) {
+    const lines = output.split('\n').map((l) => l.trim()).filter((l) => l)
+    const exception = lines.find((l) => l.startsWith('Exception'))
+    if (command.type === 'assert_trap' || command.type === 'assert_exhaustion') {
+        return exception ? null : `expected trap '${command.text}', got '${lines.join(' ')}'`
+    }
+    if (exception) {
+        return `unexpected ${exception}`
+    }
+    if (command.type === 'action') {
+        return null
+    }
+    const actual = lines.length ? lines[lines.length - 1].split(' ') : []
+    const want = command.expected
+    if (actual.length !== want.length || !want.every((e, i) => matchResult(e, actual[i]))) {
+        const text = want.map((e) => `${e.value}:${e.type}`).join(' ')
+        return `expected '${text}', got '${lines.join(' ')}'`
+    }
+    return null
+}
+
+// 判断命令能否通过 wasmc 的命令行执行
+function runnable(command) {
+    const action = command.action
+    if (!['assert_return', 'assert_trap', 'assert_exhaustion', 'action'].includes(command.type)) {
+        return false
+    }
+    if (action.type !== 'invoke' || action.module || !/^[\x21-\x7e]+$/.test(action.field) || action.field === 'quit') {
+        return false
+    }
+    if ((command.expected || []).some((e) => !numberTypes.includes(e.type))) {
+        return false
+    }
+    return action.args.every((a) => formatArg(a) !== null)
+}
+
+// 使用 wasmc-aot 预编译模块，失败时（例如 wasmc-aot 不支持 64 位内存）返回 null
+function precompile(options, file) {
+    const c = file.replace(/\.wasm$/, '.c')
+    const so = file.replace(/\.wasm$/, '.so')
+    if (spawnSync(options.aot, [file, c], { stdio: 'ignore' }).status !== 0) {
+        return null
+    }
+    const cc = spawnSync(process.env.CC || 'cc', ['-O2', '-fsignaling-nans', '-shared', '-fPIC', '-I', path.resolve(root, 'source'), c, '-o', so], {
+        encoding: 'utf8',
+    })
+    if (cc.status !== 0) {
+        throw new Error(`could not compile ${c}:\n${cc.stderr}`)
+    }
+    return so
+}
+
+function runGroup(options, group, stats) {
+    let commands = group.commands.filter(runnable)
+    stats.skipped += group.commands.length - commands.length
+    if (group.skip || !commands.length) {
+        stats.skipped += commands.length
+        return
+    }
+
+    // 越界访问不会触发陷阱时，第一个期望越界陷阱的断言之后，线性内存的状态已经与预期不一致，因此跳过剩余的断言
+    if (options.noOobTraps) {
+        const oob = commands.findIndex((c) => c.type === 'assert_trap' && /out of bounds memory access/.test(c.text))
+        if (oob >= 0) {
+            stats.skipped += commands.length - oob
+            commands = commands.slice(0, oob)
+        }
+    }
+
+    let flags = [...options.flags, ...(group.flags || [])]
+    if (options.aot) {
+        // 预编译模块只能配合保护页使用，自行指定越界检查方式的模块无法预编译
+        if (flags.includes('-b')) {
+            stats.skipped += commands.length
+            return
+        }
+        const so = precompile(options, group.file)
+        if (!so) {
+            stats.skipped += commands.length
+            return
+        }
+        flags = [...flags, '-a', so]
+    }
+
+    const input = commands.map((c) => `${[c.action.field, ...c.action.args.map(formatArg)].join(' ')}\n${sentinel}\n`).join('')
+    const limit = group.addressSpace ? `ulimit -v ${group.addressSpace}; ` : ''
+    const result = spawnSync('sh', ['-c', `${limit}exec "$0" "$@" 2>&1`, options.wasmc, ...flags, group.file], {
+        input,
+        encoding: 'utf8',
+        timeout: 120000,
+        maxBuffer: 64 * 1024 * 1024,
+    })
+    const output = (result.stdout || '')
+        .replace(/\x1b\[[0-9;]*m/g, '')
+        .replace(/wasmc\$ /g, '\n')
+    const segments = output.split(sentinelError)
+
+    commands.forEach((command, i) => {
+        stats.total++
+        const fields = new Set([command.action.field, sentinel])
+        let error
+        if (i >= segments.length - 1) {
+            error = `wasmc exited (status ${result.status}, signal ${result.signal}): ${segments[segments.length - 1].trim()}`
+        } else {
+            // readline 在标准输入不是终端时会回显输入的命令，需要将其过滤掉
+            const text = segments[i]
+                .split('\n')
+                .filter((l) => !fields.has(l.trim().split(' ')[0]))
+                .join('\n')
+            error = check(command, text)
+        }
+        if (error) {
+            stats.failed++
+            console.log(`FAIL ${command.label} ${command.action.field}: ${error}`)
+        } else {
+            stats.passed++
+        }
+    })
+}
+
+function main() {
+    const options = parseOptions(process.argv.slice(2))
+    const tmpdir = fs.mkdtempSync(path.resolve(os.tmpdir(), 'wasmc-test-'))
+    const stats = { total: 0, passed: 0, failed: 0, skipped: 0 }
+    try {
+        let groups = []
+        if (options.suite !== 'cases') {
+            groups = groups.concat(
+                loadSpectest().map((g) => {
+                    if (!options.aot) {
+                        return g
+                    }
+                    // 预编译的产物写入临时目录，避免污染 res/spectest
+                    const file = path.resolve(tmpdir, g.name.replace('/', '.'))
+                    fs.copyFileSync(g.file, file)
+                    return { ...g, file }
+                })
+            )
+        }
+        if (options.suite !== 'spectest') {
+            groups = groups.concat(loadCases(tmpdir))
+        }
+        for (const group of groups) {
+            runGroup(options, group, stats)
+        }
+    } finally {
+        fs.rmSync(tmpdir, { recursive: true, force: true })
+    }
+    console.log(`total ${stats.total} passed ${stats.passed} failed ${stats.failed} skipped ${stats.skipped}`)
+    process.exit(stats.failed ? 1 : 0)
+}
+
+main()
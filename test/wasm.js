@@ -0,0 +1,392 @@
+// 测试用例使用的最小 Wasm 汇编器：由于测试环境中不一定有 wabt（wat2wasm/wast2json），
+// 测试用例中的模块直接以 JS 对象描述，函数体使用与 WAT 相同的扁平指令文本（不支持折叠形式的 S 表达式），
+// 由该汇编器生成 Wasm 二进制格式，再交给 wasmc 加载执行
+
+// 值类型及其编码
+const valueTypes = { i32: 0x7f, i64: 0x7e, f32: 0x7d, f64: 0x7c }
+
+// 指令名称及其操作码，按照操作码顺序排列；immediates 为立即数的种类
+const opcodes = {}
+
+function defineOp(name, code, immediates = []) {
+    opcodes[name] = { code, immediates }
+}
+
+defineOp('unreachable', 0x00)
+defineOp('nop', 0x01)
+defineOp('block', 0x02, ['blocktype'])
+defineOp('loop', 0x03, ['blocktype'])
+defineOp('if', 0x04, ['blocktype'])
+defineOp('else', 0x05)
+defineOp('end', 0x0b)
+defineOp('br', 0x0c, ['u32'])
+defineOp('br_if', 0x0d, ['u32'])
+defineOp('br_table', 0x0e, ['labels'])
+defineOp('return', 0x0f)
+defineOp('call', 0x10, ['u32'])
+defineOp('call_indirect', 0x11, ['u32', 'table'])
+defineOp('return_call', 0x12, ['u32'])
+defineOp('return_call_indirect', 0x13, ['u32', 'table'])
+defineOp('drop', 0x1a)
+defineOp('select', 0x1b)
+defineOp('local.get', 0x20, ['u32'])
+defineOp('local.set', 0x21, ['u32'])
+defineOp('local.tee', 0x22, ['u32'])
+defineOp('global.get', 0x23, ['u32'])
+defineOp('global.set', 0x24, ['u32'])
+
+// 内存加载/存储指令，第三项为访问的字节数，即默认的对齐方式
+const memoryOps = [
+    ['i32.load', 0x28, 4], ['i64.load', 0x29, 8], ['f32.load', 0x2a, 4], ['f64.load', 0x2b, 8],
+    ['i32.load8_s', 0x2c, 1], ['i32.load8_u', 0x2d, 1], ['i32.load16_s', 0x2e, 2], ['i32.load16_u', 0x2f, 2],
+    ['i64.load8_s', 0x30, 1], ['i64.load8_u', 0x31, 1], ['i64.load16_s', 0x32, 2], ['i64.load16_u', 0x33, 2],
+    ['i64.load32_s', 0x34, 4], ['i64.load32_u', 0x35, 4],
+    ['i32.store', 0x36, 4], ['i64.store', 0x37, 8], ['f32.store', 0x38, 4], ['f64.store', 0x39, 8],
+    ['i32.store8', 0x3a, 1], ['i32.store16', 0x3b, 2], ['i64.store8', 0x3c, 1], ['i64.store16', 0x3d, 2],
+    ['i64.store32', 0x3e, 4],
+]
+for (const [name, code, size] of memoryOps) {
+    opcodes[name] = { code, immediates: ['memarg'], size }
+}
+
+defineOp('memory.size', 0x3f, ['memory'])
+defineOp('memory.grow', 0x40, ['memory'])
+defineOp('i32.const', 0x41, ['i32'])
+defineOp('i64.const', 0x42, ['i64'])
+defineOp('f32.const', 0x43, ['f32'])
+defineOp('f64.const', 0x44, ['f64'])
+
+// 数值指令（0x45 ~ 0xc4）没有立即数，操作码依次递增
+const numericOps = [
+    'i32.eqz', 'i32.eq', 'i32.ne', 'i32.lt_s', 'i32.lt_u', 'i32.gt_s', 'i32.gt_u', 'i32.le_s', 'i32.le_u', 'i32.ge_s', 'i32.ge_u',
+    'i64.eqz', 'i64.eq', 'i64.ne', 'i64.lt_s', 'i64.lt_u', 'i64.gt_s', 'i64.gt_u', 'i64.le_s', 'i64.le_u', 'i64.ge_s', 'i64.ge_u',
+    'f32.eq', 'f32.ne', 'f32.lt', 'f32.gt', 'f32.le', 'f32.ge',
+    'f64.eq', 'f64.ne', 'f64.lt', 'f64.gt', 'f64.le', 'f64.ge',
+    'i32.clz', 'i32.ctz', 'i32.popcnt', 'i32.add', 'i32.sub', 'i32.mul', 'i32.div_s', 'i32.div_u', 'i32.rem_s', 'i32.rem_u',
+    'i32.and', 'i32.or', 'i32.xor', 'i32.shl', 'i32.shr_s', 'i32.shr_u', 'i32.rotl', 'i32.rotr',
+    'i64.clz', 'i64.ctz', 'i64.popcnt', 'i64.add', 'i64.sub', 'i64.mul', 'i64.div_s', 'i64.div_u', 'i64.rem_s', 'i64.rem_u',
+    'i64.and', 'i64.or', 'i64.xor', 'i64.shl', 'i64.shr_s', 'i64.shr_u', 'i64.rotl', 'i64.rotr',
+    'f32.abs', 'f32.neg', 'f32.ceil', 'f32.floor', 'f32.trunc', 'f32.nearest', 'f32.sqrt',
+    'f32.add', 'f32.sub', 'f32.mul', 'f32.div', 'f32.min', 'f32.max', 'f32.copysign',
+    'f64.abs', 'f64.neg', 'f64.ceil', 'f64.floor', 'f64.trunc', 'f64.nearest', 'f64.sqrt',
+    'f64.add', 'f64.sub', 'f64.mul', 'f64.div', 'f64.min', 'f64.max', 'f64.copysign',
+    'i32.wrap_i64', 'i32.trunc_f32_s', 'i32.trunc_f32_u', 'i32.trunc_f64_s', 'i32.trunc_f64_u',
+    'i64.extend_i32_s', 'i64.extend_i32_u', 'i64.trunc_f32_s', 'i64.trunc_f32_u', 'i64.trunc_f64_s', 'i64.trunc_f64_u',
+    'f32.convert_i32_s', 'f32.convert_i32_u', 'f32.convert_i64_s', 'f32.convert_i64_u', 'f32.demote_f64',
+    'f64.convert_i32_s', 'f64.convert_i32_u', 'f64.convert_i64_s', 'f64.convert_i64_u', 'f64.promote_f32',
+    'i32.reinterpret_f32', 'i64.reinterpret_f64', 'f32.reinterpret_i32', 'f64.reinterpret_i64',
+    'i32.extend8_s', 'i32.extend16_s', 'i64.extend8_s', 'i64.extend16_s', 'i64.extend32_s',
+]
+numericOps.forEach((name, i) => defineOp(name, 0x45 + i))
+
+// 无符号 LEB128 编码（value 为 Number 或者 BigInt）
+function uleb(value) {
+    let n = BigInt(value)
+    const out = []
+    do {
+        let byte = Number(n & 0x7fn)
+        n >>= 7n
+        if (n !== 0n) {
+            byte |= 0x80
+        }
+        out.push(byte)
+    } while (n !== 0n)
+    return out
+}
+
+// 有符号 LEB128 编码（value 为 Number 或者 BigInt）
+function sleb(value) {
+    let n = BigInt(value)
+    const out = []
+    while (true) {
+        const byte = Number(n & 0x7fn)
+        n >>= 7n
+        if ((n === 0n && !(byte & 0x40)) || (n === -1n && byte & 0x40)) {
+            out.push(byte)
+            return out
+        }
+        out.push(byte | 0x80)
+    }
+}
+
+function vec(items) {
+    return [...uleb(items.length), ...items.flat()]
+}
+
+function name(str) {
+    const bytes = [...Buffer.from(str, 'utf8')]
+    return [...uleb(bytes.length), ...bytes]
+}
+
+function section(id, body) {
+    return [id, ...uleb(body.length), ...body]
+}
+
+// 解析函数签名的简写形式，例如 'i32 i64 -> f32'
+function parseType(type) {
+    const [params, results] = type.split('->').map((part) => part.trim().split(/\s+/).filter((t) => t))
+    return { params, results }
+}
+
+function encodeType(type) {
+    const { params, results } = parseType(type)
+    return [0x60, ...vec(params.map((t) => [valueTypes[t]])), ...vec(results.map((t) => [valueTypes[t]]))]
+}
+
+// 将扁平指令文本拆分成单词，括号单独作为一个单词，; 之后的内容为注释
+function tokenize(text) {
+    return text
+        .replace(/;;[^\n]*/g, ' ')
+        .replace(/[()]/g, ' $& ')
+        .split(/\s+/)
+        .filter((t) => t)
+}
+
+function isNumber(token) {
+    return token !== undefined && /^[-+]?(0x[0-9a-f_]+|[0-9_]+)$/i.test(token)
+}
+
+function parseInteger(token) {
+    const text = token.replace(/_/g, '')
+    const negative = text.startsWith('-')
+    const n = BigInt(text.replace(/^[-+]/, ''))
+    return negative ? -n : n
+}
+
+// 将浮点数常量编码成小端字节序（支持 nan、inf 以及十进制和十六进制整数形式的字面量）
+function encodeFloat(token, bytes) {
+    const buffer = Buffer.alloc(bytes)
+    const value = token === 'nan' ? NaN : token === '-nan' ? -NaN : token === 'inf' ? Infinity : token === '-inf' ? -Infinity : Number(token)
+    if (bytes === 4) {
+        buffer.writeFloatLE(value)
+    } else {
+        buffer.writeDoubleLE(value)
+    }
+    return [...buffer]
+}
+
+// 汇编函数体，memory64 为 true 时内存参数中的偏移量可以超过 32 位
+function assemble(text, memory64) {
+    const tokens = tokenize(text)
+    const out = []
+    let i = 0
+    while (i < tokens.length) {
+        const op = opcodes[tokens[i]]
+        // 直接以 0xNN 形式写出的单个字节，用于构造 wasmc 尚未支持的操作码
+        if (!op && /^0x[0-9a-f]{2}$/i.test(tokens[i])) {
+            out.push(Number(tokens[i++]))
+            continue
+        }
+        if (!op) {
+            throw new Error(`unknown instruction '${tokens[i]}'`)
+        }
+        i++
+        out.push(op.code)
+        for (const kind of op.immediates) {
+            switch (kind) {
+                case 'u32':
+                    out.push(...uleb(parseInteger(tokens[i++])))
+                    break
+                case 'labels': {
+                    const labels = []
+                    while (isNumber(tokens[i])) {
+                        labels.push(parseInteger(tokens[i++]))
+                    }
+                    const fallback = labels.pop()
+                    out.push(...vec(labels.map((l) => uleb(l))), ...uleb(fallback))
+                    break
+                }
+                case 'table':
+                case 'memory':
+                    out.push(0x00)
+                    break
+                case 'i32':
+                case 'i64':
+                    out.push(...sleb(parseInteger(tokens[i++])))
+                    break
+                case 'f32':
+                    out.push(...encodeFloat(tokens[i++], 4))
+                    break
+                case 'f64':
+                    out.push(...encodeFloat(tokens[i++], 8))
+                    break
+                case 'blocktype':
+                    // 块类型：空、(result T) 或者 (type N)（多返回值以及带参数的块）
+                    if (tokens[i] === '(' && tokens[i + 1] === 'result') {
+                        out.push(valueTypes[tokens[i + 2]])
+                        i += 4
+                    } else if (tokens[i] === '(' && tokens[i + 1] === 'type') {
+                        out.push(...sleb(parseInteger(tokens[i + 2])))
+                        i += 4
+                    } else {
+                        out.push(0x40)
+                    }
+                    break
+                case 'memarg': {
+                    // 内存参数：offset=N align=N，默认按照访问的字节数对齐
+                    let offset = 0n
+                    let align = op.size
+                    while (/^(offset|align)=/.test(tokens[i] || '')) {
+                        const [key, value] = tokens[i++].split('=')
+                        if (key === 'offset') {
+                            offset = parseInteger(value)
+                        } else {
+                            align = Number(parseInteger(value))
+                        }
+                    }
+                    if (!memory64 && offset > 0xffffffffn) {
+                        throw new Error('offset out of range for a 32-bit memory')
+                    }
+                    out.push(...uleb(Math.log2(align)), ...uleb(offset))
+                    break
+                }
+            }
+        }
+    }
+    return [...out, 0x0b]
+}
+
+function limits(min, max, flags = 0) {
+    return max === undefined ? [flags, ...uleb(min)] : [flags | 1, ...uleb(min), ...uleb(max)]
+}
+
+function constExpr(type, value) {
+    if (type === 'f32' || type === 'f64') {
+        const buffer = Buffer.alloc(type === 'f32' ? 4 : 8)
+        type === 'f32' ? buffer.writeFloatLE(value) : buffer.writeDoubleLE(value)
+        return [type === 'f32' ? 0x43 : 0x44, ...buffer, 0x0b]
+    }
+    return [type === 'i64' ? 0x42 : 0x41, ...sleb(value), 0x0b]
+}
+
+// 根据模块描述生成 Wasm 二进制格式，模块描述的字段如下（均为可选）：
+// types：函数签名的简写形式，例如 ['i32 -> i32', 'i32 i32 -> i32 i32']
+// imports：导入函数 [{module, name, type}]，函数索引从 0 开始依次分配给导入函数
+// functions：函数 [{type, locals, body, export}]，其中 locals 为局部变量类型的数组，body 为扁平指令文本（也可以直接写出 0xNN 形式的单个字节）
+// table：表中依次存放的函数索引，表的大小与之相同
+// memory：{min, max, memory64}
+// globals：全局变量 [{type, mutable, value}]
+// data：数据段 [{offset, bytes, pageAligned}]，pageAligned 为 true 时通过自定义段填充，
+//       使数据在文件中的偏移量与其内存偏移量相对于 4 KiB 的宿主机内存页对齐方式一致（最多只能有一个这样的数据段）
+function wasmModule(desc) {
+    const types = desc.types || []
+    const imports = desc.imports || []
+    const functions = desc.functions || []
+    const memory64 = desc.memory && desc.memory.memory64
+
+    const typeIndex = (type) => (typeof type === 'number' ? type : types.indexOf(type))
+    for (const f of [...imports, ...functions]) {
+        if (typeIndex(f.type) < 0) {
+            throw new Error(`undeclared function type '${f.type}'`)
+        }
+    }
+
+    const sections = []
+    sections.push(section(1, vec(types.map(encodeType))))
+    if (imports.length) {
+        sections.push(section(2, vec(imports.map((imp) => [...name(imp.module), ...name(imp.name), 0x00, ...uleb(typeIndex(imp.type))]))))
+    }
+    sections.push(section(3, vec(functions.map((f) => uleb(typeIndex(f.type))))))
+    if (desc.table) {
+        sections.push(section(4, vec([[0x70, ...limits(desc.table.length)]])))
+    }
+    if (desc.memory) {
+        sections.push(section(5, vec([limits(desc.memory.min, desc.memory.max, memory64 ? 0x04 : 0)])))
+    }
+    if (desc.globals) {
+        sections.push(section(6, vec(desc.globals.map((g) => [valueTypes[g.type], g.mutable ? 1 : 0, ...constExpr(g.type, g.value || 0)]))))
+    }
+
+    const exports = []
+    functions.forEach((f, i) => {
+        if (f.export) {
+            exports.push([...name(f.export), 0x00, ...uleb(imports.length + i)])
+        }
+    })
+    sections.push(section(7, vec(exports)))
+
+    if (desc.table) {
+        sections.push(section(9, vec([[0x00, ...constExpr('i32', 0), ...vec(desc.table.map((f) => uleb(f)))]])))
+    }
+
+    sections.push(
+        section(
+            10,
+            vec(
+                functions.map((f) => {
+                    const locals = vec((f.locals || []).map((t) => [1, valueTypes[t]]))
+                    const body = [...locals, ...assemble(f.body, memory64)]
+                    return [...uleb(body.length), ...body]
+                })
+            )
+        )
+    )
+
+    const header = [0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00]
+    let bytes = [...header, ...sections.flat()]
+
+    if (desc.data) {
+        const segment = (d) => [0x00, ...constExpr(memory64 ? 'i64' : 'i32', d.offset), ...uleb(d.bytes.length)]
+        const body = vec(desc.data.map((d) => [...segment(d), ...d.bytes]))
+        const data = section(11, body)
+        const aligned = desc.data.findIndex((d) => d.pageAligned)
+        if (aligned >= 0) {
+            // 数据在数据段中的偏移量：数据段的段头、数据段个数，以及之前的数据段和该数据段的头部
+            let offset = data.length - body.length + uleb(desc.data.length).length
+            for (let k = 0; k < aligned; k++) {
+                offset += segment(desc.data[k]).length + desc.data[k].bytes.length
+            }
+            offset += segment(desc.data[aligned]).length
+            // 逐个尝试自定义段中填充的字节数，直到数据在文件中的偏移量与其内存偏移量相对于宿主机内存页的对齐方式一致
+            const padName = name('pad')
+            for (let pad = 0; pad < 8192; pad++) {
+                const customLength = 1 + uleb(padName.length + pad).length + padName.length + pad
+                if ((BigInt(desc.data[aligned].offset) - BigInt(bytes.length + customLength + offset)) % 4096n === 0n) {
+                    bytes = bytes.concat(section(0, [...padName, ...new Array(pad).fill(0)]))
+                    break
+                }
+            }
+        }
+        bytes = bytes.concat(data)
+    }
+    return Buffer.from(bytes)
+}
+
+// 以下函数用于构造与 wast2json 输出格式一致的测试命令，值均以无符号十进制整数（浮点数为其二进制表示）的字符串保存
+function i32(value) {
+    return { type: 'i32', value: String(Number(value) >>> 0) }
+}
+
+function i64(value) {
+    return { type: 'i64', value: BigInt.asUintN(64, BigInt(value)).toString() }
+}
+
+function f32(value) {
+    const buffer = Buffer.alloc(4)
+    buffer.writeFloatLE(value)
+    return { type: 'f32', value: String(buffer.readUInt32LE()) }
+}
+
+function f64(value) {
+    const buffer = Buffer.alloc(8)
+    buffer.writeDoubleLE(value)
+    return { type: 'f64', value: buffer.readBigUInt64LE().toString() }
+}
+
+function invoke(field, ...args) {
+    return { type: 'invoke', field, args }
+}
+
+function assertReturn(action, ...expected) {
+    return { type: 'assert_return', action, expected }
+}
+
+function assertTrap(action, text) {
+    return { type: 'assert_trap', action, text }
+}
+
+function assertExhaustion(action, text) {
+    return { type: 'assert_exhaustion', action, text }
+}
+
+module.exports = { wasmModule, i32, i64, f32, f64, invoke, assertReturn, assertTrap, assertExhaustion }